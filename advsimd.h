@@ -0,0 +1,264 @@
+// advsimd.h - written and placed in the public domain
+
+//! \file advsimd.h
+//! \brief Template for AdvancedProcessBlocks with SIMD kernels
+//! \details AdvancedProcessBlocks_SSE2() lets a block cipher plug a multi-block SIMD kernel
+//!   into BlockTransformation::AdvancedProcessBlocks(). The template gathers the blocks into
+//!   SSE2 registers, handles the counter, xorBlocks and the BT_* flags, and leaves the round
+//!   function to the kernel. The kernel is free to repack the registers into wider vectors.
+//! \since Crypto++ 6.0
+
+#ifndef CRYPTOPP_ADVSIMD_H
+#define CRYPTOPP_ADVSIMD_H
+
+#include "config.h"
+#include "cryptlib.h"
+#include "misc.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE || CRYPTOPP_DOXYGEN_PROCESSING
+
+//! \brief Reverses the bytes in a 128-bit register
+//! \param x the value to reverse
+//! \details ByteReverse_SSE2() uses SSE2 shifts and shuffles, so it does not depend on SSSE3 pshufb.
+inline __m128i ByteReverse_SSE2(const __m128i &x)
+{
+	const __m128i y = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+	const __m128i z = _mm_shufflehi_epi16(_mm_shufflelo_epi16(y, _MM_SHUFFLE(0,1,2,3)), _MM_SHUFFLE(0,1,2,3));
+	return _mm_shuffle_epi32(z, _MM_SHUFFLE(1,0,3,2));
+}
+
+//! \brief Generates consecutive 16-byte counter blocks across a carry
+//! \param counter the counter block, which is advanced past the generated blocks
+//! \param x the generated blocks
+//! \param n the number of blocks to generate
+//! \param flags the flags passed to BlockTransformation::AdvancedProcessBlocks()
+//! \details The block is byte reversed so that a 32-bit or 64-bit add carries across the
+//!   counter, and reversed back. It is kept out of line so the common case stays small
+//!   enough for the callers' kernels to be inlined.
+CRYPTOPP_NOINLINE inline void GenerateCarryCounterBlocks_SSE2(byte *counter, __m128i *x, unsigned int n, word32 flags)
+{
+	const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+	const bool counter64 = !!(flags & BlockTransformation::BT_Counter64);
+	__m128i c = ByteReverse_SSE2(_mm_loadu_si128((const __m128i *)(const void *)counter));
+	for (unsigned int i=0; i<n; ++i)
+	{
+		x[i] = ByteReverse_SSE2(c);
+		c = counter64 ? _mm_add_epi64(c, one) : _mm_add_epi32(c, one);
+	}
+	_mm_storeu_si128((__m128i *)(void *)counter, ByteReverse_SSE2(c));
+}
+
+//! \brief Generates consecutive 16-byte counter blocks
+//! \param counter the counter block, which is advanced past the generated blocks
+//! \param x the generated blocks
+//! \param n the number of blocks to generate
+//! \param flags the flags passed to BlockTransformation::AdvancedProcessBlocks()
+//! \details The counter is the last byte of the block, or the last 4 or 8 bytes with
+//!   BT_Counter32 or BT_Counter64. While the last byte does not wrap, each block costs a
+//!   single byte add. Otherwise GenerateCarryCounterBlocks_SSE2() handles the carry.
+inline void GenerateCounterBlocks_SSE2(byte *counter, __m128i *x, unsigned int n, word32 flags)
+{
+	const word32 wide = BlockTransformation::BT_Counter32|BlockTransformation::BT_Counter64;
+	if ((flags & wide) && counter[15] + n >= 256)
+	{
+		GenerateCarryCounterBlocks_SSE2(counter, x, n, flags);
+		return;
+	}
+
+	const __m128i one = _mm_set_epi32(1<<24, 0, 0, 0);
+	__m128i c = _mm_loadu_si128((const __m128i *)(const void *)counter);
+	for (unsigned int i=0; i<n; ++i, c = _mm_add_epi8(c, one))
+		x[i] = c;
+	_mm_storeu_si128((__m128i *)(void *)counter, c);
+}
+
+//! \brief Generates consecutive 8-byte counter blocks
+//! \param counter the counter block, which is advanced past the generated blocks
+//! \param x the generated blocks, two to a register
+//! \param n the number of registers to generate
+//! \param flags the flags passed to BlockTransformation::AdvancedProcessBlocks()
+//! \details The counter is handled as in GenerateCounterBlocks_SSE2(). When the last byte
+//!   wraps the blocks are computed with a 64-bit add and a mask for the counter width.
+inline void GenerateCounterBlocks64_SSE2(byte *counter, __m128i *x, unsigned int n, word32 flags)
+{
+	const word32 wide = BlockTransformation::BT_Counter32|BlockTransformation::BT_Counter64;
+
+	if (!(flags & wide) || counter[7] + 2*n < 256)
+	{
+		// Load the counter into both halves and add one to the high half
+		const __m128i one = _mm_set_epi32(1<<24, 0, 0, 0);
+		const __m128i step = _mm_set_epi32(2<<24, 0, 2<<24, 0);
+		const __m128i c = _mm_loadl_epi64((const __m128i *)(const void *)counter);
+		x[0] = _mm_add_epi8(_mm_unpacklo_epi64(c, c), one);
+		for (unsigned int i=1; i<n; ++i)
+			x[i] = _mm_add_epi8(x[i-1], step);
+		_mm_storel_epi64((__m128i *)(void *)counter, _mm_add_epi8(x[n-1], step));
+	}
+	else
+	{
+		const word64 mask = (flags & BlockTransformation::BT_Counter64) ? W64LIT(0xffffffffffffffff) : W64LIT(0xffffffff);
+		const word64 c = GetWord<word64>(false, BIG_ENDIAN_ORDER, counter);
+		CRYPTOPP_ALIGN_DATA(16) byte buffer[16];
+		for (unsigned int i=0; i<n; ++i)
+		{
+			PutWord(true, BIG_ENDIAN_ORDER, buffer, (c & ~mask) | ((c + 2*i) & mask));
+			PutWord(true, BIG_ENDIAN_ORDER, buffer+8, (c & ~mask) | ((c + 2*i + 1) & mask));
+			x[i] = _mm_load_si128((const __m128i *)(const void *)buffer);
+		}
+		PutWord(false, BIG_ENDIAN_ORDER, counter, (c & ~mask) | ((c + 2*n) & mask));
+	}
+}
+
+//! \brief Processes whole groups of blocks with a SIMD kernel
+//! \tparam BLOCKSIZE the block size in bytes, either 8 or 16
+//! \tparam BLOCKS the number of blocks in a group
+//! \tparam F the kernel type
+//! \param func the kernel
+//! \param inBlocks the input blocks, or the counter if BT_InBlockIsCounter is set
+//! \param xorBlocks the xor blocks, or NULL
+//! \param outBlocks the output blocks
+//! \param length the size of the blocks, in bytes
+//! \param flags additional flags to control processing
+//! \details The kernel is called as <tt>func(x)</tt>, where <tt>x</tt> is an array of
+//!   <tt>BLOCKS*BLOCKSIZE/16</tt> __m128i holding a group of blocks in memory order. 8-byte
+//!   blocks are packed two to a register. The kernel transforms the blocks in place.
+//! \details On return inBlocks, xorBlocks, outBlocks and length describe the blocks that
+//!   were not processed, and the caller passes them to BlockTransformation::AdvancedProcessBlocks().
+//!   Nothing is processed unless BT_AllowParallel is set and BT_DontIncrementInOutPointers is not.
+//!   In the reverse direction the groups are taken from the tail, and all xorBlocks of a group
+//!   are read before its outputs are stored, so CBC decryption may run in place.
+//! \details The counter is advanced with GenerateCounterBlocks_SSE2(), so BT_Counter32 and
+//!   BT_Counter64 select its width as they do for BlockTransformation::AdvancedProcessBlocks().
+template <unsigned int BLOCKSIZE, unsigned int BLOCKS, class F>
+inline void AdvancedProcessBlocks_SSE2(const F &func, const byte *&inBlocks, const byte *&xorBlocks, byte *&outBlocks, size_t &length, word32 flags)
+{
+	CRYPTOPP_COMPILE_ASSERT(BLOCKSIZE == 8 || BLOCKSIZE == 16);
+	CRYPTOPP_COMPILE_ASSERT((BLOCKS*BLOCKSIZE) % 16 == 0);
+	const unsigned int REGISTERS = BLOCKS*BLOCKSIZE/16;
+	const size_t groupSize = BLOCKS*BLOCKSIZE;
+
+	const word32 parallelFlags = BlockTransformation::BT_AllowParallel|BlockTransformation::BT_DontIncrementInOutPointers;
+	if ((flags & parallelFlags) != BlockTransformation::BT_AllowParallel || length < groupSize)
+		return;
+
+	const size_t groups = length / groupSize;
+	const size_t processed = groups * groupSize;
+	const size_t remaining = length - processed;
+	const bool reverse = !!(flags & BlockTransformation::BT_ReverseDirection);
+	const bool counter = !!(flags & BlockTransformation::BT_InBlockIsCounter);
+	const bool xorInput = xorBlocks && (flags & BlockTransformation::BT_XorInput);
+	const bool xorOutput = xorBlocks && !(flags & BlockTransformation::BT_XorInput);
+
+	__m128i x[REGISTERS];
+	for (size_t g=0; g<groups; ++g)
+	{
+		// Reverse direction works from the tail towards the head
+		const size_t offset = reverse ? remaining + (groups-1-g)*groupSize : g*groupSize;
+
+		if (counter)
+		{
+			if (BLOCKSIZE == 16)
+				GenerateCounterBlocks_SSE2(const_cast<byte *>(inBlocks), x, REGISTERS, flags);
+			else
+				GenerateCounterBlocks64_SSE2(const_cast<byte *>(inBlocks), x, REGISTERS, flags);
+		}
+		else
+		{
+			for (unsigned int i=0; i<REGISTERS; ++i)
+				x[i] = _mm_loadu_si128((const __m128i *)(const void *)(inBlocks+offset+16*i));
+		}
+
+		if (xorInput)
+		{
+			for (unsigned int i=0; i<REGISTERS; ++i)
+				x[i] = _mm_xor_si128(x[i], _mm_loadu_si128((const __m128i *)(const void *)(xorBlocks+offset+16*i)));
+		}
+
+		func(x);
+
+		// All of xorBlocks must be read before any of outBlocks is written
+		if (xorOutput)
+		{
+			for (unsigned int i=0; i<REGISTERS; ++i)
+				x[i] = _mm_xor_si128(x[i], _mm_loadu_si128((const __m128i *)(const void *)(xorBlocks+offset+16*i)));
+		}
+
+		for (unsigned int i=0; i<REGISTERS; ++i)
+			_mm_storeu_si128((__m128i *)(void *)(outBlocks+offset+16*i), x[i]);
+	}
+
+	if (!reverse)
+	{
+		inBlocks += counter ? 0 : processed;
+		xorBlocks += xorBlocks ? processed : 0;
+		outBlocks += processed;
+	}
+	length = remaining;
+}
+
+#endif  // CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE || CRYPTOPP_DOXYGEN_PROCESSING
+
+//! \brief Transposes eight 16-byte blocks into four vectors of 32-bit words
+//! \param x the blocks, as loaded by AdvancedProcessBlocks_SSE2()
+//! \param w the words, where lane j of w[i] is word i of block j
+//! \details Words are left in memory byte order. Ciphers with big-endian words swap them afterwards.
+inline void Transpose4x8_AVX2(const __m128i x[8], __m256i w[4])
+{
+	__m128i y[8];
+	for (unsigned int i=0; i<8; i+=4)
+	{
+		const __m128i t0 = _mm_unpacklo_epi32(x[i+0], x[i+1]);
+		const __m128i t1 = _mm_unpackhi_epi32(x[i+0], x[i+1]);
+		const __m128i t2 = _mm_unpacklo_epi32(x[i+2], x[i+3]);
+		const __m128i t3 = _mm_unpackhi_epi32(x[i+2], x[i+3]);
+		y[i+0] = _mm_unpacklo_epi64(t0, t2);
+		y[i+1] = _mm_unpackhi_epi64(t0, t2);
+		y[i+2] = _mm_unpacklo_epi64(t1, t3);
+		y[i+3] = _mm_unpackhi_epi64(t1, t3);
+	}
+	for (unsigned int i=0; i<4; ++i)
+		w[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(y[i]), y[i+4], 1);
+}
+
+//! \brief Transposes four vectors of 32-bit words back into eight 16-byte blocks
+//! \param w the words, where lane j of w[i] is word i of block j
+//! \param x the blocks
+//! \sa Transpose4x8_AVX2()
+inline void Transpose8x4_AVX2(const __m256i w[4], __m128i x[8])
+{
+	for (unsigned int i=0; i<8; i+=4)
+	{
+		const __m128i y0 = i ? _mm256_extracti128_si256(w[0], 1) : _mm256_castsi256_si128(w[0]);
+		const __m128i y1 = i ? _mm256_extracti128_si256(w[1], 1) : _mm256_castsi256_si128(w[1]);
+		const __m128i y2 = i ? _mm256_extracti128_si256(w[2], 1) : _mm256_castsi256_si128(w[2]);
+		const __m128i y3 = i ? _mm256_extracti128_si256(w[3], 1) : _mm256_castsi256_si128(w[3]);
+		const __m128i t0 = _mm_unpacklo_epi32(y0, y1);
+		const __m128i t1 = _mm_unpackhi_epi32(y0, y1);
+		const __m128i t2 = _mm_unpacklo_epi32(y2, y3);
+		const __m128i t3 = _mm_unpackhi_epi32(y2, y3);
+		x[i+0] = _mm_unpacklo_epi64(t0, t2);
+		x[i+1] = _mm_unpackhi_epi64(t0, t2);
+		x[i+2] = _mm_unpacklo_epi64(t1, t3);
+		x[i+3] = _mm_unpackhi_epi64(t1, t3);
+	}
+}
+
+//! \brief Reverses the bytes in each 32-bit word
+inline __m256i ByteReverse32_AVX2(const __m256i &x)
+{
+	const __m256i mask = _mm256_set_epi8(
+		12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3,
+		12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3);
+	return _mm256_shuffle_epi8(x, mask);
+}
+
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_ADVSIMD_H
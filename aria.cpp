@@ -4,6 +4,7 @@
 #include "config.h"
 
 #include "aria.h"
+#include "advsimd.h"
 #include "misc.h"
 #include "cpu.h"
 
@@ -19,6 +20,11 @@
 # define CRYPTOPP_ENABLE_ARIA_NEON_INTRINSICS 1
 #endif
 
+// The multi-block path needs PSHUFB for the affine filters and AES-NI for the S-boxes
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE && CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+# define CRYPTOPP_ENABLE_ARIA_AESNI_INTRINSICS 1
+#endif
+
 ANONYMOUS_NAMESPACE_BEGIN
 
 CRYPTOPP_ALIGN_DATA(16)
@@ -172,6 +178,31 @@ const CryptoPP::word32 KRK[3][4] = {
 	{0xdb92371d, 0x2126e970, 0x03249775, 0x04e8c90e}
 };
 
+#if CRYPTOPP_ENABLE_ARIA_AESNI_INTRINSICS
+// Nibble tables for the affine maps used by the AES-NI S-boxes. S2(x) = L(S1(x))
+//   and X2(x) = X1(P(x)), where S1 is the AES S-box and X1 is its inverse.
+CRYPTOPP_ALIGN_DATA(16)
+const byte L_LO[16] = {
+	0x88,0x0d,0x37,0xb2,0x00,0x85,0xbf,0x3a,0xa8,0x2d,0x17,0x92,0x20,0xa5,0x9f,0x1a
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+const byte L_HI[16] = {
+	0x00,0x3e,0xd4,0xea,0x84,0xba,0x50,0x6e,0xcd,0xf3,0x19,0x27,0x49,0x77,0x9d,0xa3
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+const byte P_LO[16] = {
+	0x04,0x45,0xee,0xaf,0x17,0x56,0xfd,0xbc,0x53,0x12,0xb9,0xf8,0x40,0x01,0xaa,0xeb
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+const byte P_HI[16] = {
+	0x00,0xb6,0x08,0xbe,0xd6,0x60,0xde,0x68,0x53,0xe5,0x5b,0xed,0x85,0x33,0x8d,0x3b
+};
+
+#endif
+
 ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -515,6 +546,12 @@ void ARIA::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, b
 	volatile word32 _u = 0;
 	word32 u = _u;
 
+	// The output is written before it is xor'd, so an xorBlock that is also the outBlock,
+	//   as in CFB decryption in place, is copied first
+	byte xorCopy[16];
+	if (xorBlock && xorBlock == outBlock)
+		xorBlock = (const byte *)memcpy(xorCopy, xorBlock, 16);
+
 	for (i=0; i<COUNTOF(S1); i+=cacheLineSize/(sizeof(S1[0])))
 		u |= *(S1+i);
 	t[0] |= u;
@@ -637,4 +674,243 @@ void ARIA::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, b
 	}
 }
 
+#if CRYPTOPP_ENABLE_ARIA_AESNI_INTRINSICS
+
+// The multi-block path keeps 16 blocks byte-sliced: after the transpose, x[i] holds
+//   byte i of every block. The S-boxes are computed with AESENCLAST and AESDECLAST
+//   using a zero round key, and the diffusion layer becomes XORs and register renames.
+
+inline __m128i ARIA_AESNI_Affine(const __m128i x, const __m128i lo, const __m128i hi)
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	return _mm_xor_si128(
+		_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+		_mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+}
+
+// AESENCLAST applies ShiftRows before SubBytes, so undo it first
+inline __m128i ARIA_AESNI_S1(const __m128i x)
+{
+	const __m128i invShiftRows = _mm_set_epi8(3,6,9,12, 15,2,5,8, 11,14,1,4, 7,10,13,0);
+	return _mm_aesenclast_si128(_mm_shuffle_epi8(x, invShiftRows), _mm_setzero_si128());
+}
+
+// AESDECLAST applies InvShiftRows before InvSubBytes, so undo it first
+inline __m128i ARIA_AESNI_X1(const __m128i x)
+{
+	const __m128i shiftRows = _mm_set_epi8(11,6,1,12, 7,2,13,8, 3,14,9,4, 15,10,5,0);
+	return _mm_aesdeclast_si128(_mm_shuffle_epi8(x, shiftRows), _mm_setzero_si128());
+}
+
+inline __m128i ARIA_AESNI_S2(const __m128i x)
+{
+	return ARIA_AESNI_Affine(ARIA_AESNI_S1(x),
+		_mm_load_si128((const __m128i*)(const void*)L_LO),
+		_mm_load_si128((const __m128i*)(const void*)L_HI));
+}
+
+inline __m128i ARIA_AESNI_X2(const __m128i x)
+{
+	return ARIA_AESNI_X1(ARIA_AESNI_Affine(x,
+		_mm_load_si128((const __m128i*)(const void*)P_LO),
+		_mm_load_si128((const __m128i*)(const void*)P_HI)));
+}
+
+// Key XOR Layer. Round keys are stored as native words.
+inline void ARIA_AESNI_KXL(__m128i x[16], const byte *rk)
+{
+	for (unsigned int i=0; i<16; ++i)
+		x[i] = _mm_xor_si128(x[i], _mm_set1_epi8((char)rk[i^3]));
+}
+
+// S-Box Layer 1 (odd rounds) and 2 (even rounds)
+inline void ARIA_AESNI_SL1(__m128i x[16])
+{
+	for (unsigned int i=0; i<16; i+=4)
+	{
+		x[i+0] = ARIA_AESNI_S1(x[i+0]); x[i+1] = ARIA_AESNI_S2(x[i+1]);
+		x[i+2] = ARIA_AESNI_X1(x[i+2]); x[i+3] = ARIA_AESNI_X2(x[i+3]);
+	}
+}
+
+inline void ARIA_AESNI_SL2(__m128i x[16])
+{
+	for (unsigned int i=0; i<16; i+=4)
+	{
+		x[i+0] = ARIA_AESNI_X1(x[i+0]); x[i+1] = ARIA_AESNI_X2(x[i+1]);
+		x[i+2] = ARIA_AESNI_S1(x[i+2]); x[i+3] = ARIA_AESNI_S2(x[i+3]);
+	}
+}
+
+// The M part of SBL1_M and SBL2_M. Each output byte of a word is the sum of
+//   the other three input bytes (SL1), or of all but the byte two over (SL2).
+template <unsigned int N>
+inline void ARIA_AESNI_M(__m128i x[16])
+{
+	for (unsigned int i=0; i<16; i+=4)
+	{
+		const __m128i t[4] = {x[i+0], x[i+1], x[i+2], x[i+3]};
+		const __m128i s = _mm_xor_si128(_mm_xor_si128(t[0], t[1]), _mm_xor_si128(t[2], t[3]));
+		x[i+0] = _mm_xor_si128(s, t[0^N]); x[i+1] = _mm_xor_si128(s, t[1^N]);
+		x[i+2] = _mm_xor_si128(s, t[2^N]); x[i+3] = _mm_xor_si128(s, t[3^N]);
+	}
+}
+
+// ARIA_MM applied to each byte of the words
+inline void ARIA_AESNI_MM(__m128i x[16])
+{
+	for (unsigned int k=0; k<4; ++k)
+	{
+		__m128i &t0 = x[k], &t1 = x[4+k], &t2 = x[8+k], &t3 = x[12+k];
+		t1 = _mm_xor_si128(t1, t2); t2 = _mm_xor_si128(t2, t3); t0 = _mm_xor_si128(t0, t1);
+		t3 = _mm_xor_si128(t3, t1); t2 = _mm_xor_si128(t2, t0); t1 = _mm_xor_si128(t1, t2);
+	}
+}
+
+// ARIA_P(T0,T1,T2,T3) and ARIA_P(T2,T3,T0,T1) only permute bytes
+inline void ARIA_AESNI_P1(__m128i x[16])
+{
+	std::swap(x[ 4], x[ 5]); std::swap(x[ 6], x[ 7]);
+	std::swap(x[ 8], x[10]); std::swap(x[ 9], x[11]);
+	std::swap(x[12], x[15]); std::swap(x[13], x[14]);
+}
+
+inline void ARIA_AESNI_P2(__m128i x[16])
+{
+	std::swap(x[12], x[13]); std::swap(x[14], x[15]);
+	std::swap(x[ 0], x[ 2]); std::swap(x[ 1], x[ 3]);
+	std::swap(x[ 4], x[ 7]); std::swap(x[ 5], x[ 6]);
+}
+
+inline void ARIA_AESNI_FO(__m128i x[16])
+{
+	ARIA_AESNI_SL1(x); ARIA_AESNI_M<0>(x);
+	ARIA_AESNI_MM(x); ARIA_AESNI_P1(x); ARIA_AESNI_MM(x);
+}
+
+inline void ARIA_AESNI_FE(__m128i x[16])
+{
+	ARIA_AESNI_SL2(x); ARIA_AESNI_M<2>(x);
+	ARIA_AESNI_MM(x); ARIA_AESNI_P2(x); ARIA_AESNI_MM(x);
+}
+
+// Transposes the 16x16 byte matrix. Four rounds of the perfect shuffle is the transpose.
+inline void ARIA_AESNI_Transpose(__m128i x[16])
+{
+	__m128i t[16];
+	for (unsigned int r=0; r<4; ++r)
+	{
+		for (unsigned int i=0; i<8; ++i)
+		{
+			t[2*i+0] = _mm_unpacklo_epi8(x[i], x[i+8]);
+			t[2*i+1] = _mm_unpackhi_epi8(x[i], x[i+8]);
+		}
+		for (unsigned int i=0; i<16; ++i)
+			x[i] = t[i];
+	}
+}
+
+// Encryption and decryption only differ in the key schedule
+inline void ARIA_AESNI_16_Blocks(__m128i x[16], const byte *rk, unsigned int rounds)
+{
+	ARIA_AESNI_Transpose(x);
+
+	for (unsigned int i=0; i<rounds-2; i+=2)
+	{
+		ARIA_AESNI_KXL(x, rk); rk+= 16; ARIA_AESNI_FO(x);
+		ARIA_AESNI_KXL(x, rk); rk+= 16; ARIA_AESNI_FE(x);
+	}
+
+	ARIA_AESNI_KXL(x, rk); rk+= 16; ARIA_AESNI_FO(x);
+	ARIA_AESNI_KXL(x, rk); rk+= 16; ARIA_AESNI_SL2(x);
+	ARIA_AESNI_KXL(x, rk);
+
+	ARIA_AESNI_Transpose(x);
+}
+
+// Processes full groups of 16 blocks. 'length' must be a multiple of 256.
+inline void ARIA_AESNI_AdvancedProcessBlocks(const byte *rk, unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+	const size_t blockSize = 16;
+	size_t inIncrement = (flags & BlockTransformation::BT_InBlockIsCounter) ? 0 : blockSize;
+	size_t xorIncrement = xorBlocks ? blockSize : 0;
+	size_t outIncrement = blockSize;
+
+	if (flags & BlockTransformation::BT_ReverseDirection)
+	{
+		inBlocks += length - blockSize;
+		xorBlocks += length - blockSize;
+		outBlocks += length - blockSize;
+		inIncrement = 0-inIncrement;
+		xorIncrement = 0-xorIncrement;
+		outIncrement = 0-outIncrement;
+	}
+
+	while (length >= 16*blockSize)
+	{
+		__m128i x[16];
+		if (flags & BlockTransformation::BT_InBlockIsCounter)
+			GenerateCounterBlocks_SSE2(const_cast<byte *>(inBlocks), x, 16, flags);
+		else
+		{
+			for (unsigned int i=0; i<16; ++i, inBlocks += inIncrement)
+				x[i] = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+		}
+
+		if (flags & BlockTransformation::BT_XorInput)
+		{
+			CRYPTOPP_ASSERT(xorBlocks);
+			for (unsigned int i=0; i<16; ++i, xorBlocks += xorIncrement)
+				x[i] = _mm_xor_si128(x[i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+		}
+
+		ARIA_AESNI_16_Blocks(x, rk, rounds);
+
+		// All of xorBlocks must be read before any of outBlocks is written
+		if (xorBlocks && !(flags & BlockTransformation::BT_XorInput))
+		{
+			for (unsigned int i=0; i<16; ++i, xorBlocks += xorIncrement)
+				x[i] = _mm_xor_si128(x[i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+		}
+
+		for (unsigned int i=0; i<16; ++i, outBlocks += outIncrement)
+			_mm_storeu_si128((__m128i *)(void *)outBlocks, x[i]);
+
+		length -= 16*blockSize;
+	}
+}
+#endif  // CRYPTOPP_ENABLE_ARIA_AESNI_INTRINSICS
+
+size_t ARIA::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+#if CRYPTOPP_ENABLE_ARIA_AESNI_INTRINSICS
+	const word32 parallelFlags = BT_AllowParallel|BT_DontIncrementInOutPointers;
+	if ((flags & parallelFlags) == BT_AllowParallel && length >= 16*BLOCKSIZE && HasAESNI() && HasSSSE3())
+	{
+		const size_t remaining = length % (16*BLOCKSIZE);
+		const size_t parallel = length - remaining;
+
+		// Reverse direction works from the tail towards the head
+		if (flags & BT_ReverseDirection)
+		{
+			ARIA_AESNI_AdvancedProcessBlocks(m_rk.data(), m_rounds, inBlocks+remaining,
+				xorBlocks ? xorBlocks+remaining : NULLPTR, outBlocks+remaining, parallel, flags);
+		}
+		else
+		{
+			ARIA_AESNI_AdvancedProcessBlocks(m_rk.data(), m_rounds, inBlocks, xorBlocks, outBlocks, parallel, flags);
+			inBlocks += (flags & BT_InBlockIsCounter) ? 0 : parallel;
+			xorBlocks += xorBlocks ? parallel : 0;
+			outBlocks += parallel;
+		}
+
+		length = remaining;
+		if (length < BLOCKSIZE)
+			return length;
+	}
+#endif
+
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
 NAMESPACE_END
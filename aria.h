@@ -46,6 +46,8 @@ public:
 	public:
 		void UncheckedSetKey(const byte *key, unsigned int keylen, const NameValuePairs &params);
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
 
 	private:
 		// Reference implementation allocates a table of 17 round keys.
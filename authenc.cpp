@@ -175,6 +175,64 @@ void AuthenticatedSymmetricCipherBase::TruncatedFinal(byte *mac, size_t macSize)
 	m_state = State_KeySet;
 }
 
+void AuthenticatedSymmetricCipherBase::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	ProcessBatches(messages, count, true);
+}
+
+bool AuthenticatedSymmetricCipherBase::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	ProcessBatches(messages, count, false);
+
+	bool valid = true;
+	for (size_t i=0; i<count; ++i)
+		valid = valid && messages[i].valid;
+	return valid;
+}
+
+void AuthenticatedSymmetricCipherBase::ProcessBatches(BatchMessage *messages, size_t count, bool encrypt)
+{
+	std::vector<bool> taken(count);
+
+	for (size_t i=0; i<count; ++i)
+	{
+		if (taken[i])
+			continue;
+
+		// Group the next messages with the same key handle, looking a few messages ahead
+		AuthenticatedSymmetricCipher *handle = messages[i].cipher ? messages[i].cipher : this;
+		BatchMessage *group[BATCH_LANES];
+		unsigned int n = 0;
+		for (size_t j=i; j<count && j<i+BATCH_WINDOW && n<BATCH_LANES; ++j)
+		{
+			if (!taken[j] && (messages[j].cipher ? messages[j].cipher : this) == handle)
+			{
+				group[n++] = messages+j;
+				taken[j] = true;
+			}
+		}
+
+		AuthenticatedSymmetricCipherBase *base = dynamic_cast<AuthenticatedSymmetricCipherBase *>(handle);
+		if (base)
+			base->ProcessBatch(group, n, encrypt);
+		else
+			AuthenticatedSymmetricCipherBase::ProcessBatch(group, n, encrypt);
+	}
+}
+
+void AuthenticatedSymmetricCipherBase::ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt)
+{
+	for (unsigned int i=0; i<count; ++i)
+	{
+		BatchMessage &m = *messages[i];
+		AuthenticatedSymmetricCipher &cipher = m.cipher ? *m.cipher : *this;
+		if (encrypt)
+			cipher.EncryptAndAuthenticate(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+		else
+			m.valid = cipher.DecryptAndVerify(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+	}
+}
+
 NAMESPACE_END
 
 #endif
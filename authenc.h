@@ -40,8 +40,22 @@ public:
 	void ProcessData(byte *outString, const byte *inString, size_t length);
 	void TruncatedFinal(byte *mac, size_t macSize);
 
+	void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+	bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 protected:
 	void AuthenticateData(const byte *data, size_t len);
+	void ProcessBatches(BatchMessage *messages, size_t count, bool encrypt);
+
+	//! \brief Processes a group of messages keyed with this object
+	//! \param messages the messages, at most BATCH_LANES of them
+	//! \param count the number of messages
+	//! \param encrypt true to encrypt and authenticate, false to decrypt and verify
+	//! \details The default implementation processes the messages one at a time.
+	virtual void ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt);
+
+	// Messages with the same key handle are grouped from a window of BATCH_WINDOW messages
+	enum {BATCH_LANES = 4, BATCH_WINDOW = 16};
 	const SymmetricCipher & GetSymmetricCipher() const {return const_cast<AuthenticatedSymmetricCipherBase *>(this)->AccessSymmetricCipher();};
 
 	virtual SymmetricCipher & AccessSymmetricCipher() =0;
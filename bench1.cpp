@@ -6,6 +6,8 @@
 #include "validate.h"
 
 #include "aes.h"
+#include "chacha.h"
+#include "poly1305.h"
 #include "blumshub.h"
 #include "files.h"
 #include "filters.h"
@@ -15,6 +17,8 @@
 #include "smartptr.h"
 #include "cpu.h"
 #include "drbg.h"
+#include "osrng.h"
+#include "rdrand.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 NAMESPACE_BEGIN(Test)
@@ -91,6 +95,23 @@ void OutputResultOperations(const char *name, const char *operation, bool pc, un
 	g_logCount++;
 }
 
+void OutputResultNanoseconds(const char *name, double iterations, double timeTaken)
+{
+	// Coverity finding, also see http://stackoverflow.com/a/34509163/608639.
+	StreamState ss(std::cout);
+
+	// Coverity finding
+	if (iterations < 0.000001f) iterations = 0.000001f;
+	if (timeTaken < 0.000001f) timeTaken = 0.000001f;
+
+	std::cout << "\n<TR><TH>" << name;
+	std::cout << "<TD>" << std::setprecision(1) << std::setiosflags(std::ios::fixed) << (1000*1000*1000*timeTaken/iterations);
+
+	// Coverity finding
+	if (g_hertz > 1.0f)
+		std::cout << "<TD>" << std::setprecision(0) << std::setiosflags(std::ios::fixed) << timeTaken * g_hertz / iterations;
+}
+
 /*
 void BenchMark(const char *name, BlockTransformation &cipher, double timeTotal)
 {
@@ -268,6 +289,66 @@ void BenchMarkKeying(SimpleKeyingInterface &c, size_t keyLength, const NameValue
 	OutputResultKeying(iterations, timeTaken);
 }
 
+// A call with a fresh key each time, like the one-time keys of QUIC header protection and
+//   ChaCha20-Poly1305. The output of a call is the input of the next.
+typedef void (*OneShotFunction)(byte *output, const byte *key, const byte *input);
+
+void BenchMarkOneShot(const char *name, OneShotFunction func)
+{
+	byte buf[64] = {0};
+	unsigned long iterations = 0;
+	double timeTaken;
+
+	clock_t start = ::clock();
+	do
+	{
+		for (unsigned int i=0; i<4096; i++)
+			func(buf, defaultKey, buf);
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+		iterations += 4096;
+	}
+	while (timeTaken < g_allocatedTime);
+
+	OutputResultNanoseconds(name, iterations, timeTaken);
+}
+
+// Per-call cost of small requests, which is dominated by locking, system calls and
+//   instruction latency rather than by the generator's throughput
+void BenchMarkWord32(const char *name, RandomNumberGenerator &rng)
+{
+	word32 sum = 0;
+	unsigned long iterations = 0;
+	double timeTaken;
+
+	clock_t start = ::clock();
+	do
+	{
+		for (unsigned int i=0; i<1024; i++)
+			sum += rng.GenerateWord32();
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+		iterations += 1024;
+	}
+	while (timeTaken < g_allocatedTime);
+
+	CRYPTOPP_UNUSED(sum);
+	OutputResultNanoseconds(name, iterations, timeTaken);
+}
+
+void AES128_EncryptBlock(byte *output, const byte *key, const byte *input)
+	{AES::EncryptBlock(output, key, 16, input);}
+void AES256_EncryptBlock(byte *output, const byte *key, const byte *input)
+	{AES::EncryptBlock(output, key, 32, input);}
+void AES128_KeyedBlock(byte *output, const byte *key, const byte *input)
+	{AES::Encryption(key, 16).ProcessBlock(input, output);}
+void ChaCha20_Block(byte *output, const byte *key, const byte *input)
+	{ChaCha20::Block(output, key, 32, input);}
+void ChaCha20_KeyedBlock(byte *output, const byte *key, const byte *input)
+	{ChaCha20::Encryption(key, 32, input).ProcessString(output, input, 64);}
+void Poly1305_OneTime(byte *output, const byte *key, const byte *input)
+	{Poly1305OneTime::Hash(output, key, input, 64);}
+void Poly1305_Keyed(byte *output, const byte *key, const byte *input)
+	{Poly1305<AES>(key, 32, input, 16).CalculateDigest(output, input, 64);}
+
 template <class T_FactoryOutput, class T_Interface>
 void BenchMarkByName2(const char *factoryName, size_t keyLength = 0, const char *displayName=NULLPTR, const NameValuePairs &params = g_nullNameValuePairs)
 {
@@ -411,6 +492,9 @@ void Benchmark1(double t, double hertz)
 #ifdef OS_RNG_AVAILABLE
 		BenchMarkByNameKeyLess<RandomNumberGenerator>("AutoSeededRandomPool");
 		BenchMarkByNameKeyLess<RandomNumberGenerator>("AutoSeededX917RNG(AES)");
+#endif
+#if defined(NONBLOCKING_RNG_AVAILABLE) && defined(THREADS_AVAILABLE)
+		BenchMarkByNameKeyLess<RandomNumberGenerator>("AutoSeededThreadLocalRNG");
 #endif
 		BenchMarkByNameKeyLess<RandomNumberGenerator>("MT19937");
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
@@ -418,12 +502,21 @@ void Benchmark1(double t, double hertz)
 			BenchMarkByNameKeyLess<RandomNumberGenerator>("RDRAND");
 		if (HasRDSEED())
 			BenchMarkByNameKeyLess<RandomNumberGenerator>("RDSEED");
+		if (HasRDRAND() || HasRDSEED())
+		{
+			BenchMarkByNameKeyLess<RandomNumberGenerator>("HardwareSeededRNG", "HardwareSeededRNG(CTR_DRBG(AES))");
+			byte seed[48];
+			Test::GlobalRNG().GenerateBlock(seed, sizeof(seed));
+			HardwareSeededRNG hmac(new HMAC_DRBG<SHA256>(seed, 32, seed+32, 16));
+			BenchMark("HardwareSeededRNG(HMAC_DRBG(SHA256))", hmac, g_allocatedTime);
+		}
 #endif
 		BenchMarkByNameKeyLess<RandomNumberGenerator>("AES/OFB RNG");
 		BenchMarkByNameKeyLess<NIST_DRBG>("Hash_DRBG(SHA1)");
 		BenchMarkByNameKeyLess<NIST_DRBG>("Hash_DRBG(SHA256)");
 		BenchMarkByNameKeyLess<NIST_DRBG>("HMAC_DRBG(SHA1)");
 		BenchMarkByNameKeyLess<NIST_DRBG>("HMAC_DRBG(SHA256)");
+		BenchMarkByNameKeyLess<NIST_DRBG>("CTR_DRBG(AES)");
 	}
 
 	std::cout << "\n<TBODY style=\"background: yellow;\">";
@@ -581,6 +674,64 @@ void Benchmark2(double t, double hertz)
 	}
 
 	std::cout << "\n</TABLE>" << std::endl;
+
+	std::cout << "\n<BR>";
+	std::cout << "\n<TABLE>";
+	std::cout << "\n<COLGROUP><COL style=\"text-align: left;\"><COL style=";
+	std::cout << "\"text-align: right;\"><COL style=\"text-align: right;\">";
+	std::cout << "\n<THEAD style=\"background: #F0F0F0\"><TR><TH>Operation<TH>Nanoseconds/Operation";
+	std::cout << (g_hertz > 1.0f ? "<TH>Cycles/Operation" : "");
+
+	std::cout << "\n<TBODY style=\"background: white;\">";
+	{
+		BenchMarkOneShot("AES-128 one-shot block", AES128_EncryptBlock);
+		BenchMarkOneShot("AES-128 keyed object and block", AES128_KeyedBlock);
+		BenchMarkOneShot("AES-256 one-shot block", AES256_EncryptBlock);
+	}
+
+	std::cout << "\n<TBODY style=\"background: yellow;\">";
+	{
+		BenchMarkOneShot("ChaCha20 one-shot block", ChaCha20_Block);
+		BenchMarkOneShot("ChaCha20 keyed object and block", ChaCha20_KeyedBlock);
+	}
+
+	std::cout << "\n<TBODY style=\"background: white;\">";
+	{
+		BenchMarkOneShot("Poly1305 one-time key, 64 bytes", Poly1305_OneTime);
+		BenchMarkOneShot("Poly1305(AES) keyed object, 64 bytes", Poly1305_Keyed);
+	}
+
+	std::cout << "\n<TBODY style=\"background: yellow;\">";
+	{
+#ifdef NONBLOCKING_RNG_AVAILABLE
+		NonblockingRng nonblocking, buffered(true);
+		BenchMarkWord32("NonblockingRng GenerateWord32", nonblocking);
+		BenchMarkWord32("NonblockingRng (buffered) GenerateWord32", buffered);
+#endif
+#if defined(NONBLOCKING_RNG_AVAILABLE) && defined(THREADS_AVAILABLE)
+		AutoSeededThreadLocalRNG threadLocal;
+		BenchMarkWord32("AutoSeededThreadLocalRNG GenerateWord32", threadLocal);
+#endif
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+		if (HasRDRAND())
+		{
+			RDRAND rdrand;
+			BenchMarkWord32("RDRAND GenerateWord32", rdrand);
+		}
+		if (HasRDSEED())
+		{
+			RDSEED rdseed;
+			BenchMarkWord32("RDSEED GenerateWord32", rdseed);
+		}
+		if (HasRDRAND() || HasRDSEED())
+		{
+			HardwareSeededRNG hardware;
+			BenchMarkWord32("HardwareSeededRNG GenerateWord32", hardware);
+		}
+#endif
+	}
+
+	std::cout << "\n</TABLE>" << std::endl;
 }
 
 NAMESPACE_END  // Test
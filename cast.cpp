@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "cast.h"
 #include "misc.h"
+#include "advsimd.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -293,4 +294,72 @@ void CAST256::Base::UncheckedSetKey(const byte *userKey, unsigned int keylength,
 	SecureWipeBuffer(kappa, 8);
 }
 
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+// The three CAST round functions, l ^= f(r). The rotation is the same for every block.
+template <unsigned int F>
+inline void CAST256_AVX2_F(__m256i &l, const __m256i &r, word32 km, word32 kr, const word32 (*S)[256])
+{
+	const __m256i m = _mm256_set1_epi32((int)km);
+	__m256i t = (F == 1) ? _mm256_add_epi32(m, r) : (F == 2) ? _mm256_xor_si256(m, r) : _mm256_sub_epi32(m, r);
+	t = _mm256_or_si256(_mm256_sll_epi32(t, _mm_cvtsi32_si128((int)kr)), _mm256_srl_epi32(t, _mm_cvtsi32_si128(32-(int)kr)));
+
+	const __m256i mask = _mm256_set1_epi32(0xff);
+	const __m256i a = _mm256_i32gather_epi32((const int *)(const void *)S[0], _mm256_srli_epi32(t, 24), 4);
+	const __m256i b = _mm256_i32gather_epi32((const int *)(const void *)S[1], _mm256_and_si256(_mm256_srli_epi32(t, 16), mask), 4);
+	const __m256i c = _mm256_i32gather_epi32((const int *)(const void *)S[2], _mm256_and_si256(_mm256_srli_epi32(t, 8), mask), 4);
+	const __m256i d = _mm256_i32gather_epi32((const int *)(const void *)S[3], _mm256_and_si256(t, mask), 4);
+
+	if (F == 1)
+		l = _mm256_xor_si256(l, _mm256_add_epi32(_mm256_sub_epi32(_mm256_xor_si256(a, b), c), d));
+	else if (F == 2)
+		l = _mm256_xor_si256(l, _mm256_xor_si256(_mm256_add_epi32(_mm256_sub_epi32(a, b), c), d));
+	else
+		l = _mm256_xor_si256(l, _mm256_sub_epi32(_mm256_xor_si256(_mm256_add_epi32(a, b), c), d));
+}
+
+struct CAST256_AVX2_8_Blocks
+{
+	CAST256_AVX2_8_Blocks(const word32 *K, const word32 (*S)[256]) : m_K(K), m_S(S) {}
+
+	void operator()(__m128i x[8]) const
+	{
+		const word32 *K = m_K;
+		__m256i w[4];
+		Transpose4x8_AVX2(x, w);
+		for (unsigned int i=0; i<4; ++i)
+			w[i] = ByteReverse32_AVX2(w[i]);
+
+		// Six forward quad rounds, then six reverse quad rounds
+		for (unsigned int i=0; i<6; ++i, K+=8)
+		{
+			CAST256_AVX2_F<1>(w[2], w[3], K[4], K[0], m_S);
+			CAST256_AVX2_F<2>(w[1], w[2], K[5], K[1], m_S);
+			CAST256_AVX2_F<3>(w[0], w[1], K[6], K[2], m_S);
+			CAST256_AVX2_F<1>(w[3], w[0], K[7], K[3], m_S);
+		}
+		for (unsigned int i=6; i<12; ++i, K+=8)
+		{
+			CAST256_AVX2_F<1>(w[3], w[0], K[7], K[3], m_S);
+			CAST256_AVX2_F<3>(w[0], w[1], K[6], K[2], m_S);
+			CAST256_AVX2_F<2>(w[1], w[2], K[5], K[1], m_S);
+			CAST256_AVX2_F<1>(w[2], w[3], K[4], K[0], m_S);
+		}
+
+		for (unsigned int i=0; i<4; ++i)
+			w[i] = ByteReverse32_AVX2(w[i]);
+		Transpose8x4_AVX2(w, x);
+	}
+
+	const word32 *m_K;
+	const word32 (*m_S)[256];
+};
+
+size_t CAST256::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (HasAVX2())
+		AdvancedProcessBlocks_SSE2<BLOCKSIZE, 8>(CAST256_AVX2_8_Blocks(K, S), inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
 NAMESPACE_END
@@ -5,9 +5,29 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "ccm.h"
+#include "rijndael.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Returns the block at offset in the concatenation of a and b, zero padded. The
+//   block is assembled in scratch unless it lies entirely within b.
+inline const byte *CCM_GetBlock(byte *scratch, const byte *a, size_t aLength, const byte *b, size_t bLength, size_t offset)
+{
+	if (offset >= aLength && offset-aLength+16 <= bLength)
+		return b+offset-aLength;
+
+	for (unsigned int i=0; i<16; ++i)
+	{
+		const size_t p = offset+i;
+		scratch[i] = p < aLength ? a[p] : (p-aLength < bLength ? b[p-aLength] : 0);
+	}
+	return scratch;
+}
+
+ANONYMOUS_NAMESPACE_END
+
 void CCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
 {
 	BlockCipher &blockCipher = AccessBlockCipher();
@@ -21,7 +41,7 @@ void CCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
 	if (m_digestSize % 2 > 0 || m_digestSize < 4 || m_digestSize > 16)
 		throw InvalidArgument(AlgorithmName() + ": DigestSize must be 4, 6, 8, 10, 12, 14, or 16");
 
-	m_buffer.Grow(2*REQUIRED_BLOCKSIZE);
+	m_buffer.Grow(3*REQUIRED_BLOCKSIZE);
 	m_L = 8;
 }
 
@@ -37,6 +57,7 @@ void CCM_Base::Resync(const byte *iv, size_t len)
 	m_buffer[0] = byte(m_L-1);	// flag
 	memcpy(m_buffer+1, iv, len);
 	memset(m_buffer+1+len, 0, REQUIRED_BLOCKSIZE-1-len);
+	memcpy(CTR_Buffer(), m_buffer, REQUIRED_BLOCKSIZE);
 
 	if (m_state >= State_IVSet)
 		m_ctr.Resynchronize(m_buffer, REQUIRED_BLOCKSIZE);
@@ -90,6 +111,191 @@ void CCM_Base::UncheckedSpecifyDataLengths(lword headerLength, lword messageLeng
 	}
 }
 
+void CCM_Base::ProcessData(byte *outString, const byte *inString, size_t length)
+{
+#if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
+	// AES can run the CBC-MAC and the counter mode encryption in one interleaved pass. The
+	//   fast path needs the message position on a block boundary, and the counter mode
+	//   object is moved past the processed blocks afterwards.
+	const Rijndael::Encryption *aes = dynamic_cast<const Rijndael::Encryption *>(&GetBlockCipher());
+	const size_t full = length - length%REQUIRED_BLOCKSIZE;
+	if (aes && full && m_state >= State_IVSet && m_state < State_AuthFooter && m_totalMessageLength+full <= MaxMessageLength())
+	{
+		// Moves past the header and sets the authentication state
+		if (m_state == State_IVSet)
+			AuthenticatedSymmetricCipherBase::ProcessData(outString, inString, 0);
+
+		if (m_bufferedDataLength == 0)
+		{
+			const word64 position = m_totalMessageLength;
+			byte counter[REQUIRED_BLOCKSIZE];
+			memcpy(counter, CTR_Buffer(), REQUIRED_BLOCKSIZE);
+			PutWord<word64>(false, BIG_ENDIAN_ORDER, counter+8, GetWord<word64>(false, BIG_ENDIAN_ORDER, counter+8) + position/REQUIRED_BLOCKSIZE + 1);
+
+			const size_t done = full - aes->InterleaveCBCMACAndCTR(CBC_Buffer(), counter, inString, outString, full, m_state == State_AuthTransformed);
+			if (done)
+			{
+				m_totalMessageLength += done;
+				m_ctr.Seek(REQUIRED_BLOCKSIZE + position + done);
+				inString += done;
+				outString += done;
+				length -= done;
+			}
+		}
+	}
+#endif
+
+	if (length)
+		AuthenticatedSymmetricCipherBase::ProcessData(outString, inString, length);
+}
+
+void CCM_Base::ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt)
+{
+	const BlockCipher &cipher = GetBlockCipher();
+	const word32 ctrFlags = BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_Counter64|BlockTransformation::BT_AllowParallel;
+	byte counters[BATCH_LANES*REQUIRED_BLOCKSIZE], b0[BATCH_LANES*REQUIRED_BLOCKSIZE];
+	byte prefix[BATCH_LANES][10], scratch[REQUIRED_BLOCKSIZE];
+	unsigned int prefixLength[BATCH_LANES], lanes[BATCH_LANES];
+	size_t headerBlocks[BATCH_LANES], blocks[BATCH_LANES];
+	FixedSizeSecBlock<byte, BATCH_LANES*REQUIRED_BLOCKSIZE> masks, macs;
+	BatchMessage *direct[BATCH_LANES];
+	unsigned int n = 0;
+
+	// The CBC-MAC is a serial chain, so a message cannot use the cipher's parallel path.
+	//   The chains of different messages are independent, and run side by side as one
+	//   parallel call per block. Messages that would throw go through DecryptAndVerify()
+	//   and friends instead.
+	for (unsigned int i=0; i<count; ++i)
+	{
+		BatchMessage &m = *messages[i];
+		const int L = STDMIN(REQUIRED_BLOCKSIZE-1-m.ivLength, 8);
+		if (m_state < State_KeySet || m.ivLength < (int)MinIVLength() || m.ivLength > (int)MaxIVLength() ||
+			m.macSize > (size_t)m_digestSize || (L < 8 && (word64)m.length >= (W64LIT(1)<<(8*L))))
+		{
+			AuthenticatedSymmetricCipherBase::ProcessBatch(&messages[i], 1, encrypt);
+			continue;
+		}
+
+		byte *a0 = counters+n*REQUIRED_BLOCKSIZE, *b = b0+n*REQUIRED_BLOCKSIZE;
+		a0[0] = byte(L-1);
+		memcpy(a0+1, m.iv, m.ivLength);
+		memset(a0+1+m.ivLength, 0, L);
+
+		PutWord<word64>(false, BIG_ENDIAN_ORDER, b+REQUIRED_BLOCKSIZE-8, m.length);
+		memcpy(b+1, m.iv, m.ivLength);
+		b[0] = byte(64*(m.headerLength>0) + 8*((m_digestSize-2)/2) + (L-1));
+
+		const word64 headerLength = m.headerLength;
+		if (headerLength == 0)
+			prefixLength[n] = 0;
+		else if (headerLength < ((1<<16) - (1<<8)))
+		{
+			PutWord<word16>(false, BIG_ENDIAN_ORDER, prefix[n], (word16)headerLength);
+			prefixLength[n] = 2;
+		}
+		else if (headerLength < (W64LIT(1)<<32))
+		{
+			prefix[n][0] = 0xff;
+			prefix[n][1] = 0xfe;
+			PutWord<word32>(false, BIG_ENDIAN_ORDER, prefix[n]+2, (word32)headerLength);
+			prefixLength[n] = 6;
+		}
+		else
+		{
+			prefix[n][0] = 0xff;
+			prefix[n][1] = 0xff;
+			PutWord<word64>(false, BIG_ENDIAN_ORDER, prefix[n]+2, headerLength);
+			prefixLength[n] = 10;
+		}
+
+		headerBlocks[n] = (prefixLength[n]+m.headerLength+REQUIRED_BLOCKSIZE-1) / REQUIRED_BLOCKSIZE;
+		blocks[n] = 1 + headerBlocks[n] + (m.length+REQUIRED_BLOCKSIZE-1) / REQUIRED_BLOCKSIZE;
+		direct[n++] = &m;
+	}
+
+	if (n == 0)
+		return;
+
+	// S_0 of each message, which masks the tag
+	cipher.AdvancedProcessBlocks(counters, NULLPTR, masks, n*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+
+	// Decryption recovers the plaintext before the MAC, and encryption encrypts after the
+	//   MAC, so the MAC is always over the plaintext even when the buffers overlap
+	for (unsigned int pass=0; pass<2; ++pass)
+	{
+		if (pass == (encrypt ? 1u : 0u))
+		{
+			for (unsigned int i=0; i<n; ++i)
+			{
+				BatchMessage &m = *direct[i];
+				const size_t tail = m.length % REQUIRED_BLOCKSIZE, full = m.length - tail;
+				byte counter[REQUIRED_BLOCKSIZE];
+				memcpy(counter, counters+i*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+				counter[REQUIRED_BLOCKSIZE-1] = 1;
+
+				if (full)
+					cipher.ProcessCounterBlocks(counter, m.input, m.output, full, ctrFlags);
+				if (tail)
+				{
+					cipher.ProcessBlock(counter, scratch);
+					xorbuf(m.output+full, m.input+full, scratch, tail);
+				}
+			}
+		}
+		else
+		{
+			// Lanes are ordered by length, so the lanes still running are always a prefix
+			for (unsigned int i=0; i<n; ++i)
+			{
+				unsigned int j = i;
+				for (; j>0 && blocks[lanes[j-1]] < blocks[i]; --j)
+					lanes[j] = lanes[j-1];
+				lanes[j] = i;
+			}
+
+			memset(macs, 0, n*REQUIRED_BLOCKSIZE);
+			for (size_t k=0, active=n; active; ++k)
+			{
+				while (active && blocks[lanes[active-1]] <= k)
+					--active;
+
+				for (unsigned int i=0; i<active; ++i)
+				{
+					const unsigned int lane = lanes[i];
+					const BatchMessage &m = *direct[lane];
+					const byte *block;
+					if (k == 0)
+						block = b0+lane*REQUIRED_BLOCKSIZE;
+					else if (k <= headerBlocks[lane])
+						block = CCM_GetBlock(scratch, prefix[lane], prefixLength[lane], m.header, m.headerLength, (k-1)*REQUIRED_BLOCKSIZE);
+					else
+						block = CCM_GetBlock(scratch, NULLPTR, 0, encrypt ? m.input : m.output, m.length, (k-1-headerBlocks[lane])*REQUIRED_BLOCKSIZE);
+					xorbuf(macs+i*REQUIRED_BLOCKSIZE, block, REQUIRED_BLOCKSIZE);
+				}
+
+				if (active)
+					cipher.AdvancedProcessBlocks(macs, NULLPTR, macs, active*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+			}
+
+			for (unsigned int i=0; i<n; ++i)
+			{
+				const unsigned int lane = lanes[i];
+				BatchMessage &m = *direct[lane];
+				byte *tag = macs+i*REQUIRED_BLOCKSIZE;
+				xorbuf(tag, masks+lane*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+				if (encrypt)
+					memcpy(m.mac, tag, m.macSize);
+				else
+					m.valid = VerifyBufsEqual(tag, m.mac, m.macSize);
+			}
+		}
+	}
+
+	SecureWipeArray(scratch, REQUIRED_BLOCKSIZE);
+	m_bufferedDataLength = 0;
+	m_state = State_KeySet;
+}
+
 size_t CCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 {
 	byte *cbcBuffer = CBC_Buffer();
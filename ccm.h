@@ -55,6 +55,9 @@ public:
 		{return true;}
 	void UncheckedSpecifyDataLengths(lword headerLength, lword messageLength, lword footerLength);
 
+	// StreamTransformation
+	void ProcessData(byte *outString, const byte *inString, size_t length);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -67,6 +70,7 @@ protected:
 	void AuthenticateLastHeaderBlock();
 	void AuthenticateLastConfidentialBlock();
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	void ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
 	virtual BlockCipher & AccessBlockCipher() =0;
@@ -74,6 +78,7 @@ protected:
 
 	const BlockCipher & GetBlockCipher() const {return const_cast<CCM_Base *>(this)->AccessBlockCipher();};
 	byte *CBC_Buffer() {return m_buffer+REQUIRED_BLOCKSIZE;}
+	byte *CTR_Buffer() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
 
 	enum {REQUIRED_BLOCKSIZE = 16};
 	int m_digestSize, m_L;
@@ -144,6 +144,58 @@ void ChaCha_Policy<R>::OperateKeystream(KeystreamOperation operation, byte *outp
 	}
 }
 
+template <unsigned int R>
+void ChaCha_Info<R>::Block(byte *output, const byte *key, size_t keyLength, const byte *input)
+{
+	CRYPTOPP_ASSERT(output && key && input);
+	CRYPTOPP_ASSERT(keyLength == 16 || keyLength == 32);
+
+	word32 state[16];
+	state[0] = 0x61707865;
+	state[1] = (keyLength == 16) ? 0x3120646e : 0x3320646e;
+	state[2] = (keyLength == 16) ? 0x79622d36 : 0x79622d32;
+	state[3] = 0x6b206574;
+
+	GetBlock<word32, LittleEndian> get1(key);
+	get1(state[4])(state[5])(state[6])(state[7]);
+
+	GetBlock<word32, LittleEndian> get2(key + ((keyLength == 32) ? 16 : 0));
+	get2(state[8])(state[9])(state[10])(state[11]);
+
+	GetBlock<word32, LittleEndian> get3(input);
+	get3(state[12])(state[13])(state[14])(state[15]);
+
+	word32 x0 = state[0],   x1 = state[1],   x2 = state[2],   x3 = state[3];
+	word32 x4 = state[4],   x5 = state[5],   x6 = state[6],   x7 = state[7];
+	word32 x8 = state[8],   x9 = state[9],   x10 = state[10], x11 = state[11];
+	word32 x12 = state[12], x13 = state[13], x14 = state[14], x15 = state[15];
+
+	for (int i = static_cast<int>(R); i > 0; i -= 2)
+	{
+		CHACHA_QUARTER_ROUND(x0, x4,  x8, x12);
+		CHACHA_QUARTER_ROUND(x1, x5,  x9, x13);
+		CHACHA_QUARTER_ROUND(x2, x6, x10, x14);
+		CHACHA_QUARTER_ROUND(x3, x7, x11, x15);
+
+		CHACHA_QUARTER_ROUND(x0, x5, x10, x15);
+		CHACHA_QUARTER_ROUND(x1, x6, x11, x12);
+		CHACHA_QUARTER_ROUND(x2, x7,  x8, x13);
+		CHACHA_QUARTER_ROUND(x3, x4,  x9, x14);
+	}
+
+	PutBlock<word32, LittleEndian> put(NULLPTR, output);
+	put(x0 + state[0])(x1 + state[1])(x2 + state[2])(x3 + state[3]);
+	put(x4 + state[4])(x5 + state[5])(x6 + state[6])(x7 + state[7]);
+	put(x8 + state[8])(x9 + state[9])(x10 + state[10])(x11 + state[11]);
+	put(x12 + state[12])(x13 + state[13])(x14 + state[14])(x15 + state[15]);
+
+	SecureWipeArray(state, COUNTOF(state));
+}
+
+template struct ChaCha_Info<8>;
+template struct ChaCha_Info<12>;
+template struct ChaCha_Info<20>;
+
 template class ChaCha_Policy<8>;
 template class ChaCha_Policy<12>;
 template class ChaCha_Policy<20>;
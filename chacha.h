@@ -27,6 +27,17 @@ struct ChaCha_Info : public VariableKeyLength<32, 16, 32, 16, SimpleKeyingInterf
 	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName() {
 		return (R==8?"ChaCha8":(R==12?"ChaCha12":(R==20?"ChaCha20":"ChaCha")));
 	}
+
+	//! \brief Computes one keystream block without a ChaCha object
+	//! \param output the buffer for the 64-byte block
+	//! \param key the key
+	//! \param keyLength the size of the key, 16 or 32 bytes
+	//! \param input the 16 bytes of the last row of the state
+	//! \details Block() runs the block function once and makes no virtual calls. \p input is
+	//!   read as four little-endian words. Bernstein's layout is the 8-byte block counter followed
+	//!   by the 8-byte IV, and RFC 7539 uses a 4-byte counter followed by a 12-byte nonce. Both are
+	//!   the same 16 bytes, so a QUIC header protection sample can be passed as is.
+	static void Block(byte *output, const byte *key, size_t keyLength, const byte *input);
 };
 
 //! \class ChaCha_Policy
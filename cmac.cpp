@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "cmac.h"
+#include "rijndael.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -40,6 +41,37 @@ static void MulU(byte *k, unsigned int length)
 	}
 }
 
+// Runs several CBC-MAC chains for the same number of blocks. AES chains run side by side
+//   through AES-NI, and chains sharing any other key use the cipher's parallel path.
+static void CBCMACLanes(const BlockCipher *const *ciphers, bool sameKey, byte *state, const byte *const *inputs, unsigned int count, size_t blocks, unsigned int blockSize)
+{
+#if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
+	if (blockSize == 16 && Rijndael::Encryption::CBCEncryptWithKeys(ciphers, state, inputs, NULLPTR, count, blocks))
+		return;
+#endif
+
+	if (sameKey)
+	{
+		for (size_t k=0; k<blocks; ++k)
+		{
+			for (unsigned int i=0; i<count; ++i)
+				xorbuf(state+i*blockSize, inputs[i]+k*blockSize, blockSize);
+			ciphers[0]->AdvancedProcessBlocks(state, NULLPTR, state, count*blockSize, BlockTransformation::BT_AllowParallel);
+		}
+	}
+	else
+	{
+		for (unsigned int i=0; i<count; ++i)
+		{
+			for (size_t k=0; k<blocks; ++k)
+			{
+				xorbuf(state+i*blockSize, inputs[i]+k*blockSize, blockSize);
+				ciphers[i]->ProcessBlock(state+i*blockSize);
+			}
+		}
+	}
+}
+
 void CMAC_Base::UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
 {
 	BlockCipher &cipher = AccessCipher();
@@ -121,6 +153,135 @@ void CMAC_Base::TruncatedFinal(byte *mac, size_t size)
 	memset(m_reg, 0, blockSize);
 }
 
+void CMAC_Base::CalculateDigestBatch(BatchMessage *messages, size_t count)
+{
+	for (size_t i=0; i<count; i+=BATCH_LANES)
+		ProcessBatch(messages+i, (unsigned int)STDMIN(count-i, (size_t)BATCH_LANES), false);
+}
+
+bool CMAC_Base::VerifyDigestBatch(BatchMessage *messages, size_t count)
+{
+	bool valid = true;
+	for (size_t i=0; i<count; i+=BATCH_LANES)
+		ProcessBatch(messages+i, (unsigned int)STDMIN(count-i, (size_t)BATCH_LANES), true);
+	for (size_t i=0; i<count; ++i)
+		valid = valid && messages[i].valid;
+	return valid;
+}
+
+void CMAC_Base::ProcessBatch(BatchMessage *messages, unsigned int count, bool verify)
+{
+	const BlockCipher *ciphers[BATCH_LANES];
+	unsigned int lanes[BATCH_LANES], n = 0, blockSize = 0;
+	size_t blocks[BATCH_LANES];
+	FixedSizeAlignedSecBlock<byte, BATCH_LANES*32> state, last;
+
+	// Each lane's final block is prepared up front: the last block xor K1, or the padded
+	//   last block xor K2. Messages whose key handle has a different block size, or is not
+	//   keyed, are computed on their own.
+	for (unsigned int i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		CMAC_Base &key = m.key ? *m.key : *this;
+		const unsigned int bs = key.GetCipher().BlockSize();
+		key.ThrowIfInvalidTruncatedSize(m.digestSize);
+
+		if ((blockSize && bs != blockSize) || key.m_reg.size() < 3*bs)
+		{
+			// The chain of a message in progress on the handle is set aside and put back
+			const bool keyed = key.m_reg.size() >= 3*bs;
+			const unsigned int counter = key.m_counter;
+			SecByteBlock digest(m.digestSize), chain;
+			if (keyed)
+			{
+				chain.Assign(key.m_reg, bs);
+				memset(key.m_reg, 0, bs);
+				key.m_counter = 0;
+			}
+
+			key.CalculateTruncatedDigest(digest, digest.size(), m.input, m.length);
+			if (keyed)
+			{
+				memcpy(key.m_reg, chain, bs);
+				key.m_counter = counter;
+			}
+			if (verify)
+				m.valid = VerifyBufsEqual(digest, m.digest, m.digestSize);
+			else
+				memcpy(m.digest, digest, m.digestSize);
+			continue;
+		}
+
+		blockSize = bs;
+		const size_t tail = m.length ? (m.length-1) % bs + 1 : 0;
+		byte *final = last+n*bs;
+		memset(final, 0, bs);
+		if (tail)
+			memcpy(final, m.input+m.length-tail, tail);
+		if (tail < bs)
+		{
+			final[tail] = 0x80;
+			xorbuf(final, key.m_reg+2*bs, bs);
+		}
+		else
+			xorbuf(final, key.m_reg+bs, bs);
+
+		ciphers[n] = &key.GetCipher();
+		blocks[n] = (m.length-tail)/bs + 1;
+		lanes[n++] = i;
+	}
+
+	if (n == 0)
+		return;
+
+	// Lanes are ordered by length, so the lanes still running are always a prefix
+	unsigned int order[BATCH_LANES];
+	const BlockCipher *active[BATCH_LANES];
+	const byte *inputs[BATCH_LANES];
+	bool sameKey = true;
+	for (unsigned int i=0; i<n; ++i)
+	{
+		unsigned int j = i;
+		for (; j>0 && blocks[order[j-1]] < blocks[i]; --j)
+			order[j] = order[j-1];
+		order[j] = i;
+		sameKey = sameKey && ciphers[i] == ciphers[0];
+	}
+	for (unsigned int i=0; i<n; ++i)
+	{
+		active[i] = ciphers[order[i]];
+		inputs[i] = messages[lanes[order[i]]].input;
+	}
+
+	// The bodies run in stretches that end when the shortest running lane ends, and the
+	//   final blocks of all lanes run together
+	memset(state, 0, n*blockSize);
+	size_t done = 0;
+	for (unsigned int running=n; running; --running)
+	{
+		const size_t body = blocks[order[running-1]]-1;
+		if (body > done)
+		{
+			CBCMACLanes(active, sameKey, state, inputs, running, body-done, blockSize);
+			for (unsigned int i=0; i<running; ++i)
+				inputs[i] += (body-done)*blockSize;
+			done = body;
+		}
+	}
+	for (unsigned int i=0; i<n; ++i)
+		inputs[i] = last+order[i]*blockSize;
+	CBCMACLanes(active, sameKey, state, inputs, n, 1, blockSize);
+
+	for (unsigned int i=0; i<n; ++i)
+	{
+		BatchMessage &m = messages[lanes[order[i]]];
+		if (verify)
+			m.valid = VerifyBufsEqual(state+i*blockSize, m.digest, m.digestSize);
+		else
+			memcpy(m.digest, state+i*blockSize, m.digestSize);
+	}
+}
+
 NAMESPACE_END
 
 #endif
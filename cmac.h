@@ -27,6 +27,39 @@ public:
 	unsigned int OptimalBlockSize() const {return GetCipher().BlockSize();}
 	unsigned int OptimalDataAlignment() const {return GetCipher().OptimalDataAlignment();}
 
+	//! \brief A message in a batch
+	//! \details \p key is the key handle for the message. It is a keyed CMAC object, or NULL to use
+	//!   the object that processes the batch. The \p digest is written by CalculateDigestBatch() and
+	//!   read by VerifyDigestBatch(), and \p valid receives the result of the verification.
+	struct BatchMessage
+	{
+		BatchMessage() : key(NULLPTR), input(NULLPTR), length(0), digest(NULLPTR), digestSize(0), valid(false) {}
+
+		CMAC_Base *key;
+		const byte *input;
+		size_t length;
+		byte *digest;
+		size_t digestSize;
+		bool valid;
+	};
+
+	//! \brief Calculates the truncated digests of a batch of messages
+	//! \param messages the messages
+	//! \param count the number of messages
+	//! \details CalculateDigestBatch() has the same effect as calling CalculateTruncatedDigest() on
+	//!   each message's key handle. CMAC is serial within a message, so the batch runs the chains of
+	//!   up to eight messages side by side. Messages with the same key use the cipher's parallel
+	//!   path, and AES messages with different keys use AES-NI directly. Any message in progress
+	//!   on a key handle is not affected.
+	void CalculateDigestBatch(BatchMessage *messages, size_t count);
+	//! \brief Verifies the truncated digests of a batch of messages
+	//! \param messages the messages
+	//! \param count the number of messages
+	//! \return true if every digest is valid, false otherwise
+	//! \details VerifyDigestBatch() has the same effect as calling VerifyTruncatedDigest() on each
+	//!   message's key handle, and sets each message's \p valid member.
+	bool VerifyDigestBatch(BatchMessage *messages, size_t count);
+
 protected:
 	friend class EAX_Base;
 
@@ -34,6 +67,9 @@ protected:
 	virtual BlockCipher & AccessCipher() =0;
 
 	void ProcessBuf();
+	void ProcessBatch(BatchMessage *messages, unsigned int count, bool verify);
+
+	enum {BATCH_LANES = 8};
 	SecByteBlock m_reg;
 	unsigned int m_counter;
 };
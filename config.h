@@ -445,6 +445,12 @@ NAMESPACE_END
 	#define CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE 0
 #endif
 
+#if !defined(CRYPTOPP_DISABLE_ASM) && !defined(CRYPTOPP_DISABLE_AVX2) && !defined(_M_ARM) && ((_MSC_VER >= 1800) || defined(__AVX2__))
+	#define CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE 1
+#else
+	#define CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE 0
+#endif
+
 #if !defined(CRYPTOPP_DISABLE_ASM) && !defined(CRYPTOPP_DISABLE_SHA) && !defined(_M_ARM) && ((_MSC_VER >= 1900) || defined(__SHA__))
 	#define CRYPTOPP_BOOL_SSE_SHA_INTRINSICS_AVAILABLE 1
 #else
@@ -187,11 +187,28 @@ static bool TrySSE2()
 bool CRYPTOPP_SECTION_INIT g_x86DetectionDone = false;
 bool CRYPTOPP_SECTION_INIT g_hasMMX = false, CRYPTOPP_SECTION_INIT g_hasISSE = false, CRYPTOPP_SECTION_INIT g_hasSSE2 = false, CRYPTOPP_SECTION_INIT g_hasSSSE3 = false;
 bool CRYPTOPP_SECTION_INIT g_hasSSE4 = false, CRYPTOPP_SECTION_INIT g_hasAESNI = false, CRYPTOPP_SECTION_INIT g_hasCLMUL = false, CRYPTOPP_SECTION_INIT g_hasSHA = false;
+bool CRYPTOPP_SECTION_INIT g_hasAVX2 = false;
 bool CRYPTOPP_SECTION_INIT g_hasRDRAND = false, CRYPTOPP_SECTION_INIT g_hasRDSEED = false, CRYPTOPP_SECTION_INIT g_isP4 = false;
 bool CRYPTOPP_SECTION_INIT g_hasPadlockRNG = false, CRYPTOPP_SECTION_INIT g_hasPadlockACE = false, CRYPTOPP_SECTION_INIT g_hasPadlockACE2 = false;
 bool CRYPTOPP_SECTION_INIT g_hasPadlockPHE = false, CRYPTOPP_SECTION_INIT g_hasPadlockPMM = false;
 word32 CRYPTOPP_SECTION_INIT g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
+// Reads the extended control register. Only call it when CPUID reports OSXSAVE.
+static word64 XGetBV(word32 num)
+{
+#if defined(_MSC_FULL_VER) && (_MSC_FULL_VER >= 160040219)
+	return _xgetbv(num);
+#elif defined(__GNUC__) || defined(__SUNPRO_CC)
+	word32 a=0, d=0;
+	// xgetbv, which older assemblers do not know
+	__asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (a), "=d" (d) : "c" (num));
+	return ((word64)d << 32) | a;
+#else
+	CRYPTOPP_UNUSED(num);
+	return 0;
+#endif
+}
+
 static inline bool IsIntel(const word32 output[4])
 {
 	// This is the "GenuineIntel" string
@@ -245,6 +262,17 @@ void DetectX86Features()
 		}
 	}
 
+	// AVX2 also requires the OS to save the XMM and YMM state
+	static const unsigned int OSXSAVE_FLAG = (1 << 27);
+	static const unsigned int    AVX_FLAG = (1 << 28);
+	static const unsigned int   AVX2_FLAG = (1 << 5);
+	if (cpuid1[0] /*EAX*/ >= 7 && (cpuid2[2] /*ECX*/ & OSXSAVE_FLAG) && (cpuid2[2] /*ECX*/ & AVX_FLAG))
+	{
+		word32 cpuid4[4]={0};
+		if ((XGetBV(0) & 6) == 6 && CpuId(7, cpuid4))
+			g_hasAVX2 = !!(cpuid4[1] /*EBX*/ & AVX2_FLAG);
+	}
+
 	if (IsIntel(cpuid1))
 	{
 		static const unsigned int RDRAND_FLAG = (1 << 30);
@@ -57,7 +57,7 @@
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 #  include <wmmintrin.h>    // aesenc, aesdec, etc
 #endif // wmmintrin.h
-#if CRYPTOPP_BOOL_SSE_SHA_INTRINSICS_AVAILABLE
+#if CRYPTOPP_BOOL_SSE_SHA_INTRINSICS_AVAILABLE || CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
 #  include <immintrin.h>    // RDRAND, RDSEED, AVX, SHA
 #endif // immintrin.h
 #endif  // X86/X64/X32 Headers
@@ -117,6 +117,7 @@ extern CRYPTOPP_DLL bool g_hasSSE4;
 extern CRYPTOPP_DLL bool g_hasAESNI;
 extern CRYPTOPP_DLL bool g_hasCLMUL;
 extern CRYPTOPP_DLL bool g_hasSHA;
+extern CRYPTOPP_DLL bool g_hasAVX2;
 extern CRYPTOPP_DLL bool g_isP4;
 extern CRYPTOPP_DLL bool g_hasRDRAND;
 extern CRYPTOPP_DLL bool g_hasRDSEED;
@@ -227,6 +228,17 @@ inline bool HasSHA()
 	return g_hasSHA;
 }
 
+//! \brief Determines AVX2 availability
+//! \returns true if AVX2 is determined to be available, false otherwise
+//! \details HasAVX2() is a runtime check performed using CPUID and XGETBV. It
+//!   returns true only if the operating system saves the YMM registers.
+inline bool HasAVX2()
+{
+	if (!g_x86DetectionDone)
+		DetectX86Features();
+	return g_hasAVX2;
+}
+
 //! \brief Determines if the CPU is an Intel P4
 //! \returns true if the CPU is a P4, false otherwise
 //! \details IsP4() is a runtime check performed using CPUID
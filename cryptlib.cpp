@@ -190,7 +190,7 @@ size_t BlockTransformation::AdvancedProcessBlocks(const byte *inBlocks, const by
 		}
 
 		if (flags & BT_InBlockIsCounter)
-			const_cast<byte *>(inBlocks)[blockSize-1]++;
+			IncrementCounterBlock(const_cast<byte *>(inBlocks), blockSize, flags);
 		inBlocks += inIncrement;
 		outBlocks += outIncrement;
 		xorBlocks += xorIncrement;
@@ -200,6 +200,37 @@ size_t BlockTransformation::AdvancedProcessBlocks(const byte *inBlocks, const by
 	return length;
 }
 
+void BlockTransformation::ProcessCounterBlocks(byte *counter, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	CRYPTOPP_ASSERT(!(flags & BT_DontIncrementInOutPointers));
+	flags |= BT_InBlockIsCounter;
+	if (SupportsWideCounters() || !(flags & (BT_Counter32|BT_Counter64)))
+	{
+		AdvancedProcessBlocks(counter, xorBlocks, outBlocks, length, flags);
+		return;
+	}
+
+	// Each call stops where the last byte wraps, and the last byte is set here in case
+	//   the cipher does not store the counter back. This is the old CTR mode behavior.
+	const unsigned int blockSize = BlockSize();
+	const unsigned int width = STDMIN(blockSize, (flags & BT_Counter64) ? 8U : 4U);
+	const size_t xorIncrement = xorBlocks ? blockSize : 0;
+	flags &= ~(BT_Counter32|BT_Counter64);
+
+	while (length >= blockSize)
+	{
+		const byte lsb = counter[blockSize-1];
+		const size_t blocks = UnsignedMin(length/blockSize, 256U-lsb);
+		AdvancedProcessBlocks(counter, xorBlocks, outBlocks, blocks*blockSize, flags);
+		if ((counter[blockSize-1] = lsb + (byte)blocks) == 0)
+			IncrementCounterByOne(counter+blockSize-width, width-1);
+
+		outBlocks += blocks*blockSize;
+		xorBlocks += blocks*xorIncrement;
+		length -= blocks*blockSize;
+	}
+}
+
 unsigned int BlockTransformation::OptimalDataAlignment() const
 {
 	return GetAlignmentOf<word32>();
@@ -257,6 +288,29 @@ bool AuthenticatedSymmetricCipher::DecryptAndVerify(byte *message, const byte *m
 	return TruncatedVerify(mac, macLength);
 }
 
+void AuthenticatedSymmetricCipher::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		AuthenticatedSymmetricCipher &cipher = m.cipher ? *m.cipher : *this;
+		cipher.EncryptAndAuthenticate(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+	}
+}
+
+bool AuthenticatedSymmetricCipher::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	bool valid = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		AuthenticatedSymmetricCipher &cipher = m.cipher ? *m.cipher : *this;
+		m.valid = cipher.DecryptAndVerify(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+		valid = valid && m.valid;
+	}
+	return valid;
+}
+
 unsigned int RandomNumberGenerator::GenerateBit()
 {
 	return GenerateByte() & 1;
@@ -805,7 +805,11 @@ public:
 		//! \brief perform the transformation in reverse
 		BT_ReverseDirection=8,
 		//! \brief
-		BT_AllowParallel=16};
+		BT_AllowParallel=16,
+		//! \brief the counter is the last 4 bytes of inBlocks, big-endian, and wraps modulo 2^32
+		BT_Counter32=32,
+		//! \brief the counter is the last 8 bytes of inBlocks, big-endian, and wraps modulo 2^64
+		BT_Counter64=64};
 
 	//! \brief Encrypt and xor multiple blocks using additional flags
 	//! \param inBlocks the input message before processing
@@ -814,9 +818,33 @@ public:
 	//! \param length the size of the blocks, in bytes
 	//! \param flags additional flags to control processing
 	//! \details Encrypt and xor multiple blocks according to FlagsForAdvancedProcessBlocks flags.
-	//! \note If BT_InBlockIsCounter is set, then the last byte of inBlocks may be modified.
+	//! \note If BT_InBlockIsCounter is set, then inBlocks is advanced past the blocks processed.
+	//!   BT_Counter32 and BT_Counter64 select the width of the counter. Without either flag
+	//!   only the last byte is incremented, and the caller must not let it wrap.
+	//! \note BT_Counter32 and BT_Counter64 are only honored if SupportsWideCounters() returns
+	//!   true. Use ProcessCounterBlocks() to run a wide counter with any cipher.
 	virtual size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
 
+	//! \brief Determines if AdvancedProcessBlocks() advances a wide counter
+	//! \return true if AdvancedProcessBlocks() honors BT_Counter32 and BT_Counter64, false otherwise
+	//! \details The default implementation returns false because a derived class that overrides
+	//!   AdvancedProcessBlocks() may only increment the last byte of the counter, or may not store
+	//!   the counter back. A class whose AdvancedProcessBlocks() advances the counter as
+	//!   documented should override SupportsWideCounters() and return true.
+	virtual bool SupportsWideCounters() const {return false;}
+
+	//! \brief Encrypt and xor counter blocks with a 32-bit or 64-bit counter
+	//! \param counter the counter block, which is advanced past the blocks processed
+	//! \param xorBlocks an optional XOR mask
+	//! \param outBlocks the output message after processing
+	//! \param length the size of the blocks, in bytes
+	//! \param flags additional flags, including BT_Counter32 or BT_Counter64
+	//! \details ProcessCounterBlocks() calls AdvancedProcessBlocks() with BT_InBlockIsCounter.
+	//!   The counter wraps within its width without carrying into the rest of the block. If
+	//!   SupportsWideCounters() returns false, then the request is split where the last byte
+	//!   of the counter wraps and the carry is applied here.
+	void ProcessCounterBlocks(byte *counter, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+
 	//! \brief Provides the direction of the cipher
 	//! \return ENCRYPTION if IsForwardTransformation() is true, DECRYPTION otherwise
 	//! \sa IsForwardTransformation(), IsPermutation()
@@ -1167,6 +1195,46 @@ public:
 	//!   DecryptAndVerify() will assume MAC is truncated if <tt>macLength < TagSize()</tt>.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength);
 
+	//! \brief A message in a batch
+	//! \details BatchMessage describes one call to EncryptAndAuthenticate() or DecryptAndVerify().
+	//!   \p cipher is the key handle for the message. It is an object of the same type and direction
+	//!   that has already been keyed, or NULL to use the object that processes the batch. The
+	//!   \p mac is written when encrypting and read when decrypting, and \p valid receives the
+	//!   result of the verification.
+	struct BatchMessage
+	{
+		BatchMessage() : cipher(NULLPTR), iv(NULLPTR), ivLength(0), header(NULLPTR), headerLength(0),
+			input(NULLPTR), output(NULLPTR), length(0), mac(NULLPTR), macSize(0), valid(false) {}
+
+		AuthenticatedSymmetricCipher *cipher;
+		const byte *iv;
+		int ivLength;
+		const byte *header;
+		size_t headerLength;
+		const byte *input;
+		byte *output;
+		size_t length;
+		byte *mac;
+		size_t macSize;
+		bool valid;
+	};
+
+	//! \brief Encrypts and calculates a MAC for a batch of messages
+	//! \param messages the messages
+	//! \param count the number of messages
+	//! \details EncryptAndAuthenticateBatch() has the same effect as calling EncryptAndAuthenticate()
+	//!   on each message's key handle. Modes that support it process messages with the same key
+	//!   handle together, so that short messages still fill the block cipher's parallel pipeline.
+	//!   The key handles are left without an IV, as if after TruncatedFinal().
+	virtual void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+	//! \brief Decrypts and verifies a MAC for a batch of messages
+	//! \param messages the messages
+	//! \param count the number of messages
+	//! \return true if every MAC is valid, false otherwise
+	//! \details DecryptAndVerifyBatch() has the same effect as calling DecryptAndVerify() on each
+	//!   message's key handle, and sets each message's \p valid member.
+	virtual bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 	//! \brief Provides the name of this algorithm
 	//! \return the standard algorithm name
 	//! \details The standard algorithm name can be a name like \a AES or \a AES/GCM. Some algorithms
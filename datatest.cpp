@@ -509,59 +509,95 @@ void TestAuthenticatedSymmetricCipher(TestData &v, const NameValuePairs &overrid
 		asc1->SetKey((const byte *)key.data(), key.size(), pairs);
 		asc2->SetKey((const byte *)key.data(), key.size(), pairs);
 
-		std::string encrypted, decrypted;
-		AuthenticatedEncryptionFilter ef(*asc1, new StringSink(encrypted));
-		bool macAtBegin = !mac.empty() && !Test::GlobalRNG().GenerateBit();	// test both ways randomly
-		AuthenticatedDecryptionFilter df(*asc2, new StringSink(decrypted), macAtBegin ? AuthenticatedDecryptionFilter::MAC_AT_BEGIN : 0);
-
-		if (asc1->NeedsPrespecifiedDataLengths())
+		// Modes without an online interface, like GCM-SIV, only run the one-shot test below
+		const bool online = !DataExists(v, "Online") || GetRequiredDatum(v, "Online") != "No";
+		if (online)
 		{
-			asc1->SpecifyDataLengths(header.size(), plaintext.size(), footer.size());
-			asc2->SpecifyDataLengths(header.size(), plaintext.size(), footer.size());
-		}
+			std::string encrypted, decrypted;
+			AuthenticatedEncryptionFilter ef(*asc1, new StringSink(encrypted));
+			bool macAtBegin = !mac.empty() && !Test::GlobalRNG().GenerateBit();	// test both ways randomly
+			AuthenticatedDecryptionFilter df(*asc2, new StringSink(decrypted), macAtBegin ? AuthenticatedDecryptionFilter::MAC_AT_BEGIN : 0);
 
-		StringStore sh(header), sp(plaintext), sc(ciphertext), sf(footer), sm(mac);
+			if (asc1->NeedsPrespecifiedDataLengths())
+			{
+				asc1->SpecifyDataLengths(header.size(), plaintext.size(), footer.size());
+				asc2->SpecifyDataLengths(header.size(), plaintext.size(), footer.size());
+			}
 
-		if (macAtBegin)
-			RandomizedTransfer(sm, df, true);
-		sh.CopyTo(df, LWORD_MAX, AAD_CHANNEL);
-		RandomizedTransfer(sc, df, true);
-		sf.CopyTo(df, LWORD_MAX, AAD_CHANNEL);
-		if (!macAtBegin)
-			RandomizedTransfer(sm, df, true);
-		df.MessageEnd();
+			StringStore sh(header), sp(plaintext), sc(ciphertext), sf(footer), sm(mac);
 
-		RandomizedTransfer(sh, ef, true, AAD_CHANNEL);
-		RandomizedTransfer(sp, ef, true);
-		RandomizedTransfer(sf, ef, true, AAD_CHANNEL);
-		ef.MessageEnd();
+			if (macAtBegin)
+				RandomizedTransfer(sm, df, true);
+			sh.CopyTo(df, LWORD_MAX, AAD_CHANNEL);
+			RandomizedTransfer(sc, df, true);
+			sf.CopyTo(df, LWORD_MAX, AAD_CHANNEL);
+			if (!macAtBegin)
+				RandomizedTransfer(sm, df, true);
+			df.MessageEnd();
 
-		if (test == "Encrypt" && encrypted != ciphertext+mac)
-		{
-			std::cout << "incorrectly encrypted: ";
-			StringSource xx(encrypted, false, new HexEncoder(new FileSink(std::cout)));
-			xx.Pump(2048); xx.Flush(false);
-			std::cout << "\n";
-			SignalTestFailure();
-		}
-		if (test == "Encrypt" && decrypted != plaintext)
-		{
-			std::cout << "incorrectly decrypted: ";
-			StringSource xx(decrypted, false, new HexEncoder(new FileSink(std::cout)));
-			xx.Pump(256); xx.Flush(false);
-			std::cout << "\n";
-			SignalTestFailure();
-		}
+			RandomizedTransfer(sh, ef, true, AAD_CHANNEL);
+			RandomizedTransfer(sp, ef, true);
+			RandomizedTransfer(sf, ef, true, AAD_CHANNEL);
+			ef.MessageEnd();
 
-		if (ciphertext.size()+mac.size()-plaintext.size() != asc1->DigestSize())
-		{
-			std::cout << "bad MAC size\n";
-			SignalTestFailure();
+			if (test == "Encrypt" && encrypted != ciphertext+mac)
+			{
+				std::cout << "incorrectly encrypted: ";
+				StringSource xx(encrypted, false, new HexEncoder(new FileSink(std::cout)));
+				xx.Pump(2048); xx.Flush(false);
+				std::cout << "\n";
+				SignalTestFailure();
+			}
+			if (test == "Encrypt" && decrypted != plaintext)
+			{
+				std::cout << "incorrectly decrypted: ";
+				StringSource xx(decrypted, false, new HexEncoder(new FileSink(std::cout)));
+				xx.Pump(256); xx.Flush(false);
+				std::cout << "\n";
+				SignalTestFailure();
+			}
+
+			if (ciphertext.size()+mac.size()-plaintext.size() != asc1->DigestSize())
+			{
+				std::cout << "bad MAC size\n";
+				SignalTestFailure();
+			}
+			if (df.GetLastResult() != (test == "Encrypt"))
+			{
+				std::cout << "MAC incorrectly verified\n";
+				SignalTestFailure();
+			}
 		}
-		if (df.GetLastResult() != (test == "Encrypt"))
+
+		// EncryptAndAuthenticate() and DecryptAndVerify() take the IV and have no footer
+		if (test != "EncryptXorDigest" && footer.empty() && DataExists(v, "IV"))
 		{
-			std::cout << "MAC incorrectly verified\n";
-			SignalTestFailure();
+			std::string iv = GetDecodedDatum(v, "IV");
+			std::string expected = ciphertext+mac;
+			size_t macSize = expected.size()-plaintext.size();
+			std::string encrypted(expected.size(), 0), decrypted(plaintext.size(), 0);
+
+			// A resynchronization that no message follows must not affect the next message
+			if (online)
+			{
+				asc1->Resynchronize((const byte *)iv.data(), (int)iv.size());
+				asc2->Resynchronize((const byte *)iv.data(), (int)iv.size());
+			}
+			asc1->EncryptAndAuthenticate((byte *)&encrypted[0], (byte *)&encrypted[0]+plaintext.size(), macSize,
+				(const byte *)iv.data(), (int)iv.size(), (const byte *)header.data(), header.size(), (const byte *)plaintext.data(), plaintext.size());
+			bool verified = asc2->DecryptAndVerify((byte *)&decrypted[0], (const byte *)expected.data()+plaintext.size(), macSize,
+				(const byte *)iv.data(), (int)iv.size(), (const byte *)header.data(), header.size(), (const byte *)expected.data(), plaintext.size());
+
+			if (test == "Encrypt" && (encrypted != expected || decrypted != plaintext))
+			{
+				std::cout << "incorrectly encrypted or decrypted by EncryptAndAuthenticate() or DecryptAndVerify()\n";
+				SignalTestFailure();
+			}
+			if (verified != (test == "Encrypt"))
+			{
+				std::cout << "MAC incorrectly verified by DecryptAndVerify()\n";
+				SignalTestFailure();
+			}
 		}
 	}
 	else
@@ -17,6 +17,11 @@
 #include "pch.h"
 #include "misc.h"
 #include "des.h"
+#include "cpu.h"
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+# define CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS 1
+#endif
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -366,12 +371,698 @@ void RawDES::RawProcessBlock(word32 &l_, word32 &r_) const
 	l_ = l; r_ = r;
 }
 
+void RawDES::GetBitslicedKey(word32 *masks) const
+{
+	// k[2*i] holds the 6-bit groups for S-boxes 1, 3, 5 and 7, and k[2*i+1] for 2, 4, 6 and 8
+	for (unsigned int i=0; i<16; i++)
+		for (unsigned int j=0; j<48; j++)
+		{
+			const unsigned int s = j/6, shift = 24 - 8*(s/2) + 5 - j%6;
+			masks[48*i+j] = 0 - ((k[2*i+(s&1)] >> shift) & 1);
+		}
+}
+
+#if CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+
+// Bitsliced TripleDES for batches of blocks. Each block is loaded as a little-endian
+//   word64 and the batch is transposed so that plane q holds bit q of every block.
+//   IP, FP, E and P then become fixed plane indices, and the S-boxes are evaluated
+//   as Boolean circuits over whole planes. One pass covers 64 blocks per 64-bit lane,
+//   so SSE2 processes 128 blocks and AVX2 processes 256 blocks at a time.
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Plane holding bit i of L0||R0 after the initial permutation
+const byte s_bsInitial[64] = {
+	62, 54, 46, 38, 30, 22, 14,  6,
+	60, 52, 44, 36, 28, 20, 12,  4,
+	58, 50, 42, 34, 26, 18, 10,  2,
+	56, 48, 40, 32, 24, 16,  8,  0,
+	63, 55, 47, 39, 31, 23, 15,  7,
+	61, 53, 45, 37, 29, 21, 13,  5,
+	59, 51, 43, 35, 27, 19, 11,  3,
+	57, 49, 41, 33, 25, 17,  9,  1
+};
+
+// Bit of R16||L16 that the final permutation places in plane q
+const byte s_bsFinal[64] = {
+	31, 63, 23, 55, 15, 47,  7, 39,
+	30, 62, 22, 54, 14, 46,  6, 38,
+	29, 61, 21, 53, 13, 45,  5, 37,
+	28, 60, 20, 52, 12, 44,  4, 36,
+	27, 59, 19, 51, 11, 43,  3, 35,
+	26, 58, 18, 50, 10, 42,  2, 34,
+	25, 57, 17, 49,  9, 41,  1, 33,
+	24, 56, 16, 48,  8, 40,  0, 32
+};
+
+// Expansion, as indices into R
+const byte s_bsExpand[48] = {
+	31,  0,  1,  2,  3,  4,
+	 3,  4,  5,  6,  7,  8,
+	 7,  8,  9, 10, 11, 12,
+	11, 12, 13, 14, 15, 16,
+	15, 16, 17, 18, 19, 20,
+	19, 20, 21, 22, 23, 24,
+	23, 24, 25, 26, 27, 28,
+	27, 28, 29, 30, 31,  0
+};
+
+// Index into L that receives S-box output bit i
+const byte s_bsPerm[32] = {
+	 8, 16, 22, 30,
+	12, 27,  1, 17,
+	23, 15, 29,  5,
+	25, 19,  9,  0,
+	 7, 13, 24,  2,
+	 3, 28, 10, 18,
+	31, 11, 21,  6,
+	 4, 26, 14, 20
+};
+
+ANONYMOUS_NAMESPACE_END
+
+inline __m128i DES_BS_And(const __m128i &a, const __m128i &b) {return _mm_and_si128(a, b);}
+inline __m128i DES_BS_Or(const __m128i &a, const __m128i &b) {return _mm_or_si128(a, b);}
+inline __m128i DES_BS_Xor(const __m128i &a, const __m128i &b) {return _mm_xor_si128(a, b);}
+inline __m128i DES_BS_AndNot(const __m128i &a, const __m128i &b) {return _mm_andnot_si128(a, b);}
+inline __m128i DES_BS_Ones(const __m128i &) {return _mm_set1_epi32(-1);}
+inline __m128i DES_BS_Broadcast(word32 k, const __m128i &) {return _mm_set1_epi32((int)k);}
+template <unsigned int N> inline __m128i DES_BS_ShiftLeft(const __m128i &a) {return _mm_slli_epi64(a, N);}
+template <unsigned int N> inline __m128i DES_BS_ShiftRight(const __m128i &a) {return _mm_srli_epi64(a, N);}
+inline void DES_BS_Mask(__m128i &m, word64 v) {m = _mm_set1_epi64x((long long)v);}
+
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+inline __m256i DES_BS_And(const __m256i &a, const __m256i &b) {return _mm256_and_si256(a, b);}
+inline __m256i DES_BS_Or(const __m256i &a, const __m256i &b) {return _mm256_or_si256(a, b);}
+inline __m256i DES_BS_Xor(const __m256i &a, const __m256i &b) {return _mm256_xor_si256(a, b);}
+inline __m256i DES_BS_AndNot(const __m256i &a, const __m256i &b) {return _mm256_andnot_si256(a, b);}
+inline __m256i DES_BS_Ones(const __m256i &) {return _mm256_set1_epi32(-1);}
+inline __m256i DES_BS_Broadcast(word32 k, const __m256i &) {return _mm256_set1_epi32((int)k);}
+template <unsigned int N> inline __m256i DES_BS_ShiftLeft(const __m256i &a) {return _mm256_slli_epi64(a, N);}
+template <unsigned int N> inline __m256i DES_BS_ShiftRight(const __m256i &a) {return _mm256_srli_epi64(a, N);}
+inline void DES_BS_Mask(__m256i &m, word64 v) {m = _mm256_set1_epi64x((long long)v);}
+#endif
+
+// The S-box circuits were generated from the tables above by multiplexer
+//   decomposition, choosing the input order that gave the fewest gates.
+template <class V>
+inline void DES_BS_S1(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a5, ONES); const V x2 = DES_BS_Xor(a3, x1); const V x3 = DES_BS_Xor(x2, a5);
+	const V x4 = DES_BS_And(x3, a2); const V x5 = DES_BS_Xor(x2, x4); const V x6 = DES_BS_And(a3, x1);
+	const V x7 = DES_BS_Xor(a2, x6); const V x8 = DES_BS_Xor(x5, x7); const V x9 = DES_BS_And(x8, a1);
+	const V x10 = DES_BS_Xor(x5, x9); const V x11 = DES_BS_Xor(x5, ONES); const V x12 = DES_BS_Xor(x6, ONES);
+	const V x13 = DES_BS_Xor(x2, ONES); const V x14 = DES_BS_Xor(x12, x13); const V x15 = DES_BS_And(x14, a2);
+	const V x16 = DES_BS_Xor(x12, x15); const V x17 = DES_BS_Xor(x11, x16); const V x18 = DES_BS_And(x17, a1);
+	const V x19 = DES_BS_Xor(x11, x18); const V x20 = DES_BS_Xor(x10, x19); const V x21 = DES_BS_And(x20, a6);
+	const V x22 = DES_BS_Xor(x10, x21); const V x23 = DES_BS_Or(a3, x1); const V x24 = DES_BS_Xor(a2, x23);
+	const V x25 = DES_BS_AndNot(a3, x1); const V x26 = DES_BS_Xor(x12, x25); const V x27 = DES_BS_And(x26, a2);
+	const V x28 = DES_BS_Xor(x12, x27); const V x29 = DES_BS_Xor(x24, x28); const V x30 = DES_BS_And(x29, a1);
+	const V x31 = DES_BS_Xor(x24, x30); const V x32 = DES_BS_Xor(x25, a5); const V x33 = DES_BS_And(x32, a2);
+	const V x34 = DES_BS_Xor(x25, x33); const V x35 = DES_BS_Xor(x7, x34); const V x36 = DES_BS_And(x35, a1);
+	const V x37 = DES_BS_Xor(x7, x36); const V x38 = DES_BS_Xor(x31, x37); const V x39 = DES_BS_And(x38, a6);
+	const V x40 = DES_BS_Xor(x31, x39); const V x41 = DES_BS_Xor(x22, x40); const V x42 = DES_BS_And(x41, a4);
+	const V x43 = DES_BS_Xor(x22, x42); const V x44 = DES_BS_Xor(x7, ONES); const V x45 = DES_BS_Xor(a3, ONES);
+	const V x46 = DES_BS_Xor(x23, x45); const V x47 = DES_BS_And(x46, a2); const V x48 = DES_BS_Xor(x23, x47);
+	const V x49 = DES_BS_Xor(x44, x48); const V x50 = DES_BS_And(x49, a1); const V x51 = DES_BS_Xor(x44, x50);
+	const V x52 = DES_BS_Xor(x13, a5); const V x53 = DES_BS_And(x52, a2); const V x54 = DES_BS_Xor(x13, x53);
+	const V x55 = DES_BS_AndNot(x1, a3); const V x56 = DES_BS_Xor(x55, ONES); const V x57 = DES_BS_Xor(x56, x25);
+	const V x58 = DES_BS_And(x57, a2); const V x59 = DES_BS_Xor(x56, x58); const V x60 = DES_BS_Xor(x54, x59);
+	const V x61 = DES_BS_And(x60, a1); const V x62 = DES_BS_Xor(x54, x61); const V x63 = DES_BS_Xor(x51, x62);
+	const V x64 = DES_BS_And(x63, a6); const V x65 = DES_BS_Xor(x51, x64); const V x66 = DES_BS_Xor(x25, x12);
+	const V x67 = DES_BS_And(x66, a2); const V x68 = DES_BS_Xor(x25, x67); const V x69 = DES_BS_Xor(x25, x13);
+	const V x70 = DES_BS_And(x69, a2); const V x71 = DES_BS_Xor(x25, x70); const V x72 = DES_BS_Xor(x68, x71);
+	const V x73 = DES_BS_And(x72, a1); const V x74 = DES_BS_Xor(x68, x73); const V x75 = DES_BS_Xor(a1, x59);
+	const V x76 = DES_BS_Xor(x74, x75); const V x77 = DES_BS_And(x76, a6); const V x78 = DES_BS_Xor(x74, x77);
+	const V x79 = DES_BS_Xor(x65, x78); const V x80 = DES_BS_And(x79, a4); const V x81 = DES_BS_Xor(x65, x80);
+	const V x82 = DES_BS_Xor(x56, ONES); const V x83 = DES_BS_Xor(x82, x23); const V x84 = DES_BS_And(x83, a2);
+	const V x85 = DES_BS_Xor(x82, x84); const V x86 = DES_BS_Xor(x48, x85); const V x87 = DES_BS_And(x86, a1);
+	const V x88 = DES_BS_Xor(x48, x87); const V x89 = DES_BS_Xor(x25, ONES); const V x90 = DES_BS_Xor(x89, x45);
+	const V x91 = DES_BS_And(x90, a2); const V x92 = DES_BS_Xor(x89, x91); const V x93 = DES_BS_Xor(x92, x71);
+	const V x94 = DES_BS_And(x93, a1); const V x95 = DES_BS_Xor(x92, x94); const V x96 = DES_BS_Xor(x88, x95);
+	const V x97 = DES_BS_And(x96, a6); const V x98 = DES_BS_Xor(x88, x97); const V x99 = DES_BS_Xor(x16, ONES);
+	const V x100 = DES_BS_Xor(x99, x24); const V x101 = DES_BS_And(x100, a1); const V x102 = DES_BS_Xor(x99, x101);
+	const V x103 = DES_BS_Xor(a5, x56); const V x104 = DES_BS_And(x103, a2); const V x105 = DES_BS_Xor(a5, x104);
+	const V x106 = DES_BS_Xor(x71, x105); const V x107 = DES_BS_And(x106, a1); const V x108 = DES_BS_Xor(x71, x107);
+	const V x109 = DES_BS_Xor(x102, x108); const V x110 = DES_BS_And(x109, a6); const V x111 = DES_BS_Xor(x102, x110);
+	const V x112 = DES_BS_Xor(x98, x111); const V x113 = DES_BS_And(x112, a4); const V x114 = DES_BS_Xor(x98, x113);
+	const V x115 = DES_BS_Xor(x85, x11); const V x116 = DES_BS_And(x115, a1); const V x117 = DES_BS_Xor(x85, x116);
+	const V x118 = DES_BS_Xor(x48, ONES); const V x119 = DES_BS_Xor(x2, x45); const V x120 = DES_BS_And(x119, a2);
+	const V x121 = DES_BS_Xor(x2, x120); const V x122 = DES_BS_Xor(x118, x121); const V x123 = DES_BS_And(x122, a1);
+	const V x124 = DES_BS_Xor(x118, x123); const V x125 = DES_BS_Xor(x117, x124); const V x126 = DES_BS_And(x125, a6);
+	const V x127 = DES_BS_Xor(x117, x126); const V x128 = DES_BS_Xor(a2, x56); const V x129 = DES_BS_Xor(a1, x128);
+	const V x130 = DES_BS_Xor(x23, x13); const V x131 = DES_BS_And(x130, a2); const V x132 = DES_BS_Xor(x23, x131);
+	const V x133 = DES_BS_Xor(a3, x2); const V x134 = DES_BS_And(x133, a2); const V x135 = DES_BS_Xor(a3, x134);
+	const V x136 = DES_BS_Xor(x132, x135); const V x137 = DES_BS_And(x136, a1); const V x138 = DES_BS_Xor(x132, x137);
+	const V x139 = DES_BS_Xor(x129, x138); const V x140 = DES_BS_And(x139, a6); const V x141 = DES_BS_Xor(x129, x140);
+	const V x142 = DES_BS_Xor(x127, x141); const V x143 = DES_BS_And(x142, a4); const V x144 = DES_BS_Xor(x127, x143);
+	o1 = DES_BS_Xor(o1, x43);
+	o2 = DES_BS_Xor(o2, x81);
+	o3 = DES_BS_Xor(o3, x114);
+	o4 = DES_BS_Xor(o4, x144);
+}
+
+template <class V>
+inline void DES_BS_S2(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a4, ONES); const V x2 = DES_BS_AndNot(x1, a2); const V x3 = DES_BS_Xor(x2, ONES);
+	const V x4 = DES_BS_And(a2, x1); const V x5 = DES_BS_Xor(x3, x4); const V x6 = DES_BS_And(x5, a3);
+	const V x7 = DES_BS_Xor(x3, x6); const V x8 = DES_BS_Xor(a2, x1); const V x9 = DES_BS_Xor(a4, x8);
+	const V x10 = DES_BS_And(x9, a3); const V x11 = DES_BS_Xor(a4, x10); const V x12 = DES_BS_Xor(x7, x11);
+	const V x13 = DES_BS_And(x12, a5); const V x14 = DES_BS_Xor(x7, x13); const V x15 = DES_BS_Xor(x3, ONES);
+	const V x16 = DES_BS_Xor(a3, x15); const V x17 = DES_BS_Xor(a5, x16); const V x18 = DES_BS_Xor(x14, x17);
+	const V x19 = DES_BS_And(x18, a1); const V x20 = DES_BS_Xor(x14, x19); const V x21 = DES_BS_Xor(a3, x4);
+	const V x22 = DES_BS_Xor(a3, x8); const V x23 = DES_BS_Xor(x21, x22); const V x24 = DES_BS_And(x23, a5);
+	const V x25 = DES_BS_Xor(x21, x24); const V x26 = DES_BS_Xor(x16, ONES); const V x27 = DES_BS_Xor(x26, x8);
+	const V x28 = DES_BS_And(x27, a5); const V x29 = DES_BS_Xor(x26, x28); const V x30 = DES_BS_Xor(x25, x29);
+	const V x31 = DES_BS_And(x30, a1); const V x32 = DES_BS_Xor(x25, x31); const V x33 = DES_BS_Xor(x20, x32);
+	const V x34 = DES_BS_And(x33, a6); const V x35 = DES_BS_Xor(x20, x34); const V x36 = DES_BS_AndNot(a2, x1);
+	const V x37 = DES_BS_Or(a2, x1); const V x38 = DES_BS_Xor(x36, x37); const V x39 = DES_BS_And(x38, a3);
+	const V x40 = DES_BS_Xor(x36, x39); const V x41 = DES_BS_Xor(a5, x40); const V x42 = DES_BS_Xor(x40, ONES);
+	const V x43 = DES_BS_Xor(x42, x8); const V x44 = DES_BS_And(x43, a5); const V x45 = DES_BS_Xor(x42, x44);
+	const V x46 = DES_BS_Xor(x41, x45); const V x47 = DES_BS_And(x46, a1); const V x48 = DES_BS_Xor(x41, x47);
+	const V x49 = DES_BS_Xor(x8, ONES); const V x50 = DES_BS_Xor(x49, x1); const V x51 = DES_BS_And(x50, a3);
+	const V x52 = DES_BS_Xor(x49, x51); const V x53 = DES_BS_Xor(a2, ONES); const V x54 = DES_BS_Xor(x53, a4);
+	const V x55 = DES_BS_And(x54, a3); const V x56 = DES_BS_Xor(x53, x55); const V x57 = DES_BS_Xor(x52, x56);
+	const V x58 = DES_BS_And(x57, a5); const V x59 = DES_BS_Xor(x52, x58); const V x60 = DES_BS_Xor(a1, x59);
+	const V x61 = DES_BS_Xor(x48, x60); const V x62 = DES_BS_And(x61, a6); const V x63 = DES_BS_Xor(x48, x62);
+	const V x64 = DES_BS_Xor(x8, x53); const V x65 = DES_BS_And(x64, a3); const V x66 = DES_BS_Xor(x8, x65);
+	const V x67 = DES_BS_Xor(x22, ONES); const V x68 = DES_BS_Xor(x66, x67); const V x69 = DES_BS_And(x68, a5);
+	const V x70 = DES_BS_Xor(x66, x69); const V x71 = DES_BS_Xor(x37, ONES); const V x72 = DES_BS_Xor(x71, x8);
+	const V x73 = DES_BS_And(x72, a3); const V x74 = DES_BS_Xor(x71, x73); const V x75 = DES_BS_Xor(x4, ONES);
+	const V x76 = DES_BS_Xor(x75, a2); const V x77 = DES_BS_And(x76, a3); const V x78 = DES_BS_Xor(x75, x77);
+	const V x79 = DES_BS_Xor(x74, x78); const V x80 = DES_BS_And(x79, a5); const V x81 = DES_BS_Xor(x74, x80);
+	const V x82 = DES_BS_Xor(x70, x81); const V x83 = DES_BS_And(x82, a1); const V x84 = DES_BS_Xor(x70, x83);
+	const V x85 = DES_BS_Xor(a4, x53); const V x86 = DES_BS_And(x85, a3); const V x87 = DES_BS_Xor(a4, x86);
+	const V x88 = DES_BS_Xor(x40, x87); const V x89 = DES_BS_And(x88, a5); const V x90 = DES_BS_Xor(x40, x89);
+	const V x91 = DES_BS_Xor(x36, ONES); const V x92 = DES_BS_Xor(x91, x8); const V x93 = DES_BS_And(x92, a3);
+	const V x94 = DES_BS_Xor(x91, x93); const V x95 = DES_BS_Xor(x78, ONES); const V x96 = DES_BS_Xor(x94, x95);
+	const V x97 = DES_BS_And(x96, a5); const V x98 = DES_BS_Xor(x94, x97); const V x99 = DES_BS_Xor(x90, x98);
+	const V x100 = DES_BS_And(x99, a1); const V x101 = DES_BS_Xor(x90, x100); const V x102 = DES_BS_Xor(x84, x101);
+	const V x103 = DES_BS_And(x102, a6); const V x104 = DES_BS_Xor(x84, x103); const V x105 = DES_BS_Xor(a3, x1);
+	const V x106 = DES_BS_Xor(x37, x36); const V x107 = DES_BS_And(x106, a3); const V x108 = DES_BS_Xor(x37, x107);
+	const V x109 = DES_BS_Xor(x105, x108); const V x110 = DES_BS_And(x109, a5); const V x111 = DES_BS_Xor(x105, x110);
+	const V x112 = DES_BS_Xor(x108, ONES); const V x113 = DES_BS_Xor(x49, x112); const V x114 = DES_BS_And(x113, a5);
+	const V x115 = DES_BS_Xor(x49, x114); const V x116 = DES_BS_Xor(x111, x115); const V x117 = DES_BS_And(x116, a1);
+	const V x118 = DES_BS_Xor(x111, x117); const V x119 = DES_BS_Xor(a3, x53); const V x120 = DES_BS_Xor(x8, x119);
+	const V x121 = DES_BS_And(x120, a5); const V x122 = DES_BS_Xor(x8, x121); const V x123 = DES_BS_Xor(a3, x71);
+	const V x124 = DES_BS_Xor(x108, x123); const V x125 = DES_BS_And(x124, a5); const V x126 = DES_BS_Xor(x108, x125);
+	const V x127 = DES_BS_Xor(x122, x126); const V x128 = DES_BS_And(x127, a1); const V x129 = DES_BS_Xor(x122, x128);
+	const V x130 = DES_BS_Xor(x118, x129); const V x131 = DES_BS_And(x130, a6); const V x132 = DES_BS_Xor(x118, x131);
+	o1 = DES_BS_Xor(o1, x35);
+	o2 = DES_BS_Xor(o2, x63);
+	o3 = DES_BS_Xor(o3, x104);
+	o4 = DES_BS_Xor(o4, x132);
+}
+
+template <class V>
+inline void DES_BS_S3(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a3, ONES); const V x2 = DES_BS_Xor(a6, ONES); const V x3 = DES_BS_Xor(x1, x2);
+	const V x4 = DES_BS_And(x3, a4); const V x5 = DES_BS_Xor(x1, x4); const V x6 = DES_BS_AndNot(a6, a3);
+	const V x7 = DES_BS_Xor(x6, ONES); const V x8 = DES_BS_And(a4, x7); const V x9 = DES_BS_Xor(x5, x8);
+	const V x10 = DES_BS_And(x9, a5); const V x11 = DES_BS_Xor(x5, x10); const V x12 = DES_BS_Xor(a3, x2);
+	const V x13 = DES_BS_Xor(a3, x12); const V x14 = DES_BS_And(x13, a4); const V x15 = DES_BS_Xor(a3, x14);
+	const V x16 = DES_BS_Xor(x12, ONES); const V x17 = DES_BS_Xor(x7, x16); const V x18 = DES_BS_And(x17, a4);
+	const V x19 = DES_BS_Xor(x7, x18); const V x20 = DES_BS_Xor(x15, x19); const V x21 = DES_BS_And(x20, a5);
+	const V x22 = DES_BS_Xor(x15, x21); const V x23 = DES_BS_Xor(x11, x22); const V x24 = DES_BS_And(x23, a2);
+	const V x25 = DES_BS_Xor(x11, x24); const V x26 = DES_BS_Xor(a4, x2); const V x27 = DES_BS_Or(a3, a6);
+	const V x28 = DES_BS_Xor(a4, x27); const V x29 = DES_BS_Xor(x26, x28); const V x30 = DES_BS_And(x29, a5);
+	const V x31 = DES_BS_Xor(x26, x30); const V x32 = DES_BS_Xor(a4, x12); const V x33 = DES_BS_Xor(a5, x32);
+	const V x34 = DES_BS_Xor(x31, x33); const V x35 = DES_BS_And(x34, a2); const V x36 = DES_BS_Xor(x31, x35);
+	const V x37 = DES_BS_Xor(x25, x36); const V x38 = DES_BS_And(x37, a1); const V x39 = DES_BS_Xor(x25, x38);
+	const V x40 = DES_BS_Xor(x16, a3); const V x41 = DES_BS_And(x40, a4); const V x42 = DES_BS_Xor(x16, x41);
+	const V x43 = DES_BS_Xor(x26, ONES); const V x44 = DES_BS_Xor(x42, x43); const V x45 = DES_BS_And(x44, a5);
+	const V x46 = DES_BS_Xor(x42, x45); const V x47 = DES_BS_And(a3, a6); const V x48 = DES_BS_Xor(x47, x7);
+	const V x49 = DES_BS_And(x48, a4); const V x50 = DES_BS_Xor(x47, x49); const V x51 = DES_BS_Xor(x2, x1);
+	const V x52 = DES_BS_And(x51, a4); const V x53 = DES_BS_Xor(x2, x52); const V x54 = DES_BS_Xor(x50, x53);
+	const V x55 = DES_BS_And(x54, a5); const V x56 = DES_BS_Xor(x50, x55); const V x57 = DES_BS_Xor(x46, x56);
+	const V x58 = DES_BS_And(x57, a2); const V x59 = DES_BS_Xor(x46, x58); const V x60 = DES_BS_Xor(x42, ONES);
+	const V x61 = DES_BS_Xor(x2, x47); const V x62 = DES_BS_And(x61, a4); const V x63 = DES_BS_Xor(x2, x62);
+	const V x64 = DES_BS_Xor(x60, x63); const V x65 = DES_BS_And(x64, a5); const V x66 = DES_BS_Xor(x60, x65);
+	const V x67 = DES_BS_Or(a3, x2); const V x68 = DES_BS_Xor(a6, x67); const V x69 = DES_BS_And(x68, a4);
+	const V x70 = DES_BS_Xor(a6, x69); const V x71 = DES_BS_Xor(x16, x70); const V x72 = DES_BS_And(x71, a5);
+	const V x73 = DES_BS_Xor(x16, x72); const V x74 = DES_BS_Xor(x66, x73); const V x75 = DES_BS_And(x74, a2);
+	const V x76 = DES_BS_Xor(x66, x75); const V x77 = DES_BS_Xor(x59, x76); const V x78 = DES_BS_And(x77, a1);
+	const V x79 = DES_BS_Xor(x59, x78); const V x80 = DES_BS_Xor(x67, a3); const V x81 = DES_BS_And(x80, a4);
+	const V x82 = DES_BS_Xor(x67, x81); const V x83 = DES_BS_Xor(x32, ONES); const V x84 = DES_BS_Xor(x82, x83);
+	const V x85 = DES_BS_And(x84, a5); const V x86 = DES_BS_Xor(x82, x85); const V x87 = DES_BS_Xor(x47, x1);
+	const V x88 = DES_BS_And(x87, a4); const V x89 = DES_BS_Xor(x47, x88); const V x90 = DES_BS_Xor(x42, x89);
+	const V x91 = DES_BS_And(x90, a5); const V x92 = DES_BS_Xor(x42, x91); const V x93 = DES_BS_Xor(x86, x92);
+	const V x94 = DES_BS_And(x93, a2); const V x95 = DES_BS_Xor(x86, x94); const V x96 = DES_BS_Xor(x7, ONES);
+	const V x97 = DES_BS_Xor(x47, x96); const V x98 = DES_BS_And(x97, a4); const V x99 = DES_BS_Xor(x47, x98);
+	const V x100 = DES_BS_Xor(x47, ONES); const V x101 = DES_BS_Xor(a4, x100); const V x102 = DES_BS_Xor(x99, x101);
+	const V x103 = DES_BS_And(x102, a5); const V x104 = DES_BS_Xor(x99, x103); const V x105 = DES_BS_Or(a4, x12);
+	const V x106 = DES_BS_Xor(x105, x16); const V x107 = DES_BS_And(x106, a5); const V x108 = DES_BS_Xor(x105, x107);
+	const V x109 = DES_BS_Xor(x104, x108); const V x110 = DES_BS_And(x109, a2); const V x111 = DES_BS_Xor(x104, x110);
+	const V x112 = DES_BS_Xor(x95, x111); const V x113 = DES_BS_And(x112, a1); const V x114 = DES_BS_Xor(x95, x113);
+	const V x115 = DES_BS_Xor(x43, x16); const V x116 = DES_BS_And(x115, a5); const V x117 = DES_BS_Xor(x43, x116);
+	const V x118 = DES_BS_Xor(a2, x117); const V x119 = DES_BS_Xor(x15, ONES); const V x120 = DES_BS_Xor(a5, x119);
+	const V x121 = DES_BS_AndNot(a4, x67); const V x122 = DES_BS_Xor(x121, x19); const V x123 = DES_BS_And(x122, a5);
+	const V x124 = DES_BS_Xor(x121, x123); const V x125 = DES_BS_Xor(x120, x124); const V x126 = DES_BS_And(x125, a2);
+	const V x127 = DES_BS_Xor(x120, x126); const V x128 = DES_BS_Xor(x118, x127); const V x129 = DES_BS_And(x128, a1);
+	const V x130 = DES_BS_Xor(x118, x129);
+	o1 = DES_BS_Xor(o1, x39);
+	o2 = DES_BS_Xor(o2, x79);
+	o3 = DES_BS_Xor(o3, x114);
+	o4 = DES_BS_Xor(o4, x130);
+}
+
+template <class V>
+inline void DES_BS_S4(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a3, ONES); const V x2 = DES_BS_AndNot(x1, a1); const V x3 = DES_BS_Xor(x2, ONES);
+	const V x4 = DES_BS_Xor(a1, x3); const V x5 = DES_BS_And(x4, a4); const V x6 = DES_BS_Xor(a1, x5);
+	const V x7 = DES_BS_Xor(a1, x1); const V x8 = DES_BS_Xor(x7, a3); const V x9 = DES_BS_And(x8, a4);
+	const V x10 = DES_BS_Xor(x7, x9); const V x11 = DES_BS_Xor(x6, x10); const V x12 = DES_BS_And(x11, a5);
+	const V x13 = DES_BS_Xor(x6, x12); const V x14 = DES_BS_Xor(x7, ONES); const V x15 = DES_BS_Xor(a4, x14);
+	const V x16 = DES_BS_AndNot(a1, a3); const V x17 = DES_BS_Xor(x16, x14); const V x18 = DES_BS_And(x17, a4);
+	const V x19 = DES_BS_Xor(x16, x18); const V x20 = DES_BS_Xor(x15, x19); const V x21 = DES_BS_And(x20, a5);
+	const V x22 = DES_BS_Xor(x15, x21); const V x23 = DES_BS_Xor(x13, x22); const V x24 = DES_BS_And(x23, a2);
+	const V x25 = DES_BS_Xor(x13, x24); const V x26 = DES_BS_Xor(a4, x3); const V x27 = DES_BS_Xor(x7, x26);
+	const V x28 = DES_BS_And(x27, a5); const V x29 = DES_BS_Xor(x7, x28); const V x30 = DES_BS_Xor(a1, x16);
+	const V x31 = DES_BS_And(x30, a4); const V x32 = DES_BS_Xor(a1, x31); const V x33 = DES_BS_Or(a4, x16);
+	const V x34 = DES_BS_Xor(x32, x33); const V x35 = DES_BS_And(x34, a5); const V x36 = DES_BS_Xor(x32, x35);
+	const V x37 = DES_BS_Xor(x29, x36); const V x38 = DES_BS_And(x37, a2); const V x39 = DES_BS_Xor(x29, x38);
+	const V x40 = DES_BS_Xor(x25, x39); const V x41 = DES_BS_And(x40, a6); const V x42 = DES_BS_Xor(x25, x41);
+	const V x43 = DES_BS_Xor(x25, ONES); const V x44 = DES_BS_Xor(x39, x43); const V x45 = DES_BS_And(x44, a6);
+	const V x46 = DES_BS_Xor(x39, x45); const V x47 = DES_BS_Xor(x1, x7); const V x48 = DES_BS_And(x47, a4);
+	const V x49 = DES_BS_Xor(x1, x48); const V x50 = DES_BS_Or(a1, a3); const V x51 = DES_BS_Xor(a1, ONES);
+	const V x52 = DES_BS_Xor(x50, x51); const V x53 = DES_BS_And(x52, a4); const V x54 = DES_BS_Xor(x50, x53);
+	const V x55 = DES_BS_Xor(x49, x54); const V x56 = DES_BS_And(x55, a5); const V x57 = DES_BS_Xor(x49, x56);
+	const V x58 = DES_BS_And(a1, x1); const V x59 = DES_BS_Xor(x14, x58); const V x60 = DES_BS_And(x59, a4);
+	const V x61 = DES_BS_Xor(x14, x60); const V x62 = DES_BS_Xor(x15, ONES); const V x63 = DES_BS_Xor(x61, x62);
+	const V x64 = DES_BS_And(x63, a5); const V x65 = DES_BS_Xor(x61, x64); const V x66 = DES_BS_Xor(x57, x65);
+	const V x67 = DES_BS_And(x66, a2); const V x68 = DES_BS_Xor(x57, x67); const V x69 = DES_BS_Xor(a4, x50);
+	const V x70 = DES_BS_Xor(x69, x14); const V x71 = DES_BS_And(x70, a5); const V x72 = DES_BS_Xor(x69, x71);
+	const V x73 = DES_BS_Xor(x58, ONES); const V x74 = DES_BS_And(a4, x73); const V x75 = DES_BS_Xor(x73, a1);
+	const V x76 = DES_BS_And(x75, a4); const V x77 = DES_BS_Xor(x73, x76); const V x78 = DES_BS_Xor(x74, x77);
+	const V x79 = DES_BS_And(x78, a5); const V x80 = DES_BS_Xor(x74, x79); const V x81 = DES_BS_Xor(x72, x80);
+	const V x82 = DES_BS_And(x81, a2); const V x83 = DES_BS_Xor(x72, x82); const V x84 = DES_BS_Xor(x68, x83);
+	const V x85 = DES_BS_And(x84, a6); const V x86 = DES_BS_Xor(x68, x85); const V x87 = DES_BS_Xor(x83, ONES);
+	const V x88 = DES_BS_Xor(x87, x68); const V x89 = DES_BS_And(x88, a6); const V x90 = DES_BS_Xor(x87, x89);
+	o1 = DES_BS_Xor(o1, x42);
+	o2 = DES_BS_Xor(o2, x46);
+	o3 = DES_BS_Xor(o3, x86);
+	o4 = DES_BS_Xor(o4, x90);
+}
+
+template <class V>
+inline void DES_BS_S5(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a1, ONES); const V x2 = DES_BS_And(a5, x1); const V x3 = DES_BS_Xor(a2, x2);
+	const V x4 = DES_BS_Or(a5, a1); const V x5 = DES_BS_Xor(a2, x4); const V x6 = DES_BS_Xor(x3, x5);
+	const V x7 = DES_BS_And(x6, a3); const V x8 = DES_BS_Xor(x3, x7); const V x9 = DES_BS_And(a5, a1);
+	const V x10 = DES_BS_AndNot(x9, a2); const V x11 = DES_BS_Xor(x10, ONES); const V x12 = DES_BS_Xor(a5, a1);
+	const V x13 = DES_BS_Xor(x9, x12); const V x14 = DES_BS_And(x13, a2); const V x15 = DES_BS_Xor(x9, x14);
+	const V x16 = DES_BS_Xor(x11, x15); const V x17 = DES_BS_And(x16, a3); const V x18 = DES_BS_Xor(x11, x17);
+	const V x19 = DES_BS_Xor(x8, x18); const V x20 = DES_BS_And(x19, a6); const V x21 = DES_BS_Xor(x8, x20);
+	const V x22 = DES_BS_Xor(x12, ONES); const V x23 = DES_BS_Or(a5, x1); const V x24 = DES_BS_Xor(x22, x23);
+	const V x25 = DES_BS_And(x24, a2); const V x26 = DES_BS_Xor(x22, x25); const V x27 = DES_BS_Xor(x15, x26);
+	const V x28 = DES_BS_And(x27, a3); const V x29 = DES_BS_Xor(x15, x28); const V x30 = DES_BS_Xor(x12, x23);
+	const V x31 = DES_BS_And(x30, a2); const V x32 = DES_BS_Xor(x12, x31); const V x33 = DES_BS_Xor(x4, ONES);
+	const V x34 = DES_BS_Xor(x22, x33); const V x35 = DES_BS_And(x34, a2); const V x36 = DES_BS_Xor(x22, x35);
+	const V x37 = DES_BS_Xor(x32, x36); const V x38 = DES_BS_And(x37, a3); const V x39 = DES_BS_Xor(x32, x38);
+	const V x40 = DES_BS_Xor(x29, x39); const V x41 = DES_BS_And(x40, a6); const V x42 = DES_BS_Xor(x29, x41);
+	const V x43 = DES_BS_Xor(x21, x42); const V x44 = DES_BS_And(x43, a4); const V x45 = DES_BS_Xor(x21, x44);
+	const V x46 = DES_BS_Xor(a5, ONES); const V x47 = DES_BS_Xor(x22, x46); const V x48 = DES_BS_And(x47, a2);
+	const V x49 = DES_BS_Xor(x22, x48); const V x50 = DES_BS_Xor(x12, x49); const V x51 = DES_BS_And(x50, a3);
+	const V x52 = DES_BS_Xor(x12, x51); const V x53 = DES_BS_Xor(x2, ONES); const V x54 = DES_BS_Xor(x33, x53);
+	const V x55 = DES_BS_And(x54, a2); const V x56 = DES_BS_Xor(x33, x55); const V x57 = DES_BS_Xor(x23, x9);
+	const V x58 = DES_BS_And(x57, a2); const V x59 = DES_BS_Xor(x23, x58); const V x60 = DES_BS_Xor(x56, x59);
+	const V x61 = DES_BS_And(x60, a3); const V x62 = DES_BS_Xor(x56, x61); const V x63 = DES_BS_Xor(x52, x62);
+	const V x64 = DES_BS_And(x63, a6); const V x65 = DES_BS_Xor(x52, x64); const V x66 = DES_BS_Xor(x5, ONES);
+	const V x67 = DES_BS_Xor(a2, x12); const V x68 = DES_BS_Xor(x66, x67); const V x69 = DES_BS_And(x68, a3);
+	const V x70 = DES_BS_Xor(x66, x69); const V x71 = DES_BS_Xor(a6, x70); const V x72 = DES_BS_Xor(x65, x71);
+	const V x73 = DES_BS_And(x72, a4); const V x74 = DES_BS_Xor(x65, x73); const V x75 = DES_BS_Xor(x32, ONES);
+	const V x76 = DES_BS_Xor(x9, ONES); const V x77 = DES_BS_Xor(x76, a1); const V x78 = DES_BS_And(x77, a2);
+	const V x79 = DES_BS_Xor(x76, x78); const V x80 = DES_BS_Xor(x75, x79); const V x81 = DES_BS_And(x80, a3);
+	const V x82 = DES_BS_Xor(x75, x81); const V x83 = DES_BS_Xor(a2, a5); const V x84 = DES_BS_Xor(x79, x83);
+	const V x85 = DES_BS_And(x84, a3); const V x86 = DES_BS_Xor(x79, x85); const V x87 = DES_BS_Xor(x82, x86);
+	const V x88 = DES_BS_And(x87, a6); const V x89 = DES_BS_Xor(x82, x88); const V x90 = DES_BS_Xor(x79, ONES);
+	const V x91 = DES_BS_Xor(x15, ONES); const V x92 = DES_BS_Xor(x90, x91); const V x93 = DES_BS_And(x92, a3);
+	const V x94 = DES_BS_Xor(x90, x93); const V x95 = DES_BS_Xor(x22, x1); const V x96 = DES_BS_And(x95, a2);
+	const V x97 = DES_BS_Xor(x22, x96); const V x98 = DES_BS_Xor(x23, ONES); const V x99 = DES_BS_Xor(x98, a5);
+	const V x100 = DES_BS_And(x99, a2); const V x101 = DES_BS_Xor(x98, x100); const V x102 = DES_BS_Xor(x97, x101);
+	const V x103 = DES_BS_And(x102, a3); const V x104 = DES_BS_Xor(x97, x103); const V x105 = DES_BS_Xor(x94, x104);
+	const V x106 = DES_BS_And(x105, a6); const V x107 = DES_BS_Xor(x94, x106); const V x108 = DES_BS_Xor(x89, x107);
+	const V x109 = DES_BS_And(x108, a4); const V x110 = DES_BS_Xor(x89, x109); const V x111 = DES_BS_And(a2, x4);
+	const V x112 = DES_BS_Xor(x111, x22); const V x113 = DES_BS_And(x112, a3); const V x114 = DES_BS_Xor(x111, x113);
+	const V x115 = DES_BS_Xor(x12, x1); const V x116 = DES_BS_And(x115, a2); const V x117 = DES_BS_Xor(x12, x116);
+	const V x118 = DES_BS_Xor(x67, x117); const V x119 = DES_BS_And(x118, a3); const V x120 = DES_BS_Xor(x67, x119);
+	const V x121 = DES_BS_Xor(x114, x120); const V x122 = DES_BS_And(x121, a6); const V x123 = DES_BS_Xor(x114, x122);
+	const V x124 = DES_BS_Xor(x4, x23); const V x125 = DES_BS_And(x124, a2); const V x126 = DES_BS_Xor(x4, x125);
+	const V x127 = DES_BS_Xor(x46, x2); const V x128 = DES_BS_And(x127, a2); const V x129 = DES_BS_Xor(x46, x128);
+	const V x130 = DES_BS_Xor(x126, x129); const V x131 = DES_BS_And(x130, a3); const V x132 = DES_BS_Xor(x126, x131);
+	const V x133 = DES_BS_Xor(x9, x22); const V x134 = DES_BS_And(x133, a2); const V x135 = DES_BS_Xor(x9, x134);
+	const V x136 = DES_BS_Xor(x23, a1); const V x137 = DES_BS_And(x136, a2); const V x138 = DES_BS_Xor(x23, x137);
+	const V x139 = DES_BS_Xor(x135, x138); const V x140 = DES_BS_And(x139, a3); const V x141 = DES_BS_Xor(x135, x140);
+	const V x142 = DES_BS_Xor(x132, x141); const V x143 = DES_BS_And(x142, a6); const V x144 = DES_BS_Xor(x132, x143);
+	const V x145 = DES_BS_Xor(x123, x144); const V x146 = DES_BS_And(x145, a4); const V x147 = DES_BS_Xor(x123, x146);
+	o1 = DES_BS_Xor(o1, x45);
+	o2 = DES_BS_Xor(o2, x74);
+	o3 = DES_BS_Xor(o3, x110);
+	o4 = DES_BS_Xor(o4, x147);
+}
+
+template <class V>
+inline void DES_BS_S6(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a2, ONES); const V x2 = DES_BS_Xor(a6, x1); const V x3 = DES_BS_Xor(x1, x2);
+	const V x4 = DES_BS_And(x3, a1); const V x5 = DES_BS_Xor(x1, x4); const V x6 = DES_BS_AndNot(a6, x1);
+	const V x7 = DES_BS_Xor(x2, x6); const V x8 = DES_BS_And(x7, a1); const V x9 = DES_BS_Xor(x2, x8);
+	const V x10 = DES_BS_Xor(x5, x9); const V x11 = DES_BS_And(x10, a4); const V x12 = DES_BS_Xor(x5, x11);
+	const V x13 = DES_BS_Xor(x2, ONES); const V x14 = DES_BS_Xor(a1, x13); const V x15 = DES_BS_Xor(a4, x14);
+	const V x16 = DES_BS_Xor(x12, x15); const V x17 = DES_BS_And(x16, a5); const V x18 = DES_BS_Xor(x12, x17);
+	const V x19 = DES_BS_Xor(a6, ONES); const V x20 = DES_BS_And(a6, x1); const V x21 = DES_BS_Xor(x19, x20);
+	const V x22 = DES_BS_And(x21, a1); const V x23 = DES_BS_Xor(x19, x22); const V x24 = DES_BS_Or(a1, x20);
+	const V x25 = DES_BS_Xor(x23, x24); const V x26 = DES_BS_And(x25, a4); const V x27 = DES_BS_Xor(x23, x26);
+	const V x28 = DES_BS_Xor(a1, a6); const V x29 = DES_BS_Xor(x20, ONES); const V x30 = DES_BS_Xor(x29, a6);
+	const V x31 = DES_BS_And(x30, a1); const V x32 = DES_BS_Xor(x29, x31); const V x33 = DES_BS_Xor(x28, x32);
+	const V x34 = DES_BS_And(x33, a4); const V x35 = DES_BS_Xor(x28, x34); const V x36 = DES_BS_Xor(x27, x35);
+	const V x37 = DES_BS_And(x36, a5); const V x38 = DES_BS_Xor(x27, x37); const V x39 = DES_BS_Xor(x18, x38);
+	const V x40 = DES_BS_And(x39, a3); const V x41 = DES_BS_Xor(x18, x40); const V x42 = DES_BS_Xor(x14, ONES);
+	const V x43 = DES_BS_Xor(x42, x28); const V x44 = DES_BS_And(x43, a4); const V x45 = DES_BS_Xor(x42, x44);
+	const V x46 = DES_BS_Or(a6, x1); const V x47 = DES_BS_Xor(x29, x46); const V x48 = DES_BS_And(x47, a1);
+	const V x49 = DES_BS_Xor(x29, x48); const V x50 = DES_BS_Xor(x14, x49); const V x51 = DES_BS_And(x50, a4);
+	const V x52 = DES_BS_Xor(x14, x51); const V x53 = DES_BS_Xor(x45, x52); const V x54 = DES_BS_And(x53, a5);
+	const V x55 = DES_BS_Xor(x45, x54); const V x56 = DES_BS_And(a6, a2); const V x57 = DES_BS_Xor(x13, x56);
+	const V x58 = DES_BS_And(x57, a1); const V x59 = DES_BS_Xor(x13, x58); const V x60 = DES_BS_Xor(x19, x1);
+	const V x61 = DES_BS_And(x60, a1); const V x62 = DES_BS_Xor(x19, x61); const V x63 = DES_BS_Xor(x59, x62);
+	const V x64 = DES_BS_And(x63, a4); const V x65 = DES_BS_Xor(x59, x64); const V x66 = DES_BS_Xor(x20, a2);
+	const V x67 = DES_BS_And(x66, a1); const V x68 = DES_BS_Xor(x20, x67); const V x69 = DES_BS_Xor(x13, x68);
+	const V x70 = DES_BS_And(x69, a4); const V x71 = DES_BS_Xor(x13, x70); const V x72 = DES_BS_Xor(x65, x71);
+	const V x73 = DES_BS_And(x72, a5); const V x74 = DES_BS_Xor(x65, x73); const V x75 = DES_BS_Xor(x55, x74);
+	const V x76 = DES_BS_And(x75, a3); const V x77 = DES_BS_Xor(x55, x76); const V x78 = DES_BS_Xor(x62, ONES);
+	const V x79 = DES_BS_Xor(a4, x78); const V x80 = DES_BS_Xor(x20, x46); const V x81 = DES_BS_And(x80, a1);
+	const V x82 = DES_BS_Xor(x20, x81); const V x83 = DES_BS_Xor(x46, a2); const V x84 = DES_BS_And(x83, a1);
+	const V x85 = DES_BS_Xor(x46, x84); const V x86 = DES_BS_Xor(x82, x85); const V x87 = DES_BS_And(x86, a4);
+	const V x88 = DES_BS_Xor(x82, x87); const V x89 = DES_BS_Xor(x79, x88); const V x90 = DES_BS_And(x89, a5);
+	const V x91 = DES_BS_Xor(x79, x90); const V x92 = DES_BS_Xor(x24, ONES); const V x93 = DES_BS_Xor(x46, ONES);
+	const V x94 = DES_BS_Xor(x56, ONES); const V x95 = DES_BS_Xor(x93, x94); const V x96 = DES_BS_And(x95, a1);
+	const V x97 = DES_BS_Xor(x93, x96); const V x98 = DES_BS_Xor(x92, x97); const V x99 = DES_BS_And(x98, a4);
+	const V x100 = DES_BS_Xor(x92, x99); const V x101 = DES_BS_Xor(x15, x100); const V x102 = DES_BS_And(x101, a5);
+	const V x103 = DES_BS_Xor(x15, x102); const V x104 = DES_BS_Xor(x91, x103); const V x105 = DES_BS_And(x104, a3);
+	const V x106 = DES_BS_Xor(x91, x105); const V x107 = DES_BS_And(a1, x29); const V x108 = DES_BS_Xor(a2, x2);
+	const V x109 = DES_BS_And(x108, a1); const V x110 = DES_BS_Xor(a2, x109); const V x111 = DES_BS_Xor(x107, x110);
+	const V x112 = DES_BS_And(x111, a4); const V x113 = DES_BS_Xor(x107, x112); const V x114 = DES_BS_Xor(x107, ONES);
+	const V x115 = DES_BS_Xor(x6, x2); const V x116 = DES_BS_And(x115, a1); const V x117 = DES_BS_Xor(x6, x116);
+	const V x118 = DES_BS_Xor(x114, x117); const V x119 = DES_BS_And(x118, a4); const V x120 = DES_BS_Xor(x114, x119);
+	const V x121 = DES_BS_Xor(x113, x120); const V x122 = DES_BS_And(x121, a5); const V x123 = DES_BS_Xor(x113, x122);
+	const V x124 = DES_BS_Xor(x110, ONES); const V x125 = DES_BS_Xor(x117, ONES); const V x126 = DES_BS_Xor(x124, x125);
+	const V x127 = DES_BS_And(x126, a4); const V x128 = DES_BS_Xor(x124, x127); const V x129 = DES_BS_Xor(x5, ONES);
+	const V x130 = DES_BS_Xor(x129, x14); const V x131 = DES_BS_And(x130, a4); const V x132 = DES_BS_Xor(x129, x131);
+	const V x133 = DES_BS_Xor(x128, x132); const V x134 = DES_BS_And(x133, a5); const V x135 = DES_BS_Xor(x128, x134);
+	const V x136 = DES_BS_Xor(x123, x135); const V x137 = DES_BS_And(x136, a3); const V x138 = DES_BS_Xor(x123, x137);
+	o1 = DES_BS_Xor(o1, x41);
+	o2 = DES_BS_Xor(o2, x77);
+	o3 = DES_BS_Xor(o3, x106);
+	o4 = DES_BS_Xor(o4, x138);
+}
+
+template <class V>
+inline void DES_BS_S7(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_And(a4, a2); const V x2 = DES_BS_Xor(a5, x1); const V x3 = DES_BS_Xor(a2, ONES);
+	const V x4 = DES_BS_Xor(a4, a2); const V x5 = DES_BS_Xor(x3, x4); const V x6 = DES_BS_And(x5, a5);
+	const V x7 = DES_BS_Xor(x3, x6); const V x8 = DES_BS_Xor(x2, x7); const V x9 = DES_BS_And(x8, a3);
+	const V x10 = DES_BS_Xor(x2, x9); const V x11 = DES_BS_Or(a4, a2); const V x12 = DES_BS_Xor(x4, x11);
+	const V x13 = DES_BS_And(x12, a5); const V x14 = DES_BS_Xor(x4, x13); const V x15 = DES_BS_Xor(x4, ONES);
+	const V x16 = DES_BS_And(a4, x3); const V x17 = DES_BS_Xor(x15, x16); const V x18 = DES_BS_And(x17, a5);
+	const V x19 = DES_BS_Xor(x15, x18); const V x20 = DES_BS_Xor(x14, x19); const V x21 = DES_BS_And(x20, a3);
+	const V x22 = DES_BS_Xor(x14, x21); const V x23 = DES_BS_Xor(x10, x22); const V x24 = DES_BS_And(x23, a1);
+	const V x25 = DES_BS_Xor(x10, x24); const V x26 = DES_BS_Xor(x2, ONES); const V x27 = DES_BS_Xor(a3, x26);
+	const V x28 = DES_BS_Or(a4, x3); const V x29 = DES_BS_Xor(x4, x28); const V x30 = DES_BS_And(x29, a5);
+	const V x31 = DES_BS_Xor(x4, x30); const V x32 = DES_BS_Xor(x4, x1); const V x33 = DES_BS_And(x32, a5);
+	const V x34 = DES_BS_Xor(x4, x33); const V x35 = DES_BS_Xor(x31, x34); const V x36 = DES_BS_And(x35, a3);
+	const V x37 = DES_BS_Xor(x31, x36); const V x38 = DES_BS_Xor(x27, x37); const V x39 = DES_BS_And(x38, a1);
+	const V x40 = DES_BS_Xor(x27, x39); const V x41 = DES_BS_Xor(x25, x40); const V x42 = DES_BS_And(x41, a6);
+	const V x43 = DES_BS_Xor(x25, x42); const V x44 = DES_BS_Xor(x11, ONES); const V x45 = DES_BS_Xor(a5, x44);
+	const V x46 = DES_BS_Xor(x16, ONES); const V x47 = DES_BS_Xor(a5, x46); const V x48 = DES_BS_Xor(x45, x47);
+	const V x49 = DES_BS_And(x48, a3); const V x50 = DES_BS_Xor(x45, x49); const V x51 = DES_BS_Xor(x50, x10);
+	const V x52 = DES_BS_And(x51, a1); const V x53 = DES_BS_Xor(x50, x52); const V x54 = DES_BS_Xor(x46, a4);
+	const V x55 = DES_BS_And(x54, a5); const V x56 = DES_BS_Xor(x46, x55); const V x57 = DES_BS_Xor(x44, a2);
+	const V x58 = DES_BS_And(x57, a5); const V x59 = DES_BS_Xor(x44, x58); const V x60 = DES_BS_Xor(x56, x59);
+	const V x61 = DES_BS_And(x60, a3); const V x62 = DES_BS_Xor(x56, x61); const V x63 = DES_BS_Xor(a5, x3);
+	const V x64 = DES_BS_Xor(x28, ONES); const V x65 = DES_BS_Xor(a5, x64); const V x66 = DES_BS_Xor(x63, x65);
+	const V x67 = DES_BS_And(x66, a3); const V x68 = DES_BS_Xor(x63, x67); const V x69 = DES_BS_Xor(x62, x68);
+	const V x70 = DES_BS_And(x69, a1); const V x71 = DES_BS_Xor(x62, x70); const V x72 = DES_BS_Xor(x53, x71);
+	const V x73 = DES_BS_And(x72, a6); const V x74 = DES_BS_Xor(x53, x73); const V x75 = DES_BS_Xor(a3, x31);
+	const V x76 = DES_BS_Xor(x11, x64); const V x77 = DES_BS_And(x76, a5); const V x78 = DES_BS_Xor(x11, x77);
+	const V x79 = DES_BS_Xor(x16, x28); const V x80 = DES_BS_And(x79, a5); const V x81 = DES_BS_Xor(x16, x80);
+	const V x82 = DES_BS_Xor(x78, x81); const V x83 = DES_BS_And(x82, a3); const V x84 = DES_BS_Xor(x78, x83);
+	const V x85 = DES_BS_Xor(x75, x84); const V x86 = DES_BS_And(x85, a1); const V x87 = DES_BS_Xor(x75, x86);
+	const V x88 = DES_BS_Xor(x64, x11); const V x89 = DES_BS_And(x88, a5); const V x90 = DES_BS_Xor(x64, x89);
+	const V x91 = DES_BS_Xor(x4, x90); const V x92 = DES_BS_And(x91, a3); const V x93 = DES_BS_Xor(x4, x92);
+	const V x94 = DES_BS_Xor(x44, x15); const V x95 = DES_BS_And(x94, a5); const V x96 = DES_BS_Xor(x44, x95);
+	const V x97 = DES_BS_Xor(a3, x96); const V x98 = DES_BS_Xor(x93, x97); const V x99 = DES_BS_And(x98, a1);
+	const V x100 = DES_BS_Xor(x93, x99); const V x101 = DES_BS_Xor(x87, x100); const V x102 = DES_BS_And(x101, a6);
+	const V x103 = DES_BS_Xor(x87, x102); const V x104 = DES_BS_Xor(x7, ONES); const V x105 = DES_BS_Xor(a4, ONES);
+	const V x106 = DES_BS_Xor(a5, x105); const V x107 = DES_BS_Xor(x104, x106); const V x108 = DES_BS_And(x107, a3);
+	const V x109 = DES_BS_Xor(x104, x108); const V x110 = DES_BS_Xor(a1, x109); const V x111 = DES_BS_Xor(x28, x4);
+	const V x112 = DES_BS_And(x111, a5); const V x113 = DES_BS_Xor(x28, x112); const V x114 = DES_BS_Xor(x56, ONES);
+	const V x115 = DES_BS_Xor(x113, x114); const V x116 = DES_BS_And(x115, a3); const V x117 = DES_BS_Xor(x113, x116);
+	const V x118 = DES_BS_Xor(x19, ONES); const V x119 = DES_BS_Xor(a3, x118); const V x120 = DES_BS_Xor(x117, x119);
+	const V x121 = DES_BS_And(x120, a1); const V x122 = DES_BS_Xor(x117, x121); const V x123 = DES_BS_Xor(x110, x122);
+	const V x124 = DES_BS_And(x123, a6); const V x125 = DES_BS_Xor(x110, x124);
+	o1 = DES_BS_Xor(o1, x43);
+	o2 = DES_BS_Xor(o2, x74);
+	o3 = DES_BS_Xor(o3, x103);
+	o4 = DES_BS_Xor(o4, x125);
+}
+
+template <class V>
+inline void DES_BS_S8(const V &a1, const V &a2, const V &a3, const V &a4, const V &a5, const V &a6, V &o1, V &o2, V &o3, V &o4)
+{
+	const V ONES = DES_BS_Ones(a1);
+	const V x1 = DES_BS_Xor(a2, ONES); const V x2 = DES_BS_AndNot(x1, a4); const V x3 = DES_BS_Xor(x2, ONES);
+	const V x4 = DES_BS_Xor(x3, a4); const V x5 = DES_BS_And(x4, a3); const V x6 = DES_BS_Xor(x3, x5);
+	const V x7 = DES_BS_AndNot(a4, x1); const V x8 = DES_BS_Xor(a2, x7); const V x9 = DES_BS_And(x8, a3);
+	const V x10 = DES_BS_Xor(a2, x9); const V x11 = DES_BS_Xor(x6, x10); const V x12 = DES_BS_And(x11, a5);
+	const V x13 = DES_BS_Xor(x6, x12); const V x14 = DES_BS_Xor(x3, ONES); const V x15 = DES_BS_Xor(a3, x14);
+	const V x16 = DES_BS_Xor(a4, x1); const V x17 = DES_BS_Xor(x15, x16); const V x18 = DES_BS_And(x17, a5);
+	const V x19 = DES_BS_Xor(x15, x18); const V x20 = DES_BS_Xor(x13, x19); const V x21 = DES_BS_And(x20, a1);
+	const V x22 = DES_BS_Xor(x13, x21); const V x23 = DES_BS_Xor(x16, ONES); const V x24 = DES_BS_Xor(a3, x23);
+	const V x25 = DES_BS_Or(a4, x1); const V x26 = DES_BS_Xor(a3, x25); const V x27 = DES_BS_Xor(x24, x26);
+	const V x28 = DES_BS_And(x27, a5); const V x29 = DES_BS_Xor(x24, x28); const V x30 = DES_BS_Xor(x7, ONES);
+	const V x31 = DES_BS_And(a4, x1); const V x32 = DES_BS_Xor(x30, x31); const V x33 = DES_BS_And(x32, a3);
+	const V x34 = DES_BS_Xor(x30, x33); const V x35 = DES_BS_Xor(x26, ONES); const V x36 = DES_BS_Xor(x34, x35);
+	const V x37 = DES_BS_And(x36, a5); const V x38 = DES_BS_Xor(x34, x37); const V x39 = DES_BS_Xor(x29, x38);
+	const V x40 = DES_BS_And(x39, a1); const V x41 = DES_BS_Xor(x29, x40); const V x42 = DES_BS_Xor(x22, x41);
+	const V x43 = DES_BS_And(x42, a6); const V x44 = DES_BS_Xor(x22, x43); const V x45 = DES_BS_Xor(x34, ONES);
+	const V x46 = DES_BS_Xor(a4, x16); const V x47 = DES_BS_And(x46, a3); const V x48 = DES_BS_Xor(a4, x47);
+	const V x49 = DES_BS_Xor(x45, x48); const V x50 = DES_BS_And(x49, a5); const V x51 = DES_BS_Xor(x45, x50);
+	const V x52 = DES_BS_Xor(x10, ONES); const V x53 = DES_BS_Xor(a5, x52); const V x54 = DES_BS_Xor(x51, x53);
+	const V x55 = DES_BS_And(x54, a1); const V x56 = DES_BS_Xor(x51, x55); const V x57 = DES_BS_Xor(x51, ONES);
+	const V x58 = DES_BS_Xor(x24, x23); const V x59 = DES_BS_And(x58, a5); const V x60 = DES_BS_Xor(x24, x59);
+	const V x61 = DES_BS_Xor(x57, x60); const V x62 = DES_BS_And(x61, a1); const V x63 = DES_BS_Xor(x57, x62);
+	const V x64 = DES_BS_Xor(x56, x63); const V x65 = DES_BS_And(x64, a6); const V x66 = DES_BS_Xor(x56, x65);
+	const V x67 = DES_BS_Xor(a3, a2); const V x68 = DES_BS_Xor(x67, x16); const V x69 = DES_BS_And(x68, a5);
+	const V x70 = DES_BS_Xor(x67, x69); const V x71 = DES_BS_Xor(x24, ONES); const V x72 = DES_BS_Xor(x48, ONES);
+	const V x73 = DES_BS_Xor(x71, x72); const V x74 = DES_BS_And(x73, a5); const V x75 = DES_BS_Xor(x71, x74);
+	const V x76 = DES_BS_Xor(x70, x75); const V x77 = DES_BS_And(x76, a1); const V x78 = DES_BS_Xor(x70, x77);
+	const V x79 = DES_BS_Xor(x14, x1); const V x80 = DES_BS_And(x79, a3); const V x81 = DES_BS_Xor(x14, x80);
+	const V x82 = DES_BS_Xor(x31, ONES); const V x83 = DES_BS_Xor(x16, x82); const V x84 = DES_BS_And(x83, a3);
+	const V x85 = DES_BS_Xor(x16, x84); const V x86 = DES_BS_Xor(x81, x85); const V x87 = DES_BS_And(x86, a5);
+	const V x88 = DES_BS_Xor(x81, x87); const V x89 = DES_BS_Xor(x81, ONES); const V x90 = DES_BS_Xor(x31, x16);
+	const V x91 = DES_BS_And(x90, a3); const V x92 = DES_BS_Xor(x31, x91); const V x93 = DES_BS_Xor(x89, x92);
+	const V x94 = DES_BS_And(x93, a5); const V x95 = DES_BS_Xor(x89, x94); const V x96 = DES_BS_Xor(x88, x95);
+	const V x97 = DES_BS_And(x96, a1); const V x98 = DES_BS_Xor(x88, x97); const V x99 = DES_BS_Xor(x78, x98);
+	const V x100 = DES_BS_And(x99, a6); const V x101 = DES_BS_Xor(x78, x100); const V x102 = DES_BS_Xor(x41, ONES);
+	const V x103 = DES_BS_Xor(x1, a4); const V x104 = DES_BS_And(x103, a3); const V x105 = DES_BS_Xor(x1, x104);
+	const V x106 = DES_BS_Xor(x82, x7); const V x107 = DES_BS_And(x106, a3); const V x108 = DES_BS_Xor(x82, x107);
+	const V x109 = DES_BS_Xor(x105, x108); const V x110 = DES_BS_And(x109, a5); const V x111 = DES_BS_Xor(x105, x110);
+	const V x112 = DES_BS_Xor(x25, ONES); const V x113 = DES_BS_Xor(a2, x112); const V x114 = DES_BS_And(x113, a3);
+	const V x115 = DES_BS_Xor(a2, x114); const V x116 = DES_BS_Xor(x115, x52); const V x117 = DES_BS_And(x116, a5);
+	const V x118 = DES_BS_Xor(x115, x117); const V x119 = DES_BS_Xor(x111, x118); const V x120 = DES_BS_And(x119, a1);
+	const V x121 = DES_BS_Xor(x111, x120); const V x122 = DES_BS_Xor(x102, x121); const V x123 = DES_BS_And(x122, a6);
+	const V x124 = DES_BS_Xor(x102, x123);
+	o1 = DES_BS_Xor(o1, x44);
+	o2 = DES_BS_Xor(o2, x66);
+	o3 = DES_BS_Xor(o3, x101);
+	o4 = DES_BS_Xor(o4, x124);
+}
+
+template <class V, unsigned int S>
+inline void DES_BS_TransposeStage(V x[64], word64 mask)
+{
+	V m; DES_BS_Mask(m, mask);
+	for (unsigned int i=0; i<64; i+=2*S)
+	{
+		for (unsigned int j=i; j<i+S; ++j)
+		{
+			const V t = DES_BS_And(DES_BS_Xor(DES_BS_ShiftRight<S>(x[j]), x[j+S]), m);
+			x[j+S] = DES_BS_Xor(x[j+S], t);
+			x[j] = DES_BS_Xor(x[j], DES_BS_ShiftLeft<S>(t));
+		}
+	}
+}
+
+// Transposes the 64x64 bit matrix in each 64-bit lane. It is its own inverse.
+template <class V>
+inline void DES_BS_Transpose(V x[64])
+{
+	DES_BS_TransposeStage<V, 32>(x, W64LIT(0x00000000FFFFFFFF));
+	DES_BS_TransposeStage<V, 16>(x, W64LIT(0x0000FFFF0000FFFF));
+	DES_BS_TransposeStage<V,  8>(x, W64LIT(0x00FF00FF00FF00FF));
+	DES_BS_TransposeStage<V,  4>(x, W64LIT(0x0F0F0F0F0F0F0F0F));
+	DES_BS_TransposeStage<V,  2>(x, W64LIT(0x3333333333333333));
+	DES_BS_TransposeStage<V,  1>(x, W64LIT(0x5555555555555555));
+}
+
+// One Feistel round, l ^= f(r, k). Key bits are all-zero or all-one masks.
+template <class V>
+inline void DES_BS_Round(V *l, const V *r, const word32 *k)
+{
+#define DES_BS_SBOX(n) DES_BS_S##n( \
+	DES_BS_Xor(r[s_bsExpand[6*n-6]], DES_BS_Broadcast(k[6*n-6], r[0])), \
+	DES_BS_Xor(r[s_bsExpand[6*n-5]], DES_BS_Broadcast(k[6*n-5], r[0])), \
+	DES_BS_Xor(r[s_bsExpand[6*n-4]], DES_BS_Broadcast(k[6*n-4], r[0])), \
+	DES_BS_Xor(r[s_bsExpand[6*n-3]], DES_BS_Broadcast(k[6*n-3], r[0])), \
+	DES_BS_Xor(r[s_bsExpand[6*n-2]], DES_BS_Broadcast(k[6*n-2], r[0])), \
+	DES_BS_Xor(r[s_bsExpand[6*n-1]], DES_BS_Broadcast(k[6*n-1], r[0])), \
+	l[s_bsPerm[4*n-4]], l[s_bsPerm[4*n-3]], l[s_bsPerm[4*n-2]], l[s_bsPerm[4*n-1]])
+
+	DES_BS_SBOX(1); DES_BS_SBOX(2); DES_BS_SBOX(3); DES_BS_SBOX(4);
+	DES_BS_SBOX(5); DES_BS_SBOX(6); DES_BS_SBOX(7); DES_BS_SBOX(8);
+#undef DES_BS_SBOX
+}
+
+// Applies 'passes' back to back DES operations. FP and IP cancel between passes.
+template <class V>
+void DES_BS_Process(V x[64], const word32 *subkeys, unsigned int passes)
+{
+	V state[64];
+	for (unsigned int i=0; i<64; ++i)
+		state[i] = x[s_bsInitial[i]];
+
+	V *l = state, *r = state+32;
+	for (unsigned int p=0; p<passes; ++p)
+	{
+		for (unsigned int i=0; i<16; ++i, subkeys+=48)
+		{
+			DES_BS_Round(l, r, subkeys);
+			std::swap(l, r);
+		}
+		std::swap(l, r);
+	}
+
+	for (unsigned int q=0; q<64; ++q)
+		x[q] = s_bsFinal[q] < 32 ? l[s_bsFinal[q]] : r[s_bsFinal[q]-32];
+}
+
+template <class V>
+size_t DES_BS_AdvancedProcessBlocks(const word32 *subkeys, unsigned int passes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+	const size_t blockSize = 8, lanes = sizeof(V)/8, batchSize = 64*lanes*blockSize;
+	CRYPTOPP_ASSERT(!(flags & BlockTransformation::BT_DontIncrementInOutPointers));
+
+	const size_t batches = length / batchSize;
+	const size_t remaining = length - batches*batchSize;
+	const bool reverse = !!(flags & BlockTransformation::BT_ReverseDirection);
+	const bool counter = !!(flags & BlockTransformation::BT_InBlockIsCounter);
+
+	// The counter is big-endian, and wraps within its width without carrying into the rest of the block
+	const word64 counterMask = (flags & BlockTransformation::BT_Counter64) ? W64LIT(0xffffffffffffffff) :
+		(flags & BlockTransformation::BT_Counter32) ? W64LIT(0xffffffff) : W64LIT(0xff);
+
+	CRYPTOPP_ALIGN_DATA(32) word64 buffer[64*lanes];
+	V x[64];
+
+	for (size_t b=0; b<batches; ++b)
+	{
+		// Reverse direction works from the tail towards the head
+		const size_t offset = reverse ? remaining + (batches-1-b)*batchSize : b*batchSize;
+		const byte *in = counter ? inBlocks : inBlocks+offset;
+		const byte *xb = xorBlocks ? xorBlocks+offset : NULLPTR;
+		byte *out = outBlocks+offset;
+		const word64 base = counter ? GetWord<word64>(false, BIG_ENDIAN_ORDER, in) : 0;
+
+		// Block i of the batch is lane i/64 of vector i%64
+		for (size_t i=0; i<64*lanes; ++i)
+		{
+			word64 &w = buffer[(i%64)*lanes + i/64];
+			if (counter)
+				PutWord(true, BIG_ENDIAN_ORDER, (byte *)&w, (base & ~counterMask) | ((base + i) & counterMask));
+			else
+				memcpy(&w, in+i*blockSize, blockSize);
+			if (flags & BlockTransformation::BT_XorInput)
+				w ^= GetWord<word64>(false, LITTLE_ENDIAN_ORDER, xb+i*blockSize);
+		}
+
+		for (unsigned int i=0; i<64; ++i)
+			x[i] = *(const V *)(const void *)(buffer+i*lanes);
+		DES_BS_Transpose(x);
+		DES_BS_Process(x, subkeys, passes);
+		DES_BS_Transpose(x);
+		for (unsigned int i=0; i<64; ++i)
+			*(V *)(void *)(buffer+i*lanes) = x[i];
+
+		// Load every xor block before storing, since CBC decryption may run in place
+		if (xb && !(flags & BlockTransformation::BT_XorInput))
+		{
+			for (size_t i=0; i<64*lanes; ++i)
+				buffer[(i%64)*lanes + i/64] ^= GetWord<word64>(false, LITTLE_ENDIAN_ORDER, xb+i*blockSize);
+		}
+		for (size_t i=0; i<64*lanes; ++i)
+			memcpy(out+i*blockSize, buffer+(i%64)*lanes + i/64, blockSize);
+
+		if (counter)
+			PutWord(false, BIG_ENDIAN_ORDER, const_cast<byte *>(inBlocks), (base & ~counterMask) | ((base + 64*lanes) & counterMask));
+	}
+
+	SecureWipeArray(buffer, COUNTOF(buffer));
+	SecureWipeArray(x, COUNTOF(x));
+	return batches*batchSize;
+}
+
+// Returns the number of bytes processed, which is a multiple of the batch size
+static size_t DES_BS_ProcessBatches(const word32 *subkeys, unsigned int passes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+	const word32 parallelFlags = BlockTransformation::BT_AllowParallel|BlockTransformation::BT_DontIncrementInOutPointers;
+	if ((flags & parallelFlags) != BlockTransformation::BT_AllowParallel)
+		return 0;
+
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+	if (length >= 256*8 && HasAVX2())
+		return DES_BS_AdvancedProcessBlocks<__m256i>(subkeys, passes, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
+	if (length >= 128*8 && HasSSE2())
+		return DES_BS_AdvancedProcessBlocks<__m128i>(subkeys, passes, inBlocks, xorBlocks, outBlocks, length, flags);
+	return 0;
+}
+
+#endif  // CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+
+#if CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+static void DES_BS_SetKey(SecBlock<word32> &masks, const RawDES &des1, const RawDES &des2, const RawDES &des3)
+{
+	masks.New(3*16*48);
+	des1.GetBitslicedKey(masks);
+	des2.GetBitslicedKey(masks+16*48);
+	des3.GetBitslicedKey(masks+2*16*48);
+}
+#endif
+
 void DES_EDE2::Base::UncheckedSetKey(const byte *userKey, unsigned int length, const NameValuePairs &)
 {
 	AssertValidKeyLength(length);
 
 	m_des1.RawSetKey(GetCipherDirection(), userKey);
 	m_des2.RawSetKey(ReverseCipherDir(GetCipherDirection()), userKey+8);
+
+#if CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+	if (HasSSE2())
+		DES_BS_SetKey(m_bsKey, m_des1, m_des2, m_des1);
+#endif
 }
 
 void DES_EDE2::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
@@ -393,6 +1084,11 @@ void DES_EDE3::Base::UncheckedSetKey(const byte *userKey, unsigned int length, c
 	m_des1.RawSetKey(GetCipherDirection(), userKey + (IsForwardTransformation() ? 0 : 16));
 	m_des2.RawSetKey(ReverseCipherDir(GetCipherDirection()), userKey + 8);
 	m_des3.RawSetKey(GetCipherDirection(), userKey + (IsForwardTransformation() ? 16 : 0));
+
+#if CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+	if (HasSSE2())
+		DES_BS_SetKey(m_bsKey, m_des1, m_des2, m_des3);
+#endif
 }
 
 void DES_EDE3::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
@@ -407,6 +1103,39 @@ void DES_EDE3::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBloc
 	Block::Put(xorBlock, outBlock)(r)(l);
 }
 
+#if CRYPTOPP_ENABLE_DES_SSE2_INTRINSICS
+// Processes whole batches with the bitsliced code and advances the arguments past them
+static void DES_BS_AdvanceBatches(const word32 *subkeys, const byte *&inBlocks, const byte *&xorBlocks, byte *&outBlocks, size_t &length, word32 flags)
+{
+	const size_t processed = DES_BS_ProcessBatches(subkeys, 3, inBlocks, xorBlocks, outBlocks, length, flags);
+	length -= processed;
+
+	// Reverse direction processed the tail, so the remainder is still at the head
+	if (processed && !(flags & BlockTransformation::BT_ReverseDirection))
+	{
+		if (!(flags & BlockTransformation::BT_InBlockIsCounter))
+			inBlocks += processed;
+		if (xorBlocks)
+			xorBlocks += processed;
+		outBlocks += processed;
+	}
+}
+
+size_t DES_EDE2::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (m_bsKey.size())
+		DES_BS_AdvanceBatches(m_bsKey, inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t DES_EDE3::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (m_bsKey.size())
+		DES_BS_AdvanceBatches(m_bsKey, inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif
+
 #endif	// #ifndef CRYPTOPP_IMPORTS
 
 static inline bool CheckParity(byte b)
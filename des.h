@@ -19,6 +19,11 @@ public:
 	void RawSetKey(CipherDir direction, const byte *userKey);
 	void RawProcessBlock(word32 &l, word32 &r) const;
 
+	//! \brief Exports the key schedule for bitsliced processing
+	//! \param masks an array of 16*48 words
+	//! \details Each subkey bit is written in round order as a mask of all zeros or all ones.
+	void GetBitslicedKey(word32 *masks) const;
+
 protected:
 	static const word32 Spbox[8][64];
 
@@ -70,6 +75,8 @@ struct DES_EDE2_Info : public FixedBlockSize<8>, public FixedKeyLength<16>
 
 //! \class DES_EDE2
 //! \brief 2-key TripleDES block cipher
+//! \details On x86 processors with SSE2 or AVX2, AdvancedProcessBlocks() encrypts
+//!   parallel modes in bitsliced batches of 128 or 256 blocks.
 //! \sa <a href="http://www.weidai.com/scan-mirror/cs.html#DESede">DES-EDE2</a>
 //! \since Crypto++ 1.0
 class DES_EDE2 : public DES_EDE2_Info, public BlockCipherDocumentation
@@ -81,9 +88,17 @@ class DES_EDE2 : public DES_EDE2_Info, public BlockCipherDocumentation
 	public:
 		void UncheckedSetKey(const byte *userKey, unsigned int length, const NameValuePairs &params);
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 
 	protected:
 		RawDES m_des1, m_des2;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		// Subkey masks for the bitsliced batch code path
+		SecBlock<word32> m_bsKey;
+#endif
 	};
 
 public:
@@ -100,6 +115,8 @@ struct DES_EDE3_Info : public FixedBlockSize<8>, public FixedKeyLength<24>
 
 //! \class DES_EDE3
 //! \brief 3-key TripleDES block cipher
+//! \details On x86 processors with SSE2 or AVX2, AdvancedProcessBlocks() encrypts
+//!   parallel modes in bitsliced batches of 128 or 256 blocks.
 //! \sa <a href="http://www.weidai.com/scan-mirror/cs.html#DESede">DES-EDE3</a>
 //! \since Crypto++ 1.0
 class DES_EDE3 : public DES_EDE3_Info, public BlockCipherDocumentation
@@ -111,9 +128,17 @@ class DES_EDE3 : public DES_EDE3_Info, public BlockCipherDocumentation
 	public:
 		void UncheckedSetKey(const byte *userKey, unsigned int length, const NameValuePairs &params);
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 
 	protected:
 		RawDES m_des1, m_des2, m_des3;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		// Subkey masks for the bitsliced batch code path
+		SecBlock<word32> m_bsKey;
+#endif
 	};
 
 public:
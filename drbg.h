@@ -13,6 +13,7 @@
 #include "secblock.h"
 #include "hmac.h"
 #include "sha.h"
+#include "aes.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -374,6 +375,136 @@ private:
 
 // *************************************************************
 
+//! \class CTR_DRBG
+//! \tparam BLOCK_CIPHER NIST approved block cipher with a 128-bit block
+//! \tparam STRENGTH security strength, in bytes, which is also the key length
+//! \tparam SEEDLENGTH seed length, in bytes, which is the key length plus the block size
+//! \brief CTR_DRBG from SP 800-90A Rev 1 (June 2015)
+//! \details The NIST CTR DRBG is instantiated with a number of parameters. Two of the parameters,
+//!   Security Strength and Seed Length, depend on the block cipher and are specified as template
+//!   parameters. The remaining parameters are included in the class. The parameters and their values
+//!   are listed in NIST SP 800-90A Rev. 1, Table 3: Definitions for the CTR_DRBG (p.49).
+//! \details CTR_DRBG uses the derivation function, so the entropy input does not need to be full
+//!   entropy, and the counter field is the whole block. The output blocks are the encrypted
+//!   counter, and they are produced by the cipher's AdvancedProcessBlocks(). AES runs several
+//!   counter blocks at a time through AES-NI when it is available.
+//! \details Some parameters have been reduce to fit C++ datatypes. For example, NIST allows upto 2<sup>48</sup> requests
+//!   before a reseed. However, CTR_DRBG limits it to <tt>INT_MAX</tt> due to the limited data range of an int.
+//! \sa <A HREF="http://nvlpubs.nist.gov/nistpubs/SpecialPublications/NIST.SP.800-90Ar1.pdf">Recommendation
+//!   for Random Number Generation Using Deterministic Random Bit Generators, Rev 1 (June 2015)</A>
+//! \since Crypto++ 6.0
+template <typename BLOCK_CIPHER=AES, unsigned int STRENGTH=256/8, unsigned int SEEDLENGTH=384/8>
+class CTR_DRBG : public NIST_DRBG, public NotCopyable
+{
+    CRYPTOPP_COMPILE_ASSERT(BLOCK_CIPHER::BLOCKSIZE == 16);
+    CRYPTOPP_COMPILE_ASSERT(SEEDLENGTH == STRENGTH + BLOCK_CIPHER::BLOCKSIZE);
+
+public:
+    CRYPTOPP_CONSTANT(SECURITY_STRENGTH=STRENGTH)
+    CRYPTOPP_CONSTANT(SEED_LENGTH=SEEDLENGTH)
+    CRYPTOPP_CONSTANT(MINIMUM_ENTROPY=STRENGTH)
+    CRYPTOPP_CONSTANT(MINIMUM_NONCE=STRENGTH/2)
+    CRYPTOPP_CONSTANT(MINIMUM_ADDITIONAL=0)
+    CRYPTOPP_CONSTANT(MINIMUM_PERSONALIZATION=0)
+    CRYPTOPP_CONSTANT(MAXIMUM_ENTROPY=INT_MAX)
+    CRYPTOPP_CONSTANT(MAXIMUM_NONCE=INT_MAX)
+    CRYPTOPP_CONSTANT(MAXIMUM_ADDITIONAL=INT_MAX)
+    CRYPTOPP_CONSTANT(MAXIMUM_PERSONALIZATION=INT_MAX)
+    CRYPTOPP_CONSTANT(MAXIMUM_BYTES_PER_REQUEST=65536)
+    CRYPTOPP_CONSTANT(MAXIMUM_REQUESTS_BEFORE_RESEED=INT_MAX)
+
+    static std::string StaticAlgorithmName() { return std::string("CTR_DRBG(") + BLOCK_CIPHER::StaticAlgorithmName() + std::string(")"); }
+
+    //! \brief Construct a CTR DRBG
+    //! \param entropy the entropy to instantiate the generator
+    //! \param entropyLength the size of the entropy buffer
+    //! \param nonce additional input to instantiate the generator
+    //! \param nonceLength the size of the nonce buffer
+    //! \param personalization additional input to instantiate the generator
+    //! \param personalizationLength the size of the personalization buffer
+    //! \throws NIST_DRBG::Err if the generator is instantiated with insufficient entropy
+    //! \details All NIST DRBGs must be instaniated with at least <tt>MINIMUM_ENTROPY</tt> bytes of entropy.
+    //!   The byte array for <tt>entropy</tt> must meet <A HREF ="http://csrc.nist.gov/publications/PubsSPs.html">NIST
+    //!   SP 800-90B or SP 800-90C</A> requirements.
+    //! \details The <tt>nonce</tt> and <tt>personalization</tt> are optional byte arrays. If <tt>nonce</tt> is supplied,
+    //!   then it should be at least <tt>MINIMUM_NONCE</tt> bytes of entropy.
+    //! \details An example of instantiating an AES-256 generator is shown below.
+    //! <pre>
+    //!    SecByteBlock entropy(48), result(128);
+    //!    NonblockingRng prng;
+    //!    RandomNumberSource rns(prng, entropy.size(), new ArraySink(entropy, entropy.size()));
+    //!
+    //!    CTR_DRBG<AES, 256/8, 384/8> drbg(entropy, 32, entropy+32, 16);
+    //!    drbg.GenerateBlock(result, result.size());
+    //! </pre>
+    CTR_DRBG(const byte* entropy=NULLPTR, size_t entropyLength=STRENGTH, const byte* nonce=NULLPTR,
+        size_t nonceLength=0, const byte* personalization=NULLPTR, size_t personalizationLength=0)
+        : NIST_DRBG(), m_reseed(0)
+    {
+        // The cipher is keyed even without entropy so IncorporateEntropy() works on a default
+        //   constructed object, like Hash_DRBG and HMAC_DRBG
+        if (entropy != NULLPTR && entropyLength != 0)
+            DRBG_Instantiate(entropy, entropyLength, nonce, nonceLength, personalization, personalizationLength);
+        else
+            CTR_Reset();
+    }
+
+    unsigned int GetSecurityStrength() const {return SECURITY_STRENGTH;}
+    unsigned int GetSeedLength() const {return SEED_LENGTH;}
+    unsigned int GetMinEntropy() const {return MINIMUM_ENTROPY;}
+    unsigned int GetMaxEntropy() const {return MAXIMUM_ENTROPY;}
+    unsigned int GetMinNonce() const {return MINIMUM_NONCE;}
+    unsigned int GetMaxNonce() const {return MAXIMUM_NONCE;}
+    unsigned int GetMaxBytesPerRequest() const {return MAXIMUM_BYTES_PER_REQUEST;}
+    unsigned int GetMaxRequestBeforeReseed() const {return MAXIMUM_REQUESTS_BEFORE_RESEED;}
+
+    void IncorporateEntropy(const byte *input, size_t length)
+        {return DRBG_Reseed(input, length, NULLPTR, 0);}
+
+    void IncorporateEntropy(const byte *entropy, size_t entropyLength, const byte* additional, size_t additionaLength)
+        {return DRBG_Reseed(entropy, entropyLength, additional, additionaLength);}
+
+    void GenerateBlock(byte *output, size_t size)
+        {return CTR_Generate(NULLPTR, 0, output, size);}
+
+    void GenerateBlock(const byte* additional, size_t additionaLength, byte *output, size_t size)
+        {return CTR_Generate(additional, additionaLength, output, size);}
+
+protected:
+    // 10.2.1.3.2 Instantiation When a Derivation Function is Used (p.52)
+    void DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
+        const byte* personalization, size_t personalizationLength);
+
+    // 10.2.1.4.2 Reseeding When a Derivation Function is Used (p.54)
+    void DRBG_Reseed(const byte* entropy, size_t entropyLength, const byte* additional, size_t additionaLength);
+
+    // 10.2.1.5.2 Generating Pseudorandom Bits When a Derivation Function is Used (p.56)
+    void CTR_Generate(const byte* additional, size_t additionaLength, byte *output, size_t size);
+
+    // 10.2.1.2 The Update Function (CTR_DRBG_Update) (p.51)
+    void CTR_Update(const byte* provided);
+
+    // Sets Key and V to zero, which is the starting state in Instantiate
+    void CTR_Reset();
+
+    // Increments V and encrypts it, once per block, which leaves V at the last counter used
+    void CTR_Keystream(byte* output, size_t blocks);
+
+    // 10.3.2 Derivation Function Using a Block Cipher Algorithm (Block_Cipher_df) (p.50)
+    void Block_Cipher_df(const byte* input1, size_t inlen1, const byte* input2, size_t inlen2,
+        const byte* input3, size_t inlen3, byte* output);
+
+    typename BLOCK_CIPHER::Encryption m_cipher;
+    FixedSizeAlignedSecBlock<byte, 16> m_v;
+    word64 m_reseed;
+};
+
+// typedef CTR_DRBG<AES, 128/8, 256/8> CTR_AES128_DRBG;
+// typedef CTR_DRBG<AES, 192/8, 320/8> CTR_AES192_DRBG;
+// typedef CTR_DRBG<AES, 256/8, 384/8> CTR_AES256_DRBG;
+
+// *************************************************************
+
 // 10.1.1.2 Instantiation of Hash_DRBG (p.39)
 template <typename HASH, unsigned int STRENGTH, unsigned int SEEDLENGTH>
 void Hash_DRBG<HASH, STRENGTH, SEEDLENGTH>::DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
@@ -450,7 +581,7 @@ void Hash_DRBG<HASH, STRENGTH, SEEDLENGTH>::Hash_Generate(const byte* additional
     {
         HASH hash;
         const byte two = 2;
-        SecByteBlock w(HASH::DIGESTSIZE);
+        FixedSizeSecBlock<byte, HASH::DIGESTSIZE> w;
 
         hash.Update(&two, 1);
         hash.Update(m_v, m_v.size());
@@ -473,18 +604,20 @@ void Hash_DRBG<HASH, STRENGTH, SEEDLENGTH>::Hash_Generate(const byte* additional
         }
     }
 
-    // Step 3
+    // Step 3. The whole of data fits in one hash block for the approved seed lengths, so each
+    //   output block costs one compression, and the digest is written straight to the output.
     {
         HASH hash;
-        SecByteBlock data(m_v);
+        FixedSizeSecBlock<byte, SEEDLENGTH> data;
+        std::memcpy(data, m_v, SEEDLENGTH);
 
         while (size)
         {
-            hash.Update(data, data.size());
+            hash.Update(data, SEEDLENGTH);
             size_t count = STDMIN(size, (size_t)HASH::DIGESTSIZE);
             hash.TruncatedFinal(output, count);
 
-            IncrementCounterByOne(data, static_cast<unsigned int>(data.size()));
+            IncrementCounterByOne(data, SEEDLENGTH);
             size -= count; output += count;
         }
     }
@@ -493,7 +626,7 @@ void Hash_DRBG<HASH, STRENGTH, SEEDLENGTH>::Hash_Generate(const byte* additional
     {
         HASH hash;
         const byte three = 3;
-        SecByteBlock h(HASH::DIGESTSIZE);
+        FixedSizeSecBlock<byte, HASH::DIGESTSIZE> h;
 
         hash.Update(&three, 1);
         hash.Update(m_v, m_v.size());
@@ -672,19 +805,37 @@ void HMAC_DRBG<HASH, STRENGTH, SEEDLENGTH>::HMAC_Generate(const byte* additional
     if (additional && additionaLength)
         HMAC_Update(additional, additionaLength, NULLPTR, 0, NULLPTR, 0);
 
-    // Step 3
-    HMAC<HASH> hmac;
-    hmac.SetKey(m_k, m_k.size());
-
-    while (size)
+    // Step 3. K does not change during the request, so the states after the inner and outer
+    //   padded keys are hashed once and copied for each block. HMAC<HASH> would hash both
+    //   padded keys again for every block, which is twice the compressions.
     {
-        hmac.Update(m_v, m_v.size());
-        hmac.TruncatedFinal(m_v, m_v.size());
+        HASH inner, outer, hash;
+        FixedSizeSecBlock<byte, HASH::BLOCKSIZE> pad;
+
+        CRYPTOPP_ASSERT(HASH::DIGESTSIZE <= HASH::BLOCKSIZE);
+        std::memset(pad, 0x36, HASH::BLOCKSIZE);
+        xorbuf(pad, m_k, HASH::DIGESTSIZE);
+        inner.Update(pad, HASH::BLOCKSIZE);
+
+        std::memset(pad, 0x5c, HASH::BLOCKSIZE);
+        xorbuf(pad, m_k, HASH::DIGESTSIZE);
+        outer.Update(pad, HASH::BLOCKSIZE);
+
+        while (size)
+        {
+            hash = inner;
+            hash.Update(m_v, HASH::DIGESTSIZE);
+            hash.Final(m_v);
 
-        size_t count = STDMIN(size, (size_t)HASH::DIGESTSIZE);
-        memcpy(output, m_v, count);
+            hash = outer;
+            hash.Update(m_v, HASH::DIGESTSIZE);
+            hash.Final(m_v);
 
-        size -= count; output += count;
+            size_t count = STDMIN(size, (size_t)HASH::DIGESTSIZE);
+            memcpy(output, m_v, count);
+
+            size -= count; output += count;
+        }
     }
 
     HMAC_Update(additional, additionaLength, NULLPTR, 0, NULLPTR, 0);
@@ -743,6 +894,205 @@ void HMAC_DRBG<HASH, STRENGTH, SEEDLENGTH>::HMAC_Update(const byte* input1, size
     hmac.TruncatedFinal(m_v, m_v.size());
 }
 
+// *************************************************************
+
+// 10.2.1.3.2 Instantiation When a Derivation Function is Used (p.52)
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
+    const byte* personalization, size_t personalizationLength)
+{
+    //  SP 800-90A, 8.6.3: The entropy input shall have entropy that is equal to or greater than the security
+    //  strength of the instantiation. Additional entropy may be provided in the nonce or the optional
+    //  personalization string during instantiation, or in the additional input during reseeding and generation,
+    //  but this is not required and does not increase the "official" security strength of the DRBG
+    //  instantiation that is recorded in the internal state.
+    CRYPTOPP_ASSERT(entropyLength >= MINIMUM_ENTROPY);
+    if (entropyLength < MINIMUM_ENTROPY)
+        throw NIST_DRBG::Err("CTR_DRBG", "Insufficient entropy during instantiate");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(entropyLength <= MAXIMUM_ENTROPY);
+    CRYPTOPP_ASSERT(nonceLength <= MAXIMUM_NONCE);
+    CRYPTOPP_ASSERT(personalizationLength <= MAXIMUM_PERSONALIZATION);
+
+    FixedSizeSecBlock<byte, SEEDLENGTH> seed;
+    Block_Cipher_df(entropy, entropyLength, nonce, nonceLength, personalization, personalizationLength, seed);
+
+    CTR_Reset();
+    CTR_Update(seed);
+    m_reseed = 1;
+}
+
+// 10.2.1.4.2 Reseeding When a Derivation Function is Used (p.54)
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::DRBG_Reseed(const byte* entropy, size_t entropyLength, const byte* additional, size_t additionaLength)
+{
+    //  SP 800-90A, 8.6.3: The entropy input shall have entropy that is equal to or greater than the security
+    //  strength of the instantiation. Additional entropy may be provided in the nonce or the optional
+    //  personalization string during instantiation, or in the additional input during reseeding and generation,
+    //  but this is not required and does not increase the "official" security strength of the DRBG
+    //  instantiation that is recorded in the internal state..
+    CRYPTOPP_ASSERT(entropyLength >= MINIMUM_ENTROPY);
+    if (entropyLength < MINIMUM_ENTROPY)
+        throw NIST_DRBG::Err("CTR_DRBG", "Insufficient entropy during reseed");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(entropyLength <= MAXIMUM_ENTROPY);
+    CRYPTOPP_ASSERT(additionaLength <= MAXIMUM_ADDITIONAL);
+
+    FixedSizeSecBlock<byte, SEEDLENGTH> seed;
+    Block_Cipher_df(entropy, entropyLength, additional, additionaLength, NULLPTR, 0, seed);
+
+    CTR_Update(seed);
+    m_reseed = 1;
+}
+
+// 10.2.1.5.2 Generating Pseudorandom Bits When a Derivation Function is Used (p.56)
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::CTR_Generate(const byte* additional, size_t additionaLength, byte *output, size_t size)
+{
+    // Step 1
+    if (static_cast<word64>(m_reseed) >= static_cast<word64>(GetMaxRequestBeforeReseed()))
+        throw NIST_DRBG::Err("CTR_DRBG", "Reseed required");
+
+    if (size > GetMaxBytesPerRequest())
+        throw NIST_DRBG::Err("CTR_DRBG", "Request size exceeds limit");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(additionaLength <= MAXIMUM_ADDITIONAL);
+
+    // Step 2
+    FixedSizeSecBlock<byte, SEEDLENGTH> provided;
+    if (additional && additionaLength)
+    {
+        Block_Cipher_df(additional, additionaLength, NULLPTR, 0, NULLPTR, 0, provided);
+        CTR_Update(provided);
+    }
+    else
+    {
+        std::memset(provided, 0, SEEDLENGTH);
+    }
+
+    // Steps 3-5
+    const size_t blocks = size/16, tail = size%16;
+    CTR_Keystream(output, blocks);
+    if (tail)
+    {
+        FixedSizeSecBlock<byte, 16> last;
+        CTR_Keystream(last, 1);
+        std::memcpy(output+blocks*16, last, tail);
+    }
+
+    // Steps 6-7
+    CTR_Update(provided);
+    m_reseed++;
+}
+
+// 10.2.1.2 The Update Function (CTR_DRBG_Update) (p.51)
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::CTR_Update(const byte* provided)
+{
+    // The seed length is not a multiple of the block size for AES-192
+    FixedSizeSecBlock<byte, (SEEDLENGTH+15)/16*16> temp;
+    CTR_Keystream(temp, temp.size()/16);
+    xorbuf(temp, provided, SEEDLENGTH);
+
+    m_cipher.SetKey(temp, STRENGTH);
+    std::memcpy(m_v, temp+STRENGTH, 16);
+}
+
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::CTR_Reset()
+{
+    FixedSizeSecBlock<byte, STRENGTH> key;
+    std::memset(key, 0, STRENGTH);
+    m_cipher.SetKey(key, STRENGTH);
+    std::memset(m_v, 0, m_v.size());
+}
+
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::CTR_Keystream(byte* output, size_t blocks)
+{
+    if (!blocks)
+        return;
+
+    // The cipher increments the low 64 bits of the counter, so a run stops where they wrap.
+    //   The counter goes in as V+1 and comes out one past the last block.
+    IncrementCounterByOne(m_v, 16);
+    const word32 flags = BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_Counter64|BlockTransformation::BT_AllowParallel;
+    while (blocks)
+    {
+        const word64 last = ~GetWord<word64>(false, BIG_ENDIAN_ORDER, m_v+8);
+        const size_t count = (blocks-1 > last) ? size_t(last+1) : blocks;
+
+        m_cipher.ProcessCounterBlocks(m_v, NULLPTR, output, count*16, flags);
+        if (count-1 == last)
+            IncrementCounterByOne(m_v, 8);
+
+        output += count*16; blocks -= count;
+    }
+
+    // V is the last counter that was encrypted
+    for (int i=15; i>=0 && m_v[i]-- == 0; --i) {}
+}
+
+// 10.3.2 Derivation Function Using a Block Cipher Algorithm (Block_Cipher_df) (p.50)
+template <typename BLOCK_CIPHER, unsigned int STRENGTH, unsigned int SEEDLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, STRENGTH, SEEDLENGTH>::Block_Cipher_df(const byte* input1, size_t inlen1, const byte* input2, size_t inlen2,
+    const byte* input3, size_t inlen3, byte* output)
+{
+    // Steps 1-4. S is L || N || input_string || 0x80, padded with zeros. A block is left in
+    //   front of S for the IV of the BCC chains in step 9.
+    const size_t inlen = (input1 ? inlen1 : 0) + (input2 ? inlen2 : 0) + (input3 ? inlen3 : 0);
+    SecByteBlock s(RoundUpToMultipleOf(16 + 8 + inlen + 1, size_t(16)));
+    std::memset(s, 0, s.size());
+
+    PutWord(false, BIG_ENDIAN_ORDER, s+16, static_cast<word32>(inlen));
+    PutWord(false, BIG_ENDIAN_ORDER, s+20, static_cast<word32>(SEEDLENGTH));
+
+    byte* p = s+24;
+    if (input1 && inlen1)
+        {std::memcpy(p, input1, inlen1); p += inlen1;}
+    if (input2 && inlen2)
+        {std::memcpy(p, input2, inlen2); p += inlen2;}
+    if (input3 && inlen3)
+        {std::memcpy(p, input3, inlen3); p += inlen3;}
+    *p = 0x80;
+
+    // Steps 5-10. The chains use the fixed key 00 01 02 ..., and chain i has i in the IV.
+    FixedSizeSecBlock<byte, (SEEDLENGTH+15)/16*16> temp;
+    FixedSizeSecBlock<byte, STRENGTH> key;
+    for (unsigned int i=0; i<STRENGTH; ++i)
+        key[i] = static_cast<byte>(i);
+
+    typename BLOCK_CIPHER::Encryption cipher(key, STRENGTH);
+    for (size_t i=0; i<temp.size(); i+=16)
+    {
+        PutWord(false, BIG_ENDIAN_ORDER, s.begin(), static_cast<word32>(i/16));
+
+        // BCC
+        byte* chain = temp+i;
+        std::memset(chain, 0, 16);
+        for (size_t j=0; j<s.size(); j+=16)
+        {
+            xorbuf(chain, s+j, 16);
+            cipher.ProcessBlock(chain);
+        }
+    }
+
+    // Steps 11-16
+    cipher.SetKey(temp, STRENGTH);
+    byte* x = temp+STRENGTH;
+    for (size_t i=0; i<SEEDLENGTH; i+=16)
+    {
+        cipher.ProcessBlock(x);
+        std::memcpy(output+i, x, STDMIN(size_t(16), SEEDLENGTH-i));
+    }
+}
+
 NAMESPACE_END
 
 #endif  // CRYPTOPP_NIST_DRBG_H
@@ -2,28 +2,70 @@
 
 #include "pch.h"
 #include "eax.h"
+#include "rijndael.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
 void EAX_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
 {
-	AccessMAC().SetKey(userKey, keylength, params);
-	m_buffer.New(2*AccessMAC().TagSize());
+	CMAC_Base &mac = AccessMAC();
+	mac.SetKey(userKey, keylength, params);
+
+	const unsigned int blockSize = mac.TagSize();
+	m_buffer.New(6*blockSize);
+
+	// The OMACs of the nonce, header and message each start with a block that holds only
+	//   the tweak, so their first steps are the same for every message under a key
+	byte *tweaks = m_buffer+3*blockSize;
+	memset(tweaks, 0, 3*blockSize);
+	tweaks[2*blockSize-1] = 1;
+	tweaks[3*blockSize-1] = 2;
+	mac.AccessCipher().AdvancedProcessBlocks(tweaks, NULLPTR, tweaks, 3*blockSize, BlockTransformation::BT_AllowParallel);
+}
+
+void EAX_Base::StartMAC(unsigned int tweak)
+{
+	CMAC_Base &mac = AccessMAC();
+	const unsigned int blockSize = mac.TagSize();
+
+	memcpy(mac.m_reg, m_buffer+(3+tweak)*blockSize, blockSize);
+	mac.m_counter = 0;
+}
+
+void EAX_Base::PrepareLastMACBlock(byte *block, unsigned int tweak)
+{
+	CMAC_Base &mac = AccessMAC();
+	const unsigned int blockSize = mac.TagSize();
+
+	// This is CMAC_Base::TruncatedFinal() without the last encryption. When nothing
+	//   followed the tweak block, the tweak block is the last block.
+	if (mac.m_counter == 0)
+	{
+		memset(block, 0, blockSize);
+		block[blockSize-1] = byte(tweak);
+		xorbuf(block, mac.m_reg+blockSize, blockSize);
+	}
+	else if (mac.m_counter < blockSize)
+	{
+		xorbuf(block, mac.m_reg, mac.m_reg+2*blockSize, blockSize);
+		block[mac.m_counter] ^= 0x80;
+	}
+	else
+		xorbuf(block, mac.m_reg, mac.m_reg+blockSize, blockSize);
 }
 
 void EAX_Base::Resync(const byte *iv, size_t len)
 {
-	MessageAuthenticationCode &mac = AccessMAC();
+	CMAC_Base &mac = AccessMAC();
 	unsigned int blockSize = mac.TagSize();
 
-	memset(m_buffer, 0, blockSize);
-	mac.Update(m_buffer, blockSize);
-	mac.CalculateDigest(m_buffer+blockSize, iv, len);
-
-	m_buffer[blockSize-1] = 1;
-	mac.Update(m_buffer, blockSize);
+	// The last block of the nonce OMAC is encrypted together with the header OMAC's
+	StartMAC(0);
+	if (len)
+		mac.Update(iv, len);
+	PrepareLastMACBlock(m_buffer+blockSize, 0);
 
-	m_ctr.SetCipherWithIV(AccessMAC().AccessCipher(), m_buffer+blockSize, blockSize);
+	StartMAC(1);
 }
 
 size_t EAX_Base::AuthenticateBlocks(const byte *data, size_t len)
@@ -35,25 +77,75 @@ size_t EAX_Base::AuthenticateBlocks(const byte *data, size_t len)
 void EAX_Base::AuthenticateLastHeaderBlock()
 {
 	CRYPTOPP_ASSERT(m_bufferedDataLength == 0);
-	MessageAuthenticationCode &mac = AccessMAC();
-	unsigned int blockSize = mac.TagSize();
+	BlockCipher &cipher = AccessMAC().AccessCipher();
+	unsigned int blockSize = cipher.BlockSize();
+
+	// The header OMAC goes in the first block and the nonce OMAC in the second
+	PrepareLastMACBlock(m_buffer, 1);
+	cipher.AdvancedProcessBlocks(m_buffer, NULLPTR, m_buffer, 2*blockSize, BlockTransformation::BT_AllowParallel);
 
-	mac.Final(m_buffer);
+	memcpy(m_buffer+2*blockSize, m_buffer+blockSize, blockSize);
+	m_ctr.SetCipherWithIV(cipher, m_buffer+blockSize, blockSize);
 	xorbuf(m_buffer+blockSize, m_buffer, blockSize);
 
-	memset(m_buffer, 0, blockSize);
-	m_buffer[blockSize-1] = 2;
-	mac.Update(m_buffer, blockSize);
+	StartMAC(2);
 }
 
 void EAX_Base::AuthenticateLastFooterBlock(byte *tag, size_t macSize)
 {
 	CRYPTOPP_ASSERT(m_bufferedDataLength == 0);
-	MessageAuthenticationCode &mac = AccessMAC();
-	unsigned int blockSize = mac.TagSize();
+	BlockCipher &cipher = AccessMAC().AccessCipher();
+
+	PrepareLastMACBlock(m_buffer, 2);
+	cipher.ProcessBlock(m_buffer);
+	xorbuf(tag, m_buffer, m_buffer+cipher.BlockSize(), macSize);
+}
+
+void EAX_Base::ProcessData(byte *outString, const byte *inString, size_t length)
+{
+#if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
+	// AES can run the OMAC chain and the counter mode encryption in one interleaved pass.
+	//   The fast path needs the message position on a block boundary, and it leaves the
+	//   last block to the usual path because OMAC treats the last block differently.
+	const Rijndael::Encryption *aes = dynamic_cast<const Rijndael::Encryption *>(&GetMAC().GetCipher());
+	const unsigned int blockSize = 16;
+	if (aes && length > 2*blockSize && m_state >= State_IVSet && m_state < State_AuthFooter && m_totalMessageLength%blockSize == 0)
+	{
+		// Moves past the header and sets the authentication state
+		if (m_state == State_IVSet)
+			AuthenticatedSymmetricCipherBase::ProcessData(outString, inString, 0);
+
+		CMAC_Base &mac = AccessMAC();
+		const size_t run = (length-1) - (length-1)%blockSize;
+		const lword position = m_totalMessageLength;
+
+		// The kernel carries within the low 64 bits of the counter only
+		byte counter[16];
+		memcpy(counter, m_buffer+2*blockSize, blockSize);
+		const word64 low = GetWord<word64>(false, BIG_ENDIAN_ORDER, counter+8);
+		if (low <= W64LIT(0xffffffffffffffff) - position/blockSize - run/blockSize)
+		{
+			PutWord<word64>(false, BIG_ENDIAN_ORDER, counter+8, low + position/blockSize);
+			if (mac.m_counter == blockSize)
+			{
+				aes->ProcessBlock(mac.m_reg);
+				mac.m_counter = 0;
+			}
+
+			const size_t done = run - aes->InterleaveCBCMACAndCTR(mac.m_reg, counter, inString, outString, run, m_state == State_AuthTransformed);
+			if (done)
+			{
+				m_totalMessageLength += done;
+				m_ctr.Seek(position + done);
+				inString += done;
+				outString += done;
+				length -= done;
+			}
+		}
+	}
+#endif
 
-	mac.TruncatedFinal(m_buffer, macSize);
-	xorbuf(tag, m_buffer, m_buffer+blockSize, macSize);
+	AuthenticatedSymmetricCipherBase::ProcessData(outString, inString, length);
 }
 
 NAMESPACE_END
@@ -49,6 +49,9 @@ public:
 	lword MaxMessageLength() const
 		{return LWORD_MAX;}
 
+	// StreamTransformation
+	void ProcessData(byte *outString, const byte *inString, size_t length);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -60,6 +63,8 @@ protected:
 	size_t AuthenticateBlocks(const byte *data, size_t len);
 	void AuthenticateLastHeaderBlock();
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	void StartMAC(unsigned int tweak);
+	void PrepareLastMACBlock(byte *block, unsigned int tweak);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 	const CMAC_Base & GetMAC() const {return const_cast<EAX_Base *>(this)->AccessMAC();}
 	virtual CMAC_Base & AccessMAC() =0;
@@ -148,11 +148,6 @@ inline uint64x2_t VEXT_U8(uint64x2_t a, uint64x2_t b)
 word16 GCM_Base::s_reductionTable[256];
 volatile bool GCM_Base::s_reductionTableInitialized = false;
 
-void GCM_Base::GCTR::IncrementCounterBy256()
-{
-    IncrementCounterByOne(m_counterArray+BlockSize()-4, 3);
-}
-
 #if 0
 // preserved for testing
 void gcm_gf_mult(const unsigned char *a, const unsigned char *b, unsigned char *c)
@@ -320,15 +315,9 @@ inline uint64x2_t PMULL_GF_Mul(const uint64x2_t &x, const uint64x2_t &h, const u
 }
 #endif
 
-void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+int GCM_Base::GetTableSize(const NameValuePairs &params, GCM_TablesOption option)
 {
-    BlockCipher &blockCipher = AccessBlockCipher();
-    blockCipher.SetKey(userKey, keylength, params);
-
-    if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
-        throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
-
-    int tableSize, i, j, k;
+    int tableSize;
 
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
     if (HasCLMUL())
@@ -351,7 +340,7 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
         if (params.GetIntValue(Name::TableSize(), tableSize))
             tableSize = (tableSize >= 64*1024) ? 64*1024 : 2*1024;
         else
-            tableSize = (GetTablesOption() == GCM_64K_Tables) ? 64*1024 : 2*1024;
+            tableSize = (option == GCM_64K_Tables) ? 64*1024 : 2*1024;
 
 #if defined(_MSC_VER) && (_MSC_VER < 1400)
         // VC 2003 workaround: compiler generates bad code for 64K tables
@@ -359,17 +348,36 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
 #endif
     }
 
+    return tableSize;
+}
+
+void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+{
+    BlockCipher &blockCipher = AccessBlockCipher();
+    blockCipher.SetKey(userKey, keylength, params);
+    m_preparedKey = NULLPTR;
+
+    if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
+        throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+    const int tableSize = GetTableSize(params, GetTablesOption());
     m_buffer.resize(3*REQUIRED_BLOCKSIZE + tableSize);
-    byte *table = MulTable();
     byte *hashKey = HashKey();
     memset(hashKey, 0, REQUIRED_BLOCKSIZE);
     blockCipher.ProcessBlock(hashKey);
 
+    BuildMulTable(hashKey, m_buffer+3*REQUIRED_BLOCKSIZE, tableSize);
+}
+
+void GCM_Base::BuildMulTable(const byte *hashKey, byte *table, int tableSize)
+{
+    int i, j, k;
+
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
     if (HasCLMUL())
     {
         const __m128i r = s_clmulConstants[0];
-        __m128i h0 = _mm_shuffle_epi8(_mm_load_si128((__m128i *)(void *)hashKey), s_clmulConstants[1]);
+        __m128i h0 = _mm_shuffle_epi8(_mm_load_si128((const __m128i *)(const void *)hashKey), s_clmulConstants[1]);
         __m128i h = h0;
 
         for (i=0; i<tableSize; i+=32)
@@ -512,6 +520,49 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
     }
 }
 
+void GCM_PreparedKeyBase::SetKey(BlockCipher &cipher, const byte *userKey, size_t keylength, const NameValuePairs &params, GCM_TablesOption option)
+{
+    cipher.SetKey(userKey, keylength, params);
+
+    if (cipher.BlockSize() != GCM_Base::REQUIRED_BLOCKSIZE)
+        throw InvalidArgument(cipher.AlgorithmName() + "/GCM: block size of underlying block cipher is not 16");
+
+    FixedSizeAlignedSecBlock<byte, GCM_Base::REQUIRED_BLOCKSIZE> hashKey;
+    memset(hashKey, 0, hashKey.size());
+    cipher.ProcessBlock(hashKey);
+
+    const int tableSize = GCM_Base::GetTableSize(params, option);
+    m_table.New(tableSize);
+    GCM_Base::BuildMulTable(hashKey, m_table, tableSize);
+}
+
+void GCM_Base::SetPreparedKey(const GCM_PreparedKeyBase &key)
+{
+    // Only the scratch and hash buffer blocks are needed, and a larger buffer is kept
+    if (m_buffer.size() < 3*REQUIRED_BLOCKSIZE)
+        m_buffer.resize(3*REQUIRED_BLOCKSIZE);
+
+    m_preparedKey = &key;
+    m_bufferedDataLength = 0;
+    m_state = State_KeySet;
+}
+
+BlockCipher & GCM_Base::AccessKeyedCipher()
+{
+    // GCTR and the batch path only call the const members of the cipher
+    return m_preparedKey ? const_cast<BlockCipher &>(m_preparedKey->GetBlockCipher()) : AccessBlockCipher();
+}
+
+const byte * GCM_Base::MulTable() const
+{
+    return m_preparedKey ? m_preparedKey->m_table.data() : m_buffer.data()+3*REQUIRED_BLOCKSIZE;
+}
+
+size_t GCM_Base::MulTableSize() const
+{
+    return m_preparedKey ? m_preparedKey->m_table.size() : m_buffer.size()-3*REQUIRED_BLOCKSIZE;
+}
+
 inline void GCM_Base::ReverseHashBufferIfNeeded()
 {
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
@@ -534,7 +585,7 @@ inline void GCM_Base::ReverseHashBufferIfNeeded()
 
 void GCM_Base::Resync(const byte *iv, size_t len)
 {
-    BlockCipher &cipher = AccessBlockCipher();
+    BlockCipher &cipher = AccessKeyedCipher();
     byte *hashBuffer = HashBuffer();
 
     if (len == 12)
@@ -746,9 +797,10 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     word64 *hashBuffer = (word64 *)(void *)HashBuffer();
     CRYPTOPP_ASSERT(IsAlignedOn(hashBuffer,GetAlignmentOf<word64>()));
 
-    switch (2*(m_buffer.size()>=64*1024)
+    // The assembly expects the table to follow the hash buffer, which rules out a prepared key
+    switch (2*(MulTableSize()>=64*1024)
 #if CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)
-        + HasSSE2()
+        + (HasSSE2() && !m_preparedKey)
 //#elif CRYPTOPP_BOOL_NEON_INTRINSICS_AVAILABLE
 //      + HasNEON()
 #endif
@@ -756,7 +808,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     {
     case 0:        // non-SSE2 and 2K tables
         {
-        byte *table = MulTable();
+        const byte *table = MulTable();
         word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
         do
@@ -824,7 +876,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 
     case 2:        // non-SSE2 and 64K tables
         {
-        byte *table = MulTable();
+        const byte *table = MulTable();
         word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
         do
@@ -1159,6 +1211,90 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     return len%16;
 }
 
+// GHASH of data zero padded to a multiple of the block size
+void GCM_Base::AuthenticatePadded(const byte *data, size_t len)
+{
+    const size_t tail = len >= HASH_BLOCKSIZE ? GCM_Base::AuthenticateBlocks(data, len) : len;
+    if (tail)
+    {
+        memcpy(m_buffer, data+len-tail, tail);
+        memset(m_buffer+tail, 0, HASH_BLOCKSIZE-tail);
+        GCM_Base::AuthenticateBlocks(m_buffer, HASH_BLOCKSIZE);
+    }
+}
+
+void GCM_Base::ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt)
+{
+    const BlockCipher &cipher = AccessKeyedCipher();
+    byte counters[BATCH_LANES*REQUIRED_BLOCKSIZE];
+    FixedSizeSecBlock<byte, BATCH_LANES*REQUIRED_BLOCKSIZE> masks;
+    BatchMessage *direct[BATCH_LANES];
+    unsigned int n = 0;
+
+    // Messages with a 96-bit IV take a direct path that skips the streaming state machine.
+    //   The rest, including any that would throw, go through DecryptAndVerify() and friends.
+    for (unsigned int i=0; i<count; ++i)
+    {
+        BatchMessage &m = *messages[i];
+        if (m_state >= State_KeySet && m.ivLength == 12 && m.macSize <= DigestSize() &&
+            m.headerLength <= MaxHeaderLength() && m.length <= MaxMessageLength())
+        {
+            memcpy(counters+n*REQUIRED_BLOCKSIZE, m.iv, 12);
+            PutWord<word32>(false, BIG_ENDIAN_ORDER, counters+n*REQUIRED_BLOCKSIZE+12, 1);
+            direct[n++] = &m;
+        }
+        else
+            AuthenticatedSymmetricCipherBase::ProcessBatch(&messages[i], 1, encrypt);
+    }
+
+    if (n == 0)
+        return;
+
+    // The tag masks E(J0) of the group share one parallel call
+    cipher.AdvancedProcessBlocks(counters, NULLPTR, masks, n*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+
+    for (unsigned int i=0; i<n; ++i)
+    {
+        BatchMessage &m = *direct[i];
+        byte *counter = counters+i*REQUIRED_BLOCKSIZE;
+        const size_t tail = m.length % REQUIRED_BLOCKSIZE, full = m.length - tail;
+
+        memset(HashBuffer(), 0, HASH_BLOCKSIZE);
+        AuthenticatePadded(m.header, m.headerLength);
+        if (!encrypt)
+            AuthenticatePadded(m.input, m.length);
+
+        counter[REQUIRED_BLOCKSIZE-1] = 2;
+        if (full)
+            cipher.ProcessCounterBlocks(counter, m.input, m.output, full, BlockTransformation::BT_Counter32|BlockTransformation::BT_AllowParallel);
+        if (tail)
+        {
+            byte keystream[REQUIRED_BLOCKSIZE];
+            cipher.ProcessBlock(counter, keystream);
+            xorbuf(m.output+full, m.input+full, keystream, tail);
+            SecureWipeArray(keystream, REQUIRED_BLOCKSIZE);
+        }
+
+        if (encrypt)
+            AuthenticatePadded(m.output, m.length);
+
+        PutBlock<word64, BigEndian, true>(NULLPTR, m_buffer)(word64(m.headerLength)*8)(word64(m.length)*8);
+        GCM_Base::AuthenticateBlocks(m_buffer, HASH_BLOCKSIZE);
+        ReverseHashBufferIfNeeded();
+
+        byte *tag = HashBuffer();
+        xorbuf(tag, masks+i*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+        if (encrypt)
+            memcpy(m.mac, tag, m.macSize);
+        else
+            m.valid = VerifyBufsEqual(tag, m.mac, m.macSize);
+        memset(tag, 0, HASH_BLOCKSIZE);
+    }
+
+    m_bufferedDataLength = 0;
+    m_state = State_KeySet;
+}
+
 void GCM_Base::AuthenticateLastHeaderBlock()
 {
     if (m_bufferedDataLength > 0)
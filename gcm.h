@@ -20,6 +20,8 @@ enum GCM_TablesOption {
 	//! \brief Use a table with 64K entries
 	GCM_64K_Tables};
 
+class GCM_PreparedKeyBase;
+
 //! \class GCM_Base
 //! \brief GCM block cipher base implementation
 //! \details Base implementation of the AuthenticatedSymmetricCipher interface
@@ -56,7 +58,19 @@ public:
 	lword MaxMessageLength() const
 		{return ((W64LIT(1)<<39)-256)/8;}
 
+	//! \brief Switches to a prepared key
+	//! \param key the prepared key
+	//! \details SetPreparedKey() makes the object use the block cipher and GHASH table held by
+	//!   \p key rather than its own, so changing keys does not expand a key schedule or build
+	//!   a table. Nothing is copied and \p key must outlive its use by this object. Call
+	//!   Resynchronize() to set the IV before processing a message. A later SetKey() returns
+	//!   the object to a key of its own.
+	//! \sa GCM_PreparedKeyBase
+	void SetPreparedKey(const GCM_PreparedKeyBase &key);
+
 protected:
+	GCM_Base() : m_preparedKey(NULLPTR) {}
+
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
 		{return false;}
@@ -68,27 +82,88 @@ protected:
 	void AuthenticateLastHeaderBlock();
 	void AuthenticateLastConfidentialBlock();
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	void ProcessBatch(BatchMessage *const *messages, unsigned int count, bool encrypt);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
 	virtual BlockCipher & AccessBlockCipher() =0;
 	virtual GCM_TablesOption GetTablesOption() const =0;
 
 	const BlockCipher & GetBlockCipher() const {return const_cast<GCM_Base *>(this)->AccessBlockCipher();};
+	BlockCipher & AccessKeyedCipher();
 	byte *HashBuffer() {return m_buffer+REQUIRED_BLOCKSIZE;}
 	byte *HashKey() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
-	byte *MulTable() {return m_buffer+3*REQUIRED_BLOCKSIZE;}
+	const byte *MulTable() const;
+	size_t MulTableSize() const;
 	inline void ReverseHashBufferIfNeeded();
+	void AuthenticatePadded(const byte *data, size_t len);
+
+	static int GetTableSize(const NameValuePairs &params, GCM_TablesOption option);
+	static void BuildMulTable(const byte *hashKey, byte *table, int tableSize);
 
 	class CRYPTOPP_DLL GCTR : public CTR_Mode_ExternalCipher::Encryption
 	{
 	protected:
-		void IncrementCounterBy256();
+		// The GCM counter is the last 32 bits of the block, and wraps without a carry
+		word32 CounterFlags() const
+			{return BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_Counter32;}
+		void IncrementCounterCarry() {}
 	};
 
 	GCTR m_ctr;
+	const GCM_PreparedKeyBase *m_preparedKey;
 	static word16 s_reductionTable[256];
 	static volatile bool s_reductionTableInitialized;
 	enum {REQUIRED_BLOCKSIZE = 16, HASH_BLOCKSIZE = 16};
+
+	friend class GCM_PreparedKeyBase;
+};
+
+//! \class GCM_PreparedKeyBase
+//! \brief GCM prepared key base implementation
+//! \details A prepared key holds a keyed block cipher and the GHASH multiplication table for
+//!   one key. It does not change after construction, and any number of GCM objects can use
+//!   it at once through GCM_Base::SetPreparedKey(). The GCM objects only call the const members
+//!   of the block cipher, so one prepared key can serve several threads when those members are
+//!   reentrant, as they are for Rijndael on every code path.
+//! \since Crypto++ 6.0
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE GCM_PreparedKeyBase
+{
+public:
+	virtual ~GCM_PreparedKeyBase() {}
+
+	//! \brief Provides the keyed block cipher
+	virtual const BlockCipher & GetBlockCipher() const =0;
+
+protected:
+	void SetKey(BlockCipher &cipher, const byte *userKey, size_t keylength, const NameValuePairs &params, GCM_TablesOption option);
+
+private:
+	friend class GCM_Base;
+	AlignedSecByteBlock m_table;
+};
+
+//! \class GCM_PreparedKey_Final
+//! \brief GCM prepared key final implementation
+//! \tparam T_BlockCipher block cipher
+//! \tparam T_TablesOption table size, either \p GCM_2K_Tables or \p GCM_64K_Tables
+//! \details The table size can be overridden with Name::TableSize() in \p params, as with
+//!   SetKey() on a GCM object.
+//! \since Crypto++ 6.0
+template <class T_BlockCipher, GCM_TablesOption T_TablesOption>
+class GCM_PreparedKey_Final : public GCM_PreparedKeyBase
+{
+public:
+	//! \brief Construct a GCM_PreparedKey_Final
+	//! \param userKey the key
+	//! \param keylength the size of the key, in bytes
+	//! \param params additional parameters
+	GCM_PreparedKey_Final(const byte *userKey, size_t keylength, const NameValuePairs &params = g_nullNameValuePairs)
+		{SetKey(m_cipher, userKey, keylength, params, T_TablesOption);}
+
+	const BlockCipher & GetBlockCipher() const {return m_cipher;}
+
+private:
+	typename T_BlockCipher::Encryption m_cipher;
 };
 
 //! \class GCM_Final
@@ -118,6 +193,8 @@ private:
 //! \tparam T_TablesOption table size, either \p GCM_2K_Tables or \p GCM_64K_Tables
 //! \details \p GCM provides the \p Encryption and \p Decryption typedef. See GCM_Base
 //!   and GCM_Final for the AuthenticatedSymmetricCipher implementation.
+//! \details \p PreparedKey holds the expanded key for applications that switch between many
+//!   keys. Both directions accept it through GCM_Base::SetPreparedKey().
 //! \sa <a href="http://www.cryptolounge.org/wiki/GCM">GCM</a> at the Crypto Lounge
 //! \since Crypto++ 5.6.0
 template <class T_BlockCipher, GCM_TablesOption T_TablesOption=GCM_2K_Tables>
@@ -125,6 +202,7 @@ struct GCM : public AuthenticatedSymmetricCipherDocumentation
 {
 	typedef GCM_Final<T_BlockCipher, T_TablesOption, true> Encryption;
 	typedef GCM_Final<T_BlockCipher, T_TablesOption, false> Decryption;
+	typedef GCM_PreparedKey_Final<T_BlockCipher, T_TablesOption> PreparedKey;
 };
 
 NAMESPACE_END
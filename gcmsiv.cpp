@@ -0,0 +1,327 @@
+// gcmsiv.cpp - written and placed in the public domain
+
+#include "pch.h"
+#include "gcmsiv.h"
+#include "argnames.h"
+#include "algparam.h"
+#include "misc.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// POLYVAL works in GF(2^128) modulo x^128 + x^127 + x^126 + x^121 + 1 with little-endian
+//   bit order, and its product is a*b*x^-128. The portable version shifts a right one bit at
+//   a time and multiplies the accumulator by x^-1, which needs no table and no branches.
+inline void POLYVAL_Multiply(word64 &r0, word64 &r1, word64 a0, word64 a1, word64 b0, word64 b1)
+{
+	word64 z0 = 0, z1 = 0;
+	for (unsigned int i=0; i<128; ++i)
+	{
+		const word64 bit = 0 - ((i < 64 ? a0 >> i : a1 >> (i-64)) & 1);
+		z0 ^= b0 & bit; z1 ^= b1 & bit;
+
+		// z = z * x^-1: add the modulus when z is odd, then shift right
+		const word64 odd = 0 - (z0 & 1);
+		z0 ^= odd & 1; z1 ^= odd & W64LIT(0xc200000000000000);
+		z0 = (z0 >> 1) | (z1 << 63);
+		z1 = (z1 >> 1) | (odd << 63);
+	}
+	r0 = z0; r1 = z1;
+}
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+// Montgomery reduction of c2*x^128 + c1*x^64 + c0. Two folds by the low 64 bits
+//   multiply the 256-bit product by x^-128, as in GCM_Base's CLMUL_Reduce.
+inline __m128i POLYVAL_Reduce(__m128i c0, __m128i c1, __m128i c2)
+{
+	const __m128i p = _mm_set_epi32(0xc2000000, 0, 0, 1);
+	c0 = _mm_xor_si128(c0, _mm_slli_si128(c1, 8));
+	c2 = _mm_xor_si128(c2, _mm_srli_si128(c1, 8));
+	c0 = _mm_xor_si128(_mm_shuffle_epi32(c0, _MM_SHUFFLE(1, 0, 3, 2)), _mm_clmulepi64_si128(c0, p, 0x10));
+	c0 = _mm_xor_si128(_mm_shuffle_epi32(c0, _MM_SHUFFLE(1, 0, 3, 2)), _mm_clmulepi64_si128(c0, p, 0x10));
+	return _mm_xor_si128(c0, c2);
+}
+
+inline void POLYVAL_Accumulate(const __m128i &x, const __m128i &h, __m128i &c0, __m128i &c1, __m128i &c2)
+{
+	c0 = _mm_xor_si128(c0, _mm_clmulepi64_si128(x, h, 0x00));
+	c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(x, h, 0x01));
+	c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(x, h, 0x10));
+	c2 = _mm_xor_si128(c2, _mm_clmulepi64_si128(x, h, 0x11));
+}
+
+inline __m128i POLYVAL_Multiply(const __m128i &x, const __m128i &h)
+{
+	__m128i c0 = _mm_setzero_si128(), c1 = c0, c2 = c0;
+	POLYVAL_Accumulate(x, h, c0, c1, c2);
+	return POLYVAL_Reduce(c0, c1, c2);
+}
+#endif
+
+ANONYMOUS_NAMESPACE_END
+
+void GCM_SIV_Base::UncheckedSetKey(const byte *userKey, unsigned int keylength, const NameValuePairs &params)
+{
+	AccessKeyCipher().SetKey(userKey, keylength, params);
+
+	if (GetBlockCipher().BlockSize() != REQUIRED_BLOCKSIZE)
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	m_keyLength = keylength;
+	m_hashKey.New(HASH_POWERS*REQUIRED_BLOCKSIZE);
+	m_hash.New(REQUIRED_BLOCKSIZE);
+	m_nonce.New(REQUIRED_BLOCKSIZE);
+	m_counters.New(COUNTER_BLOCKS*REQUIRED_BLOCKSIZE);
+
+	// A nonce passed with the key, as by SetKeyWithIV(), is the default for later messages
+	m_defaultNonce.New(0);
+	ConstByteArrayParameter iv;
+	if (params.GetValue(Name::IV(), iv) && iv.begin())
+		Resynchronize(iv.begin(), (int)iv.size());
+}
+
+void GCM_SIV_Base::Resynchronize(const byte *iv, int ivLength)
+{
+	ThrowIfInvalidIV(iv);
+	m_defaultNonce.Assign(iv, ThrowIfInvalidIVLength(ivLength));
+}
+
+void GCM_SIV_Base::DeriveKeys(const byte *iv, int ivLength)
+{
+	if (!m_keyLength)
+		throw BadState(AlgorithmName(), "DeriveKeys", "SetKey");
+
+	if (!iv)
+	{
+		if (m_defaultNonce.empty())
+			throw InvalidArgument(AlgorithmName() + ": no nonce was passed, and none was set with the key or Resynchronize()");
+		iv = m_defaultNonce;
+		ivLength = (int)m_defaultNonce.size();
+	}
+
+	ThrowIfInvalidIVLength(ivLength);
+	memcpy(m_nonce, iv, IVSize());
+
+	// Block i is E(LE32(i) || nonce). The first 8 bytes of blocks 0 and 1 are the hash key,
+	//   and of the next 2 or 4 blocks the message key. All of them run through the cipher at once.
+	const unsigned int blocks = 2 + m_keyLength/8;
+	FixedSizeAlignedSecBlock<byte, 6*REQUIRED_BLOCKSIZE> derived;
+	for (unsigned int i=0; i<blocks; ++i)
+	{
+		PutWord(false, LITTLE_ENDIAN_ORDER, derived+i*REQUIRED_BLOCKSIZE, word32(i));
+		memcpy(derived+i*REQUIRED_BLOCKSIZE+4, iv, IVSize());
+	}
+	AccessKeyCipher().AdvancedProcessBlocks(derived, NULLPTR, derived, blocks*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+	for (unsigned int i=1; i<blocks; ++i)
+		memmove(derived+i*8, derived+i*REQUIRED_BLOCKSIZE, 8);
+
+	AccessBlockCipher().SetKey(derived+REQUIRED_BLOCKSIZE, m_keyLength);
+
+	byte *hashKey = m_hashKey;
+	memcpy(hashKey, derived, REQUIRED_BLOCKSIZE);
+	memset(m_hash, 0, REQUIRED_BLOCKSIZE);
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+	{
+		// H, H^2, ..., H^8 for the aggregated reduction in HashBlocks()
+		const __m128i h = _mm_load_si128((const __m128i *)(const void *)hashKey);
+		__m128i p = h;
+		for (unsigned int i=1; i<HASH_POWERS; ++i)
+		{
+			p = POLYVAL_Multiply(p, h);
+			_mm_store_si128((__m128i *)(void *)(hashKey+i*REQUIRED_BLOCKSIZE), p);
+		}
+	}
+#endif
+}
+
+void GCM_SIV_Base::HashBlocks(const byte *data, size_t blocks)
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasCLMUL())
+	{
+		const __m128i *table = (const __m128i *)(const void *)m_hashKey.begin();
+		__m128i x = _mm_load_si128((const __m128i *)(const void *)m_hash.begin());
+
+		// Eight blocks share one reduction: x = (x^X1)*H^8 + X2*H^7 + ... + X8*H
+		while (blocks >= HASH_POWERS)
+		{
+			__m128i c0 = _mm_setzero_si128(), c1 = c0, c2 = c0;
+			POLYVAL_Accumulate(_mm_xor_si128(x, _mm_loadu_si128((const __m128i *)(const void *)data)),
+				_mm_load_si128(table+HASH_POWERS-1), c0, c1, c2);
+			for (unsigned int i=1; i<HASH_POWERS; ++i)
+				POLYVAL_Accumulate(_mm_loadu_si128((const __m128i *)(const void *)(data+i*REQUIRED_BLOCKSIZE)),
+					_mm_load_si128(table+HASH_POWERS-1-i), c0, c1, c2);
+			x = POLYVAL_Reduce(c0, c1, c2);
+
+			data += HASH_POWERS*REQUIRED_BLOCKSIZE;
+			blocks -= HASH_POWERS;
+		}
+
+		const __m128i h = _mm_load_si128(table);
+		for (; blocks; --blocks, data+=REQUIRED_BLOCKSIZE)
+			x = POLYVAL_Multiply(_mm_xor_si128(x, _mm_loadu_si128((const __m128i *)(const void *)data)), h);
+
+		_mm_store_si128((__m128i *)(void *)m_hash.begin(), x);
+		return;
+	}
+#endif
+
+	typedef BlockGetAndPut<word64, LittleEndian> Block;
+	word64 h0, h1, x0, x1, d0, d1;
+	Block::Get(m_hashKey)(h0)(h1);
+	Block::Get(m_hash)(x0)(x1);
+
+	for (; blocks; --blocks, data+=REQUIRED_BLOCKSIZE)
+	{
+		Block::Get(data)(d0)(d1);
+		POLYVAL_Multiply(x0, x1, x0^d0, x1^d1, h0, h1);
+	}
+
+	Block::Put(NULLPTR, m_hash)(x0)(x1);
+}
+
+void GCM_SIV_Base::HashPadded(const byte *data, size_t length)
+{
+	HashBlocks(data, length/REQUIRED_BLOCKSIZE);
+
+	const size_t tail = length % REQUIRED_BLOCKSIZE;
+	if (tail)
+	{
+		FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> block;
+		memcpy(block, data+length-tail, tail);
+		memset(block+tail, 0, REQUIRED_BLOCKSIZE-tail);
+		HashBlocks(block, 1);
+	}
+}
+
+void GCM_SIV_Base::ComputeTag(byte *tag, const byte *header, size_t headerLength, const byte *message, size_t messageLength)
+{
+	if (headerLength > MaxHeaderLength())
+		throw InvalidArgument(AlgorithmName() + ": header length " + IntToString(headerLength) + " exceeds the maximum of " + IntToString(MaxHeaderLength()));
+	if (messageLength > MaxMessageLength())
+		throw InvalidArgument(AlgorithmName() + ": message length " + IntToString(messageLength) + " exceeds the maximum of " + IntToString(MaxMessageLength()));
+
+	// S = POLYVAL(H, AAD || M || LE64(bitlen(AAD)) || LE64(bitlen(M)))
+	HashPadded(header, headerLength);
+	HashPadded(message, messageLength);
+
+	FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> block;
+	BlockGetAndPut<word64, LittleEndian>::Put(NULLPTR, block)(word64(headerLength)*8)(word64(messageLength)*8);
+	HashBlocks(block, 1);
+
+	// Tag = E(S ^ nonce, with the top bit cleared)
+	xorbuf(block, m_hash, m_nonce, IVSize());
+	memcpy(block+IVSize(), m_hash+IVSize(), REQUIRED_BLOCKSIZE-IVSize());
+	block[REQUIRED_BLOCKSIZE-1] &= 0x7f;
+	AccessBlockCipher().ProcessBlock(block, tag);
+}
+
+// The counter is the tag with the top bit set, and its first 32 bits are a little-endian
+//   counter that wraps without carrying into the rest of the block.
+void GCM_SIV_Base::ProcessCTR(byte *outString, const byte *inString, size_t length, const byte *tag)
+{
+	BlockCipher &cipher = AccessBlockCipher();
+	byte *counters = m_counters;
+	memcpy(counters, tag, REQUIRED_BLOCKSIZE);
+	counters[REQUIRED_BLOCKSIZE-1] |= 0x80;
+	word32 ctr = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, counters);
+
+	while (length)
+	{
+		const size_t blocks = STDMIN(size_t((length+REQUIRED_BLOCKSIZE-1)/REQUIRED_BLOCKSIZE), size_t(COUNTER_BLOCKS));
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		if (HasSSE2())
+		{
+			const __m128i c = _mm_load_si128((const __m128i *)(const void *)counters);
+			const __m128i base = _mm_insert_epi16(_mm_insert_epi16(c, int(ctr & 0xffff), 0), int(ctr >> 16), 1);
+			for (size_t i=0; i<blocks; ++i)
+				_mm_store_si128((__m128i *)(void *)(counters+i*REQUIRED_BLOCKSIZE), _mm_add_epi32(base, _mm_cvtsi32_si128(int(i))));
+		}
+		else
+#endif
+		{
+			for (size_t i=0; i<blocks; ++i)
+			{
+				if (i)
+					memcpy(counters+i*REQUIRED_BLOCKSIZE+4, counters+4, REQUIRED_BLOCKSIZE-4);
+				PutWord(false, LITTLE_ENDIAN_ORDER, counters+i*REQUIRED_BLOCKSIZE, word32(ctr+i));
+			}
+		}
+		ctr += word32(blocks);
+
+		const size_t len = STDMIN(length, blocks*REQUIRED_BLOCKSIZE);
+		const size_t full = len - len%REQUIRED_BLOCKSIZE;
+		if (full)
+			cipher.AdvancedProcessBlocks(counters, inString, outString, full, BlockTransformation::BT_AllowParallel);
+		if (len != full)
+		{
+			byte *pad = counters+full;
+			cipher.ProcessBlock(pad);
+			xorbuf(outString+full, inString+full, pad, len-full);
+		}
+
+		inString += len;
+		outString += len;
+		length -= len;
+	}
+}
+
+void GCM_SIV_Base::EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *message, size_t messageLength)
+{
+	if (macSize != DigestSize())
+		throw InvalidArgument(AlgorithmName() + ": the tag is the initial counter and cannot be truncated");
+
+	DeriveKeys(iv, ivLength);
+
+	FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> tag;
+	ComputeTag(tag, header, headerLength, message, messageLength);
+	ProcessCTR(ciphertext, message, messageLength, tag);
+	memcpy(mac, tag, REQUIRED_BLOCKSIZE);
+}
+
+bool GCM_SIV_Base::DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength)
+{
+	if (macLength != DigestSize())
+		throw InvalidArgument(AlgorithmName() + ": the tag is the initial counter and cannot be truncated");
+
+	DeriveKeys(iv, ivLength);
+
+	FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> tag;
+	memcpy(tag, mac, REQUIRED_BLOCKSIZE);
+	ProcessCTR(message, ciphertext, ciphertextLength, tag);
+
+	FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> expected;
+	ComputeTag(expected, header, headerLength, message, ciphertextLength);
+	if (!VerifyBufsEqual(expected, tag, REQUIRED_BLOCKSIZE))
+	{
+		// Don't release unauthenticated plaintext
+		memset(message, 0, ciphertextLength);
+		return false;
+	}
+	return true;
+}
+
+void GCM_SIV_Base::ProcessData(byte *outString, const byte *inString, size_t length)
+{
+	CRYPTOPP_UNUSED(outString); CRYPTOPP_UNUSED(inString); CRYPTOPP_UNUSED(length);
+	throw NotImplemented(AlgorithmName() + ": not an online mode, use EncryptAndAuthenticate() or DecryptAndVerify()");
+}
+
+void GCM_SIV_Base::Update(const byte *input, size_t length)
+{
+	CRYPTOPP_UNUSED(input); CRYPTOPP_UNUSED(length);
+	throw NotImplemented(AlgorithmName() + ": not an online mode, use EncryptAndAuthenticate() or DecryptAndVerify()");
+}
+
+void GCM_SIV_Base::TruncatedFinal(byte *mac, size_t macSize)
+{
+	CRYPTOPP_UNUSED(mac); CRYPTOPP_UNUSED(macSize);
+	throw NotImplemented(AlgorithmName() + ": not an online mode, use EncryptAndAuthenticate() or DecryptAndVerify()");
+}
+
+NAMESPACE_END
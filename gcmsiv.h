@@ -0,0 +1,149 @@
+// gcmsiv.h - written and placed in the public domain
+
+//! \file gcmsiv.h
+//! \brief GCM-SIV block cipher mode of operation
+//! \details GCM-SIV is the nonce misuse-resistant authenticated encryption mode from RFC 8452.
+//!   The tag is computed over the plaintext with POLYVAL and then used as the initial counter,
+//!   so a repeated nonce only reveals whether two messages are equal.
+//! \since Crypto++ 6.0
+
+#ifndef CRYPTOPP_GCMSIV_H
+#define CRYPTOPP_GCMSIV_H
+
+#include "cryptlib.h"
+#include "seckey.h"
+#include "secblock.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! \class GCM_SIV_Base
+//! \brief GCM-SIV block cipher base implementation
+//! \details Base implementation of the AuthenticatedSymmetricCipher interface.
+//! \details GCM-SIV must see the whole message before it can encrypt the first byte, so
+//!   it is not an online mode. Messages are processed with EncryptAndAuthenticate() and
+//!   DecryptAndVerify(). The streaming members ProcessData(), Update() and TruncatedFinal()
+//!   throw NotImplemented, so the object cannot be used with AuthenticatedEncryptionFilter
+//!   or AuthenticatedDecryptionFilter.
+//! \details The nonce is normally passed with each message. A nonce set with SetKeyWithIV() or
+//!   Resynchronize() is used when EncryptAndAuthenticate() or DecryptAndVerify() is called
+//!   with a NULL \p iv.
+//! \since Crypto++ 6.0
+class CRYPTOPP_NO_VTABLE GCM_SIV_Base : public AuthenticatedSymmetricCipher
+{
+public:
+	GCM_SIV_Base() : m_keyLength(0) {}
+
+	// AuthenticatedSymmetricCipher
+	std::string AlgorithmName() const
+		{return GetBlockCipher().AlgorithmName() + std::string("/GCM-SIV");}
+	size_t MinKeyLength() const
+		{return 16;}
+	size_t MaxKeyLength() const
+		{return 32;}
+	size_t DefaultKeyLength() const
+		{return 16;}
+	size_t GetValidKeyLength(size_t keylength) const
+		{return keylength < 32 ? 16 : 32;}
+	unsigned int OptimalDataAlignment() const
+		{return GetBlockCipher().OptimalDataAlignment();}
+	IV_Requirement IVRequirement() const
+		{return UNIQUE_IV;}
+	unsigned int IVSize() const
+		{return 12;}
+	unsigned int DigestSize() const
+		{return 16;}
+	lword MaxHeaderLength() const
+		{return W64LIT(1)<<36;}
+	lword MaxMessageLength() const
+		{return W64LIT(1)<<36;}
+
+	// StreamTransformation
+	bool IsRandomAccess() const
+		{return false;}
+	bool IsSelfInverting() const
+		{return false;}
+
+	//! \brief Sets the default nonce
+	//! \param iv the nonce
+	//! \param ivLength the size of the nonce, in bytes
+	//! \details The nonce is used for messages processed with a NULL \p iv.
+	void Resynchronize(const byte *iv, int ivLength=-1);
+
+	void EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *message, size_t messageLength);
+	bool DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength);
+
+	//! \brief Not available in GCM-SIV
+	//! \throws NotImplemented
+	void ProcessData(byte *outString, const byte *inString, size_t length);
+	//! \brief Not available in GCM-SIV
+	//! \throws NotImplemented
+	void Update(const byte *input, size_t length);
+	//! \brief Not available in GCM-SIV
+	//! \throws NotImplemented
+	void TruncatedFinal(byte *mac, size_t macSize);
+
+protected:
+	void UncheckedSetKey(const byte *userKey, unsigned int keylength, const NameValuePairs &params);
+
+	//! \brief The block cipher keyed with the key-generating key
+	virtual BlockCipher & AccessKeyCipher() =0;
+	//! \brief The block cipher keyed with the per-nonce message encryption key
+	virtual BlockCipher & AccessBlockCipher() =0;
+
+	const BlockCipher & GetBlockCipher() const {return const_cast<GCM_SIV_Base *>(this)->AccessKeyCipher();};
+
+	void DeriveKeys(const byte *iv, int ivLength);
+	void ComputeTag(byte *tag, const byte *header, size_t headerLength, const byte *message, size_t messageLength);
+	void HashBlocks(const byte *data, size_t blocks);
+	void HashPadded(const byte *data, size_t length);
+	void ProcessCTR(byte *outString, const byte *inString, size_t length, const byte *tag);
+
+	// The hash key holds H, and with CLMUL also H^2 to H^8 for the aggregated reduction
+	enum {REQUIRED_BLOCKSIZE = 16, HASH_POWERS = 8, COUNTER_BLOCKS = 64};
+
+	unsigned int m_keyLength;
+	AlignedSecByteBlock m_hashKey, m_hash, m_nonce, m_counters;
+	SecByteBlock m_defaultNonce;
+};
+
+//! \class GCM_SIV_Final
+//! \brief GCM-SIV block cipher final implementation
+//! \tparam T_BlockCipher block cipher
+//! \tparam T_IsEncryption direction in which to operate the cipher
+//! \details Both directions use the block cipher in the encryption direction.
+//! \since Crypto++ 6.0
+template <class T_BlockCipher, bool T_IsEncryption>
+class GCM_SIV_Final : public GCM_SIV_Base
+{
+public:
+	static std::string StaticAlgorithmName()
+		{return T_BlockCipher::StaticAlgorithmName() + std::string("/GCM-SIV");}
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+
+private:
+	BlockCipher & AccessKeyCipher() {return m_keyCipher;}
+	BlockCipher & AccessBlockCipher() {return m_cipher;}
+	typename T_BlockCipher::Encryption m_keyCipher, m_cipher;
+};
+
+//! \class GCM_SIV
+//! \brief GCM-SIV block cipher mode of operation
+//! \tparam T_BlockCipher block cipher
+//! \details \p GCM_SIV provides the \p Encryption and \p Decryption typedef. See GCM_SIV_Base
+//!   and GCM_SIV_Final for the AuthenticatedSymmetricCipher implementation.
+//! \details GCM-SIV requires a 128-bit block cipher with 128-bit and 256-bit keys. The nonce
+//!   is 12 bytes and the tag is 16 bytes. The tag is the initial counter, so it cannot be truncated.
+//! \sa <a href="https://tools.ietf.org/html/rfc8452">RFC 8452, AES-GCM-SIV: Nonce Misuse-Resistant
+//!   Authenticated Encryption</a>
+//! \since Crypto++ 6.0
+template <class T_BlockCipher>
+struct GCM_SIV : public AuthenticatedSymmetricCipherDocumentation
+{
+	typedef GCM_SIV_Final<T_BlockCipher, true> Encryption;
+	typedef GCM_SIV_Final<T_BlockCipher, false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
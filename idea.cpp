@@ -4,6 +4,12 @@
 #include "idea.h"
 #include "misc.h"
 #include "secblock.h"
+#include "advsimd.h"
+
+// The SIMD path needs the plain key schedule, not the log tables
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(IDEA_LARGECACHE)
+# define CRYPTOPP_ENABLE_IDEA_SSE2_INTRINSICS 1
+#endif
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -188,4 +194,91 @@ void IDEA::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, b
 	Block::Put(xorBlock, outBlock)(x0)(x2)(x1)(x3);
 }
 
+#if CRYPTOPP_ENABLE_IDEA_SSE2_INTRINSICS
+// Multiplication modulo 2^16+1, where 0 stands for 2^16
+inline __m128i IDEA_SSE2_MUL(const __m128i &a, const __m128i &b)
+{
+	const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1);
+	const __m128i lo = _mm_mullo_epi16(a, b), hi = _mm_mulhi_epu16(a, b);
+
+	// lo-hi, plus one if hi > lo
+	const __m128i le = _mm_cmpeq_epi16(_mm_subs_epu16(hi, lo), zero);
+	const __m128i r = _mm_add_epi16(_mm_sub_epi16(lo, hi), _mm_add_epi16(le, one));
+
+	// If either operand is 2^16 the product is 1-a-b
+	const __m128i z = _mm_or_si128(_mm_cmpeq_epi16(a, zero), _mm_cmpeq_epi16(b, zero));
+	const __m128i s = _mm_sub_epi16(_mm_sub_epi16(one, a), b);
+	return _mm_or_si128(_mm_andnot_si128(z, r), _mm_and_si128(z, s));
+}
+
+inline __m128i IDEA_SSE2_ByteSwap(const __m128i &x)
+{
+	return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+// Encrypts or decrypts 8 blocks. x[i] holds blocks 2*i and 2*i+1.
+struct IDEA_SSE2_8_Blocks
+{
+	IDEA_SSE2_8_Blocks(const IDEA::Word *key) : m_key(key) {}
+
+	void operator()(__m128i x[4]) const
+	{
+		const IDEA::Word *key = m_key;
+		__m128i t0, t1, t2, t3;
+
+		// Transpose so that x0 holds word 0 of each block, and so on
+		t0 = _mm_unpacklo_epi16(x[0], x[1]);
+		t1 = _mm_unpackhi_epi16(x[0], x[1]);
+		t2 = _mm_unpacklo_epi16(x[2], x[3]);
+		t3 = _mm_unpackhi_epi16(x[2], x[3]);
+		const __m128i u0 = _mm_unpacklo_epi16(t0, t1), u1 = _mm_unpackhi_epi16(t0, t1);
+		const __m128i u2 = _mm_unpacklo_epi16(t2, t3), u3 = _mm_unpackhi_epi16(t2, t3);
+		__m128i x0 = IDEA_SSE2_ByteSwap(_mm_unpacklo_epi64(u0, u2));
+		__m128i x1 = IDEA_SSE2_ByteSwap(_mm_unpackhi_epi64(u0, u2));
+		__m128i x2 = IDEA_SSE2_ByteSwap(_mm_unpacklo_epi64(u1, u3));
+		__m128i x3 = IDEA_SSE2_ByteSwap(_mm_unpackhi_epi64(u1, u3));
+
+		for (unsigned int i=0; i<IDEA::ROUNDS; i++, key+=6)
+		{
+			x0 = IDEA_SSE2_MUL(x0, _mm_set1_epi16((short)key[0]));
+			x1 = _mm_add_epi16(x1, _mm_set1_epi16((short)key[1]));
+			x2 = _mm_add_epi16(x2, _mm_set1_epi16((short)key[2]));
+			x3 = IDEA_SSE2_MUL(x3, _mm_set1_epi16((short)key[3]));
+			t0 = IDEA_SSE2_MUL(_mm_xor_si128(x0, x2), _mm_set1_epi16((short)key[4]));
+			t1 = IDEA_SSE2_MUL(_mm_add_epi16(t0, _mm_xor_si128(x1, x3)), _mm_set1_epi16((short)key[5]));
+			t0 = _mm_add_epi16(t0, t1);
+			x0 = _mm_xor_si128(x0, t1);
+			x3 = _mm_xor_si128(x3, t0);
+			t0 = _mm_xor_si128(t0, x1);
+			x1 = _mm_xor_si128(x2, t1);
+			x2 = t0;
+		}
+
+		x0 = IDEA_SSE2_ByteSwap(IDEA_SSE2_MUL(x0, _mm_set1_epi16((short)key[0])));
+		x2 = IDEA_SSE2_ByteSwap(_mm_add_epi16(x2, _mm_set1_epi16((short)key[1])));
+		x1 = IDEA_SSE2_ByteSwap(_mm_add_epi16(x1, _mm_set1_epi16((short)key[2])));
+		x3 = IDEA_SSE2_ByteSwap(IDEA_SSE2_MUL(x3, _mm_set1_epi16((short)key[3])));
+
+		// Output order is x0, x2, x1, x3
+		t0 = _mm_unpacklo_epi16(x0, x2);
+		t1 = _mm_unpackhi_epi16(x0, x2);
+		t2 = _mm_unpacklo_epi16(x1, x3);
+		t3 = _mm_unpackhi_epi16(x1, x3);
+		x[0] = _mm_unpacklo_epi32(t0, t2);
+		x[1] = _mm_unpackhi_epi32(t0, t2);
+		x[2] = _mm_unpacklo_epi32(t1, t3);
+		x[3] = _mm_unpackhi_epi32(t1, t3);
+	}
+
+	const IDEA::Word *m_key;
+};
+
+size_t IDEA::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (HasSSE2())
+		AdvancedProcessBlocks_SSE2<BLOCKSIZE, 8>(IDEA_SSE2_8_Blocks(m_key), inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_ENABLE_IDEA_SSE2_INTRINSICS
+
 NAMESPACE_END
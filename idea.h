@@ -21,6 +21,7 @@ struct IDEA_Info : public FixedBlockSize<8>, public FixedKeyLength<16>, public F
 
 //! \class IDEA
 //! \brief IDEA block cipher
+//! \details On x86 processors with SSE2, AdvancedProcessBlocks() processes eight blocks at a time.
 //! \sa <a href="http://www.weidai.com/scan-mirror/cs.html#IDEA">IDEA</a>
 //! \since Crypto++ 1.0
 class IDEA : public IDEA_Info, public BlockCipherDocumentation
@@ -38,6 +39,10 @@ private:
 	public:
 		unsigned int OptimalDataAlignment() const {return 2;}
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(IDEA_LARGECACHE)
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 
 		void UncheckedSetKey(const byte *userKey, unsigned int length, const NameValuePairs &params);
 
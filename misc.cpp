@@ -93,6 +93,13 @@ void xorbuf(byte *output, const byte *input, const byte *mask, size_t count)
 		output[i] = input[i] ^ mask[i];
 }
 
+void IncrementCounterBlock(byte *block, unsigned int blockSize, word32 flags)
+{
+	const unsigned int width = STDMIN(blockSize, (flags & BlockTransformation::BT_Counter64) ? 8U :
+		(flags & BlockTransformation::BT_Counter32) ? 4U : 1U);
+	IncrementCounterByOne(block+blockSize-width, width);
+}
+
 bool VerifyBufsEqual(const byte *buf, const byte *mask, size_t count)
 {
 	CRYPTOPP_ASSERT(buf != NULLPTR);
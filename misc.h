@@ -1135,6 +1135,16 @@ inline void IncrementCounterByOne(byte *output, const byte *input, unsigned int
 	memcpy_s(output, size, input, size_t(i)+1);
 }
 
+//! \brief Increments the counter of a counter mode block
+//! \param block the counter block
+//! \param blockSize the size of the block, in bytes
+//! \param flags the BlockTransformation::FlagsForAdvancedProcessBlocks passed to AdvancedProcessBlocks()
+//! \details The counter is the last 8 bytes of the block with BT_Counter64, the last 4 bytes with
+//!   BT_Counter32, and the last byte otherwise. It wraps without carrying into the rest of the block.
+//! \details IncrementCounterBlock() is out of line so it does not count against the inlining
+//!   budget of the SIMD kernels that call it for their last blocks.
+CRYPTOPP_DLL void CRYPTOPP_API IncrementCounterBlock(byte *block, unsigned int blockSize, word32 flags);
+
 //! \brief Performs a branchless swap of values a and b if condition c is true
 //! \tparam T class or type
 //! \param c the condition to perform the swap
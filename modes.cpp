@@ -6,9 +6,12 @@
 
 #include "modes.h"
 #include "misc.h"
+#include "cpu.h"
+#include "rijndael.h"
 
 #if defined(CRYPTOPP_DEBUG)
 #include "des.h"
+#include "aes.h"
 #endif
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -22,6 +25,7 @@ void Modes_TestInstantiations()
 	CTR_Mode<DES>::Encryption m3;
 	ECB_Mode<DES>::Encryption m4;
 	CBC_Mode<DES>::Encryption m5;
+	XTS_Mode<AES>::Encryption m6;
 }
 #endif
 
@@ -47,9 +51,11 @@ void CFB_ModePolicy::Iterate(byte *output, const byte *input, CipherDir dir, siz
 	}
 	else
 	{
+		// All the ciphertext is known, so the cipher can run on all of it at once. Working from the
+		//   tail lets decryption run in place, like CBC decryption.
 		memcpy(m_temp, input+(iterationCount-1)*s, s);	// make copy first in case of in-place decryption
 		if (iterationCount > 1)
-			m_cipher->AdvancedProcessBlocks(input, input+s, output+s, (iterationCount-1)*s, BlockTransformation::BT_ReverseDirection);
+			m_cipher->AdvancedProcessBlocks(input, input+s, output+s, (iterationCount-1)*s, BlockTransformation::BT_ReverseDirection|BlockTransformation::BT_AllowParallel);
 		m_cipher->ProcessAndXorBlock(m_register, input, output);
 		memcpy(m_register, m_temp, s);
 	}
@@ -114,24 +120,33 @@ void CTR_ModePolicy::SeekToIteration(lword iterationCount)
 	}
 }
 
-void CTR_ModePolicy::IncrementCounterBy256()
+void CTR_ModePolicy::IncrementCounterCarry()
 {
-	IncrementCounterByOne(m_counterArray, BlockSize()-1);
+	const unsigned int s = BlockSize(), width = (CounterFlags() & BlockTransformation::BT_Counter64) ? 8 : 4;
+	if (s > width)
+		IncrementCounterByOne(m_counterArray, s-width);
 }
 
 void CTR_ModePolicy::OperateKeystream(KeystreamOperation /*operation*/, byte *output, const byte *input, size_t iterationCount)
 {
 	CRYPTOPP_ASSERT(m_cipher->IsForwardTransformation());	// CTR mode needs the "encrypt" direction of the underlying block cipher, even to decrypt
-	unsigned int s = BlockSize();
-	unsigned int inputIncrement = input ? s : 0;
+	const unsigned int s = BlockSize();
+	const unsigned int inputIncrement = input ? s : 0;
+	const word32 flags = CounterFlags();
+	const unsigned int width = (flags & BlockTransformation::BT_Counter64) ? 8 : 4;
+	CRYPTOPP_ASSERT(s >= width);
 
 	while (iterationCount)
 	{
-		byte lsb = m_counterArray[s-1];
-		size_t blocks = UnsignedMin(iterationCount, 256U-lsb);
-		m_cipher->AdvancedProcessBlocks(m_counterArray, input, output, blocks*s, BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_AllowParallel);
-		if ((m_counterArray[s-1] = lsb + (byte)blocks) == 0)
-			IncrementCounterBy256();
+		// The cipher advances the counter, so a run only stops where the counter wraps
+		const word64 counter = (width == 8) ? GetWord<word64>(false, BIG_ENDIAN_ORDER, m_counterArray+s-8) :
+			GetWord<word32>(false, BIG_ENDIAN_ORDER, m_counterArray+s-4);
+		const word64 last = (width == 8) ? ~counter : W64LIT(0xffffffff) - counter;
+		const size_t blocks = (iterationCount-1 > last) ? size_t(last+1) : iterationCount;
+
+		m_cipher->ProcessCounterBlocks(m_counterArray, input, output, blocks*s, flags|BlockTransformation::BT_AllowParallel);
+		if (blocks-1 == last)
+			IncrementCounterCarry();
 
 		output += blocks*s;
 		input += blocks*inputIncrement;
@@ -185,6 +200,137 @@ void CBC_Encryption::ProcessData(byte *outString, const byte *inString, size_t l
 	memcpy(m_register, outString + length - blockSize, blockSize);
 }
 
+// Runs several CBC chains for the same number of blocks. AES chains run side by side
+//   through AES-NI, and chains sharing any other key use the cipher's parallel path.
+static void CBCEncryptLanes(const BlockCipher *const *ciphers, bool sameKey, byte *state, const byte *const *inputs, byte *const *outputs, unsigned int count, size_t blocks, unsigned int blockSize)
+{
+#if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
+	if (blockSize == 16 && Rijndael::Encryption::CBCEncryptWithKeys(ciphers, state, inputs, outputs, count, blocks))
+		return;
+#endif
+
+	if (sameKey)
+	{
+		for (size_t k=0; k<blocks; ++k)
+		{
+			for (unsigned int i=0; i<count; ++i)
+				xorbuf(state+i*blockSize, inputs[i]+k*blockSize, blockSize);
+			ciphers[0]->AdvancedProcessBlocks(state, NULLPTR, state, count*blockSize, BlockTransformation::BT_AllowParallel);
+			for (unsigned int i=0; i<count; ++i)
+				memcpy(outputs[i]+k*blockSize, state+i*blockSize, blockSize);
+		}
+	}
+	else
+	{
+		for (unsigned int i=0; i<count; ++i)
+		{
+			const size_t length = blocks*blockSize;
+			ciphers[i]->AdvancedProcessBlocks(inputs[i], state+i*blockSize, outputs[i], blockSize, BlockTransformation::BT_XorInput);
+			if (length > blockSize)
+				ciphers[i]->AdvancedProcessBlocks(inputs[i]+blockSize, outputs[i], outputs[i]+blockSize, length-blockSize, BlockTransformation::BT_XorInput);
+			memcpy(state+i*blockSize, outputs[i]+length-blockSize, blockSize);
+		}
+	}
+}
+
+void CBC_Encryption::ProcessStreams(Stream *streams, size_t count)
+{
+	// An object holds one chain, so a group of lanes ends before an object repeats
+	for (size_t i=0; i<count;)
+	{
+		unsigned int n = 0;
+		for (; n<STREAM_LANES && i+n<count; ++n)
+		{
+			const CBC_Encryption *mode = streams[i+n].mode ? streams[i+n].mode : this;
+			unsigned int j = 0;
+			while (j<n && (streams[i+j].mode ? streams[i+j].mode : this) != mode)
+				++j;
+			if (j < n)
+				break;
+		}
+
+		ProcessLanes(streams+i, n);
+		i += n;
+	}
+}
+
+void CBC_Encryption::ProcessLanes(Stream *streams, unsigned int count)
+{
+	const BlockCipher *ciphers[STREAM_LANES];
+	CBC_Encryption *modes[STREAM_LANES];
+	const byte *inputs[STREAM_LANES];
+	byte *outputs[STREAM_LANES];
+	size_t blocks[STREAM_LANES];
+	unsigned int order[STREAM_LANES], n = 0;
+	const unsigned int blockSize = (unsigned int)m_register.size();
+
+	// Streams whose object has a different block size, or is not keyed, are processed on their own
+	for (unsigned int i=0; i<count; ++i)
+	{
+		Stream &s = streams[i];
+		CBC_Encryption &mode = s.mode ? *s.mode : *this;
+		if (!blockSize || mode.m_register.size() != blockSize)
+		{
+			mode.ProcessData(s.output, s.input, s.length);
+			continue;
+		}
+
+		CRYPTOPP_ASSERT(s.length%blockSize == 0);
+		if (s.length < blockSize)
+			continue;
+
+		// Lanes are ordered by length, so the lanes still running are always a prefix
+		unsigned int j = n;
+		for (; j>0 && blocks[order[j-1]] < s.length/blockSize; --j)
+			order[j] = order[j-1];
+		order[j] = n;
+
+		modes[n] = &mode;
+		ciphers[n] = mode.m_cipher;
+		inputs[n] = s.input;
+		outputs[n] = s.output;
+		blocks[n++] = s.length/blockSize;
+	}
+
+	if (n == 0)
+		return;
+
+	const BlockCipher *active[STREAM_LANES];
+	const byte *in[STREAM_LANES];
+	byte *out[STREAM_LANES];
+	bool sameKey = true;
+	AlignedSecByteBlock state(n*blockSize);
+	for (unsigned int i=0; i<n; ++i)
+	{
+		const unsigned int lane = order[i];
+		active[i] = ciphers[lane];
+		in[i] = inputs[lane];
+		out[i] = outputs[lane];
+		memcpy(state+i*blockSize, modes[lane]->m_register, blockSize);
+		sameKey = sameKey && ciphers[lane] == ciphers[0];
+	}
+
+	// The streams run in stretches that end when the shortest running stream ends
+	size_t done = 0;
+	for (unsigned int running=n; running; --running)
+	{
+		const size_t end = blocks[order[running-1]];
+		if (end > done)
+		{
+			CBCEncryptLanes(active, sameKey, state, in, out, running, end-done, blockSize);
+			for (unsigned int i=0; i<running; ++i)
+			{
+				in[i] += (end-done)*blockSize;
+				out[i] += (end-done)*blockSize;
+			}
+			done = end;
+		}
+	}
+
+	for (unsigned int i=0; i<n; ++i)
+		memcpy(modes[order[i]]->m_register, state+i*blockSize, blockSize);
+}
+
 void CBC_CTS_Encryption::ProcessLastBlock(byte *outString, const byte *inString, size_t length)
 {
 	if (length <= BlockSize())
@@ -266,6 +412,216 @@ void CBC_CTS_Decryption::ProcessLastBlock(byte *outString, const byte *inString,
 	}
 }
 
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+// Multiply the tweak by x in GF(2^128). IEEE 1619 treats the tweak as a little-endian
+//   integer, so each 32-bit lane shifts left and passes its top bit to the next lane.
+inline __m128i XTS_MultiplyAlpha(const __m128i &t)
+{
+	const __m128i poly = _mm_set_epi32(1, 1, 1, 0x87);
+	const __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), _MM_SHUFFLE(2,1,0,3));
+	return _mm_xor_si128(_mm_add_epi32(t, t), _mm_and_si128(carry, poly));
+}
+#endif
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+// Multiply the tweak by x^8 in GF(2^128). The byte shifted out of the top is
+//   reduced with a carryless multiply by the polynomial x^7+x^2+x+1.
+inline __m128i XTS_MultiplyAlpha8(const __m128i &t)
+{
+	const __m128i poly = _mm_set_epi32(0, 0, 0, 0x87);
+	const __m128i carry = _mm_clmulepi64_si128(_mm_srli_si128(t, 15), poly, 0x00);
+	return _mm_xor_si128(_mm_slli_si128(t, 1), carry);
+}
+#endif
+
+void XTS_ModeBase::UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
+{
+	if (m_cipher->BlockSize() != 16)
+		throw InvalidArgument(AlgorithmName() + ": XTS requires a 128-bit block cipher");
+
+	CRYPTOPP_ASSERT(length % 2 == 0);
+	const unsigned int keyLength = length / 2;
+	m_cipher->SetKey(key, keyLength, params);
+	m_tweakCipher->SetKey(key + keyLength, keyLength, params);
+	ResizeBuffers();
+
+	size_t ivLength;
+	const byte *iv = GetIVAndThrowIfInvalid(params, ivLength);
+	Resynchronize(iv, (int)ivLength);
+}
+
+void XTS_ModeBase::ResizeBuffers()
+{
+	BlockOrientedCipherModeBase::ResizeBuffers();
+	// 256 blocks covers a 4 KiB sector in a single pass
+	m_tweaks.New(256 * BlockSize());
+}
+
+void XTS_ModeBase::Resynchronize(const byte *iv, int length)
+{
+	memcpy_s(m_register, m_register.size(), iv, ThrowIfInvalidIVLength(length));
+	m_tweakCipher->ProcessBlock(m_register);
+}
+
+void XTS_ModeBase::ResynchronizeSector(word64 sector)
+{
+	memset(m_register, 0, m_register.size());
+	PutWord(false, LITTLE_ENDIAN_ORDER, m_register.begin(), sector);
+	m_tweakCipher->ProcessBlock(m_register);
+}
+
+// Writes the next blocks tweaks to m_tweaks and advances the tweak in m_register
+void XTS_ModeBase::GenerateTweaks(size_t blocks)
+{
+	CRYPTOPP_ASSERT(BlockSize() == 16);
+	CRYPTOPP_ASSERT(blocks * 16 <= m_tweaks.size());
+	byte *tweaks = m_tweaks;
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+	if (HasSSE2())
+	{
+		__m128i t = _mm_load_si128((const __m128i *)(const void *)m_register.begin());
+		size_t i = 0;
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+		// Eight independent tweaks, each advanced by x^8 per group
+		if (HasCLMUL() && blocks >= 8)
+		{
+			__m128i x[8];
+			x[0] = t;
+			for (unsigned int j=1; j<8; ++j)
+				x[j] = XTS_MultiplyAlpha(x[j-1]);
+
+			for (; i+8 <= blocks; i+=8)
+			{
+				for (unsigned int j=0; j<8; ++j)
+				{
+					_mm_store_si128((__m128i *)(void *)(tweaks+16*(i+j)), x[j]);
+					x[j] = XTS_MultiplyAlpha8(x[j]);
+				}
+			}
+			t = x[0];
+		}
+#endif
+
+		for (; i<blocks; ++i)
+		{
+			_mm_store_si128((__m128i *)(void *)(tweaks+16*i), t);
+			t = XTS_MultiplyAlpha(t);
+		}
+
+		_mm_store_si128((__m128i *)(void *)m_register.begin(), t);
+		return;
+	}
+#endif
+
+	word64 lo = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, m_register);
+	word64 hi = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, m_register+8);
+	for (size_t i=0; i<blocks; ++i)
+	{
+		PutWord(false, LITTLE_ENDIAN_ORDER, tweaks+16*i, lo);
+		PutWord(false, LITTLE_ENDIAN_ORDER, tweaks+16*i+8, hi);
+		const word64 carry = hi >> 63;
+		hi = (hi << 1) | (lo >> 63);
+		lo = (lo << 1) ^ (0x87 & (0 - carry));
+	}
+	PutWord(false, LITTLE_ENDIAN_ORDER, m_register.begin(), lo);
+	PutWord(false, LITTLE_ENDIAN_ORDER, m_register+8, hi);
+}
+
+void XTS_ModeBase::ProcessData(byte *outString, const byte *inString, size_t length)
+{
+	CRYPTOPP_ASSERT(length%BlockSize()==0);
+
+	while (length)
+	{
+		const size_t len = STDMIN(length, m_tweaks.size());
+		GenerateTweaks(len / BlockSize());
+
+		// C = E(P ^ T) ^ T. The cipher applies the first xor, and xorbuf the second.
+		m_cipher->AdvancedProcessBlocks(inString, m_tweaks, outString, len, BlockTransformation::BT_XorInput|BlockTransformation::BT_AllowParallel);
+		xorbuf(outString, m_tweaks, len);
+
+		inString += len;
+		outString += len;
+		length -= len;
+	}
+}
+
+void XTS_ModeBase::ProcessLastBlock(byte *outString, const byte *inString, size_t length)
+{
+	const unsigned int blockSize = BlockSize();
+	if (length < blockSize)
+		throw InvalidArgument(AlgorithmName() + ": message is too short for ciphertext stealing");
+
+	const size_t tail = length % blockSize;
+	const size_t head = tail ? length - tail - blockSize : length;
+	ProcessData(outString, inString, head);
+	if (!tail)
+		return;
+
+	inString += head;
+	outString += head;
+	GenerateTweaks(2);
+
+	// Decryption processes the last full block with the second tweak
+	const byte *t0 = m_tweaks, *t1 = m_tweaks+blockSize;
+	if (!IsForwardTransformation())
+		std::swap(t0, t1);
+
+	// process next to last block, and steal from it for the last block
+	xorbuf(m_buffer, inString, t0, blockSize);
+	m_cipher->ProcessAndXorBlock(m_buffer, t0, m_buffer);
+
+	byte *last = m_tweaks+2*blockSize;
+	memcpy(last, inString+blockSize, tail);
+	memcpy(last+tail, m_buffer+tail, blockSize-tail);
+	memcpy(outString+blockSize, m_buffer, tail);
+
+	// output last full block
+	xorbuf(last, t1, blockSize);
+	m_cipher->ProcessAndXorBlock(last, t1, outString);
+}
+
+void XTS_ModeBase::ProcessSectors(byte *outString, const byte *inString, size_t sectorSize, size_t sectorCount, word64 firstSector)
+{
+	const unsigned int blockSize = BlockSize();
+	if (sectorSize < blockSize)
+		throw InvalidArgument(AlgorithmName() + ": sector size is too small for ciphertext stealing");
+
+	// Encrypt the sector tweaks eight at a time so the tweak cipher runs in parallel
+	const unsigned int batchSize = 8;
+	AlignedSecByteBlock tweaks(batchSize * blockSize);
+
+	// The sector number is a 128-bit integer, so a run past 2^64-1 carries into the high word
+	word64 sectorHigh = 0;
+
+	while (sectorCount)
+	{
+		const size_t batch = STDMIN(sectorCount, (size_t)batchSize);
+		memset(tweaks, 0, tweaks.size());
+		for (size_t i=0; i<batch; ++i)
+		{
+			const word64 sector = firstSector+i;
+			PutWord(false, LITTLE_ENDIAN_ORDER, tweaks+i*blockSize, sector);
+			PutWord(false, LITTLE_ENDIAN_ORDER, tweaks+i*blockSize+8, word64(sectorHigh + (sector < firstSector)));
+		}
+		m_tweakCipher->AdvancedProcessBlocks(tweaks, NULLPTR, tweaks, batch*blockSize, BlockTransformation::BT_AllowParallel);
+
+		for (size_t i=0; i<batch; ++i)
+		{
+			memcpy(m_register, tweaks+i*blockSize, blockSize);
+			ProcessLastBlock(outString, inString, sectorSize);
+			inString += sectorSize;
+			outString += sectorSize;
+		}
+
+		firstSector += batch;
+		sectorHigh += (firstSector < batch);
+		sectorCount -= batch;
+	}
+}
+
 NAMESPACE_END
 
 #endif
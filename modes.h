@@ -170,7 +170,14 @@ public:
 	IV_Requirement IVRequirement() const {return RANDOM_IV;}
 
 protected:
-	virtual void IncrementCounterBy256();
+	//! \brief Flags that describe the counter to AdvancedProcessBlocks()
+	//! \details The default is a 64-bit big-endian counter in the last 8 bytes of the block,
+	//!   which the block cipher advances over the whole run. A mode with a 32-bit counter,
+	//!   like GCM or RFC 3686, returns BT_Counter32 instead.
+	virtual word32 CounterFlags() const
+		{return BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_Counter64;}
+	//! \brief Carries into the rest of the block after the counter wraps
+	virtual void IncrementCounterCarry();
 	unsigned int GetAlignment() const {return m_cipher->OptimalDataAlignment();}
 	unsigned int GetBytesPerIteration() const {return BlockSize();}
 	unsigned int GetIterationsToBuffer() const {return m_cipher->OptimalNumberOfParallelBlocks();}
@@ -236,6 +243,35 @@ class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE CBC_Encryption : public CBC_ModeBase
 {
 public:
 	void ProcessData(byte *outString, const byte *inString, size_t length);
+
+	//! \brief A stream in a multi-stream call
+	//! \details \p mode is the stream's CBC encryption object, or NULL to use the object that
+	//!   processes the streams. The \p length is a multiple of the block size, as it is for
+	//!   ProcessData().
+	struct Stream
+	{
+		Stream() : mode(NULLPTR), output(NULLPTR), input(NULLPTR), length(0) {}
+
+		CBC_Encryption *mode;
+		byte *output;
+		const byte *input;
+		size_t length;
+	};
+
+	//! \brief Encrypts data on several independent streams
+	//! \param streams the streams
+	//! \param count the number of streams
+	//! \details ProcessStreams() has the same effect as calling ProcessData() on each stream's
+	//!   object in turn, and leaves each object ready to continue its stream. CBC encryption is
+	//!   serial within a stream, so the call runs the chains of up to eight streams side by side.
+	//!   Streams with the same key use the cipher's parallel path, and AES streams with
+	//!   different keys use AES-NI directly. Streams on the same object are processed in order.
+	void ProcessStreams(Stream *streams, size_t count);
+
+protected:
+	void ProcessLanes(Stream *streams, unsigned int count);
+
+	enum {STREAM_LANES = 8};
 };
 
 //! \class CBC_CTS_Encryption
@@ -282,6 +318,63 @@ public:
 	void ProcessLastBlock(byte *outString, const byte *inString, size_t length);
 };
 
+//! \class XTS_ModeBase
+//! \brief XTS block cipher mode of operation default implementation
+//! \details XTS_ModeBase holds the data cipher in m_cipher and the tweak cipher in m_tweakCipher.
+//!   The key is the data key followed by the tweak key, so it is twice the length of the
+//!   block cipher's key. The IV is the 16-byte tweak, which is the little-endian data unit
+//!   sequence number in IEEE 1619. The direction of the data cipher selects encryption or decryption.
+//! \details ProcessData() continues the current data unit, and ProcessLastBlock() finishes it
+//!   using ciphertext stealing when the data unit is not a multiple of the block size.
+//! \since Crypto++ 6.0
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE XTS_ModeBase : public BlockOrientedCipherModeBase
+{
+public:
+	CRYPTOPP_STATIC_CONSTEXPR const char* CRYPTOPP_API StaticAlgorithmName() {return "XTS";}
+
+	virtual ~XTS_ModeBase() {}
+	size_t MinKeyLength() const {return 2*m_cipher->MinKeyLength();}
+	size_t MaxKeyLength() const {return 2*m_cipher->MaxKeyLength();}
+	size_t DefaultKeyLength() const {return 2*m_cipher->DefaultKeyLength();}
+	size_t GetValidKeyLength(size_t n) const {return 2*m_cipher->GetValidKeyLength(n/2);}
+	bool IsValidKeyLength(size_t n) const {return n%2 == 0 && m_cipher->IsValidKeyLength(n/2);}
+
+	IV_Requirement IVRequirement() const {return UNIQUE_IV;}
+	unsigned int OptimalBlockSize() const {return BlockSize() * m_cipher->OptimalNumberOfParallelBlocks();}
+	unsigned int MinLastBlockSize() const {return BlockSize()+1;}
+
+	void Resynchronize(const byte *iv, int length=-1);
+	void ProcessData(byte *outString, const byte *inString, size_t length);
+	void ProcessLastBlock(byte *outString, const byte *inString, size_t length);
+
+	//! \brief Resynchronize with a sector number
+	//! \param sector the data unit sequence number
+	//! \details The tweak is the sector number encoded as a 16-byte little-endian integer.
+	void ResynchronizeSector(word64 sector);
+
+	//! \brief Encrypts or decrypts consecutive sectors
+	//! \param outString the output byte buffer
+	//! \param inString the input byte buffer
+	//! \param sectorSize the size of each sector, in bytes
+	//! \param sectorCount the number of sectors
+	//! \param firstSector the sector number of the first sector
+	//! \details Sector <tt>i</tt> is processed as a complete data unit with the tweak
+	//!   <tt>firstSector+i</tt>, computed as a 128-bit integer, so a run that passes 2^64-1
+	//!   continues at 2^64 rather than wrapping to 0. The tweaks are encrypted in batches, and
+	//!   sectors that are not a multiple of the block size use ciphertext stealing. Call
+	//!   Resynchronize() or ResynchronizeSector() before calling ProcessData() again.
+	void ProcessSectors(byte *outString, const byte *inString, size_t sectorSize, size_t sectorCount, word64 firstSector);
+
+protected:
+	XTS_ModeBase() : m_tweakCipher(NULLPTR) {}
+	void UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params);
+	virtual void ResizeBuffers();
+	void GenerateTweaks(size_t blocks);
+
+	BlockCipher *m_tweakCipher;
+	AlignedSecByteBlock m_tweaks;
+};
+
 //! \class CipherModeFinalTemplate_CipherHolder
 //! \brief Block cipher mode of operation aggregate
 template <class CIPHER, class BASE>
@@ -465,6 +558,54 @@ struct CBC_CTS_Mode_ExternalCipher : public CipherModeDocumentation
 	typedef CipherModeFinalTemplate_ExternalCipher<CBC_CTS_Decryption> Decryption;
 };
 
+//! \class XTS_FinalTemplate_CipherHolder
+//! \brief XTS block cipher mode of operation aggregate
+//! \tparam CIPHER the data cipher, either CIPHER::Encryption or CIPHER::Decryption
+//! \tparam TWEAK_CIPHER the tweak cipher, which is always CIPHER::Encryption
+template <class CIPHER, class TWEAK_CIPHER>
+class XTS_FinalTemplate_CipherHolder : protected ObjectHolder<CIPHER>, public AlgorithmImpl<XTS_ModeBase, XTS_FinalTemplate_CipherHolder<CIPHER, TWEAK_CIPHER> >
+{
+public:
+	static std::string CRYPTOPP_API StaticAlgorithmName()
+		{return CIPHER::StaticAlgorithmName() + "/" + XTS_ModeBase::StaticAlgorithmName();}
+
+	XTS_FinalTemplate_CipherHolder()
+	{
+		this->m_cipher = &this->m_object;
+		this->m_tweakCipher = &m_tweakObject;
+		this->ResizeBuffers();
+	}
+	XTS_FinalTemplate_CipherHolder(const byte *key, size_t length)
+	{
+		this->m_cipher = &this->m_object;
+		this->m_tweakCipher = &m_tweakObject;
+		this->SetKey(key, length);
+	}
+	XTS_FinalTemplate_CipherHolder(const byte *key, size_t length, const byte *iv)
+	{
+		this->m_cipher = &this->m_object;
+		this->m_tweakCipher = &m_tweakObject;
+		this->SetKey(key, length, MakeParameters(Name::IV(), ConstByteArrayParameter(iv, this->m_cipher->BlockSize())));
+	}
+
+protected:
+	TWEAK_CIPHER m_tweakObject;
+};
+
+//! \class XTS_Mode
+//! \brief XTS block cipher mode of operation
+//! \details XTS is the IEEE 1619 mode for sector-based storage encryption. It requires a
+//!   128-bit block cipher, and the key is twice the length of the block cipher's key.
+//!   Messages that are not a multiple of the block size use ciphertext stealing.
+//! \sa <A HREF="http://standards.ieee.org/findstds/standard/1619-2007.html">IEEE 1619-2007</A>
+//! \since Crypto++ 6.0
+template <class CIPHER>
+struct XTS_Mode : public CipherModeDocumentation
+{
+	typedef XTS_FinalTemplate_CipherHolder<typename CIPHER::Encryption, typename CIPHER::Encryption> Encryption;
+	typedef XTS_FinalTemplate_CipherHolder<typename CIPHER::Decryption, typename CIPHER::Encryption> Decryption;
+};
+
 //#ifdef CRYPTOPP_MAINTAIN_BACKWARDS_COMPATIBILITY
 //typedef CFB_Mode_ExternalCipher::Encryption CFBEncryption;
 //typedef CFB_Mode_ExternalCipher::Decryption CFBDecryption;
@@ -0,0 +1,250 @@
+// ocb.cpp - written and placed in the public domain
+
+#include "pch.h"
+#include "ocb.h"
+#include "misc.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Doubling in GF(2^128) with the big-endian convention of RFC 7253
+inline void OCB_Double(byte *out, const byte *in)
+{
+	const byte carry = byte(in[0] >> 7);
+	for (unsigned int i=0; i<15; ++i)
+		out[i] = byte((in[i] << 1) | (in[i+1] >> 7));
+	out[15] = byte((in[15] << 1) ^ (carry * 0x87));
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void OCB_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+{
+	BlockCipher &blockCipher = AccessBlockCipher();
+
+	blockCipher.SetKey(userKey, keylength, params);
+
+	if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	if (!IsForwardTransformation())
+		AccessMessageCipher().SetKey(userKey, keylength, params);
+
+	m_digestSize = params.GetIntValueWithDefault(Name::DigestSize(), DefaultDigestSize());
+	if (m_digestSize < 1 || m_digestSize > 16)
+		throw InvalidArgument(AlgorithmName() + ": DigestSize must be between 1 and 16");
+
+	m_buffer.Grow(REQUIRED_BLOCKSIZE);
+	m_table.New(TABLE_BLOCKS*REQUIRED_BLOCKSIZE);
+	m_offsets.New(OFFSET_BLOCKS*REQUIRED_BLOCKSIZE);
+	m_offset.New(REQUIRED_BLOCKSIZE);
+	m_checksum.New(REQUIRED_BLOCKSIZE);
+	m_headerOffset.New(REQUIRED_BLOCKSIZE);
+	m_headerSum.New(REQUIRED_BLOCKSIZE);
+
+	// L_* = E(0), L_$ = double(L_*), L_0 = double(L_$), L_i = double(L_{i-1})
+	byte *table = m_table;
+	memset(table, 0, REQUIRED_BLOCKSIZE);
+	blockCipher.ProcessBlock(table);
+	for (unsigned int i=1; i<2+L_COUNT; ++i)
+		OCB_Double(table+i*REQUIRED_BLOCKSIZE, table+(i-1)*REQUIRED_BLOCKSIZE);
+
+	// Offsets of blocks 1 to 7 of a group, relative to the offset before the group
+	byte *group = table+(2+L_COUNT)*REQUIRED_BLOCKSIZE;
+	const unsigned int ntz[7] = {0, 1, 0, 2, 0, 1, 0};
+	memcpy(group, L(0), REQUIRED_BLOCKSIZE);
+	for (unsigned int i=1; i<7; ++i)
+		xorbuf(group+i*REQUIRED_BLOCKSIZE, group+(i-1)*REQUIRED_BLOCKSIZE, L(ntz[i]), REQUIRED_BLOCKSIZE);
+}
+
+void OCB_Base::Resync(const byte *iv, size_t len)
+{
+	CRYPTOPP_ASSERT(len >= 1 && len <= 15);
+
+	// Nonce = num2str(TAGLEN mod 128, 7) || zeros || 1 || N
+	byte *nonce = m_offsets, *ktop = m_offsets+REQUIRED_BLOCKSIZE;
+	memset(nonce, 0, REQUIRED_BLOCKSIZE);
+	nonce[0] = byte(((m_digestSize*8) % 128) << 1);
+	nonce[REQUIRED_BLOCKSIZE-1-len] |= 1;
+	memcpy(nonce+REQUIRED_BLOCKSIZE-len, iv, len);
+
+	const unsigned int bottom = nonce[REQUIRED_BLOCKSIZE-1] & 0x3f;
+	nonce[REQUIRED_BLOCKSIZE-1] &= 0xc0;
+
+	// Stretch = Ktop || (Ktop[1..64] xor Ktop[9..72])
+	AccessBlockCipher().ProcessBlock(nonce, ktop);
+	xorbuf(ktop+REQUIRED_BLOCKSIZE, ktop, ktop+1, 8);
+
+	// Offset_0 = Stretch[1+bottom..128+bottom]
+	const unsigned int byteShift = bottom / 8, bitShift = bottom % 8;
+	for (unsigned int i=0; i<REQUIRED_BLOCKSIZE; ++i)
+		m_offset[i] = bitShift ? byte((ktop[i+byteShift] << bitShift) | (ktop[i+byteShift+1] >> (8-bitShift))) : ktop[i+byteShift];
+
+	memset(m_checksum, 0, REQUIRED_BLOCKSIZE);
+	memset(m_headerOffset, 0, REQUIRED_BLOCKSIZE);
+	memset(m_headerSum, 0, REQUIRED_BLOCKSIZE);
+	m_messageBlocks = m_headerBlocks = 0;
+}
+
+// Writes the offsets of the next blocks to m_offsets, and advances offset and index
+void OCB_Base::GenerateOffsets(byte *offset, word64 &index, size_t blocks)
+{
+	CRYPTOPP_ASSERT(blocks <= OFFSET_BLOCKS);
+	byte *out = m_offsets;
+	size_t i = 0;
+
+	while (i < blocks)
+	{
+		if ((index % 8) == 0 && blocks-i >= 8)
+		{
+			// Eight offsets at once. Within a group ntz(i) is 0,1,0,2,0,1,0, so blocks 1
+			//   to 7 are a fixed offset from the start of the group, and only block 8 varies.
+			const unsigned int last = TrailingZeros(index+8);
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+			if (HasSSE2())
+			{
+				__m128i o = _mm_load_si128((const __m128i *)(const void *)offset);
+				for (unsigned int j=1; j<8; ++j)
+					_mm_store_si128((__m128i *)(void *)(out+16*(i+j-1)), _mm_xor_si128(o,
+						_mm_load_si128((const __m128i *)(const void *)GroupOffset(j))));
+				o = _mm_xor_si128(o, _mm_load_si128((const __m128i *)(const void *)GroupOffset(7)));
+				o = _mm_xor_si128(o, _mm_load_si128((const __m128i *)(const void *)L(last)));
+				_mm_store_si128((__m128i *)(void *)(out+16*(i+7)), o);
+				_mm_store_si128((__m128i *)(void *)offset, o);
+			}
+			else
+#endif
+			{
+				for (unsigned int j=1; j<8; ++j)
+					xorbuf(out+16*(i+j-1), offset, GroupOffset(j), 16);
+				xorbuf(offset, GroupOffset(7), 16);
+				xorbuf(offset, L(last), 16);
+				memcpy(out+16*(i+7), offset, 16);
+			}
+			index += 8;
+			i += 8;
+		}
+		else
+		{
+			xorbuf(offset, L(TrailingZeros(++index)), 16);
+			memcpy(out+16*i, offset, 16);
+			++i;
+		}
+	}
+}
+
+void OCB_Base::ProcessMessage(byte *outString, const byte *inString, size_t length)
+{
+	BlockCipher &cipher = AccessMessageCipher();
+	const size_t tail = length % REQUIRED_BLOCKSIZE;
+	size_t full = length - tail;
+
+	while (full)
+	{
+		const size_t len = STDMIN(full, m_offsets.size());
+		GenerateOffsets(m_offset, m_messageBlocks, len/REQUIRED_BLOCKSIZE);
+
+		// C_i = Offset_i ^ E(P_i ^ Offset_i). The cipher applies the first xor, and xorbuf the second.
+		cipher.AdvancedProcessBlocks(inString, m_offsets, outString, len, BlockTransformation::BT_XorInput|BlockTransformation::BT_AllowParallel);
+		xorbuf(outString, m_offsets, len);
+
+		inString += len;
+		outString += len;
+		full -= len;
+	}
+
+	if (tail)
+	{
+		// Offset_* = Offset_m ^ L_*, C_* = P_* ^ E(Offset_*)
+		byte *pad = m_offsets;
+		xorbuf(m_offset, L_Star(), REQUIRED_BLOCKSIZE);
+		AccessBlockCipher().ProcessBlock(m_offset, pad);
+		xorbuf(outString, inString, pad, tail);
+	}
+}
+
+size_t OCB_Base::AuthenticateBlocks(const byte *data, size_t len)
+{
+	size_t blocks = len / REQUIRED_BLOCKSIZE;
+
+	if (m_state == State_IVSet)
+	{
+		// Sum_i = Sum_{i-1} ^ E(A_i ^ Offset_i)
+		BlockCipher &cipher = AccessBlockCipher();
+		while (blocks)
+		{
+			const size_t count = STDMIN(blocks, (size_t)OFFSET_BLOCKS);
+			GenerateOffsets(m_headerOffset, m_headerBlocks, count);
+			cipher.AdvancedProcessBlocks(data, m_offsets, m_offsets, count*REQUIRED_BLOCKSIZE, BlockTransformation::BT_XorInput|BlockTransformation::BT_AllowParallel);
+			for (size_t i=0; i<count; ++i)
+				xorbuf(m_headerSum, m_offsets+i*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+
+			data += count*REQUIRED_BLOCKSIZE;
+			blocks -= count;
+		}
+	}
+	else
+	{
+		// Checksum_i = Checksum_{i-1} ^ P_i
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		if (HasSSE2())
+		{
+			__m128i checksum = _mm_load_si128((const __m128i *)(const void *)m_checksum.begin());
+			for (size_t i=0; i<blocks; ++i, data+=REQUIRED_BLOCKSIZE)
+				checksum = _mm_xor_si128(checksum, _mm_loadu_si128((const __m128i *)(const void *)data));
+			_mm_store_si128((__m128i *)(void *)m_checksum.begin(), checksum);
+		}
+		else
+#endif
+		{
+			for (size_t i=0; i<blocks; ++i, data+=REQUIRED_BLOCKSIZE)
+				xorbuf(m_checksum, data, REQUIRED_BLOCKSIZE);
+		}
+	}
+
+	return len % REQUIRED_BLOCKSIZE;
+}
+
+void OCB_Base::AuthenticateLastHeaderBlock()
+{
+	if (m_bufferedDataLength)
+	{
+		// Sum = Sum_m ^ E((A_* || 1 || zeros) ^ Offset_*)
+		byte *data = m_buffer;
+		const unsigned int num = m_bufferedDataLength;
+		data[num] = 0x80;
+		memset(data+num+1, 0, REQUIRED_BLOCKSIZE-num-1);
+
+		xorbuf(m_headerOffset, L_Star(), REQUIRED_BLOCKSIZE);
+		xorbuf(data, m_headerOffset, REQUIRED_BLOCKSIZE);
+		AccessBlockCipher().ProcessBlock(data);
+		xorbuf(m_headerSum, data, REQUIRED_BLOCKSIZE);
+	}
+}
+
+void OCB_Base::AuthenticateLastConfidentialBlock()
+{
+	if (m_bufferedDataLength)
+	{
+		// Checksum_* = Checksum_m ^ (P_* || 1 || zeros)
+		byte *data = m_buffer;
+		const unsigned int num = m_bufferedDataLength;
+		data[num] = 0x80;
+		memset(data+num+1, 0, REQUIRED_BLOCKSIZE-num-1);
+		xorbuf(m_checksum, data, REQUIRED_BLOCKSIZE);
+	}
+}
+
+void OCB_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
+{
+	// Tag = E(Checksum ^ Offset ^ L_$) ^ HASH(K,A)
+	byte *tag = m_buffer;
+	xorbuf(tag, m_checksum, m_offset, REQUIRED_BLOCKSIZE);
+	xorbuf(tag, L_Dollar(), REQUIRED_BLOCKSIZE);
+	AccessBlockCipher().ProcessBlock(tag);
+	xorbuf(mac, tag, m_headerSum, macSize);
+}
+
+NAMESPACE_END
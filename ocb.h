@@ -0,0 +1,186 @@
+// ocb.h - written and placed in the public domain
+
+//! \file ocb.h
+//! \brief OCB block cipher mode of operation
+//! \details OCB is the one-pass authenticated encryption mode from RFC 7253. Each block is
+//!   encrypted with a whitening offset, so full groups of blocks run through the block
+//!   cipher's AdvancedProcessBlocks() in parallel.
+//! \since Crypto++ 6.0
+
+#ifndef CRYPTOPP_OCB_H
+#define CRYPTOPP_OCB_H
+
+#include "authenc.h"
+#include "modes.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+//! \class OCB_Base
+//! \brief OCB block cipher base implementation
+//! \details Base implementation of the AuthenticatedSymmetricCipher interface.
+//!   The message is processed in whole blocks until the last call, so OCB_Base reports a
+//!   MandatoryBlockSize() of 16 and a MinLastBlockSize() of 17, like CBC_CTS_Mode.
+//!   AuthenticatedEncryptionFilter and AuthenticatedDecryptionFilter take care of this.
+//! \since Crypto++ 6.0
+class CRYPTOPP_NO_VTABLE OCB_Base : public AuthenticatedSymmetricCipherBase
+{
+public:
+	OCB_Base()
+		: m_digestSize(0), m_messageBlocks(0), m_headerBlocks(0), m_messageCipher(*this) {}
+
+	// AuthenticatedSymmetricCipher
+	std::string AlgorithmName() const
+		{return GetBlockCipher().AlgorithmName() + std::string("/OCB");}
+	size_t MinKeyLength() const
+		{return GetBlockCipher().MinKeyLength();}
+	size_t MaxKeyLength() const
+		{return GetBlockCipher().MaxKeyLength();}
+	size_t DefaultKeyLength() const
+		{return GetBlockCipher().DefaultKeyLength();}
+	size_t GetValidKeyLength(size_t keylength) const
+		{return GetBlockCipher().GetValidKeyLength(keylength);}
+	bool IsValidKeyLength(size_t keylength) const
+		{return GetBlockCipher().IsValidKeyLength(keylength);}
+	unsigned int OptimalDataAlignment() const
+		{return GetBlockCipher().OptimalDataAlignment();}
+	IV_Requirement IVRequirement() const
+		{return UNIQUE_IV;}
+	unsigned int IVSize() const
+		{return 12;}
+	unsigned int MinIVLength() const
+		{return 1;}
+	unsigned int MaxIVLength() const
+		{return 15;}
+	unsigned int DigestSize() const
+		{return m_digestSize;}
+	lword MaxHeaderLength() const
+		{return LWORD_MAX;}
+	lword MaxMessageLength() const
+		{return LWORD_MAX;}
+
+	// StreamTransformation
+	unsigned int MandatoryBlockSize() const
+		{return REQUIRED_BLOCKSIZE;}
+	unsigned int OptimalBlockSize() const
+		{return REQUIRED_BLOCKSIZE * GetBlockCipher().OptimalNumberOfParallelBlocks();}
+	unsigned int MinLastBlockSize() const
+		{return REQUIRED_BLOCKSIZE+1;}
+	void ProcessLastBlock(byte *outString, const byte *inString, size_t length)
+		{ProcessData(outString, inString, length);}
+
+protected:
+	// AuthenticatedSymmetricCipherBase
+	bool AuthenticationIsOnPlaintext() const
+		{return true;}
+	unsigned int AuthenticationBlockSize() const
+		{return REQUIRED_BLOCKSIZE;}
+	void SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params);
+	void Resync(const byte *iv, size_t len);
+	size_t AuthenticateBlocks(const byte *data, size_t len);
+	void AuthenticateLastHeaderBlock();
+	void AuthenticateLastConfidentialBlock();
+	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	SymmetricCipher & AccessSymmetricCipher() {return m_messageCipher;}
+
+	//! \brief The block cipher in the encryption direction
+	virtual BlockCipher & AccessBlockCipher() =0;
+	//! \brief The block cipher in the direction of the message transformation
+	virtual BlockCipher & AccessMessageCipher() =0;
+	virtual int DefaultDigestSize() const =0;
+
+	const BlockCipher & GetBlockCipher() const {return const_cast<OCB_Base *>(this)->AccessBlockCipher();};
+
+	void ProcessMessage(byte *outString, const byte *inString, size_t length);
+	void GenerateOffsets(byte *offset, word64 &index, size_t blocks);
+
+	//! \brief Message transformation
+	//! \details MessageCipher hands the message to OCB_Base::ProcessMessage(), which
+	//!   applies the offsets. It exists so OCB can use AuthenticatedSymmetricCipherBase.
+	class CRYPTOPP_NO_VTABLE MessageCipher : public SymmetricCipher
+	{
+	public:
+		MessageCipher(OCB_Base &ocb) : m_ocb(ocb) {}
+
+		size_t MinKeyLength() const {return 0;}
+		size_t MaxKeyLength() const {return 0;}
+		size_t DefaultKeyLength() const {return 0;}
+		size_t GetValidKeyLength(size_t keylength) const {CRYPTOPP_UNUSED(keylength); return 0;}
+		IV_Requirement IVRequirement() const {return NOT_RESYNCHRONIZABLE;}
+		unsigned int MandatoryBlockSize() const {return REQUIRED_BLOCKSIZE;}
+		bool IsRandomAccess() const {return false;}
+		bool IsSelfInverting() const {return false;}
+		bool IsForwardTransformation() const {return m_ocb.IsForwardTransformation();}
+		void ProcessData(byte *outString, const byte *inString, size_t length)
+			{m_ocb.ProcessMessage(outString, inString, length);}
+
+	protected:
+		void UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
+			{CRYPTOPP_UNUSED(key), CRYPTOPP_UNUSED(length), CRYPTOPP_UNUSED(params); CRYPTOPP_ASSERT(false);}
+
+	private:
+		MessageCipher & operator=(const MessageCipher &);
+		OCB_Base &m_ocb;
+	};
+
+	// L_*, L_$, L_0 ... L_63, then the offsets of blocks 1 to 7 of a group of 8 relative to the
+	//   start of the group. Block 8 of a group adds L_2 ^ L_ntz(i) to block 0.
+	enum {REQUIRED_BLOCKSIZE = 16, L_COUNT = 64, TABLE_BLOCKS = 2+L_COUNT+7, OFFSET_BLOCKS = 128};
+	const byte *L_Star() const {return m_table;}
+	const byte *L_Dollar() const {return m_table+REQUIRED_BLOCKSIZE;}
+	const byte *L(unsigned int i) const {return m_table+(2+i)*REQUIRED_BLOCKSIZE;}
+	const byte *GroupOffset(unsigned int i) const {return m_table+(2+L_COUNT+i-1)*REQUIRED_BLOCKSIZE;}
+
+	int m_digestSize;
+	word64 m_messageBlocks, m_headerBlocks;
+	AlignedSecByteBlock m_table, m_offsets;
+	AlignedSecByteBlock m_offset, m_checksum, m_headerOffset, m_headerSum;
+	MessageCipher m_messageCipher;
+};
+
+//! \class OCB_Final
+//! \brief OCB block cipher final implementation
+//! \tparam T_BlockCipher block cipher
+//! \tparam T_DefaultDigestSize default digest size, in bytes
+//! \tparam T_IsEncryption direction in which to operate the cipher
+//! \details Decryption keys both directions of the block cipher. The header, the nonce
+//!   and the tag always use the encryption direction.
+//! \since Crypto++ 6.0
+template <class T_BlockCipher, int T_DefaultDigestSize, bool T_IsEncryption>
+class OCB_Final : public OCB_Base
+{
+public:
+	static std::string StaticAlgorithmName()
+		{return T_BlockCipher::StaticAlgorithmName() + std::string("/OCB");}
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+
+private:
+	BlockCipher & AccessBlockCipher() {return m_cipher;}
+	BlockCipher & AccessMessageCipher()
+		{return T_IsEncryption ? static_cast<BlockCipher &>(m_cipher) : static_cast<BlockCipher &>(m_decipher);}
+	int DefaultDigestSize() const {return T_DefaultDigestSize;}
+	typename T_BlockCipher::Encryption m_cipher;
+	typename T_BlockCipher::Decryption m_decipher;
+};
+
+//! \class OCB
+//! \brief OCB block cipher mode of operation
+//! \tparam T_BlockCipher block cipher
+//! \tparam T_DefaultDigestSize default digest size, in bytes
+//! \details \p OCB provides the \p Encryption and \p Decryption typedef. See OCB_Base
+//!   and OCB_Final for the AuthenticatedSymmetricCipher implementation.
+//! \details OCB requires a 128-bit block cipher. The nonce is 1 to 15 bytes, and the
+//!   default is 12 bytes. The tag size is part of the nonce, so a different tag size is
+//!   selected with the Name::DigestSize() parameter when the key is set, not by truncation.
+//! \sa <a href="https://tools.ietf.org/html/rfc7253">RFC 7253, The OCB Authenticated-Encryption Algorithm</a>
+//! \since Crypto++ 6.0
+template <class T_BlockCipher, int T_DefaultDigestSize = 16>
+struct OCB : public AuthenticatedSymmetricCipherDocumentation
+{
+	typedef OCB_Final<T_BlockCipher, T_DefaultDigestSize, true> Encryption;
+	typedef OCB_Final<T_BlockCipher, T_DefaultDigestSize, false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
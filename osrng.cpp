@@ -18,6 +18,8 @@
 
 #include "osrng.h"
 #include "rng.h"
+#include "chacha.h"
+#include "trdlocal.h"
 
 #ifdef CRYPTOPP_WIN32_AVAILABLE
 #define WIN32_LEAN_AND_MEAN
@@ -50,8 +52,73 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAS_PTHREADS
+#include <pthread.h>
+#endif
+
+// getrandom() is Linux 3.17 and above. The system call is used directly because the
+//   glibc wrapper is 2.25 and above. ENOSYS at runtime falls back to /dev/urandom.
+#if defined(__linux__) && !defined(CRYPTOPP_DISABLE_GETRANDOM)
+# include <sys/syscall.h>
+# if defined(SYS_getrandom)
+#  define CRYPTOPP_GETRANDOM_AVAILABLE 1
+#  ifndef GRND_NONBLOCK
+#   define GRND_NONBLOCK 0x0001
+#  endif
+# endif
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+#ifdef HAS_PTHREADS
+// Set on first use, and again in the child after a fork
+pthread_once_t s_processIdOnce = PTHREAD_ONCE_INIT;
+volatile pid_t s_processId = 0;
+
+void UpdateProcessId()
+{
+	s_processId = getpid();
+}
+
+void RegisterProcessId()
+{
+	UpdateProcessId();
+	pthread_atfork(NULLPTR, NULLPTR, UpdateProcessId);
+}
+
+// Buffered generators compare this to the value saved when they were filled
+inline unsigned long CurrentProcessId()
+{
+	pthread_once(&s_processIdOnce, RegisterProcessId);
+	return static_cast<unsigned long>(s_processId);
+}
+#else
+inline unsigned long CurrentProcessId()
+{
+	return 0;
+}
+#endif
+
+#if CRYPTOPP_GETRANDOM_AVAILABLE
+// Probes the kernel once. A race only repeats the probe. EAGAIN means the pool is not
+//   initialized yet, and anything else, like ENOSYS or a seccomp filter, uses /dev/urandom.
+bool GetRandomAvailable()
+{
+	static volatile int s_available = -1;
+	if (s_available < 0)
+	{
+		byte unused;
+		const long ret = syscall(SYS_getrandom, &unused, 0, GRND_NONBLOCK);
+		s_available = (ret == 0 || errno == EAGAIN || errno == EINTR) ? 1 : 0;
+	}
+	return s_available == 1;
+}
+#endif
+
+ANONYMOUS_NAMESPACE_END
+
 #if defined(NONBLOCKING_RNG_AVAILABLE) || defined(BLOCKING_RNG_AVAILABLE)
 OS_RNG_Err::OS_RNG_Err(const std::string &operation)
 	: Exception(OTHER_ERROR, "OS_Rng: " + operation + " operation failed with error " +
@@ -126,9 +193,15 @@ MicrosoftCryptoProvider::~MicrosoftCryptoProvider()
 
 #endif  // CRYPTOPP_WIN32_AVAILABLE
 
-NonblockingRng::NonblockingRng()
+NonblockingRng::NonblockingRng(bool buffered)
+	: m_available(0), m_processId(0), m_buffered(buffered)
 {
 #ifndef CRYPTOPP_WIN32_AVAILABLE
+	m_fd = -1;
+# if CRYPTOPP_GETRANDOM_AVAILABLE
+	if (GetRandomAvailable())
+		return;
+# endif
 	m_fd = open("/dev/urandom",O_RDONLY);
 	if (m_fd == -1)
 		throw OS_RNG_Err("open /dev/urandom");
@@ -138,11 +211,52 @@ NonblockingRng::NonblockingRng()
 NonblockingRng::~NonblockingRng()
 {
 #ifndef CRYPTOPP_WIN32_AVAILABLE
-	close(m_fd);
+	if (m_fd != -1)
+		close(m_fd);
 #endif
 }
 
+void NonblockingRng::Reseed()
+{
+	std::memset(m_buffer, 0, m_buffer.size());
+	m_available = 0;
+}
+
 void NonblockingRng::GenerateBlock(byte *output, size_t size)
+{
+	if (!m_buffered || size >= SMALL_REQUEST)
+	{
+		GenerateFromOS(output, size);
+		return;
+	}
+
+	// A child process must not hand out the bytes its parent buffered
+	const unsigned long processId = CurrentProcessId();
+	if (m_processId != processId)
+	{
+		Reseed();
+		m_processId = processId;
+	}
+
+	while (size)
+	{
+		if (m_available == 0)
+		{
+			GenerateFromOS(m_buffer, m_buffer.size());
+			m_available = m_buffer.size();
+		}
+
+		const size_t len = STDMIN(size, m_available);
+		byte *p = m_buffer + m_buffer.size() - m_available;
+		std::memcpy(output, p, len);
+		std::memset(p, 0, len);
+
+		m_available -= len;
+		output += len; size -= len;
+	}
+}
+
+void NonblockingRng::GenerateFromOS(byte *output, size_t size)
 {
 #ifdef CRYPTOPP_WIN32_AVAILABLE
 	// Acquiring a provider is expensive. Do it once and retain the reference.
@@ -160,6 +274,24 @@ void NonblockingRng::GenerateBlock(byte *output, size_t size)
 	}
 # endif
 #else
+# if CRYPTOPP_GETRANDOM_AVAILABLE
+	// Reads of 256 bytes or less are not interrupted once the pool is initialized
+	while (m_fd == -1 && size)
+	{
+		const long len = syscall(SYS_getrandom, output, size, 0);
+		if (len < 0)
+		{
+			if (errno != EINTR)
+				throw OS_RNG_Err("getrandom");
+
+			continue;
+		}
+
+		output += len;
+		size -= len;
+	}
+# endif
+
 	while (size)
 	{
 		ssize_t len = read(m_fd, output, size);
@@ -254,6 +386,11 @@ void OS_GenerateRandomBlock(bool blocking, byte *output, size_t size)
 	}
 }
 
+unsigned long OS_ProcessId()
+{
+	return CurrentProcessId();
+}
+
 void AutoSeededRandomPool::Reseed(bool blocking, unsigned int seedSize)
 {
 	SecByteBlock seed(seedSize);
@@ -261,6 +398,146 @@ void AutoSeededRandomPool::Reseed(bool blocking, unsigned int seedSize)
 	IncorporateEntropy(seed, seedSize);
 }
 
+// *************************************************************
+
+#if defined(NONBLOCKING_RNG_AVAILABLE) && defined(THREADS_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// One refill is 12 ChaCha20 blocks. The first 32 bytes are the next key and the
+//   rest is handed out, which is fast key erasure as described by Bernstein.
+struct ThreadLocalRNGState
+{
+	enum {KEY_SIZE = 32, BUFFER_SIZE = 12*64};
+
+	ThreadLocalRNGState() : m_available(0), m_processId(0) {}
+
+	FixedSizeSecBlock<byte, KEY_SIZE> m_key;
+	FixedSizeSecBlock<byte, BUFFER_SIZE> m_buffer;
+	size_t m_available;
+	unsigned long m_processId;
+};
+
+void DeleteThreadLocalRNGState(void *state)
+{
+	delete static_cast<ThreadLocalRNGState *>(state);
+}
+
+struct ThreadLocalRNGStorage
+{
+	ThreadLocalRNGStorage() : m_storage(DeleteThreadLocalRNGState) {}
+
+	mutable ThreadLocalStorage m_storage;
+};
+
+// Writes ChaCha20 keystream blocks under key, starting at counter, with a zero IV
+void ChaCha20KeystreamBlocks(byte *output, const byte *key, word64 counter, size_t blocks)
+{
+	byte input[16] = {0};
+	for (size_t i=0; i<blocks; ++i, ++counter, output+=64)
+	{
+		PutWord(false, LITTLE_ENDIAN_ORDER, input, counter);
+		ChaCha_Info<20>::Block(output, key, ThreadLocalRNGState::KEY_SIZE, input);
+	}
+}
+
+void SeedThreadLocalRNGState(ThreadLocalRNGState &state)
+{
+	OS_GenerateRandomBlock(false, state.m_key, state.m_key.size());
+	std::memset(state.m_buffer, 0, state.m_buffer.size());
+	state.m_available = 0;
+	state.m_processId = CurrentProcessId();
+}
+
+ThreadLocalRNGState & AccessThreadLocalRNGState()
+{
+	ThreadLocalStorage &storage = Singleton<ThreadLocalRNGStorage>().Ref().m_storage;
+	ThreadLocalRNGState *state = static_cast<ThreadLocalRNGState *>(storage.GetValue());
+
+	if (!state)
+	{
+		member_ptr<ThreadLocalRNGState> newState(new ThreadLocalRNGState);
+		SeedThreadLocalRNGState(*newState);
+		storage.SetValue(newState.get());
+		state = newState.release();
+	}
+	else if (state->m_processId != CurrentProcessId())
+	{
+		SeedThreadLocalRNGState(*state);
+	}
+
+	return *state;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void AutoSeededThreadLocalRNG::Reseed()
+{
+	SeedThreadLocalRNGState(AccessThreadLocalRNGState());
+}
+
+void AutoSeededThreadLocalRNG::IncorporateEntropy(const byte *input, size_t length)
+{
+	ThreadLocalRNGState &state = AccessThreadLocalRNGState();
+
+	SHA256 hash;
+	hash.Update(state.m_key, state.m_key.size());
+	hash.Update(input, length);
+	hash.Final(state.m_key);
+
+	std::memset(state.m_buffer, 0, state.m_buffer.size());
+	state.m_available = 0;
+}
+
+void AutoSeededThreadLocalRNG::GenerateBlock(byte *output, size_t size)
+{
+	ThreadLocalRNGState &state = AccessThreadLocalRNGState();
+	const size_t bufferSize = ThreadLocalRNGState::BUFFER_SIZE;
+
+	while (size)
+	{
+		if (state.m_available == 0)
+		{
+			if (size >= bufferSize)
+				break;
+
+			ChaCha20KeystreamBlocks(state.m_buffer, state.m_key, 0, bufferSize/64);
+			std::memcpy(state.m_key, state.m_buffer, state.m_key.size());
+			std::memset(state.m_buffer, 0, state.m_key.size());
+			state.m_available = bufferSize - state.m_key.size();
+		}
+
+		const size_t len = STDMIN(size, state.m_available);
+		byte *p = state.m_buffer + bufferSize - state.m_available;
+		std::memcpy(output, p, len);
+		std::memset(p, 0, len);
+
+		state.m_available -= len;
+		output += len; size -= len;
+	}
+
+	// Large requests skip the buffer. Block 0 is the next key and the rest goes to output.
+	if (size)
+	{
+		FixedSizeSecBlock<byte, 64> block;
+		FixedSizeSecBlock<byte, ThreadLocalRNGState::KEY_SIZE> next;
+		ChaCha20KeystreamBlocks(block, state.m_key, 0, 1);
+		std::memcpy(next, block, next.size());
+
+		const size_t blocks = size/64, tail = size%64;
+		ChaCha20KeystreamBlocks(output, state.m_key, 1, blocks);
+		if (tail)
+		{
+			ChaCha20KeystreamBlocks(block, state.m_key, 1+blocks, 1);
+			std::memcpy(output+blocks*64, block, tail);
+		}
+
+		std::memcpy(state.m_key, next, next.size());
+	}
+}
+
+#endif  // NONBLOCKING_RNG_AVAILABLE and THREADS_AVAILABLE
+
 NAMESPACE_END
 
 #endif  // OS_RNG_AVAILABLE
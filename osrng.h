@@ -83,16 +83,33 @@ private:
 //! \class NonblockingRng
 //! \brief Wrapper class for /dev/random and /dev/srandom
 //! \details Encapsulates CryptoAPI's CryptGenRandom() or CryptoNG's BCryptGenRandom()
-//!   on Windows, or /dev/urandom on Unix and compatibles.
+//!   on Windows, or /dev/urandom on Unix and compatibles. On Linux the getrandom()
+//!   system call is used when the kernel provides it, and /dev/urandom is not opened.
+//!   getrandom() waits for the kernel's pool to be initialized early in boot, and never
+//!   blocks after that.
+//! \details By default every request reads from the operating system, and the object holds
+//!   no generator state, so it may be shared between threads.
+//! \details A buffered NonblockingRng serves requests smaller than <tt>SMALL_REQUEST</tt>
+//!   bytes from a <tt>BUFFER_SIZE</tt> byte buffer in the object, which is refilled from the
+//!   operating system in one call. A word or a nonce then costs a copy instead of a system
+//!   call. Bytes are wiped from the buffer as they are handed out. On Unix and compatibles
+//!   the buffer is discarded in a child process after a fork, so the child does not repeat
+//!   its parent's output. A buffered object must not be used from several threads at once
+//!   without a lock, because two threads could receive the same bytes.
 class CRYPTOPP_DLL NonblockingRng : public RandomNumberGenerator
 {
 public:
 	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName() { return "NonblockingRng"; }
 
+	CRYPTOPP_CONSTANT(BUFFER_SIZE = 256)
+	CRYPTOPP_CONSTANT(SMALL_REQUEST = 64)
+
 	~NonblockingRng();
 
 	//! \brief Construct a NonblockingRng
-	NonblockingRng();
+	//! \param buffered flag indicating small requests are served from a buffer
+	//! \details A buffered object is not thread safe. See the class documentation.
+	explicit NonblockingRng(bool buffered = false);
 
 	//! \brief Generate random array of bytes
 	//! \param output the byte buffer
@@ -100,12 +117,27 @@ public:
 	//! \details GenerateIntoBufferedTransformation() calls are routed to GenerateBlock().
 	void GenerateBlock(byte *output, size_t size);
 
+	//! \brief Discard the buffered bytes
+	//! \details Reseed() wipes the buffer, so the next small request reads fresh bytes from
+	//!   the operating system. Use it after an event that the generator cannot detect, like
+	//!   restoring a virtual machine snapshot.
+	void Reseed();
+
 protected:
+	//! \brief Read random bytes from the operating system
+	//! \param output the byte buffer
+	//! \param size the length of the buffer, in bytes
+	void GenerateFromOS(byte *output, size_t size);
+
 #ifdef CRYPTOPP_WIN32_AVAILABLE
 	MicrosoftCryptoProvider m_Provider;
 #else
 	int m_fd;
 #endif
+	FixedSizeSecBlock<byte, BUFFER_SIZE> m_buffer;
+	size_t m_available;
+	unsigned long m_processId;
+	bool m_buffered;
 };
 
 #endif
@@ -147,8 +179,18 @@ protected:
 //! \details On Unix and compatibles, /dev/urandom is called if blocking is false using
 //!   NonblockingRng. If blocking is true, then either /dev/randomd or /dev/srandom is used
 //!  by way of BlockingRng, if available.
+//! \details The NonblockingRng is not buffered, so only <tt>size</tt> bytes are read.
 CRYPTOPP_DLL void CRYPTOPP_API OS_GenerateRandomBlock(bool blocking, byte *output, size_t size);
 
+//! OS_ProcessId
+//! \brief Retrieve the current process id
+//! \returns the process id on Unix and compatibles, 0 otherwise
+//! \details OS_ProcessId() does not make a system call. The value is cached on first use and
+//!   updated in the child by a fork handler, so buffered generators can call it on each request
+//!   to detect a fork and discard output the parent may also use.
+//! \since Crypto++ 6.0
+CRYPTOPP_DLL unsigned long CRYPTOPP_API OS_ProcessId();
+
 //! \class AutoSeededRandomPool
 //! \brief Automatically Seeded Randomness Pool
 //! \details This class seeds itself using an operating system provided RNG.
@@ -174,6 +216,59 @@ public:
 	void Reseed(bool blocking = false, unsigned int seedSize = 32);
 };
 
+#if (defined(NONBLOCKING_RNG_AVAILABLE) && defined(THREADS_AVAILABLE)) || defined(CRYPTOPP_DOXYGEN_PROCESSING)
+
+//! \class AutoSeededThreadLocalRNG
+//! \brief Automatically seeded generator with a ChaCha20 state for each thread
+//! \details AutoSeededThreadLocalRNG keeps a ChaCha20 key in thread local storage, so any
+//!   number of threads can generate from one object, or from their own objects, without a lock.
+//!   The object itself holds no state, and every object in a thread uses the same key.
+//! \details The key is seeded with 32 bytes from NonblockingRng the first time a thread uses it.
+//!   Output is produced with fast key erasure: each refill encrypts a counter under the key, the
+//!   first 32 bytes become the next key, and the rest is handed out and wiped as it is used. The
+//!   old key cannot be recovered from the current state.
+//! \details On Unix and compatibles the generator reseeds from NonblockingRng after the process
+//!   forks, so a child does not repeat its parent's output. The process id is tracked with
+//!   <tt>pthread_atfork()</tt>, so the check does not make a system call.
+//! \details The state of a thread is freed when the thread exits on Unix and compatibles. Windows
+//!   TLS has no exit notification, so the state of a thread is not freed on Windows.
+//! \sa AutoSeededRandomPool, NonblockingRng
+//! \since Crypto++ 6.0
+class CRYPTOPP_DLL AutoSeededThreadLocalRNG : public RandomNumberGenerator
+{
+public:
+	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName() { return "AutoSeededThreadLocalRNG"; }
+
+	~AutoSeededThreadLocalRNG() {}
+
+	//! \brief Construct an AutoSeededThreadLocalRNG
+	//! \details The calling thread's state is seeded on first use, not by the constructor.
+	AutoSeededThreadLocalRNG() {}
+
+	//! \brief Reseed the calling thread's generator
+	//! \details Reseed() replaces the calling thread's key with 32 bytes from NonblockingRng
+	//!   and discards its buffered output. Other threads are not affected.
+	void Reseed();
+
+	bool CanIncorporateEntropy() const {return true;}
+
+	//! \brief Update the calling thread's key with additional entropy
+	//! \param input the entropy to add to the generator
+	//! \param length the size of the input buffer
+	//! \details The key is replaced with the SHA-256 digest of the key and the input, and the
+	//!   buffered output is discarded. Other threads are not affected.
+	void IncorporateEntropy(const byte *input, size_t length);
+
+	//! \brief Generate random array of bytes
+	//! \param output the byte buffer
+	//! \param size the length of the buffer, in bytes
+	//! \details Small requests are served from the thread's buffer. Requests larger than the
+	//!   buffer are written straight to <tt>output</tt> after the key is replaced.
+	void GenerateBlock(byte *output, size_t size);
+};
+
+#endif  // NONBLOCKING_RNG_AVAILABLE and THREADS_AVAILABLE
+
 //! \class AutoSeededX917RNG
 //! \tparam BLOCK_CIPHER a block cipher
 //! \brief Automatically Seeded X9.17 RNG
@@ -281,6 +281,7 @@ void CRYPTOPP_NOINLINE Panama_SSE2_Pull(size_t count, word32 *state, word32 *z,
 
 	// save state
 	AS2(	mov		[AS_REG_2+4*16], eax)
+	AS2(	mov		[AS_REG_2+4*17], AS_REG_6d)
 	AS2(	movdqa	XMMWORD_PTR [AS_REG_2+3*16], xmm3)
 	AS2(	movdqa	XMMWORD_PTR [AS_REG_2+2*16], xmm2)
 	AS2(	movdqa	XMMWORD_PTR [AS_REG_2+1*16], xmm1)
@@ -323,6 +324,108 @@ void CRYPTOPP_NOINLINE Panama_SSE2_Pull(size_t count, word32 *state, word32 *z,
 
 #ifndef CRYPTOPP_GENERATE_X64_MASM
 
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// [x1, ..., x7, y0] and [x2, ..., x7, y0, y1] take t = [x4, ..., x7, y0, ..., y3]
+#define PANAMA_SHIFT1(t, x) _mm256_alignr_epi8(t, x, 4)
+#define PANAMA_SHIFT2(t, x) _mm256_alignr_epi8(t, x, 8)
+
+// A pull over the state laid out the same way as for Panama_SSE2_Pull(). The 17 words of a
+//   are held as a(0) in every lane of r0, a(1..8) in r1 and a(9..16) in r2, so the buffer
+//   update, the sigma step and the keystream output each use one register as is.
+void Panama_AVX2_Pull(size_t count, word32 *state, word32 *z, const word32 *y)
+{
+#define PANAMA_A(i) state[((i)*13+16) % 17]
+	__m256i r0 = _mm256_set1_epi32(PANAMA_A(0));
+	__m256i r1 = _mm256_setr_epi32(PANAMA_A(1), PANAMA_A(2), PANAMA_A(3), PANAMA_A(4),
+		PANAMA_A(5), PANAMA_A(6), PANAMA_A(7), PANAMA_A(8));
+	__m256i r2 = _mm256_setr_epi32(PANAMA_A(9), PANAMA_A(10), PANAMA_A(11), PANAMA_A(12),
+		PANAMA_A(13), PANAMA_A(14), PANAMA_A(15), PANAMA_A(16));
+
+	// The buffer stages keep words 0 4 1 5 2 6 3 7 in that order
+	const __m256i toLogical = _mm256_setr_epi32(0,2,4,6,1,3,5,7);
+	const __m256i toStage = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+	const __m256i toStage25 = _mm256_setr_epi32(4,5,6,7,1,0,3,2);
+
+	// pi takes c(k) from g(7k mod 17) rotated by k(k+1)/2 mod 32
+	const __m256i pi1a = _mm256_setr_epi32(6,0,3,0,0,7,0,4), pi1b = _mm256_setr_epi32(0,5,0,2,0,0,6,0);
+	const __m256i pi2a = _mm256_setr_epi32(3,0,0,7,0,4,0,1), pi2b = _mm256_setr_epi32(0,1,0,0,5,0,2,0);
+	const __m256i rot1 = _mm256_setr_epi32(1,3,6,10,15,21,28,4), rot2 = _mm256_setr_epi32(13,23,2,14,27,9,24,8);
+	const __m256i bits = _mm256_set1_epi32(32), ones = _mm256_set1_epi32(-1), one = _mm256_setr_epi32(1,0,0,0,0,0,0,0);
+
+	byte *const buffer = (byte *)(void *)(state+20);
+	word32 bstart = state[17];
+
+	while (count--)
+	{
+		if (z)
+		{
+			__m256i k = r2;
+			if (y)
+			{
+				k = _mm256_xor_si256(k, _mm256_loadu_si256((const __m256i *)(const void *)y));
+				y += 8;
+			}
+			_mm256_storeu_si256((__m256i *)(void *)z, k);
+			z += 8;
+		}
+
+		__m256i *const b16 = (__m256i *)(void *)(buffer+((bstart+16*32) & 31*32));
+		__m256i *const b4 = (__m256i *)(void *)(buffer+((bstart+(32-4)*32) & 31*32));
+		bstart += 32;
+		__m256i *const b0 = (__m256i *)(void *)(buffer+((bstart) & 31*32));
+		__m256i *const b25 = (__m256i *)(void *)(buffer+((bstart+(32-25)*32) & 31*32));
+
+		// buffer update
+		const __m256i t = _mm256_loadu_si256(b0);
+		_mm256_storeu_si256(b0, _mm256_xor_si256(t, _mm256_permutevar8x32_epi32(r1, toStage)));
+		_mm256_storeu_si256(b25, _mm256_xor_si256(_mm256_loadu_si256(b25), _mm256_permutevar8x32_epi32(t, toStage25)));
+
+		// gamma, where x | ~y is ~(~x & y)
+		__m256i u = _mm256_permute2x128_si256(r1, r2, 0x21);
+		const __m256i s1 = PANAMA_SHIFT1(u, r1);
+		const __m256i g1 = _mm256_xor_si256(_mm256_xor_si256(r1, ones), _mm256_andnot_si256(s1, PANAMA_SHIFT2(u, r1)));
+		const __m256i g0 = _mm256_xor_si256(_mm256_xor_si256(r0, ones), _mm256_andnot_si256(r1, s1));
+		u = _mm256_permute2x128_si256(r2, _mm256_unpacklo_epi32(r0, r1), 0x21);
+		const __m256i g2 = _mm256_xor_si256(_mm256_xor_si256(r2, ones), _mm256_andnot_si256(PANAMA_SHIFT1(u, r2), PANAMA_SHIFT2(u, r2)));
+
+		// pi, with c(0) in every lane of c0
+		const __m256i c0 = _mm256_broadcastd_epi32(_mm256_castsi256_si128(g0));
+		__m256i c1 = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(g1, pi1a), _mm256_permutevar8x32_epi32(g2, pi1b), 0x4A);
+		__m256i c2 = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(g2, pi2a), _mm256_permutevar8x32_epi32(g1, pi2b), 0x52);
+		c1 = _mm256_or_si256(_mm256_sllv_epi32(c1, rot1), _mm256_srlv_epi32(c1, _mm256_sub_epi32(bits, rot1)));
+		c2 = _mm256_or_si256(_mm256_sllv_epi32(c2, rot2), _mm256_srlv_epi32(c2, _mm256_sub_epi32(bits, rot2)));
+
+		// theta and sigma
+		u = _mm256_xor_si256(_mm256_xor_si256(c0, one), _mm256_xor_si256(c1, _mm256_srli_si256(c1, 12)));
+		r0 = _mm256_broadcastd_epi32(_mm256_castsi256_si128(u));
+		u = _mm256_permute2x128_si256(c1, c2, 0x21);
+		r1 = _mm256_xor_si256(_mm256_xor_si256(c1, PANAMA_SHIFT1(u, c1)), u);
+		r1 = _mm256_xor_si256(r1, _mm256_permutevar8x32_epi32(_mm256_loadu_si256(b4), toLogical));
+		u = _mm256_permute2x128_si256(c2, _mm256_alignr_epi8(c1, c0, 12), 0x21);
+		r2 = _mm256_xor_si256(_mm256_xor_si256(c2, PANAMA_SHIFT1(u, c2)), u);
+		r2 = _mm256_xor_si256(r2, _mm256_permutevar8x32_epi32(_mm256_loadu_si256(b16), toLogical));
+	}
+
+	state[17] = bstart;
+	CRYPTOPP_ALIGN_DATA(32) word32 a[16];
+	_mm256_store_si256((__m256i *)(void *)a, r1);
+	_mm256_store_si256((__m256i *)(void *)(a+8), r2);
+	PANAMA_A(0) = word32(_mm_cvtsi128_si32(_mm256_castsi256_si128(r0)));
+	for (unsigned int i=1; i<17; ++i)
+		PANAMA_A(i) = a[i-1];
+#undef PANAMA_A
+}
+
+#undef PANAMA_SHIFT1
+#undef PANAMA_SHIFT2
+
+ANONYMOUS_NAMESPACE_END
+
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
 template <class B>
 void Panama<B>::Iterate(size_t count, const word32 *p, byte *output, const byte *input, KeystreamOperation operation)
 {
@@ -477,6 +580,11 @@ void PanamaCipherPolicy<B>::CipherResynchronize(byte *keystreamBuffer, const byt
 		this->Iterate(1, buf);
 	}
 
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+	if (HasAVX2())
+		Panama_AVX2_Pull(32, this->m_state, NULLPTR, NULLPTR);
+	else
+#endif
 #if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_PANAMA_ASM)
 	if (B::ToEnum() == LITTLE_ENDIAN_ORDER && HasSSE2() && !IsP4())		// SSE2 code is slower on P4 Prescott
 		Panama_SSE2_Pull(32, this->m_state, NULLPTR, NULLPTR);
@@ -499,6 +607,11 @@ unsigned int PanamaCipherPolicy<B>::GetAlignment() const
 template <class B>
 void PanamaCipherPolicy<B>::OperateKeystream(KeystreamOperation operation, byte *output, const byte *input, size_t iterationCount)
 {
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+	if (B::ToEnum() == LITTLE_ENDIAN_ORDER && HasAVX2())
+		Panama_AVX2_Pull(iterationCount, this->m_state, (word32 *)(void *)output, (const word32 *)(void *)input);
+	else
+#endif
 #if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_PANAMA_ASM)
 	if (B::ToEnum() == LITTLE_ENDIAN_ORDER && HasSSE2())
 		Panama_SSE2_Pull(iterationCount, this->m_state, (word32 *)(void *)output, (const word32 *)(void *)input);
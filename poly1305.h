@@ -164,6 +164,28 @@ public:
 		{this->SetKey(key, keyLength, MakeParameters(Name::IV(), ConstByteArrayParameter(nonce, nonceLength)));}
 };
 
+//! \class Poly1305OneTime
+//! \brief Poly1305 with a one-time key
+//! \details Poly1305OneTime computes the authenticator of RFC 7539, where the 32-byte key is the
+//!   16-byte r followed by the 16-byte s and is used for one message only. The key usually comes
+//!   from a stream cipher, like the first block of ChaCha20 in ChaCha20-Poly1305. There is no
+//!   object and no keying interface. Use Poly1305 for Poly1305-AES, where s is derived from a
+//!   nonce under a long-term key.
+//! \since Crypto++ 6.0
+struct CRYPTOPP_DLL Poly1305OneTime
+{
+	CRYPTOPP_CONSTANT(KEYLENGTH=32)
+	CRYPTOPP_CONSTANT(DIGESTSIZE=16)
+
+	//! \brief Computes a MAC with a one-time key
+	//! \param mac the buffer for the MAC, DIGESTSIZE bytes
+	//! \param key the 32-byte one-time key, r followed by s
+	//! \param input the message
+	//! \param length the size of the message, in bytes
+	//! \details Hash() keeps the state in local variables. r is clamped as the algorithm requires.
+	static void Hash(byte *mac, const byte *key, const byte *input, size_t length);
+};
+
 NAMESPACE_END
 
 #endif  // CRYPTOPP_POLY1305_H
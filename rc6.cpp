@@ -5,6 +5,7 @@
 #include "rc6.h"
 #include "misc.h"
 #include "secblock.h"
+#include "advsimd.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -94,4 +95,122 @@ void RC6::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byt
 	Block::Put(xorBlock, outBlock)(a)(b)(c)(d);
 }
 
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+template <unsigned int R>
+inline __m256i RC6_AVX2_RotlFixed(const __m256i &x)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(x, R), _mm256_srli_epi32(x, 32-R));
+}
+
+// Shifts of 32 or more produce 0, so a rotate by 0 needs no special case
+inline __m256i RC6_AVX2_RotlMod(const __m256i &x, const __m256i &y)
+{
+	const __m256i n = _mm256_and_si256(y, _mm256_set1_epi32(31));
+	return _mm256_or_si256(_mm256_sllv_epi32(x, n), _mm256_srlv_epi32(x, _mm256_sub_epi32(_mm256_set1_epi32(32), n)));
+}
+
+inline __m256i RC6_AVX2_RotrMod(const __m256i &x, const __m256i &y)
+{
+	const __m256i n = _mm256_and_si256(y, _mm256_set1_epi32(31));
+	return _mm256_or_si256(_mm256_srlv_epi32(x, n), _mm256_sllv_epi32(x, _mm256_sub_epi32(_mm256_set1_epi32(32), n)));
+}
+
+// rotlFixed(x*(2*x+1), 5)
+inline __m256i RC6_AVX2_F(const __m256i &x)
+{
+	const __m256i t = _mm256_add_epi32(_mm256_add_epi32(x, x), _mm256_set1_epi32(1));
+	return RC6_AVX2_RotlFixed<5>(_mm256_mullo_epi32(x, t));
+}
+
+inline __m256i RC6_AVX2_Key(const RC6::RC6_WORD *k)
+{
+	return _mm256_set1_epi32((int)*k);
+}
+
+struct RC6_AVX2_Enc_8_Blocks
+{
+	RC6_AVX2_Enc_8_Blocks(const RC6::RC6_WORD *sTable, unsigned int rounds) : m_sTable(sTable), m_rounds(rounds) {}
+
+	void operator()(__m128i x[8]) const
+	{
+		const RC6::RC6_WORD *sptr = m_sTable;
+		__m256i w[4];
+		Transpose4x8_AVX2(x, w);
+		__m256i a = w[0], b = w[1], c = w[2], d = w[3], t, u;
+
+		b = _mm256_add_epi32(b, RC6_AVX2_Key(sptr+0));
+		d = _mm256_add_epi32(d, RC6_AVX2_Key(sptr+1));
+		sptr += 2;
+
+		for (unsigned int i=0; i<m_rounds; i++, sptr += 2)
+		{
+			t = RC6_AVX2_F(b);
+			u = RC6_AVX2_F(d);
+			a = _mm256_add_epi32(RC6_AVX2_RotlMod(_mm256_xor_si256(a, t), u), RC6_AVX2_Key(sptr+0));
+			c = _mm256_add_epi32(RC6_AVX2_RotlMod(_mm256_xor_si256(c, u), t), RC6_AVX2_Key(sptr+1));
+			t = a; a = b; b = c; c = d; d = t;
+		}
+
+		w[0] = _mm256_add_epi32(a, RC6_AVX2_Key(sptr+0));
+		w[1] = b;
+		w[2] = _mm256_add_epi32(c, RC6_AVX2_Key(sptr+1));
+		w[3] = d;
+		Transpose8x4_AVX2(w, x);
+	}
+
+	const RC6::RC6_WORD *m_sTable;
+	unsigned int m_rounds;
+};
+
+struct RC6_AVX2_Dec_8_Blocks
+{
+	RC6_AVX2_Dec_8_Blocks(const RC6::RC6_WORD *sTable, unsigned int rounds) : m_sTable(sTable), m_rounds(rounds) {}
+
+	void operator()(__m128i x[8]) const
+	{
+		const RC6::RC6_WORD *sptr = m_sTable + 2*(m_rounds+2);
+		__m256i w[4];
+		Transpose4x8_AVX2(x, w);
+		__m256i a = w[0], b = w[1], c = w[2], d = w[3], t, u;
+
+		sptr -= 2;
+		c = _mm256_sub_epi32(c, RC6_AVX2_Key(sptr+1));
+		a = _mm256_sub_epi32(a, RC6_AVX2_Key(sptr+0));
+
+		for (unsigned int i=0; i<m_rounds; i++)
+		{
+			sptr -= 2;
+			t = a; a = d; d = c; c = b; b = t;
+			u = RC6_AVX2_F(d);
+			t = RC6_AVX2_F(b);
+			c = _mm256_xor_si256(RC6_AVX2_RotrMod(_mm256_sub_epi32(c, RC6_AVX2_Key(sptr+1)), t), u);
+			a = _mm256_xor_si256(RC6_AVX2_RotrMod(_mm256_sub_epi32(a, RC6_AVX2_Key(sptr+0)), u), t);
+		}
+
+		w[0] = a;
+		w[1] = _mm256_sub_epi32(b, RC6_AVX2_Key(m_sTable+0));
+		w[2] = c;
+		w[3] = _mm256_sub_epi32(d, RC6_AVX2_Key(m_sTable+1));
+		Transpose8x4_AVX2(w, x);
+	}
+
+	const RC6::RC6_WORD *m_sTable;
+	unsigned int m_rounds;
+};
+
+size_t RC6::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (HasAVX2())
+		AdvancedProcessBlocks_SSE2<BLOCKSIZE, 8>(RC6_AVX2_Enc_8_Blocks(sTable, r), inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t RC6::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (HasAVX2())
+		AdvancedProcessBlocks_SSE2<BLOCKSIZE, 8>(RC6_AVX2_Dec_8_Blocks(sTable, r), inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
 NAMESPACE_END
@@ -21,6 +21,7 @@ struct RC6_Info : public FixedBlockSize<16>, public VariableKeyLength<16, 16, 32
 
 //! \class RC6
 //! \brief RC6 block cipher
+//! \details On x86 processors with AVX2, AdvancedProcessBlocks() processes eight blocks at a time.
 //! \sa <a href="http://www.weidai.com/scan-mirror/cs.html#RC6">RC6</a>
 class RC6 : public RC6_Info, public BlockCipherDocumentation
 {
@@ -38,12 +39,20 @@ class RC6 : public RC6_Info, public BlockCipherDocumentation
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 	};
 
 	class CRYPTOPP_NO_VTABLE Dec : public Base
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 	};
 
 public:
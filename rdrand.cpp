@@ -6,6 +6,8 @@
 #include "secblock.h"
 #include "rdrand.h"
 #include "cpu.h"
+#include "drbg.h"
+#include "osrng.h"
 
 #if CRYPTOPP_MSC_VERSION
 # pragma warning(disable: 4100)
@@ -404,4 +406,135 @@ void RDSEED::DiscardBytes(size_t n)
     }
 }
 
+/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Used to detect a fork. Platforms without a process id never reseed for it.
+inline unsigned long ProcessId()
+{
+#if !defined(NO_OS_DEPENDENCE) && defined(OS_RNG_AVAILABLE)
+    return OS_ProcessId();
+#else
+    return 0;
+#endif
+}
+
+ANONYMOUS_NAMESPACE_END
+
+HardwareSeededRNG::HardwareSeededRNG(NIST_DRBG *drbg, lword reseedInterval)
+    : m_drbg(drbg), m_available(0), m_reseedInterval(reseedInterval),
+      m_generated(0), m_processId(0)
+{
+    CRYPTOPP_ASSERT(reseedInterval > 0);
+
+#if CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64
+    if (!HasRDSEED() && !HasRDRAND())
+        throw NotImplemented("HardwareSeededRNG: RDRAND and RDSEED are not available");
+#else
+    throw NotImplemented("HardwareSeededRNG: RDRAND and RDSEED are not available");
+#endif
+
+    if (m_drbg.get())
+    {
+        // The caller instantiated the DRBG, so it only needs the hardware entropy
+        Reseed();
+        return;
+    }
+
+    // SP 800-90A instantiate with an entropy input and a nonce from the hardware
+    typedef CTR_DRBG<AES> DefaultDRBG;
+    FixedSizeSecBlock<byte, DefaultDRBG::MINIMUM_ENTROPY+DefaultDRBG::MINIMUM_NONCE> seed;
+    CollectEntropy(seed, seed.size());
+    m_drbg.reset(new DefaultDRBG(seed, DefaultDRBG::MINIMUM_ENTROPY,
+        seed+DefaultDRBG::MINIMUM_ENTROPY, DefaultDRBG::MINIMUM_NONCE));
+    m_processId = ProcessId();
+}
+
+HardwareSeededRNG::~HardwareSeededRNG()
+{
+}
+
+void HardwareSeededRNG::CollectEntropy(byte *output, size_t size)
+{
+#if CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64
+    if (HasRDSEED())
+        RDSEED().GenerateBlock(output, size);
+    else
+        RDRAND().GenerateBlock(output, size);
+#else
+    CRYPTOPP_UNUSED(output); CRYPTOPP_UNUSED(size);
+    throw NotImplemented("HardwareSeededRNG: RDRAND and RDSEED are not available");
+#endif
+}
+
+void HardwareSeededRNG::Reseed()
+{
+    IncorporateEntropy(NULLPTR, 0);
+}
+
+void HardwareSeededRNG::IncorporateEntropy(const byte *input, size_t length)
+{
+    SecByteBlock seed(m_drbg->GetSeedLength());
+    CollectEntropy(seed, seed.size());
+    m_drbg->IncorporateEntropy(seed, seed.size(), input, length);
+
+    std::memset(m_buffer, 0, m_buffer.size());
+    m_available = 0;
+    m_generated = 0;
+    m_processId = ProcessId();
+}
+
+void HardwareSeededRNG::GenerateFromDRBG(byte *output, size_t size)
+{
+    const size_t maxRequest = m_drbg->GetMaxBytesPerRequest();
+    while (size)
+    {
+        if (m_generated >= m_reseedInterval)
+            Reseed();
+
+        // A request stops at the interval, so a large request reseeds on time
+        const size_t len = (size_t)STDMIN(lword(STDMIN(size, maxRequest)), m_reseedInterval-m_generated);
+        m_drbg->GenerateBlock(output, len);
+        m_generated += len;
+        output += len;
+        size -= len;
+    }
+}
+
+void HardwareSeededRNG::GenerateBlock(byte *output, size_t size)
+{
+    CRYPTOPP_ASSERT((output && size) || !(output || size));
+    if (m_processId != ProcessId())
+        Reseed();
+
+    // Requests of a buffer or more skip the copy. The buffer is drained
+    //   first so bytes are not left behind from an earlier small request.
+    while (size)
+    {
+        if (m_available)
+        {
+            const size_t len = STDMIN(size, m_available);
+            byte *p = m_buffer + BUFFER_SIZE - m_available;
+            std::memcpy(output, p, len);
+            std::memset(p, 0, len);
+            m_available -= len;
+            output += len;
+            size -= len;
+        }
+        else if (size >= BUFFER_SIZE)
+        {
+            GenerateFromDRBG(output, size);
+            break;
+        }
+        else
+        {
+            // Reseeding in GenerateFromDRBG() wipes the buffer, so set the count after
+            GenerateFromDRBG(m_buffer, BUFFER_SIZE);
+            m_available = BUFFER_SIZE;
+        }
+    }
+}
+
 NAMESPACE_END
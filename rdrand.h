@@ -8,6 +8,8 @@
 #define CRYPTOPP_RDRAND_H
 
 #include "cryptlib.h"
+#include "secblock.h"
+#include "smartptr.h"
 
 // This file (and friends) provides both RDRAND and RDSEED. They were added at
 //   Crypto++ 5.6.3. At compile time, it uses CRYPTOPP_BOOL_{X86|X32|X64}
@@ -132,6 +134,77 @@ public:
     }
 };
 
+class NIST_DRBG;
+
+//! \brief Buffered generator seeded by RDSEED or RDRAND
+//! \details HardwareSeededRNG conditions the hardware generator with a NIST DRBG.
+//!   The DRBG is instantiated and reseeded with RDSEED when available, and RDRAND
+//!   otherwise. Output is produced in BUFFER_SIZE batches, and small requests are
+//!   served from the buffer without executing an RDRAND or RDSEED instruction.
+//!   Each byte is wiped from the buffer when it is handed out.
+//! \details RDRAND and RDSEED cost about the same per call regardless of the
+//!   size of the request, so the class is useful when a program makes many small
+//!   requests, like nonces and GenerateWord32(). RDRAND and RDSEED are
+//!   appropriate for large requests.
+//! \details On Unix and compatibles the generator reseeds after a fork, so a child
+//!   does not produce the parent's buffered output. The class is not thread safe.
+//! \sa RDRAND, RDSEED, CTR_DRBG, Hash_DRBG, HMAC_DRBG
+//! \since Crypto++ 6.0
+class HardwareSeededRNG : public RandomNumberGenerator, public NotCopyable
+{
+public:
+    CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName() { return "HardwareSeededRNG"; }
+
+    //! \brief Size of the output buffer, in bytes
+    CRYPTOPP_CONSTANT(BUFFER_SIZE = 1024)
+    //! \brief Default number of bytes generated between reseeds
+    CRYPTOPP_CONSTANT(DEFAULT_RESEED_INTERVAL = 1024*1024)
+
+    virtual ~HardwareSeededRNG();
+
+    //! \brief Construct a HardwareSeededRNG
+    //! \param drbg the DRBG used to condition the hardware generator
+    //! \param reseedInterval the number of bytes generated between reseeds
+    //! \details HardwareSeededRNG takes ownership of drbg, even if the constructor throws.
+    //!   The DRBG must already be instantiated with entropy and a nonce, like
+    //!   <tt>new HMAC_DRBG<SHA256>(entropy, 32, nonce, 16)</tt>. A default constructed
+    //!   DRBG is not instantiated. The DRBG is reseeded with RDSEED or RDRAND before use.
+    //! \details If drbg is NULL, then CTR_DRBG<AES> is instantiated with an entropy input
+    //!   and a nonce from RDSEED or RDRAND.
+    //! \throws NotImplemented if neither RDRAND nor RDSEED is available
+    explicit HardwareSeededRNG(NIST_DRBG *drbg = NULLPTR, lword reseedInterval = DEFAULT_RESEED_INTERVAL);
+
+    //! \brief Generate random array of bytes
+    //! \param output the byte buffer
+    //! \param size the length of the buffer, in bytes
+    virtual void GenerateBlock(byte *output, size_t size);
+
+    //! \brief Reseed the generator
+    //! \details Reseed() reseeds the DRBG with RDSEED or RDRAND and discards the
+    //!   buffered output.
+    void Reseed();
+
+    virtual bool CanIncorporateEntropy() const {return true;}
+
+    //! \brief Update RNG state with additional unpredictable values
+    //! \param input the entropy to add to the generator
+    //! \param length the size of the input buffer
+    //! \details The input is used as additional input when the DRBG is reseeded
+    //!   with RDSEED or RDRAND. The buffered output is discarded.
+    virtual void IncorporateEntropy(const byte *input, size_t length);
+
+protected:
+    void CollectEntropy(byte *output, size_t size);
+    void GenerateFromDRBG(byte *output, size_t size);
+
+private:
+    member_ptr<NIST_DRBG> m_drbg;
+    FixedSizeSecBlock<byte, BUFFER_SIZE> m_buffer;
+    size_t m_available;
+    lword m_reseedInterval, m_generated;
+    unsigned long m_processId;
+};
+
 NAMESPACE_END
 
 #endif // CRYPTOPP_RDRAND_H
@@ -101,6 +101,9 @@ void RegisterFactories1()
 #ifdef OS_RNG_AVAILABLE
 	RegisterDefaultFactoryFor<RandomNumberGenerator, AutoSeededRandomPool>();
 	RegisterDefaultFactoryFor<RandomNumberGenerator, AutoSeededX917RNG<AES> >();
+#endif
+#if defined(NONBLOCKING_RNG_AVAILABLE) && defined(THREADS_AVAILABLE)
+	RegisterDefaultFactoryFor<RandomNumberGenerator, AutoSeededThreadLocalRNG>();
 #endif
 	RegisterDefaultFactoryFor<RandomNumberGenerator, MT19937>();
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
@@ -108,10 +111,13 @@ void RegisterFactories1()
 		RegisterDefaultFactoryFor<RandomNumberGenerator, RDRAND>();
 	if (HasRDSEED())
 		RegisterDefaultFactoryFor<RandomNumberGenerator, RDSEED>();
+	if (HasRDRAND() || HasRDSEED())
+		RegisterDefaultFactoryFor<RandomNumberGenerator, HardwareSeededRNG>();
 #endif
 	RegisterDefaultFactoryFor<RandomNumberGenerator, OFB_Mode<AES>::Encryption >("AES/OFB RNG");
 	RegisterDefaultFactoryFor<NIST_DRBG, Hash_DRBG<SHA1> >("Hash_DRBG(SHA1)");
 	RegisterDefaultFactoryFor<NIST_DRBG, Hash_DRBG<SHA256> >("Hash_DRBG(SHA256)");
 	RegisterDefaultFactoryFor<NIST_DRBG, HMAC_DRBG<SHA1> >("HMAC_DRBG(SHA1)");
 	RegisterDefaultFactoryFor<NIST_DRBG, HMAC_DRBG<SHA256> >("HMAC_DRBG(SHA256)");
+	RegisterDefaultFactoryFor<NIST_DRBG, CTR_DRBG<AES> >("CTR_DRBG(AES)");
 }
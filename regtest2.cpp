@@ -24,7 +24,9 @@
 #include "arc4.h"
 #include "ccm.h"
 #include "gcm.h"
+#include "gcmsiv.h"
 #include "eax.h"
+#include "ocb.h"
 #include "twofish.h"
 #include "serpent.h"
 #include "cast.h"
@@ -99,6 +101,7 @@ void RegisterFactories2()
 	RegisterSymmetricCipherDefaultFactories<CFB_Mode<AES> >();
 	RegisterSymmetricCipherDefaultFactories<OFB_Mode<AES> >();
 	RegisterSymmetricCipherDefaultFactories<CTR_Mode<AES> >();
+	RegisterSymmetricCipherDefaultFactories<XTS_Mode<AES> >();
 	RegisterSymmetricCipherDefaultFactories<Salsa20>();
 	RegisterSymmetricCipherDefaultFactories<XSalsa20>();
 	RegisterSymmetricCipherDefaultFactories<ChaCha8>();
@@ -111,7 +114,9 @@ void RegisterFactories2()
 	RegisterSymmetricCipherDefaultFactories<SEAL<LittleEndian> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<CCM<AES> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<GCM<AES> >();
+	RegisterAuthenticatedSymmetricCipherDefaultFactories<GCM_SIV<AES> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<EAX<AES> >();
+	RegisterAuthenticatedSymmetricCipherDefaultFactories<OCB<AES> >();
 	RegisterSymmetricCipherDefaultFactories<CBC_Mode<ARIA> >();  // For test vectors
 	RegisterSymmetricCipherDefaultFactories<CTR_Mode<ARIA> >();
 	RegisterSymmetricCipherDefaultFactories<CTR_Mode<Camellia> >();
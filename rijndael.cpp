@@ -71,6 +71,7 @@ being unloaded from L1 cache, until that round is finished.
 #ifndef CRYPTOPP_GENERATE_X64_MASM
 
 #include "rijndael.h"
+#include "advsimd.h"
 #include "misc.h"
 #include "cpu.h"
 
@@ -88,6 +89,24 @@ NAMESPACE_BEGIN(CryptoPP)
 # define MAYBE_CONST const
 #endif
 
+// Constant-time fallback for processors without AES-NI
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE
+# define CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS 1
+#endif
+
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+static void Rijndael_SSSE3_SetKey(const byte *schedule, __m128i *subkeys, unsigned int rounds, bool forward);
+
+static inline bool UseRijndaelSSSE3()
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasAESNI())
+		return false;
+#endif
+	return HasSSSE3();
+}
+#endif
+
 #if defined(CRYPTOPP_ALLOW_UNALIGNED_DATA_ACCESS) || defined(CRYPTOPP_ALLOW_RIJNDAEL_UNALIGNED_DATA_ACCESS)
 # if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
 namespace rdtable {CRYPTOPP_ALIGN_DATA(16) word64 Te[256+2];}
@@ -341,6 +360,20 @@ void Rijndael::Base::UncheckedSetKey(const byte *userKey, unsigned int keylen, c
 		rk += keylen/4;
 	}
 
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+	if (UseRijndaelSSSE3())
+	{
+		// The schedule is in big-endian words at this point
+		SecBlock<word32> schedule(4*(m_rounds+1));
+		ConditionalByteReverse(BIG_ENDIAN_ORDER, schedule.begin(), m_key.begin(), 16*(m_rounds+1));
+
+		// 8 bitsliced slots per round key, plus one vector permute slot when encrypting
+		m_ssse3Key.New(16*(m_rounds+1)*(IsForwardTransformation() ? 9 : 8));
+		Rijndael_SSSE3_SetKey((const byte *)schedule.begin(), (__m128i *)(void *)m_ssse3Key.begin(), m_rounds, IsForwardTransformation());
+		return;
+	}
+#endif
+
 	rk = m_key;
 
 	if (IsForwardTransformation())
@@ -387,6 +420,13 @@ void Rijndael::Base::UncheckedSetKey(const byte *userKey, unsigned int keylen, c
 
 void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
 {
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+	if (UseRijndaelSSSE3())
+	{
+		return (void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
+	}
+#endif
+
 #if CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE) || CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 #if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
 	if (HasSSE2())
@@ -468,6 +508,14 @@ void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock
 
 void Rijndael::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
 {
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+	if (UseRijndaelSSSE3())
+	{
+		Rijndael::Dec::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
+		return;
+	}
+#endif
+
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 	if (HasAESNI())
 	{
@@ -1096,6 +1144,43 @@ inline void AESNI_Enc_Block(__m128i &block, MAYBE_CONST __m128i *subkeys, unsign
 	block = _mm_aesenclast_si128(block, subkeys[rounds]);
 }
 
+// Two independent blocks in lockstep, so one can be a serial chain and the other still overlaps it
+inline void AESNI_Enc_2_Blocks(__m128i &block0, __m128i &block1, MAYBE_CONST __m128i *subkeys, unsigned int rounds)
+{
+	__m128i rk = subkeys[0];
+	block0 = _mm_xor_si128(block0, rk);
+	block1 = _mm_xor_si128(block1, rk);
+	for (unsigned int i=1; i<rounds; i++)
+	{
+		rk = subkeys[i];
+		block0 = _mm_aesenc_si128(block0, rk);
+		block1 = _mm_aesenc_si128(block1, rk);
+	}
+	rk = subkeys[rounds];
+	block0 = _mm_aesenclast_si128(block0, rk);
+	block1 = _mm_aesenclast_si128(block1, rk);
+}
+
+// Four independent blocks, each with its own key schedule
+inline void AESNI_Enc_4_Blocks_Keys(__m128i &block0, __m128i &block1, __m128i &block2, __m128i &block3, MAYBE_CONST __m128i *const *subkeys, unsigned int rounds)
+{
+	block0 = _mm_xor_si128(block0, subkeys[0][0]);
+	block1 = _mm_xor_si128(block1, subkeys[1][0]);
+	block2 = _mm_xor_si128(block2, subkeys[2][0]);
+	block3 = _mm_xor_si128(block3, subkeys[3][0]);
+	for (unsigned int i=1; i<rounds; i++)
+	{
+		block0 = _mm_aesenc_si128(block0, subkeys[0][i]);
+		block1 = _mm_aesenc_si128(block1, subkeys[1][i]);
+		block2 = _mm_aesenc_si128(block2, subkeys[2][i]);
+		block3 = _mm_aesenc_si128(block3, subkeys[3][i]);
+	}
+	block0 = _mm_aesenclast_si128(block0, subkeys[0][rounds]);
+	block1 = _mm_aesenclast_si128(block1, subkeys[1][rounds]);
+	block2 = _mm_aesenclast_si128(block2, subkeys[2][rounds]);
+	block3 = _mm_aesenclast_si128(block3, subkeys[3][rounds]);
+}
+
 inline void AESNI_Enc_4_Blocks(__m128i &block0, __m128i &block1, __m128i &block2, __m128i &block3, MAYBE_CONST __m128i *subkeys, unsigned int rounds)
 {
 	__m128i rk = subkeys[0];
@@ -1118,6 +1203,63 @@ inline void AESNI_Enc_4_Blocks(__m128i &block0, __m128i &block1, __m128i &block2
 	block3 = _mm_aesenclast_si128(block3, rk);
 }
 
+// One step of the AES-128 and AES-256 key expansion. assist is the output of aeskeygenassist
+//   with the word that feeds the step already broadcast.
+inline __m128i AESNI_ExpandKeyStep(__m128i key, const __m128i &assist)
+{
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, assist);
+}
+
+// aeskeygenassist takes the round constant as an immediate, so the rounds are unrolled
+#define AESNI_EXPAND_128(k, rcon) \
+	AESNI_ExpandKeyStep(k, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k, rcon), _MM_SHUFFLE(3,3,3,3)))
+#define AESNI_EXPAND_256_EVEN(k0, k1, rcon) \
+	AESNI_ExpandKeyStep(k0, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k1, rcon), _MM_SHUFFLE(3,3,3,3)))
+#define AESNI_EXPAND_256_ODD(k1, k0) \
+	AESNI_ExpandKeyStep(k1, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k0, 0), _MM_SHUFFLE(2,2,2,2)))
+
+// Encrypts one block while the round keys are expanded, for 16-byte keys
+inline __m128i AESNI_Enc_Block_OneShot128(__m128i block, const byte *userKey)
+{
+	__m128i k = _mm_loadu_si128((const __m128i *)(const void *)userKey);
+	block = _mm_xor_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x01); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x02); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x04); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x08); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x10); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x20); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x40); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x80); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x1B); block = _mm_aesenc_si128(block, k);
+	k = AESNI_EXPAND_128(k, 0x36); return _mm_aesenclast_si128(block, k);
+}
+
+// Encrypts one block while the round keys are expanded, for 32-byte keys
+inline __m128i AESNI_Enc_Block_OneShot256(__m128i block, const byte *userKey)
+{
+	__m128i k0 = _mm_loadu_si128((const __m128i *)(const void *)userKey);
+	__m128i k1 = _mm_loadu_si128((const __m128i *)(const void *)(userKey+16));
+	block = _mm_xor_si128(block, k0);
+	block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x01); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x02); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x04); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x08); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x10); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x20); block = _mm_aesenc_si128(block, k0);
+	k1 = AESNI_EXPAND_256_ODD(k1, k0);        block = _mm_aesenc_si128(block, k1);
+	k0 = AESNI_EXPAND_256_EVEN(k0, k1, 0x40); return _mm_aesenclast_si128(block, k0);
+}
+
 inline void AESNI_Dec_Block(__m128i &block, MAYBE_CONST __m128i *subkeys, unsigned int rounds)
 {
 	block = _mm_xor_si128(block, subkeys[0]);
@@ -1152,11 +1294,13 @@ inline void AESNI_Dec_4_Blocks(__m128i &block0, __m128i &block1, __m128i &block2
 	block3 = _mm_aesdeclast_si128(block3, rk);
 }
 
-CRYPTOPP_ALIGN_DATA(16)
-static const word32 s_one[] = {0, 0, 0, 1<<24};
+// The kernels are template arguments rather than function pointers, so they are inlined into
+//   each instantiation even when the instantiation itself is too large to inline into its caller
+typedef void (*AESNI_Func1)(__m128i &, MAYBE_CONST __m128i *, unsigned int);
+typedef void (*AESNI_Func4)(__m128i &, __m128i &, __m128i &, __m128i &, MAYBE_CONST __m128i *, unsigned int);
 
-template <typename F1, typename F4>
-inline size_t AESNI_AdvancedProcessBlocks(F1 func1, F4 func4, MAYBE_CONST __m128i *subkeys, unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+template <AESNI_Func1 func1, AESNI_Func4 func4>
+inline size_t AESNI_AdvancedProcessBlocks(MAYBE_CONST __m128i *subkeys, unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
 {
 	size_t blockSize = 16;
 	size_t inIncrement = (flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)) ? 0 : blockSize;
@@ -1181,11 +1325,12 @@ inline size_t AESNI_AdvancedProcessBlocks(F1 func1, F4 func4, MAYBE_CONST __m128
 			__m128i block0 = _mm_loadu_si128((const __m128i *)(const void *)inBlocks), block1, block2, block3;
 			if (flags & BlockTransformation::BT_InBlockIsCounter)
 			{
-				const __m128i be1 = *(const __m128i *)(const void *)s_one;
-				block1 = _mm_add_epi32(block0, be1);
-				block2 = _mm_add_epi32(block1, be1);
-				block3 = _mm_add_epi32(block2, be1);
-				_mm_storeu_si128((__m128i *)(void *)inBlocks, _mm_add_epi32(block3, be1));
+				__m128i counters[4];
+				GenerateCounterBlocks_SSE2(const_cast<byte *>(inBlocks), counters, 4, flags);
+				block0 = counters[0];
+				block1 = counters[1];
+				block2 = counters[2];
+				block3 = counters[3];
 			}
 			else
 			{
@@ -1247,7 +1392,460 @@ inline size_t AESNI_AdvancedProcessBlocks(F1 func1, F4 func4, MAYBE_CONST __m128
 			block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
 
 		if (flags & BlockTransformation::BT_InBlockIsCounter)
-			const_cast<byte *>(inBlocks)[15]++;
+			IncrementCounterBlock(const_cast<byte *>(inBlocks), 16, flags);
+
+		func1(block, subkeys, rounds);
+
+		if (xorBlocks && !(flags & BlockTransformation::BT_XorInput))
+			block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+
+		_mm_storeu_si128((__m128i *)(void *)outBlocks, block);
+
+		inBlocks += inIncrement;
+		outBlocks += outIncrement;
+		xorBlocks += xorIncrement;
+		length -= blockSize;
+	}
+
+	return length;
+}
+#endif
+
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+
+// Constant-time fallback for processors with SSSE3 but without AES-NI. Multiple
+//   blocks are bitsliced eight at a time following Kasper and Schwabe, "Faster
+//   and Timing-Attack Resistant AES-GCM". After the transpose x[i] holds bit 7-i
+//   of every byte of the eight blocks, so SubBytes is a Boyar-Peralta circuit
+//   and ShiftRows and MixColumns become byte shuffles. Single blocks are
+//   encrypted with Hamburg's vector permute S-box, "Accelerating AES with
+//   Vector Permute Instructions". Neither path has secret dependent loads.
+
+// Vector permute constants, from Mike Hamburg's public domain implementation
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_INV[2][16] = {
+	{0x80,0x01,0x08,0x0d,0x0f,0x06,0x05,0x0e,0x02,0x0c,0x0b,0x0a,0x09,0x03,0x07,0x04},
+	{0x80,0x07,0x0b,0x0f,0x06,0x0a,0x04,0x01,0x09,0x08,0x05,0x02,0x0c,0x0e,0x0d,0x03}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_IPT[2][16] = {
+	{0x00,0x70,0x2a,0x5a,0x98,0xe8,0xb2,0xc2,0x08,0x78,0x22,0x52,0x90,0xe0,0xba,0xca},
+	{0x00,0x4d,0x7c,0x31,0x7d,0x30,0x01,0x4c,0x81,0xcc,0xfd,0xb0,0xfc,0xb1,0x80,0xcd}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_SB1[2][16] = {
+	{0x00,0x3e,0x50,0xcb,0x8f,0xe1,0x9b,0xb1,0x44,0xf5,0x2a,0x14,0x6e,0x7a,0xdf,0xa5},
+	{0x00,0x23,0xe2,0xfa,0x15,0xd4,0x18,0x36,0xef,0xd9,0x2e,0x0d,0xc1,0xcc,0xf7,0x3b}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_SB2[2][16] = {
+	{0x00,0x24,0x71,0x0b,0xc6,0x93,0x7a,0xe2,0xcd,0x2f,0x98,0xbc,0x55,0xe9,0xb7,0x5e},
+	{0x00,0x29,0xe1,0x0a,0x40,0x88,0xeb,0x69,0x4a,0x23,0x82,0xab,0xc8,0x63,0xa1,0xc2}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_SBO[2][16] = {
+	{0x00,0xc7,0xbd,0x6f,0x17,0x6d,0xd2,0xd0,0x78,0xa8,0x02,0xc5,0x7a,0xbf,0xaa,0x15},
+	{0x00,0x6a,0xbb,0x5f,0xa5,0x74,0xe4,0xcf,0xfa,0x35,0x2b,0x41,0xd1,0x90,0x1e,0x8e}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_MC_FORWARD[4][16] = {
+	{0x01,0x02,0x03,0x00,0x05,0x06,0x07,0x04,0x09,0x0a,0x0b,0x08,0x0d,0x0e,0x0f,0x0c},
+	{0x05,0x06,0x07,0x04,0x09,0x0a,0x0b,0x08,0x0d,0x0e,0x0f,0x0c,0x01,0x02,0x03,0x00},
+	{0x09,0x0a,0x0b,0x08,0x0d,0x0e,0x0f,0x0c,0x01,0x02,0x03,0x00,0x05,0x06,0x07,0x04},
+	{0x0d,0x0e,0x0f,0x0c,0x01,0x02,0x03,0x00,0x05,0x06,0x07,0x04,0x09,0x0a,0x0b,0x08}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_MC_BACKWARD[4][16] = {
+	{0x03,0x00,0x01,0x02,0x07,0x04,0x05,0x06,0x0b,0x08,0x09,0x0a,0x0f,0x0c,0x0d,0x0e},
+	{0x0f,0x0c,0x0d,0x0e,0x03,0x00,0x01,0x02,0x07,0x04,0x05,0x06,0x0b,0x08,0x09,0x0a},
+	{0x0b,0x08,0x09,0x0a,0x0f,0x0c,0x0d,0x0e,0x03,0x00,0x01,0x02,0x07,0x04,0x05,0x06},
+	{0x07,0x04,0x05,0x06,0x0b,0x08,0x09,0x0a,0x0f,0x0c,0x0d,0x0e,0x03,0x00,0x01,0x02}
+};
+
+CRYPTOPP_ALIGN_DATA(16)
+static const byte VP_SR[4][16] = {
+	{0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f},
+	{0x00,0x05,0x0a,0x0f,0x04,0x09,0x0e,0x03,0x08,0x0d,0x02,0x07,0x0c,0x01,0x06,0x0b},
+	{0x00,0x09,0x02,0x0b,0x04,0x0d,0x06,0x0f,0x08,0x01,0x0a,0x03,0x0c,0x05,0x0e,0x07},
+	{0x00,0x0d,0x0a,0x07,0x04,0x01,0x0e,0x0b,0x08,0x05,0x02,0x0f,0x0c,0x09,0x06,0x03}
+};
+
+inline void BS_SwapMove(__m128i &a, __m128i &b, const __m128i mask, const int n)
+{
+	const __m128i t = _mm_and_si128(_mm_xor_si128(_mm_srli_epi64(b, n), a), mask);
+	a = _mm_xor_si128(a, t);
+	b = _mm_xor_si128(b, _mm_slli_epi64(t, n));
+}
+
+// An 8x8 bit matrix transpose per byte position. It is its own inverse.
+inline void BS_Transpose(__m128i x[8])
+{
+	const __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33), m4 = _mm_set1_epi8(0x0f);
+	BS_SwapMove(x[0], x[1], m1, 1); BS_SwapMove(x[2], x[3], m1, 1);
+	BS_SwapMove(x[4], x[5], m1, 1); BS_SwapMove(x[6], x[7], m1, 1);
+	BS_SwapMove(x[0], x[2], m2, 2); BS_SwapMove(x[1], x[3], m2, 2);
+	BS_SwapMove(x[4], x[6], m2, 2); BS_SwapMove(x[5], x[7], m2, 2);
+	BS_SwapMove(x[0], x[4], m4, 4); BS_SwapMove(x[1], x[5], m4, 4);
+	BS_SwapMove(x[2], x[6], m4, 4); BS_SwapMove(x[3], x[7], m4, 4);
+}
+
+inline void BS_AddRoundKey(__m128i x[8], const __m128i *rk)
+{
+	for (unsigned int i=0; i<8; ++i)
+		x[i] = _mm_xor_si128(x[i], _mm_load_si128(rk+i));
+}
+
+inline void BS_Shuffle(__m128i x[8], const __m128i perm)
+{
+	for (unsigned int i=0; i<8; ++i)
+		x[i] = _mm_shuffle_epi8(x[i], perm);
+}
+
+// Boyar and Peralta, "A depth-16 circuit for the AES S-box"
+inline void BS_SubBytes(__m128i x[8])
+{
+#define BS_XOR(a,b) _mm_xor_si128(a,b)
+#define BS_AND(a,b) _mm_and_si128(a,b)
+#define BS_XNOR(a,b) _mm_xor_si128(_mm_xor_si128(a,b),ones)
+	const __m128i ones = _mm_set1_epi8(-1);
+	const __m128i x0=x[0], x1=x[1], x2=x[2], x3=x[3], x4=x[4], x5=x[5], x6=x[6], x7=x[7];
+
+	// Top linear transformation
+	const __m128i y14 = BS_XOR(x3, x5), y13 = BS_XOR(x0, x6), y9 = BS_XOR(x0, x3), y8 = BS_XOR(x0, x5);
+	const __m128i t0 = BS_XOR(x1, x2), y1 = BS_XOR(t0, x7), y4 = BS_XOR(y1, x3), y12 = BS_XOR(y13, y14);
+	const __m128i y2 = BS_XOR(y1, x0), y5 = BS_XOR(y1, x6), y3 = BS_XOR(y5, y8), t1 = BS_XOR(x4, y12);
+	const __m128i y15 = BS_XOR(t1, x5), y20 = BS_XOR(t1, x1), y6 = BS_XOR(y15, x7), y10 = BS_XOR(y15, t0);
+	const __m128i y11 = BS_XOR(y20, y9), y7 = BS_XOR(x7, y11), y17 = BS_XOR(y10, y11), y19 = BS_XOR(y10, y8);
+	const __m128i y16 = BS_XOR(t0, y11), y21 = BS_XOR(y13, y16), y18 = BS_XOR(x0, y16);
+
+	// Non-linear section
+	const __m128i t2 = BS_AND(y12, y15), t3 = BS_AND(y3, y6), t4 = BS_XOR(t3, t2), t5 = BS_AND(y4, x7);
+	const __m128i t6 = BS_XOR(t5, t2), t7 = BS_AND(y13, y16), t8 = BS_AND(y5, y1), t9 = BS_XOR(t8, t7);
+	const __m128i t10 = BS_AND(y2, y7), t11 = BS_XOR(t10, t7), t12 = BS_AND(y9, y11), t13 = BS_AND(y14, y17);
+	const __m128i t14 = BS_XOR(t13, t12), t15 = BS_AND(y8, y10), t16 = BS_XOR(t15, t12), t17 = BS_XOR(t4, t14);
+	const __m128i t18 = BS_XOR(t6, t16), t19 = BS_XOR(t9, t14), t20 = BS_XOR(t11, t16), t21 = BS_XOR(t17, y20);
+	const __m128i t22 = BS_XOR(t18, y19), t23 = BS_XOR(t19, y21), t24 = BS_XOR(t20, y18);
+
+	const __m128i t25 = BS_XOR(t21, t22), t26 = BS_AND(t21, t23), t27 = BS_XOR(t24, t26), t28 = BS_AND(t25, t27);
+	const __m128i t29 = BS_XOR(t28, t22), t30 = BS_XOR(t23, t24), t31 = BS_XOR(t22, t26), t32 = BS_AND(t31, t30);
+	const __m128i t33 = BS_XOR(t32, t24), t34 = BS_XOR(t23, t33), t35 = BS_XOR(t27, t33), t36 = BS_AND(t24, t35);
+	const __m128i t37 = BS_XOR(t36, t34), t38 = BS_XOR(t27, t36), t39 = BS_AND(t29, t38), t40 = BS_XOR(t25, t39);
+
+	const __m128i t41 = BS_XOR(t40, t37), t42 = BS_XOR(t29, t33), t43 = BS_XOR(t29, t40), t44 = BS_XOR(t33, t37);
+	const __m128i t45 = BS_XOR(t42, t41);
+	const __m128i z0 = BS_AND(t44, y15), z1 = BS_AND(t37, y6), z2 = BS_AND(t33, x7), z3 = BS_AND(t43, y16);
+	const __m128i z4 = BS_AND(t40, y1), z5 = BS_AND(t29, y7), z6 = BS_AND(t42, y11), z7 = BS_AND(t45, y17);
+	const __m128i z8 = BS_AND(t41, y10), z9 = BS_AND(t44, y12), z10 = BS_AND(t37, y3), z11 = BS_AND(t33, y4);
+	const __m128i z12 = BS_AND(t43, y13), z13 = BS_AND(t40, y5), z14 = BS_AND(t29, y2), z15 = BS_AND(t42, y9);
+	const __m128i z16 = BS_AND(t45, y14), z17 = BS_AND(t41, y8);
+
+	// Bottom linear transformation
+	const __m128i t46 = BS_XOR(z15, z16), t47 = BS_XOR(z10, z11), t48 = BS_XOR(z5, z13), t49 = BS_XOR(z9, z10);
+	const __m128i t50 = BS_XOR(z2, z12), t51 = BS_XOR(z2, z5), t52 = BS_XOR(z7, z8), t53 = BS_XOR(z0, z3);
+	const __m128i t54 = BS_XOR(z6, z7), t55 = BS_XOR(z16, z17), t56 = BS_XOR(z12, t48), t57 = BS_XOR(t50, t53);
+	const __m128i t58 = BS_XOR(z4, t46), t59 = BS_XOR(z3, t54), t60 = BS_XOR(t46, t57), t61 = BS_XOR(z14, t57);
+	const __m128i t62 = BS_XOR(t52, t58), t63 = BS_XOR(t49, t58), t64 = BS_XOR(z4, t59), t65 = BS_XOR(t61, t62);
+	const __m128i t66 = BS_XOR(z1, t63), t67 = BS_XOR(t64, t65);
+
+	x[0] = BS_XOR(t59, t63);
+	x[6] = BS_XNOR(t56, t62);
+	x[7] = BS_XNOR(t48, t60);
+	x[3] = BS_XOR(t53, t66);
+	x[4] = BS_XOR(t51, t66);
+	x[5] = BS_XOR(t47, t65);
+	x[1] = BS_XNOR(t64, x[3]);
+	x[2] = BS_XNOR(t55, t67);
+#undef BS_XOR
+#undef BS_AND
+#undef BS_XNOR
+}
+
+// The inverse of the affine map in the S-box, including the 0x63 constant
+inline void BS_InvAffine(__m128i x[8])
+{
+	const __m128i ones = _mm_set1_epi8(-1);
+	__m128i b[8];
+	for (unsigned int i=0; i<8; ++i)
+		b[i] = x[7-i];
+	for (unsigned int i=0; i<8; ++i)
+		x[7-i] = _mm_xor_si128(_mm_xor_si128(b[(i+2)%8], b[(i+5)%8]), b[(i+7)%8]);
+	x[7] = _mm_xor_si128(x[7], ones);
+	x[5] = _mm_xor_si128(x[5], ones);
+}
+
+inline void BS_InvSubBytes(__m128i x[8])
+{
+	BS_InvAffine(x);
+	BS_SubBytes(x);
+	BS_InvAffine(x);
+}
+
+// Multiply every byte by x in GF(2^8)
+inline void BS_XTime(__m128i x[8])
+{
+	const __m128i h = x[0];
+	x[0] = x[1]; x[1] = x[2]; x[2] = x[3];
+	x[3] = _mm_xor_si128(x[4], h);
+	x[4] = _mm_xor_si128(x[5], h);
+	x[5] = x[6];
+	x[6] = _mm_xor_si128(x[7], h);
+	x[7] = h;
+}
+
+inline void BS_MixColumns(__m128i x[8])
+{
+	const __m128i rot1 = _mm_set_epi8(12,15,14,13, 8,11,10,9, 4,7,6,5, 0,3,2,1);
+	const __m128i rot2 = _mm_set_epi8(13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2);
+	__m128i r[8], t[8];
+	for (unsigned int i=0; i<8; ++i)
+	{
+		r[i] = _mm_shuffle_epi8(x[i], rot1);
+		t[i] = _mm_xor_si128(x[i], r[i]);
+		x[i] = _mm_xor_si128(r[i], _mm_shuffle_epi8(t[i], rot2));
+	}
+	BS_XTime(t);
+	for (unsigned int i=0; i<8; ++i)
+		x[i] = _mm_xor_si128(x[i], t[i]);
+}
+
+// InvMixColumns(x) = MixColumns(x ^ 4(x ^ rot2(x)))
+inline void BS_InvMixColumns(__m128i x[8])
+{
+	const __m128i rot2 = _mm_set_epi8(13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2);
+	__m128i t[8];
+	for (unsigned int i=0; i<8; ++i)
+		t[i] = _mm_xor_si128(x[i], _mm_shuffle_epi8(x[i], rot2));
+	BS_XTime(t);
+	BS_XTime(t);
+	for (unsigned int i=0; i<8; ++i)
+		x[i] = _mm_xor_si128(x[i], t[i]);
+	BS_MixColumns(x);
+}
+
+// Bitsliced round keys occupy the first 8*(rounds+1) slots of the key table
+inline void BS_Enc_8_Blocks(__m128i x[8], const __m128i *subkeys, unsigned int rounds)
+{
+	const __m128i shiftRows = _mm_set_epi8(11,6,1,12, 7,2,13,8, 3,14,9,4, 15,10,5,0);
+
+	BS_Transpose(x);
+	BS_AddRoundKey(x, subkeys);
+	for (unsigned int i=1; i<rounds; ++i)
+	{
+		BS_SubBytes(x);
+		BS_Shuffle(x, shiftRows);
+		BS_MixColumns(x);
+		BS_AddRoundKey(x, subkeys+8*i);
+	}
+	BS_SubBytes(x);
+	BS_Shuffle(x, shiftRows);
+	BS_AddRoundKey(x, subkeys+8*rounds);
+	BS_Transpose(x);
+}
+
+inline void BS_Dec_8_Blocks(__m128i x[8], const __m128i *subkeys, unsigned int rounds)
+{
+	const __m128i invShiftRows = _mm_set_epi8(3,6,9,12, 15,2,5,8, 11,14,1,4, 7,10,13,0);
+
+	BS_Transpose(x);
+	BS_AddRoundKey(x, subkeys+8*rounds);
+	for (unsigned int i=rounds-1; i>0; --i)
+	{
+		BS_Shuffle(x, invShiftRows);
+		BS_InvSubBytes(x);
+		BS_AddRoundKey(x, subkeys+8*i);
+		BS_InvMixColumns(x);
+	}
+	BS_Shuffle(x, invShiftRows);
+	BS_InvSubBytes(x);
+	BS_AddRoundKey(x, subkeys);
+	BS_Transpose(x);
+}
+
+inline void BS_Dec_Block(__m128i &block, const __m128i *subkeys, unsigned int rounds)
+{
+	__m128i x[8];
+	x[0] = block;
+	for (unsigned int i=1; i<8; ++i)
+		x[i] = _mm_setzero_si128();
+	BS_Dec_8_Blocks(x, subkeys, rounds);
+	block = x[0];
+}
+
+inline __m128i VP_Transform(const __m128i x, const byte table[2][16])
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	return _mm_xor_si128(
+		_mm_shuffle_epi8(_mm_load_si128((const __m128i*)(const void*)table[0]), _mm_and_si128(x, mask)),
+		_mm_shuffle_epi8(_mm_load_si128((const __m128i*)(const void*)table[1]), _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+}
+
+inline __m128i VP_Load(const byte table[16])
+{
+	return _mm_load_si128((const __m128i*)(const void*)table);
+}
+
+// Inversion in GF(2^8) by way of GF(2^4), leaving the two nibbles in io and jo
+inline void VP_Invert(const __m128i x, __m128i &io, __m128i &jo)
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	const __m128i inv = VP_Load(VP_INV[0]), inva = VP_Load(VP_INV[1]);
+	const __m128i i = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+	const __m128i k = _mm_and_si128(x, mask);
+	const __m128i ak = _mm_shuffle_epi8(inva, k);
+	const __m128i j = _mm_xor_si128(i, k);
+	const __m128i iak = _mm_xor_si128(_mm_shuffle_epi8(inv, i), ak);
+	const __m128i jak = _mm_xor_si128(_mm_shuffle_epi8(inv, j), ak);
+	io = _mm_xor_si128(_mm_shuffle_epi8(inv, iak), j);
+	jo = _mm_xor_si128(_mm_shuffle_epi8(inv, jak), i);
+}
+
+// Vector permute round keys follow the bitsliced round keys
+inline void VP_Enc_Block(__m128i &block, const __m128i *subkeys, unsigned int rounds)
+{
+	const __m128i *rk = subkeys + 8*(rounds+1);
+	__m128i io, jo, x = _mm_xor_si128(VP_Transform(block, VP_IPT), _mm_load_si128(rk));
+	unsigned int r = 1;
+
+	for (unsigned int i=1; i<rounds; ++i)
+	{
+		VP_Invert(x, io, jo);
+		const __m128i forward = VP_Load(VP_MC_FORWARD[r]), backward = VP_Load(VP_MC_BACKWARD[r]);
+		const __m128i a = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(VP_Load(VP_SB1[0]), io),
+			_mm_load_si128(rk+i)), _mm_shuffle_epi8(VP_Load(VP_SB1[1]), jo));
+		const __m128i a2 = _mm_xor_si128(_mm_shuffle_epi8(VP_Load(VP_SB2[0]), io), _mm_shuffle_epi8(VP_Load(VP_SB2[1]), jo));
+		const __m128i t0 = _mm_xor_si128(a2, _mm_shuffle_epi8(a, forward));
+		const __m128i t3 = _mm_xor_si128(t0, _mm_shuffle_epi8(a, backward));
+		x = _mm_xor_si128(_mm_shuffle_epi8(t0, forward), t3);
+		r = (r+1)%4;
+	}
+
+	VP_Invert(x, io, jo);
+	x = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(VP_Load(VP_SBO[0]), io),
+		_mm_load_si128(rk+rounds)), _mm_shuffle_epi8(VP_Load(VP_SBO[1]), jo));
+	block = _mm_shuffle_epi8(x, VP_Load(VP_SR[r]));
+}
+
+// Converts the standard key schedule to the bitsliced and vector permute forms
+static void Rijndael_SSSE3_SetKey(const byte *schedule, __m128i *subkeys, unsigned int rounds, bool forward)
+{
+	for (unsigned int i=0; i<=rounds; ++i)
+	{
+		byte bits[8][16];
+		for (unsigned int j=0; j<16; ++j)
+			for (unsigned int k=0; k<8; ++k)
+				bits[k][j] = byte(0) - ((schedule[16*i+j] >> (7-k)) & 1);
+		for (unsigned int k=0; k<8; ++k)
+			subkeys[8*i+k] = _mm_loadu_si128((const __m128i*)(const void*)bits[k]);
+		SecureWipeArray(&bits[0][0], sizeof(bits));
+	}
+
+	if (!forward)
+		return;
+
+	const __m128i mcf = VP_Load(VP_MC_FORWARD[0]), s63 = _mm_set1_epi8(0x5b);
+	__m128i *rk = subkeys + 8*(rounds+1);
+	unsigned int r = 3;
+
+	rk[0] = VP_Transform(_mm_loadu_si128((const __m128i*)(const void*)schedule), VP_IPT);
+	for (unsigned int i=1; i<rounds; ++i)
+	{
+		__m128i x = _mm_xor_si128(VP_Transform(_mm_loadu_si128((const __m128i*)(const void*)(schedule+16*i)), VP_IPT), s63);
+		x = _mm_shuffle_epi8(x, mcf);
+		__m128i t = x;
+		x = _mm_shuffle_epi8(x, mcf);
+		t = _mm_xor_si128(t, x);
+		x = _mm_shuffle_epi8(x, mcf);
+		t = _mm_xor_si128(t, x);
+		rk[i] = _mm_shuffle_epi8(t, VP_Load(VP_SR[r]));
+		r = (r+3)%4;
+	}
+	rk[rounds] = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(const void*)(schedule+16*rounds)), VP_Load(VP_SR[r])), _mm_set1_epi8(0x63));
+}
+
+template <typename F1, typename F8>
+inline size_t Rijndael_SSSE3_AdvancedProcessBlocks(F1 func1, F8 func8, const __m128i *subkeys, unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+	size_t blockSize = 16;
+	size_t inIncrement = (flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)) ? 0 : blockSize;
+	size_t xorIncrement = xorBlocks ? blockSize : 0;
+	size_t outIncrement = (flags & BlockTransformation::BT_DontIncrementInOutPointers) ? 0 : blockSize;
+
+	if (flags & BlockTransformation::BT_ReverseDirection)
+	{
+		CRYPTOPP_ASSERT(length % blockSize == 0);
+		inBlocks += length - blockSize;
+		xorBlocks += length - blockSize;
+		outBlocks += length - blockSize;
+		inIncrement = 0-inIncrement;
+		xorIncrement = 0-xorIncrement;
+		outIncrement = 0-outIncrement;
+	}
+
+	if (flags & BlockTransformation::BT_AllowParallel)
+	{
+		while (length >= 8*blockSize)
+		{
+			__m128i block[8];
+			block[0] = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+			if (flags & BlockTransformation::BT_InBlockIsCounter)
+				GenerateCounterBlocks_SSE2(const_cast<byte *>(inBlocks), block, 8, flags);
+			else
+			{
+				for (unsigned int i=1; i<8; ++i)
+				{
+					inBlocks += inIncrement;
+					block[i] = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+				}
+				inBlocks += inIncrement;
+			}
+
+			if (flags & BlockTransformation::BT_XorInput)
+			{
+				// Coverity finding, appears to be false positive. Assert the condition.
+				CRYPTOPP_ASSERT(xorBlocks);
+				for (unsigned int i=0; i<8; ++i)
+				{
+					block[i] = _mm_xor_si128(block[i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+					xorBlocks += xorIncrement;
+				}
+			}
+
+			func8(block, subkeys, rounds);
+
+			if (xorBlocks && !(flags & BlockTransformation::BT_XorInput))
+			{
+				for (unsigned int i=0; i<8; ++i)
+				{
+					block[i] = _mm_xor_si128(block[i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+					xorBlocks += xorIncrement;
+				}
+			}
+
+			for (unsigned int i=0; i<8; ++i)
+			{
+				_mm_storeu_si128((__m128i *)(void *)outBlocks, block[i]);
+				outBlocks += outIncrement;
+			}
+
+			length -= 8*blockSize;
+		}
+	}
+
+	while (length >= blockSize)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+
+		if (flags & BlockTransformation::BT_XorInput)
+			block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+
+		if (flags & BlockTransformation::BT_InBlockIsCounter)
+			IncrementCounterBlock(const_cast<byte *>(inBlocks), 16, flags);
 
 		func1(block, subkeys, rounds);
 
@@ -1279,15 +1877,17 @@ struct Locals
 const size_t s_aliasPageSize = 4096;
 const size_t s_aliasBlockSize = 256;
 const size_t s_sizeToAllocate = s_aliasPageSize + s_aliasBlockSize + sizeof(Locals);
-
-Rijndael::Enc::Enc() : m_aliasBlock(s_sizeToAllocate) { }
 #endif
 
 size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
 {
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+	if (UseRijndaelSSSE3())
+		return Rijndael_SSSE3_AdvancedProcessBlocks(VP_Enc_Block, BS_Enc_8_Blocks, (const __m128i *)(const void *)m_ssse3Key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 	if (HasAESNI())
-		return AESNI_AdvancedProcessBlocks(AESNI_Enc_Block, AESNI_Enc_4_Blocks, (MAYBE_CONST __m128i *)(const void *)m_key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+		return AESNI_AdvancedProcessBlocks<AESNI_Enc_Block, AESNI_Enc_4_Blocks>((MAYBE_CONST __m128i *)(const void *)m_key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
 #endif
 
 #if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
@@ -1296,8 +1896,30 @@ size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 		if (length < BLOCKSIZE)
 			return length;
 
+		// The assembly caches the first round of the counter block, so wider counters are
+		//   processed in runs that end where the last byte wraps
+		if ((flags & BT_InBlockIsCounter) && (flags & (BT_Counter32|BT_Counter64)))
+		{
+			byte *counter = const_cast<byte *>(inBlocks);
+			const unsigned int width = (flags & BT_Counter64) ? 8 : 4;
+			const size_t outIncrement = (flags & BT_DontIncrementInOutPointers) ? 0 : 1;
+			while (length >= BLOCKSIZE)
+			{
+				const size_t len = STDMIN(length - length%BLOCKSIZE, size_t(256-counter[BLOCKSIZE-1])*BLOCKSIZE);
+				AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, len, flags & ~(BT_Counter32|BT_Counter64));
+				if (counter[BLOCKSIZE-1] == 0)
+					IncrementCounterByOne(counter+BLOCKSIZE-width, width-1);
+
+				xorBlocks += xorBlocks ? len : 0;
+				outBlocks += outIncrement*len;
+				length -= len;
+			}
+			return length;
+		}
+
+		// The locals live on the stack so that threads can share one keyed object
 		static const byte *zeros = (const byte*)(Te+256);
-		byte *space = NULLPTR, *originalSpace = const_cast<byte*>(m_aliasBlock.data());
+		byte originalSpace[s_sizeToAllocate], *space = NULLPTR;
 
 		// round up to nearest 256 byte boundary
 		space = originalSpace +	(s_aliasBlockSize - (uintptr_t)originalSpace % s_aliasBlockSize) % s_aliasBlockSize;
@@ -1334,6 +1956,12 @@ size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 		locals.keysBegin = (12-keysToCopy)*16;
 
 		Rijndael_Enc_AdvancedProcessBlocks(&locals, m_key);
+		SecureWipeArray(locals.subkeys, COUNTOF(locals.subkeys));
+		SecureWipeArray(locals.workspace, COUNTOF(locals.workspace));
+
+		// The assembly does not store the counter back
+		if (flags & BT_InBlockIsCounter)
+			const_cast<byte *>(inBlocks)[BLOCKSIZE-1] += byte(length/BLOCKSIZE);
 
 		return length % BLOCKSIZE;
 	}
@@ -1342,20 +1970,161 @@ size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
 }
 
+size_t Rijndael::Enc::InterleaveCBCMACAndCTR(byte *macBlock, byte *counter, const byte *inBlocks, byte *outBlocks, size_t length, bool macOutput) const
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasAESNI() && length >= BLOCKSIZE)
+	{
+		MAYBE_CONST __m128i *subkeys = (MAYBE_CONST __m128i *)(const void *)m_key.begin();
+		const word32 flags = BT_InBlockIsCounter|BT_Counter64;
+		const size_t blocks = length / BLOCKSIZE;
+
+		// The keystream runs one block ahead of the CBC-MAC. Each MAC block is encrypted in
+		//   lockstep with the next counter block, which hides the counter block behind the
+		//   latency of the MAC chain. Decryption needs the keystream before it can MAC the
+		//   plaintext, so this also works when the MAC is over the output.
+		__m128i mac = _mm_loadu_si128((const __m128i *)(const void *)macBlock), keystream;
+		GenerateCounterBlocks_SSE2(counter, &keystream, 1, flags);
+		AESNI_Enc_Block(keystream, subkeys, m_rounds);
+
+		for (size_t i=0; i<blocks; ++i, inBlocks+=BLOCKSIZE, outBlocks+=BLOCKSIZE)
+		{
+			const __m128i in = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+			const __m128i out = _mm_xor_si128(in, keystream);
+			_mm_storeu_si128((__m128i *)(void *)outBlocks, out);
+			mac = _mm_xor_si128(mac, macOutput ? out : in);
+
+			if (i+1 < blocks)
+			{
+				GenerateCounterBlocks_SSE2(counter, &keystream, 1, flags);
+				AESNI_Enc_2_Blocks(mac, keystream, subkeys, m_rounds);
+			}
+			else
+				AESNI_Enc_Block(mac, subkeys, m_rounds);
+		}
+
+		_mm_storeu_si128((__m128i *)(void *)macBlock, mac);
+		return length % BLOCKSIZE;
+	}
+#else
+	CRYPTOPP_UNUSED(macBlock); CRYPTOPP_UNUSED(counter); CRYPTOPP_UNUSED(inBlocks);
+	CRYPTOPP_UNUSED(outBlocks); CRYPTOPP_UNUSED(macOutput);
+#endif
+
+	return length;
+}
+
+bool Rijndael::Enc::CBCEncryptWithKeys(const BlockCipher *const *ciphers, byte *chainBlocks, const byte *const *inputs, byte *const *outputs, size_t count, size_t blocks)
+{
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (!HasAESNI() || count == 0)
+		return false;
+
+	// The objects are checked by exact type, which is much cheaper than a dynamic_cast.
+	//   The type is checked before any member is read.
+	if (typeid(*ciphers[0]) != typeid(Rijndael::Encryption))
+		return false;
+
+	const unsigned int rounds = static_cast<const Rijndael::Encryption *>(ciphers[0])->m_rounds;
+	for (size_t i=1; i<count; ++i)
+	{
+		if (typeid(*ciphers[i]) != typeid(Rijndael::Encryption) || static_cast<const Rijndael::Encryption *>(ciphers[i])->m_rounds != rounds)
+			return false;
+	}
+
+	MAYBE_CONST __m128i *subkeys[4];
+	size_t i = 0;
+	for (; i+4<=count; i+=4)
+	{
+		for (unsigned int j=0; j<4; ++j)
+			subkeys[j] = (MAYBE_CONST __m128i *)(const void *)static_cast<const Rijndael::Encryption *>(ciphers[i+j])->m_key.begin();
+
+		__m128i *b = (__m128i *)(void *)(chainBlocks+16*i);
+		__m128i block0 = _mm_loadu_si128(b), block1 = _mm_loadu_si128(b+1);
+		__m128i block2 = _mm_loadu_si128(b+2), block3 = _mm_loadu_si128(b+3);
+		const byte *in0 = inputs[i], *in1 = inputs[i+1], *in2 = inputs[i+2], *in3 = inputs[i+3];
+		for (size_t k=0; k<blocks; ++k, in0+=16, in1+=16, in2+=16, in3+=16)
+		{
+			block0 = _mm_xor_si128(block0, _mm_loadu_si128((const __m128i *)(const void *)in0));
+			block1 = _mm_xor_si128(block1, _mm_loadu_si128((const __m128i *)(const void *)in1));
+			block2 = _mm_xor_si128(block2, _mm_loadu_si128((const __m128i *)(const void *)in2));
+			block3 = _mm_xor_si128(block3, _mm_loadu_si128((const __m128i *)(const void *)in3));
+			AESNI_Enc_4_Blocks_Keys(block0, block1, block2, block3, subkeys, rounds);
+
+			if (outputs)
+			{
+				_mm_storeu_si128((__m128i *)(void *)(outputs[i]+16*k), block0);
+				_mm_storeu_si128((__m128i *)(void *)(outputs[i+1]+16*k), block1);
+				_mm_storeu_si128((__m128i *)(void *)(outputs[i+2]+16*k), block2);
+				_mm_storeu_si128((__m128i *)(void *)(outputs[i+3]+16*k), block3);
+			}
+		}
+		_mm_storeu_si128(b, block0); _mm_storeu_si128(b+1, block1);
+		_mm_storeu_si128(b+2, block2); _mm_storeu_si128(b+3, block3);
+	}
+
+	for (; i<count; ++i)
+	{
+		MAYBE_CONST __m128i *key = (MAYBE_CONST __m128i *)(const void *)static_cast<const Rijndael::Encryption *>(ciphers[i])->m_key.begin();
+		__m128i *b = (__m128i *)(void *)(chainBlocks+16*i);
+		__m128i block = _mm_loadu_si128(b);
+		const byte *in = inputs[i];
+		for (size_t k=0; k<blocks; ++k, in+=16)
+		{
+			block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i *)(const void *)in));
+			AESNI_Enc_Block(block, key, rounds);
+			if (outputs)
+				_mm_storeu_si128((__m128i *)(void *)(outputs[i]+16*k), block);
+		}
+		_mm_storeu_si128(b, block);
+	}
+
+	return true;
+#else
+	CRYPTOPP_UNUSED(ciphers); CRYPTOPP_UNUSED(chainBlocks); CRYPTOPP_UNUSED(inputs);
+	CRYPTOPP_UNUSED(outputs); CRYPTOPP_UNUSED(count); CRYPTOPP_UNUSED(blocks);
+	return false;
+#endif
+}
+
 #endif
 
 #if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
 size_t Rijndael::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
 {
+#if CRYPTOPP_ENABLE_RIJNDAEL_SSSE3_INTRINSICS
+	if (UseRijndaelSSSE3())
+		return Rijndael_SSSE3_AdvancedProcessBlocks(BS_Dec_Block, BS_Dec_8_Blocks, (const __m128i *)(const void *)m_ssse3Key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 #if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
 	if (HasAESNI())
-		return AESNI_AdvancedProcessBlocks(AESNI_Dec_Block, AESNI_Dec_4_Blocks, (MAYBE_CONST __m128i *)(const void *)m_key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+		return AESNI_AdvancedProcessBlocks<AESNI_Dec_Block, AESNI_Dec_4_Blocks>((MAYBE_CONST __m128i *)(const void *)m_key.begin(), m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
 #endif
 
 	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
 }
 #endif	// CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
 
+void Rijndael::EncryptBlock(byte *outBlock, const byte *key, size_t keyLength, const byte *inBlock)
+{
+	CRYPTOPP_ASSERT(outBlock && key && inBlock);
+	CRYPTOPP_ASSERT(keyLength == 16 || keyLength == 24 || keyLength == 32);
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	if (HasAESNI() && keyLength != 24)
+	{
+		const __m128i block = _mm_loadu_si128((const __m128i *)(const void *)inBlock);
+		_mm_storeu_si128((__m128i *)(void *)outBlock, keyLength == 16 ?
+			AESNI_Enc_Block_OneShot128(block, key) : AESNI_Enc_Block_OneShot256(block, key));
+		return;
+	}
+#endif
+
+	Encryption cipher;
+	cipher.UncheckedSetKey(key, (unsigned int)keyLength, g_nullNameValuePairs);
+	cipher.ProcessBlock(inBlock, outBlock);
+}
+
 NAMESPACE_END
 
 #endif
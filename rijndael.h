@@ -3,7 +3,10 @@
 //! \file rijndael.h
 //! \brief Classes for Rijndael encryption algorithm
 //! \details All key sizes are supported. The library only provides Rijndael with 128-bit blocks,
-//!   and not 192-bit or 256-bit blocks
+//!   and not 192-bit or 256-bit blocks.
+//! \details On x86 processors with SSSE3 but without AES-NI the library uses a constant-time
+//!   implementation. Parallel modes use a bitsliced 8-block kernel, and single blocks are encrypted
+//!   using vector permutes. Neither depends on table lookups.
 
 #ifndef CRYPTOPP_RIJNDAEL_H
 #define CRYPTOPP_RIJNDAEL_H
@@ -47,6 +50,10 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 
 		unsigned int m_rounds;
 		FixedSizeAlignedSecBlock<word32, 4*15> m_key;
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE
+		// Bitsliced and vector permute round keys for the constant-time SSSE3 code path
+		AlignedSecByteBlock m_ssse3Key;
+#endif
 	};
 
 	//! \brief Rijndael block cipher data processing functions
@@ -56,10 +63,37 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
 #if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
-		Enc();
 		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
-	private:
-		SecByteBlock m_aliasBlock;
+		bool SupportsWideCounters() const {return true;}
+
+		//! \brief Encrypt in counter mode and compute a CBC-MAC in one pass
+		//! \param macBlock the CBC-MAC state, updated in place
+		//! \param counter the counter block, incremented in place as a 64-bit big-endian integer
+		//! \param inBlocks the input blocks
+		//! \param outBlocks the output blocks, which may be the same as the input blocks
+		//! \param length the size of the blocks, in bytes
+		//! \param macOutput true to authenticate the output blocks rather than the input blocks
+		//! \returns the number of bytes that were not processed
+		//! \details InterleaveCBCMACAndCTR() overlaps the serial CBC-MAC with the counter mode
+		//!   keystream, which is the inner loop of CCM. It is only available with AES-NI. If
+		//!   AES-NI is not available then nothing is processed and the function returns \p length.
+		size_t InterleaveCBCMACAndCTR(byte *macBlock, byte *counter, const byte *inBlocks, byte *outBlocks, size_t length, bool macOutput) const;
+
+		//! \brief Run several CBC chains, each with its own key
+		//! \param ciphers the AES encryption objects, one per chain
+		//! \param chainBlocks the chaining values, 16 bytes each
+		//! \param inputs the input pointers, one per chain
+		//! \param outputs the output pointers, one per chain, or NULL
+		//! \param count the number of chains
+		//! \param blocks the number of blocks to process on each chain
+		//! \returns true if the chains were processed, false otherwise
+		//! \details CBCEncryptWithKeys() xors \p blocks blocks of each input into its chaining value
+		//!   and encrypts, with the chains running side by side through AES-NI. The chaining values
+		//!   stay in registers for the whole run. Each encrypted block is written to the chain's
+		//!   output, or only kept as the chaining value when \p outputs is NULL, which is CBC-MAC.
+		//!   It returns false and processes nothing if AES-NI is not available, if an object is not
+		//!   a Rijndael::Encryption, or if the key lengths differ.
+		static bool CBCEncryptWithKeys(const BlockCipher *const *ciphers, byte *chainBlocks, const byte *const *inputs, byte *const *outputs, size_t count, size_t blocks);
 #endif
 	};
 
@@ -71,12 +105,25 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
 #if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
 		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
 #endif
 	};
 
 public:
 	typedef BlockCipherFinal<ENCRYPTION, Enc> Encryption;
 	typedef BlockCipherFinal<DECRYPTION, Dec> Decryption;
+
+	//! \brief Encrypts one block without a Rijndael object
+	//! \param outBlock the buffer for the 16-byte ciphertext
+	//! \param key the key
+	//! \param keyLength the size of the key, 16, 24 or 32 bytes
+	//! \param inBlock the 16-byte plaintext
+	//! \details EncryptBlock() is for keys that are used once, like the header protection
+	//!   mask of QUIC. The key length is not checked, and no NameValuePairs are parsed. With
+	//!   AES-NI and a 16 or 32-byte key the round keys are expanded in registers alongside the
+	//!   rounds, and nothing is stored. Otherwise a Rijndael::Encryption object is keyed on the
+	//!   stack.
+	static void EncryptBlock(byte *outBlock, const byte *key, size_t keyLength, const byte *inBlock);
 };
 
 typedef Rijndael::Encryption RijndaelEncryption;
@@ -9,13 +9,6 @@
 #include "strciphr.h"
 #include "secblock.h"
 
-// TODO: work around GCC 4.8+ issue with SSE2 ASM until the exact details are known
-//   and fix is released. Duplicate with "valgrind ./cryptest.exe tv salsa"
-// "Inline assembly operands don't work with .intel_syntax", http://llvm.org/bugs/show_bug.cgi?id=24232
-#if CRYPTOPP_BOOL_X32 || defined(CRYPTOPP_DISABLE_INTEL_ASM) || (CRYPTOPP_GCC_VERSION >= 40800)
-# define CRYPTOPP_DISABLE_SALSA_ASM
-#endif
-
 NAMESPACE_BEGIN(CryptoPP)
 
 //! \class Salsa20_Info
@@ -35,10 +28,10 @@ protected:
 	void CipherResynchronize(byte *keystreamBuffer, const byte *IV, size_t length);
 	bool CipherIsRandomAccess() const {return true;}
 	void SeekToIteration(lword iterationCount);
-#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64) && !defined(CRYPTOPP_DISABLE_SALSA_ASM)
-	unsigned int GetAlignment() const;
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
 	unsigned int GetOptimalBlockSize() const;
 #endif
+	void AdvanceCounter(size_t blocks);
 
 	FixedSizeAlignedSecBlock<word32, 16> m_state;
 	int m_rounds;
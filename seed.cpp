@@ -3,6 +3,7 @@
 #include "pch.h"
 #include "seed.h"
 #include "misc.h"
+#include "advsimd.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -10,7 +11,8 @@ static const word32 s_kc[16] = {
 	0x9e3779b9, 0x3c6ef373, 0x78dde6e6, 0xf1bbcdcc, 0xe3779b99, 0xc6ef3733, 0x8dde6e67, 0x1bbcdccf,
 	0x3779b99e, 0x6ef3733c, 0xdde6e678, 0xbbcdccf1, 0x779b99e3, 0xef3733c6, 0xde6e678d, 0xbcdccf1b};
 
-static const byte s_s0[256] = {
+// The S-boxes are padded so that a 32-bit gather at any index stays in bounds
+static const byte s_s0[256+3] = {
 	0xA9, 0x85, 0xD6, 0xD3, 0x54, 0x1D, 0xAC, 0x25, 0x5D, 0x43, 0x18, 0x1E, 0x51, 0xFC, 0xCA, 0x63, 0x28,
 	0x44, 0x20, 0x9D, 0xE0, 0xE2, 0xC8, 0x17, 0xA5, 0x8F, 0x03, 0x7B, 0xBB, 0x13, 0xD2, 0xEE, 0x70, 0x8C,
 	0x3F, 0xA8, 0x32, 0xDD, 0xF6, 0x74, 0xEC, 0x95, 0x0B, 0x57, 0x5C, 0x5B, 0xBD, 0x01, 0x24, 0x1C, 0x73,
@@ -28,7 +30,7 @@ static const byte s_s0[256] = {
 	0xCD, 0x88, 0x16, 0x3A, 0x58, 0xD4, 0x62, 0x29, 0x07, 0x33, 0xE8, 0x1B, 0x05, 0x79, 0x90, 0x6A, 0x2A,
 	0x9A};
 
-static const byte s_s1[256] = {
+static const byte s_s1[256+3] = {
 	0x38, 0xE8, 0x2D, 0xA6, 0xCF, 0xDE, 0xB3, 0xB8, 0xAF, 0x60, 0x55, 0xC7, 0x44, 0x6F, 0x6B, 0x5B, 0xC3,
 	0x62, 0x33, 0xB5, 0x29, 0xA0, 0xE2, 0xA7, 0xD3, 0x91, 0x11, 0x06, 0x1C, 0xBC, 0x36, 0x4B, 0xEF, 0x88,
 	0x6C, 0xA8, 0x17, 0xC4, 0x16, 0xF4, 0xC2, 0x45, 0xE1, 0xD6, 0x3F, 0x3D, 0x8E, 0x98, 0x28, 0x4E, 0xF6,
@@ -101,4 +103,66 @@ void SEED::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, b
 	Block::Put(xorBlock, outBlock)(b0)(b1)(a0)(a1);
 }
 
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+// SS(x) for byte N of each word, which is s[x]*0x01010101 & mask
+template <unsigned int N>
+inline __m256i SEED_AVX2_SS(const __m256i &x, const byte *s, word32 mask)
+{
+	const __m256i index = _mm256_and_si256(_mm256_srli_epi32(x, 8*N), _mm256_set1_epi32(0xff));
+	__m256i t = _mm256_and_si256(_mm256_i32gather_epi32((const int *)(const void *)s, index, 1), _mm256_set1_epi32(0xff));
+	t = _mm256_or_si256(t, _mm256_slli_epi32(t, 8));
+	t = _mm256_or_si256(t, _mm256_slli_epi32(t, 16));
+	return _mm256_and_si256(t, _mm256_set1_epi32((int)mask));
+}
+
+inline __m256i SEED_AVX2_G(const __m256i &x)
+{
+	return _mm256_xor_si256(
+		_mm256_xor_si256(SEED_AVX2_SS<0>(x, s_s0, 0x3FCFF3FC), SEED_AVX2_SS<1>(x, s_s1, 0xFC3FCFF3)),
+		_mm256_xor_si256(SEED_AVX2_SS<2>(x, s_s0, 0xF3FC3FCF), SEED_AVX2_SS<3>(x, s_s1, 0xCFF3FC3F)));
+}
+
+struct SEED_AVX2_8_Blocks
+{
+	SEED_AVX2_8_Blocks(const word32 *k) : m_k(k) {}
+
+	void operator()(__m128i x[8]) const
+	{
+		__m256i w[4];
+		Transpose4x8_AVX2(x, w);
+		__m256i a0 = ByteReverse32_AVX2(w[0]), a1 = ByteReverse32_AVX2(w[1]);
+		__m256i b0 = ByteReverse32_AVX2(w[2]), b1 = ByteReverse32_AVX2(w[3]);
+		__m256i t0, t1;
+
+		for (int i=0; i<SEED::ROUNDS; i+=2)
+		{
+			t0 = _mm256_xor_si256(b0, _mm256_set1_epi32((int)m_k[2*i+0]));
+			t1 = _mm256_xor_si256(_mm256_xor_si256(b1, _mm256_set1_epi32((int)m_k[2*i+1])), t0);
+			t1 = SEED_AVX2_G(t1); t0 = _mm256_add_epi32(t0, t1); t0 = SEED_AVX2_G(t0);
+			t1 = _mm256_add_epi32(t1, t0); t1 = SEED_AVX2_G(t1);
+			a0 = _mm256_xor_si256(a0, _mm256_add_epi32(t0, t1)); a1 = _mm256_xor_si256(a1, t1);
+
+			t0 = _mm256_xor_si256(a0, _mm256_set1_epi32((int)m_k[2*i+2]));
+			t1 = _mm256_xor_si256(_mm256_xor_si256(a1, _mm256_set1_epi32((int)m_k[2*i+3])), t0);
+			t1 = SEED_AVX2_G(t1); t0 = _mm256_add_epi32(t0, t1); t0 = SEED_AVX2_G(t0);
+			t1 = _mm256_add_epi32(t1, t0); t1 = SEED_AVX2_G(t1);
+			b0 = _mm256_xor_si256(b0, _mm256_add_epi32(t0, t1)); b1 = _mm256_xor_si256(b1, t1);
+		}
+
+		w[0] = ByteReverse32_AVX2(b0); w[1] = ByteReverse32_AVX2(b1);
+		w[2] = ByteReverse32_AVX2(a0); w[3] = ByteReverse32_AVX2(a1);
+		Transpose8x4_AVX2(w, x);
+	}
+
+	const word32 *m_k;
+};
+
+size_t SEED::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	if (HasAVX2())
+		AdvancedProcessBlocks_SSE2<BLOCKSIZE, 8>(SEED_AVX2_8_Blocks(m_k), inBlocks, xorBlocks, outBlocks, length, flags);
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
 NAMESPACE_END
@@ -7,7 +7,13 @@
 
 #include "pch.h"
 #include "shacal2.h"
+#include "advsimd.h"
 #include "misc.h"
+#include "cpu.h"
+
+#if CRYPTOPP_BOOL_SSE_SHA_INTRINSICS_AVAILABLE
+# define CRYPTOPP_ENABLE_SHACAL2_SHANI_INTRINSICS 1
+#endif
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -52,8 +58,166 @@ void SHACAL2::Base::UncheckedSetKey(const byte *userKey, unsigned int keylen, co
 
 typedef BlockGetAndPut<word32, BigEndian> Block;
 
+#if CRYPTOPP_ENABLE_SHACAL2_SHANI_INTRINSICS
+// Encrypts N blocks held in x[2*i] (ABCD) and x[2*i+1] (EFGH). The round keys
+//   already include the SHA-256 constants, so each pair of rounds is one SHA256RNDS2.
+template <unsigned int N>
+inline void SHACAL2_SHANI_Enc_Blocks(__m128i x[2*N], const word32 *rk)
+{
+	const __m128i MASK = _mm_set_epi64x(W64LIT(0x0c0d0e0f08090a0b), W64LIT(0x0405060700010203));
+	__m128i state0[N], state1[N];
+
+	for (unsigned int i=0; i<N; ++i)
+	{
+		const __m128i t = _mm_shuffle_epi32(_mm_shuffle_epi8(x[2*i], MASK), 0xB1); // CDAB
+		const __m128i u = _mm_shuffle_epi32(_mm_shuffle_epi8(x[2*i+1], MASK), 0x1B); // EFGH
+		state0[i] = _mm_alignr_epi8(t, u, 8); // ABEF
+		state1[i] = _mm_blend_epi16(u, t, 0xF0); // CDGH
+	}
+
+	for (unsigned int r=0; r<64; r+=4)
+	{
+		const __m128i k0 = _mm_loadu_si128((const __m128i *)(const void *)(rk+r));
+		const __m128i k1 = _mm_shuffle_epi32(k0, 0x0E);
+		for (unsigned int i=0; i<N; ++i)
+			state1[i] = _mm_sha256rnds2_epu32(state1[i], state0[i], k0);
+		for (unsigned int i=0; i<N; ++i)
+			state0[i] = _mm_sha256rnds2_epu32(state0[i], state1[i], k1);
+	}
+
+	for (unsigned int i=0; i<N; ++i)
+	{
+		const __m128i t = _mm_shuffle_epi32(state0[i], 0x1B); // FEBA
+		const __m128i u = _mm_shuffle_epi32(state1[i], 0xB1); // DCHG
+		x[2*i] = _mm_shuffle_epi8(_mm_blend_epi16(t, u, 0xF0), MASK); // DCBA
+		x[2*i+1] = _mm_shuffle_epi8(_mm_alignr_epi8(u, t, 8), MASK); // HGFE
+	}
+}
+
+// Processes full groups of 4 blocks. 'length' must be a multiple of 128.
+inline void SHACAL2_SHANI_AdvancedProcessBlocks(const word32 *rk, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+	const size_t blockSize = 32;
+	size_t inIncrement = (flags & BlockTransformation::BT_InBlockIsCounter) ? 0 : blockSize;
+	size_t xorIncrement = xorBlocks ? blockSize : 0;
+	size_t outIncrement = blockSize;
+
+	if (flags & BlockTransformation::BT_ReverseDirection)
+	{
+		inBlocks += length - blockSize;
+		xorBlocks += length - blockSize;
+		outBlocks += length - blockSize;
+		inIncrement = 0-inIncrement;
+		xorIncrement = 0-xorIncrement;
+		outIncrement = 0-outIncrement;
+	}
+
+	while (length >= 4*blockSize)
+	{
+		__m128i x[8];
+		if (flags & BlockTransformation::BT_InBlockIsCounter)
+		{
+			// The counter is at the end of the block, which is in the high half
+			__m128i counters[4];
+			GenerateCounterBlocks_SSE2(const_cast<byte *>(inBlocks+16), counters, 4, flags);
+			for (unsigned int i=0; i<4; ++i)
+			{
+				x[2*i] = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+				x[2*i+1] = counters[i];
+			}
+		}
+		else
+		{
+			for (unsigned int i=0; i<4; ++i, inBlocks += inIncrement)
+			{
+				x[2*i] = _mm_loadu_si128((const __m128i *)(const void *)inBlocks);
+				x[2*i+1] = _mm_loadu_si128((const __m128i *)(const void *)(inBlocks+16));
+			}
+		}
+
+		if (flags & BlockTransformation::BT_XorInput)
+		{
+			CRYPTOPP_ASSERT(xorBlocks);
+			for (unsigned int i=0; i<4; ++i, xorBlocks += xorIncrement)
+			{
+				x[2*i] = _mm_xor_si128(x[2*i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+				x[2*i+1] = _mm_xor_si128(x[2*i+1], _mm_loadu_si128((const __m128i *)(const void *)(xorBlocks+16)));
+			}
+		}
+
+		SHACAL2_SHANI_Enc_Blocks<4>(x, rk);
+
+		// All of xorBlocks must be read before any of outBlocks is written
+		if (xorBlocks && !(flags & BlockTransformation::BT_XorInput))
+		{
+			for (unsigned int i=0; i<4; ++i, xorBlocks += xorIncrement)
+			{
+				x[2*i] = _mm_xor_si128(x[2*i], _mm_loadu_si128((const __m128i *)(const void *)xorBlocks));
+				x[2*i+1] = _mm_xor_si128(x[2*i+1], _mm_loadu_si128((const __m128i *)(const void *)(xorBlocks+16)));
+			}
+		}
+
+		for (unsigned int i=0; i<4; ++i, outBlocks += outIncrement)
+		{
+			_mm_storeu_si128((__m128i *)(void *)outBlocks, x[2*i]);
+			_mm_storeu_si128((__m128i *)(void *)(outBlocks+16), x[2*i+1]);
+		}
+
+		length -= 4*blockSize;
+	}
+}
+
+size_t SHACAL2::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+{
+	const word32 parallelFlags = BT_AllowParallel|BT_DontIncrementInOutPointers;
+	if ((flags & parallelFlags) == BT_AllowParallel && length >= 4*BLOCKSIZE && HasSHA())
+	{
+		const size_t remaining = length % (4*BLOCKSIZE);
+		const size_t parallel = length - remaining;
+
+		// Reverse direction works from the tail towards the head
+		if (flags & BT_ReverseDirection)
+		{
+			SHACAL2_SHANI_AdvancedProcessBlocks(m_key, inBlocks+remaining,
+				xorBlocks ? xorBlocks+remaining : NULLPTR, outBlocks+remaining, parallel, flags);
+		}
+		else
+		{
+			SHACAL2_SHANI_AdvancedProcessBlocks(m_key, inBlocks, xorBlocks, outBlocks, parallel, flags);
+			inBlocks += (flags & BT_InBlockIsCounter) ? 0 : parallel;
+			xorBlocks += xorBlocks ? parallel : 0;
+			outBlocks += parallel;
+		}
+
+		length = remaining;
+		if (length < BLOCKSIZE)
+			return length;
+	}
+
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_ENABLE_SHACAL2_SHANI_INTRINSICS
+
 void SHACAL2::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
 {
+#if CRYPTOPP_ENABLE_SHACAL2_SHANI_INTRINSICS
+	if (HasSHA())
+	{
+		__m128i x[2];
+		x[0] = _mm_loadu_si128((const __m128i *)(const void *)inBlock);
+		x[1] = _mm_loadu_si128((const __m128i *)(const void *)(inBlock+16));
+		SHACAL2_SHANI_Enc_Blocks<1>(x, m_key);
+		if (xorBlock)
+		{
+			x[0] = _mm_xor_si128(x[0], _mm_loadu_si128((const __m128i *)(const void *)xorBlock));
+			x[1] = _mm_xor_si128(x[1], _mm_loadu_si128((const __m128i *)(const void *)(xorBlock+16)));
+		}
+		_mm_storeu_si128((__m128i *)(void *)outBlock, x[0]);
+		_mm_storeu_si128((__m128i *)(void *)(outBlock+16), x[1]);
+		return;
+	}
+#endif
+
 	word32 a, b, c, d, e, f, g, h;
 	const word32 *rk = m_key;
 
@@ -20,6 +20,8 @@ struct SHACAL2_Info : public FixedBlockSize<32>, public VariableKeyLength<16, 16
 
 //! \class SHACAL2
 //! \brief SHACAL2 block cipher
+//! \details On x86 processors with the SHA extensions, encryption uses the SHA-256
+//!   round instructions and AdvancedProcessBlocks() interleaves four blocks.
 //! \sa <a href="http://www.weidai.com/scan-mirror/cs.html#SHACAL-2">SHACAL-2</a>
 class SHACAL2 : public SHACAL2_Info, public BlockCipherDocumentation
 {
@@ -38,6 +40,10 @@ class SHACAL2 : public SHACAL2_Info, public BlockCipherDocumentation
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_BOOL_SSE_SHA_INTRINSICS_AVAILABLE
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+		bool SupportsWideCounters() const {return true;}
+#endif
 	};
 
 	class CRYPTOPP_NO_VTABLE Dec : public Base
@@ -0,0 +1,215 @@
+// siphash.cpp - written and placed in the public domain
+
+#include "pch.h"
+#include "config.h"
+
+#include "siphash.h"
+#include "misc.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+template <unsigned int R>
+inline __m256i RotateLeft64_AVX2(const __m256i &x)
+{
+	return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64-R));
+}
+
+template <>
+inline __m256i RotateLeft64_AVX2<16>(const __m256i &x)
+{
+	const __m256i mask = _mm256_setr_epi8(6,7,0,1,2,3,4,5, 14,15,8,9,10,11,12,13,
+		6,7,0,1,2,3,4,5, 14,15,8,9,10,11,12,13);
+	return _mm256_shuffle_epi8(x, mask);
+}
+
+template <>
+inline __m256i RotateLeft64_AVX2<32>(const __m256i &x)
+{
+	return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2,3,0,1));
+}
+
+// SipHash_Base::SIPROUND() with one message in each 64-bit lane
+inline void SipRound_AVX2(__m256i &v0, __m256i &v1, __m256i &v2, __m256i &v3)
+{
+	v0 = _mm256_add_epi64(v0, v1);
+	v1 = RotateLeft64_AVX2<13>(v1);
+	v1 = _mm256_xor_si256(v1, v0);
+	v0 = RotateLeft64_AVX2<32>(v0);
+	v2 = _mm256_add_epi64(v2, v3);
+	v3 = RotateLeft64_AVX2<16>(v3);
+	v3 = _mm256_xor_si256(v3, v2);
+	v0 = _mm256_add_epi64(v0, v3);
+	v3 = RotateLeft64_AVX2<21>(v3);
+	v3 = _mm256_xor_si256(v3, v0);
+	v2 = _mm256_add_epi64(v2, v1);
+	v1 = RotateLeft64_AVX2<17>(v1);
+	v1 = _mm256_xor_si256(v1, v2);
+	v2 = RotateLeft64_AVX2<32>(v2);
+}
+
+// The final word holds the tail bytes and the length mod 256 in the high octet
+inline word64 LastWord(const byte *tail, size_t length)
+{
+	word64 b = word64(length) << 56;
+	switch (length % 8)
+	{
+		case 7:
+			b |= ((word64)tail[6]) << 48;
+			// fall through
+		case 6:
+			b |= ((word64)tail[5]) << 40;
+			// fall through
+		case 5:
+			b |= ((word64)tail[4]) << 32;
+			// fall through
+		case 4:
+			b |= ((word64)tail[3]) << 24;
+			// fall through
+		case 3:
+			b |= ((word64)tail[2]) << 16;
+			// fall through
+		case 2:
+			b |= ((word64)tail[1]) << 8;
+			// fall through
+		case 1:
+			b |= ((word64)tail[0]);
+	}
+	return b;
+}
+
+// Processes the first done messages, where done is a multiple of 4
+template <unsigned int C, unsigned int D>
+void SipHash_AVX2_Groups(byte *digests, const byte *key, const byte *const *inputs,
+	const size_t *lengths, size_t done, bool wide)
+{
+	const word64 k0 = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, key);
+	const word64 k1 = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, key+8);
+	const __m256i i0 = _mm256_set1_epi64x(W64LIT(0x736f6d6570736575) ^ k0);
+	const __m256i i1 = _mm256_set1_epi64x(W64LIT(0x646f72616e646f6d) ^ k1 ^ (wide ? 0xee : 0));
+	const __m256i i2 = _mm256_set1_epi64x(W64LIT(0x6c7967656e657261) ^ k0);
+	const __m256i i3 = _mm256_set1_epi64x(W64LIT(0x7465646279746573) ^ k1);
+	const size_t digestSize = wide ? 16 : 8;
+
+	// Lanes run until the longest message of the group is done, so each chunk of messages
+	//   is ordered by block count before it is split into groups. Counting sort is enough.
+	enum {CHUNK = 64, BUCKETS = 16};
+	for (size_t base = 0; base < done; base += CHUNK)
+	{
+		const size_t n = STDMIN(size_t(CHUNK), done-base);
+		byte order[CHUNK];
+		unsigned int position[BUCKETS] = {0};
+		for (size_t k=0; k<n; ++k)
+			++position[STDMIN(lengths[base+k]/8, size_t(BUCKETS-1))];
+		for (unsigned int b=0, sum=0; b<BUCKETS; ++b)
+		{
+			const unsigned int t = position[b];
+			position[b] = sum; sum += t;
+		}
+		for (size_t k=0; k<n; ++k)
+			order[position[STDMIN(lengths[base+k]/8, size_t(BUCKETS-1))]++] = (byte)k;
+
+		for (size_t g=0; g<n; g+=4)
+		{
+			// Each lane compresses its full words and then its final word. A lane that
+			//   runs out before the others reads its final word again and keeps its state.
+			const byte *input[4];
+			word64 blocks[4], last[4], minBlocks = ~word64(0), maxBlocks = 0;
+			for (unsigned int j=0; j<4; ++j)
+			{
+				const size_t length = lengths[base+order[g+j]];
+				input[j] = inputs[base+order[g+j]];
+				blocks[j] = length/8;
+				minBlocks = STDMIN(minBlocks, blocks[j]);
+				maxBlocks = STDMAX(maxBlocks, blocks[j]);
+				last[j] = LastWord(input[j]+length-length%8, length);
+			}
+
+			const __m256i limit = _mm256_loadu_si256((const __m256i *)(const void *)blocks);
+			__m256i v0 = i0, v1 = i1, v2 = i2, v3 = i3;
+			for (word64 i=0; i<=maxBlocks; ++i)
+			{
+				const byte *p[4];
+				for (unsigned int j=0; j<4; ++j)
+					p[j] = i < blocks[j] ? input[j]+i*8 : (const byte *)(last+j);
+
+				const __m256i x = _mm256_set_epi64x(
+					GetWord<word64>(false, LITTLE_ENDIAN_ORDER, p[3]), GetWord<word64>(false, LITTLE_ENDIAN_ORDER, p[2]),
+					GetWord<word64>(false, LITTLE_ENDIAN_ORDER, p[1]), GetWord<word64>(false, LITTLE_ENDIAN_ORDER, p[0]));
+				const __m256i s0 = v0, s1 = v1, s2 = v2, s3 = v3;
+
+				v3 = _mm256_xor_si256(v3, x);
+				for (unsigned int r=0; r<C; ++r)
+					SipRound_AVX2(v0, v1, v2, v3);
+				v0 = _mm256_xor_si256(v0, x);
+
+				if (i > minBlocks)
+				{
+					const __m256i keep = _mm256_cmpgt_epi64(_mm256_set1_epi64x(i), limit);
+					v0 = _mm256_blendv_epi8(v0, s0, keep);
+					v1 = _mm256_blendv_epi8(v1, s1, keep);
+					v2 = _mm256_blendv_epi8(v2, s2, keep);
+					v3 = _mm256_blendv_epi8(v3, s3, keep);
+				}
+			}
+
+			// The digests are little-endian words, which is lane order on x86
+			word64 h[2][4];
+			v2 = _mm256_xor_si256(v2, _mm256_set1_epi64x(wide ? 0xee : 0xff));
+			for (unsigned int r=0; r<D; ++r)
+				SipRound_AVX2(v0, v1, v2, v3);
+			_mm256_storeu_si256((__m256i *)(void *)h[0], _mm256_xor_si256(_mm256_xor_si256(v0, v1), _mm256_xor_si256(v2, v3)));
+
+			if (wide)
+			{
+				v1 = _mm256_xor_si256(v1, _mm256_set1_epi64x(0xdd));
+				for (unsigned int r=0; r<D; ++r)
+					SipRound_AVX2(v0, v1, v2, v3);
+				_mm256_storeu_si256((__m256i *)(void *)h[1], _mm256_xor_si256(_mm256_xor_si256(v0, v1), _mm256_xor_si256(v2, v3)));
+			}
+
+			for (unsigned int j=0; j<4; ++j)
+			{
+				byte *digest = digests + (base+order[g+j])*digestSize;
+				memcpy(digest, &h[0][j], 8);
+				if (wide)
+					memcpy(digest+8, &h[1][j], 8);
+			}
+		}
+	}
+
+}
+
+ANONYMOUS_NAMESPACE_END
+
+#endif  // CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+
+size_t CRYPTOPP_API SipHash_BatchKernel::AVX2(byte *digests, const byte *key, const byte *const *inputs,
+	const size_t *lengths, size_t count, unsigned int c, unsigned int d, bool wide)
+{
+#if CRYPTOPP_BOOL_AVX2_INTRINSICS_AVAILABLE
+	// Other round counts are left to the scalar code
+	const size_t done = count - count%4;
+	if (!HasAVX2() || !done)
+		return 0;
+	else if (c == 2 && d == 4)
+		SipHash_AVX2_Groups<2, 4>(digests, key, inputs, lengths, done, wide);
+	else if (c == 4 && d == 8)
+		SipHash_AVX2_Groups<4, 8>(digests, key, inputs, lengths, done, wide);
+	else
+		return 0;
+
+	return done;
+#else
+	CRYPTOPP_UNUSED(digests); CRYPTOPP_UNUSED(key); CRYPTOPP_UNUSED(inputs);
+	CRYPTOPP_UNUSED(lengths); CRYPTOPP_UNUSED(count); CRYPTOPP_UNUSED(c);
+	CRYPTOPP_UNUSED(d); CRYPTOPP_UNUSED(wide);
+	return 0;
+#endif
+}
+
+NAMESPACE_END
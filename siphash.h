@@ -28,10 +28,25 @@
 
 #include "cryptlib.h"
 #include "secblock.h"
+#include "seckey.h"
 #include "misc.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+//! \class SipHash_BatchKernel
+//! \brief AVX2 path of SipHash_Base::HashBatch()
+//! \details The kernel is private to SipHash_Base. HashBatch() is the public interface.
+//! \since Crypto++ 6.0
+class CRYPTOPP_DLL SipHash_BatchKernel
+{
+	template <unsigned int C, unsigned int D, bool T_128bit> friend class SipHash_Base;
+
+	// Returns the number of messages processed, which is a multiple of 4. It returns 0
+	//   when AVX2 is not available, and leaves the final count%4 messages to the caller.
+	static size_t CRYPTOPP_API AVX2(byte *digests, const byte *key, const byte *const *inputs,
+		const size_t *lengths, size_t count, unsigned int c, unsigned int d, bool wide);
+};
+
 //! \class SipHash_Info
 //! \brief SipHash message authentication code information
 //! \tparam T_128bit flag indicating 128-bit (true) versus 64-bit (false) digest size
@@ -82,6 +97,27 @@ public:
 	virtual void Update(const byte *input, size_t length);
 	virtual void TruncatedFinal(byte *digest, size_t digestSize);
 
+	//! \brief Computes a MAC without a SipHash object
+	//! \param digest the buffer for the MAC, DIGESTSIZE bytes
+	//! \param key the 16-byte key
+	//! \param input the message
+	//! \param length the size of the message, in bytes
+	//! \details Hash() keeps the state in local variables and makes no virtual calls. It is
+	//!   meant for short inputs, like keys of a hash table, where the cost of a
+	//!   MessageAuthenticationCode object exceeds the cost of the MAC.
+	static void Hash(byte *digest, const byte *key, const byte *input, size_t length);
+
+	//! \brief Computes MACs for a batch of messages under one key
+	//! \param digests the buffer for the MACs, DIGESTSIZE bytes per message in message order
+	//! \param key the 16-byte key
+	//! \param inputs the messages
+	//! \param lengths the sizes of the messages, in bytes
+	//! \param count the number of messages
+	//! \details With AVX2, HashBatch() processes four messages at a time, one in each 64-bit
+	//!   lane. The messages of a group can have different lengths. Otherwise, and for the
+	//!   messages left over, it calls Hash().
+	static void HashBatch(byte *digests, const byte *key, const byte *const *inputs, const size_t *lengths, size_t count);
+
 protected:
 
 	virtual void UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params);
@@ -105,6 +141,14 @@ protected:
 		m_v[2] = rotlFixed(m_v[2], 32U);
 	}
 
+	static inline void SIPROUND(word64 &v0, word64 &v1, word64 &v2, word64 &v3)
+	{
+		v0 += v1; v1 = rotlFixed(v1, 13U); v1 ^= v0; v0 = rotlFixed(v0, 32U);
+		v2 += v3; v3 = rotlFixed(v3, 16U); v3 ^= v2;
+		v0 += v3; v3 = rotlFixed(v3, 21U); v3 ^= v0;
+		v2 += v1; v1 = rotlFixed(v1, 17U); v1 ^= v2; v2 = rotlFixed(v2, 32U);
+	}
+
 private:
 	FixedSizeSecBlock<word64, 4> m_v;
 	FixedSizeSecBlock<word64, 2> m_k;
@@ -214,21 +258,27 @@ void SipHash_Base<C,D,T_128bit>::TruncatedFinal(byte *digest, size_t digestSize)
 	m_b[0] += m_idx; m_b[0] <<= 56U;
 	switch (m_idx)
 	{
-		// all fall through
 		case 7:
 			m_b[0] |= ((word64)m_acc[6]) << 48;
+			// fall through
 		case 6:
 			m_b[0] |= ((word64)m_acc[5]) << 40;
+			// fall through
 		case 5:
 			m_b[0] |= ((word64)m_acc[4]) << 32;
+			// fall through
 		case 4:
 			m_b[0] |= ((word64)m_acc[3]) << 24;
+			// fall through
 		case 3:
 			m_b[0] |= ((word64)m_acc[2]) << 16;
+			// fall through
 		case 2:
 			m_b[0] |= ((word64)m_acc[1]) << 8;
+			// fall through
 		case 1:
 			m_b[0] |= ((word64)m_acc[0]);
+			// fall through
 		case 0:
 			break;
 	}
@@ -265,6 +315,87 @@ void SipHash_Base<C,D,T_128bit>::TruncatedFinal(byte *digest, size_t digestSize)
 	Restart();
 }
 
+template <unsigned int C, unsigned int D, bool T_128bit>
+void SipHash_Base<C,D,T_128bit>::Hash(byte *digest, const byte *key, const byte *input, size_t length)
+{
+	CRYPTOPP_ASSERT(digest && key);
+	CRYPTOPP_ASSERT((input && length) || !length);
+
+	const word64 k0 = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, key);
+	const word64 k1 = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, key+8);
+	word64 v0 = W64LIT(0x736f6d6570736575) ^ k0;
+	word64 v1 = W64LIT(0x646f72616e646f6d) ^ k1 ^ (T_128bit ? 0xee : 0);
+	word64 v2 = W64LIT(0x6c7967656e657261) ^ k0;
+	word64 v3 = W64LIT(0x7465646279746573) ^ k1;
+
+	const size_t tail = length % 8;
+	for (size_t blocks = length / 8; blocks; --blocks, input += 8)
+	{
+		const word64 m = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, input);
+		v3 ^= m;
+		for (unsigned int i = 0; i < C; ++i)
+			SIPROUND(v0, v1, v2, v3);
+		v0 ^= m;
+	}
+
+	// The high octet holds length and is digested mod 256
+	word64 b = word64(length) << 56U;
+	switch (tail)
+	{
+		case 7:
+			b |= ((word64)input[6]) << 48;
+			// fall through
+		case 6:
+			b |= ((word64)input[5]) << 40;
+			// fall through
+		case 5:
+			b |= ((word64)input[4]) << 32;
+			// fall through
+		case 4:
+			b |= ((word64)input[3]) << 24;
+			// fall through
+		case 3:
+			b |= ((word64)input[2]) << 16;
+			// fall through
+		case 2:
+			b |= ((word64)input[1]) << 8;
+			// fall through
+		case 1:
+			b |= ((word64)input[0]);
+			// fall through
+		case 0:
+			break;
+	}
+
+	v3 ^= b;
+	for (unsigned int i = 0; i < C; ++i)
+		SIPROUND(v0, v1, v2, v3);
+	v0 ^= b;
+
+	v2 ^= T_128bit ? 0xee : 0xff;
+	for (unsigned int i = 0; i < D; ++i)
+		SIPROUND(v0, v1, v2, v3);
+	PutWord(false, LITTLE_ENDIAN_ORDER, digest, v0 ^ v1 ^ v2 ^ v3);
+
+	if (T_128bit)
+	{
+		v1 ^= 0xdd;
+		for (unsigned int i = 0; i < D; ++i)
+			SIPROUND(v0, v1, v2, v3);
+		PutWord(false, LITTLE_ENDIAN_ORDER, digest+8, v0 ^ v1 ^ v2 ^ v3);
+	}
+}
+
+template <unsigned int C, unsigned int D, bool T_128bit>
+void SipHash_Base<C,D,T_128bit>::HashBatch(byte *digests, const byte *key, const byte *const *inputs, const size_t *lengths, size_t count)
+{
+	CRYPTOPP_ASSERT((digests && key && inputs && lengths) || !count);
+
+	const size_t done = SipHash_BatchKernel::AVX2(digests, key, inputs, lengths, count, C, D, T_128bit);
+	for (size_t i = done; i < count; ++i)
+		Hash(digests+i*SipHash_Info<T_128bit>::DIGESTSIZE, key, inputs[i], lengths[i]);
+}
+
 template <unsigned int C, unsigned int D, bool T_128bit>
 void SipHash_Base<C,D,T_128bit>::UncheckedSetKey(const byte *key, unsigned int length, const NameValuePairs &params)
 {
@@ -625,6 +625,9 @@ void SosemanukPolicy::OperateKeystream(KeystreamOperation operation, byte *outpu
 #endif
 #ifndef CRYPTOPP_GENERATE_X64_MASM
 	{
+	// This code also runs where the assembly is disabled, like Clang and X32. The LFSR and
+	//   FSM steps are serial, and SSE2 intrinsics for S2 over four groups at a time, as the
+	//   assembly does, measured no faster than this code.
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64) && !defined(CRYPTOPP_DISABLE_SOSEMANUK_ASM)
 #define MUL_A(x)    (x = rotlFixed(x, 8), x ^ s_sosemanukMulTables[byte(x)])
 #else
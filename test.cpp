@@ -993,6 +993,9 @@ bool Validate(int alg, bool thorough, const char *seedInput)
 	case 77: result = Test::ValidateSipHash(); break;
 	case 78: result = Test::ValidateHashDRBG(); break;
 	case 79: result = Test::ValidateHmacDRBG(); break;
+	case 80: result = Test::ValidateCtrDRBG(); break;
+	case 81: result = Test::ValidateGCM_SIV(); break;
+	case 82: result = Test::ValidateOCB(); break;
 
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_IMPORTS)
 	// http://github.com/weidai11/cryptopp/issues/92
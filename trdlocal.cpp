@@ -23,16 +23,17 @@ ThreadLocalStorage::Err::Err(const std::string& operation, int error)
 
 // Windows: "a process may have up to TLS_MINIMUM_AVAILABLE indexes (guaranteed to be greater than
 // or equal to 64)", https://support.microsoft.com/en-us/help/94804/info-thread-local-storage-overview
-ThreadLocalStorage::ThreadLocalStorage()
+ThreadLocalStorage::ThreadLocalStorage(void (*cleanup)(void *))
 {
 #ifdef HAS_WINTHREADS
+	CRYPTOPP_UNUSED(cleanup);
 	m_index = TlsAlloc();
 	CRYPTOPP_ASSERT(m_index != TLS_OUT_OF_INDEXES);
 	if (m_index == TLS_OUT_OF_INDEXES)
 		throw Err("TlsAlloc", GetLastError());
 #else
 	m_index = 0;
-	int error = pthread_key_create(&m_index, NULLPTR);
+	int error = pthread_key_create(&m_index, cleanup);
 	CRYPTOPP_ASSERT(!error);
 	if (error)
 		throw Err("pthread_key_create", error);
@@ -27,7 +27,12 @@ public:
 		Err(const std::string& operation, int error);
 	};
 
-	ThreadLocalStorage();
+	//! \brief Construct a ThreadLocalStorage
+	//! \param cleanup a function called with the thread's value when a thread exits, or NULL
+	//! \details On Unix and compatibles <tt>cleanup</tt> is passed to <tt>pthread_key_create()</tt>,
+	//!   and it is only called for non-NULL values. Windows TLS does not call a function when a
+	//!   thread exits, so <tt>cleanup</tt> is ignored on Windows.
+	explicit ThreadLocalStorage(void (*cleanup)(void *) = NULLPTR);
 	~ThreadLocalStorage() CRYPTOPP_THROW;
 
 	void SetValue(void *value);
@@ -42,6 +42,12 @@
 #include "shacal2.h"
 #include "camellia.h"
 #include "aria.h"
+#include "ccm.h"
+#include "gcm.h"
+#include "gcmsiv.h"
+#include "ocb.h"
+#include "sha.h"
+#include "cmac.h"
 #include "osrng.h"
 #include "drbg.h"
 #include "rdrand.h"
@@ -55,6 +61,15 @@
 #include <iostream>
 #include <iomanip>
 
+#ifdef CRYPTOPP_UNIX_AVAILABLE
+# include <unistd.h>
+# include <sys/wait.h>
+#endif
+
+#ifdef HAS_PTHREADS
+# include <pthread.h>
+#endif
+
 #include "validate.h"
 
 // Aggressive stack checking with VS2005 SP1 and above.
@@ -71,11 +86,13 @@ bool ValidateAll(bool thorough)
 	pass=TestOS_RNG() && pass;
 	pass=TestAutoSeeded() && pass;
 	pass=TestAutoSeededX917() && pass;
+	pass=TestAutoSeededThreadLocal() && pass;
 	// pass=TestSecRandom() && pass;
 
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
 	pass=TestRDRAND() && pass;
 	pass=TestRDSEED() && pass;
+	pass=TestHardwareSeeded() && pass;
 #endif
 
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_IMPORTS)
@@ -107,6 +124,7 @@ bool ValidateAll(bool thorough)
 
 	pass=ValidateHashDRBG() && pass;
 	pass=ValidateHmacDRBG() && pass;
+	pass=ValidateCtrDRBG() && pass;
 
 	pass=ValidateTiger() && pass;
 	pass=ValidateRIPEMD() && pass;
@@ -154,6 +172,8 @@ bool ValidateAll(bool thorough)
 	pass=ValidateGCM() && pass;
 	pass=ValidateCMAC() && pass;
 	pass=RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/eax.txt") && pass;
+	pass=ValidateOCB() && pass;
+	pass=ValidateGCM_SIV() && pass;
 	pass=RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/seed.txt") && pass;
 
 	pass=ValidateBBS() && pass;
@@ -362,6 +382,64 @@ bool TestSettings()
 	return pass;
 }
 
+// Requests smaller than a generator's buffer are served from it, and larger ones skip it.
+//   The output of 200 requests of mixed sizes must not compress.
+bool TestMixedRequestSizes(RandomNumberGenerator &rng)
+{
+	MeterFilter meter(new Redirector(TheBitBucket()));
+	Deflator deflator(new Redirector(meter));
+	SecByteBlock block(4096);
+	lword total = 0;
+	for (size_t i=0, size=1; i<200; ++i, size=(size*7+3)%block.size())
+	{
+		rng.GenerateBlock(block, size);
+		deflator.Put(block, size);
+		total += size;
+	}
+	deflator.MessageEnd();
+
+	const bool pass = meter.GetTotalBytes() >= total;
+	std::cout << (pass ? "passed:" : "FAILED:");
+	std::cout << "  " << total << " bytes in mixed request sizes compressed to " << meter.GetTotalBytes() << " bytes by DEFLATE" << std::endl;
+	return pass;
+}
+
+#ifdef CRYPTOPP_UNIX_AVAILABLE
+// Leaves bytes in the generator's buffer, so a child process that kept them, or that did
+//   not reseed, would repeat the parent's next request
+bool TestForkedOutput(RandomNumberGenerator &rng)
+{
+	byte parent[16], child[16];
+	rng.GenerateBlock(parent, sizeof(parent));
+
+	int fds[2];
+	bool pass = (pipe(fds) == 0);
+	if (pass)
+	{
+		const pid_t pid = fork();
+		if (pid == 0)
+		{
+			rng.GenerateBlock(child, sizeof(child));
+			ssize_t unused = write(fds[1], child, sizeof(child));
+			CRYPTOPP_UNUSED(unused);
+			_exit(0);
+		}
+
+		rng.GenerateBlock(parent, sizeof(parent));
+		pass = (pid > 0 && read(fds[0], child, sizeof(child)) == (ssize_t)sizeof(child));
+		pass = pass && (memcmp(parent, child, sizeof(parent)) != 0);
+
+		if (pid > 0)
+			waitpid(pid, NULLPTR, 0);
+		close(fds[0]); close(fds[1]);
+	}
+
+	std::cout << (pass ? "passed:" : "FAILED:");
+	std::cout << "  child process output differs from the parent after fork" << std::endl;
+	return pass;
+}
+#endif
+
 bool TestOS_RNG()
 {
 	bool pass = true;
@@ -471,6 +549,55 @@ bool TestOS_RNG()
 	else
 		std::cout << "\nNo operating system provided nonblocking random number generator, skipping test." << std::endl;
 
+	rng.reset(NULLPTR);
+#ifdef NONBLOCKING_RNG_AVAILABLE
+	try {rng.reset(new NonblockingRng(true));}
+	catch (OS_RNG_Err &) {}
+#endif
+
+	if (rng.get())
+	{
+		std::cout << "\nTesting operating system provided nonblocking random number generator with a buffer...\n\n";
+
+		MeterFilter meter(new Redirector(TheBitBucket()));
+		RandomNumberSource test(*rng, 100000, true, new Deflator(new Redirector(meter)));
+
+		if (meter.GetTotalBytes() < 100000)
+		{
+			std::cout << "FAILED:";
+			pass = false;
+		}
+		else
+			std::cout << "passed:";
+		std::cout << "  100000 generated bytes compressed to " << meter.GetTotalBytes() << " bytes by DEFLATE" << std::endl;
+
+		// Words and nonces are served from the buffer
+		MeterFilter meter2(new Redirector(TheBitBucket()));
+		Deflator deflator(new Redirector(meter2));
+		byte nonce[16];
+		for (unsigned int i=0; i<2000; ++i)
+		{
+			const word32 w = rng->GenerateWord32();
+			deflator.Put(reinterpret_cast<const byte*>(&w), sizeof(w));
+			rng->GenerateBlock(nonce, sizeof(nonce));
+			deflator.Put(nonce, sizeof(nonce));
+		}
+		deflator.MessageEnd();
+
+		if (meter2.GetTotalBytes() < 2000*20)
+		{
+			std::cout << "FAILED:";
+			pass = false;
+		}
+		else
+			std::cout << "passed:";
+		std::cout << "  " << 2000*20 << " bytes in small requests compressed to " << meter2.GetTotalBytes() << " bytes by DEFLATE" << std::endl;
+
+#ifdef CRYPTOPP_UNIX_AVAILABLE
+		pass = TestForkedOutput(*rng) && pass;
+#endif
+	}
+
 	return pass;
 }
 
@@ -518,7 +645,7 @@ bool TestAutoSeeded()
 		std::cout << "FAILED:";
 	else
 		std::cout << "passed:";
-	std::cout << "  discarded 10000 bytes" << std::endl;
+	std::cout << "  discarded 100000 bytes" << std::endl;
 
 	try
 	{
@@ -582,7 +709,7 @@ bool TestAutoSeededX917()
 		std::cout << "FAILED:";
 	else
 		std::cout << "passed:";
-	std::cout << "  discarded 10000 bytes" << std::endl;
+	std::cout << "  discarded 100000 bytes" << std::endl;
 
 	try
 	{
@@ -613,6 +740,159 @@ bool TestAutoSeededX917()
 }
 #endif // NO_OS_DEPENDENCE
 
+#if defined(NO_OS_DEPENDENCE) || !defined(NONBLOCKING_RNG_AVAILABLE) || !defined(THREADS_AVAILABLE)
+bool TestAutoSeededThreadLocal()
+{
+	return true;
+}
+#else
+#ifdef HAS_PTHREADS
+// One thread's requests on a generator shared with other threads
+struct ThreadLocalRNGJob
+{
+	enum {NONCES = 256, NONCE_SIZE = 16};
+	RandomNumberGenerator *rng;
+	byte output[NONCES*NONCE_SIZE];
+	bool generated;
+};
+
+void* ThreadLocalRNGWorker(void *arg)
+{
+	ThreadLocalRNGJob *job = static_cast<ThreadLocalRNGJob *>(arg);
+	try
+	{
+		for (unsigned int i=0; i<ThreadLocalRNGJob::NONCES; ++i)
+			job->rng->GenerateBlock(job->output+i*ThreadLocalRNGJob::NONCE_SIZE, ThreadLocalRNGJob::NONCE_SIZE);
+		job->generated = true;
+	}
+	catch(const Exception&)
+	{
+		job->generated = false;
+	}
+	return NULLPTR;
+}
+#endif
+
+bool TestAutoSeededThreadLocal()
+{
+	// This tests Auto-Seeding, the buffered and unbuffered paths, and reseeding after a fork.
+	std::cout << "\nTesting AutoSeeded thread local generator...\n\n";
+
+	AutoSeededThreadLocalRNG prng;
+	static const unsigned int ENTROPY_SIZE = 32;
+	bool generate = true, mixed = true, discard = true, incorporate = false;
+
+	MeterFilter meter(new Redirector(TheBitBucket()));
+	RandomNumberSource test(prng, 100000, true, new Deflator(new Redirector(meter)));
+
+	if (meter.GetTotalBytes() < 100000)
+	{
+		std::cout << "FAILED:";
+		generate = false;
+	}
+	else
+		std::cout << "passed:";
+	std::cout << "  100000 generated bytes compressed to " << meter.GetTotalBytes() << " bytes by DEFLATE" << std::endl;
+
+	mixed = TestMixedRequestSizes(prng);
+
+	try
+	{
+		prng.DiscardBytes(100000);
+	}
+	catch(const Exception&)
+	{
+		discard = false;
+	}
+
+	if (!discard)
+		std::cout << "FAILED:";
+	else
+		std::cout << "passed:";
+	std::cout << "  discarded 100000 bytes" << std::endl;
+
+	try
+	{
+		if(prng.CanIncorporateEntropy())
+		{
+			SecByteBlock entropy(ENTROPY_SIZE);
+			OS_GenerateRandomBlock(false, entropy, entropy.SizeInBytes());
+
+			prng.IncorporateEntropy(entropy, entropy.SizeInBytes());
+			prng.IncorporateEntropy(entropy, entropy.SizeInBytes());
+			prng.IncorporateEntropy(entropy, entropy.SizeInBytes());
+			prng.IncorporateEntropy(entropy, entropy.SizeInBytes());
+
+			incorporate = true;
+		}
+	}
+	catch(const Exception& /*ex*/)
+	{
+	}
+
+	if (!incorporate)
+		std::cout << "FAILED:";
+	else
+		std::cout << "passed:";
+	std::cout << "  IncorporateEntropy with " << 4*ENTROPY_SIZE << " bytes" << std::endl;
+
+	bool threaded = true;
+#ifdef HAS_PTHREADS
+	{
+		// Threads share one object with no lock. Each thread has its own state, so no
+		//   nonce may repeat within a thread or across threads.
+		static const unsigned int THREADS = 4;
+		std::vector<ThreadLocalRNGJob> jobs(THREADS);
+		pthread_t threads[THREADS];
+		unsigned int started = 0;
+
+		for (unsigned int i=0; i<THREADS; ++i)
+		{
+			jobs[i].rng = &prng;
+			jobs[i].generated = false;
+			memset(jobs[i].output, 0, sizeof(jobs[i].output));
+			if (pthread_create(&threads[i], NULLPTR, ThreadLocalRNGWorker, &jobs[i]) == 0)
+				started++;
+			else
+				break;
+		}
+		for (unsigned int i=0; i<started; ++i)
+			pthread_join(threads[i], NULLPTR);
+		threaded = (started == THREADS);
+
+		const byte zero[ThreadLocalRNGJob::NONCE_SIZE] = {0};
+		std::vector<std::string> nonces;
+		for (unsigned int i=0; threaded && i<THREADS; ++i)
+		{
+			threaded = jobs[i].generated;
+			for (unsigned int j=0; threaded && j<ThreadLocalRNGJob::NONCES; ++j)
+			{
+				const byte *nonce = jobs[i].output+j*ThreadLocalRNGJob::NONCE_SIZE;
+				threaded = (memcmp(nonce, zero, sizeof(zero)) != 0);
+				nonces.push_back(std::string(reinterpret_cast<const char *>(nonce), ThreadLocalRNGJob::NONCE_SIZE));
+			}
+		}
+
+		std::sort(nonces.begin(), nonces.end());
+		threaded = threaded && (std::adjacent_find(nonces.begin(), nonces.end()) == nonces.end());
+	}
+
+	if (!threaded)
+		std::cout << "FAILED:";
+	else
+		std::cout << "passed:";
+	std::cout << "  4 threads sharing the generator produced distinct, non-empty output" << std::endl;
+#endif
+
+	bool forked = true;
+#ifdef CRYPTOPP_UNIX_AVAILABLE
+	forked = TestForkedOutput(prng);
+#endif
+
+	return generate && mixed && discard && incorporate && threaded && forked;
+}
+#endif // NO_OS_DEPENDENCE
+
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
 bool TestRDRAND()
 {
@@ -766,6 +1046,122 @@ bool TestRDSEED()
 
 	return entropy && compress && discard;
 }
+
+// Counts the calls HardwareSeededRNG makes, so reseeding is observable
+class CountingDRBG : public HMAC_DRBG<SHA256>
+{
+public:
+	CountingDRBG(const byte *seed) : HMAC_DRBG<SHA256>(seed, 32, seed+32, 16), m_reseeds(0), m_requests(0) {}
+
+	using HMAC_DRBG<SHA256>::IncorporateEntropy;
+	using HMAC_DRBG<SHA256>::GenerateBlock;
+
+	void IncorporateEntropy(const byte *entropy, size_t entropyLength, const byte* additional, size_t additionaLength)
+	{
+		m_reseeds++;
+		m_additional.Assign(additional, additionaLength);
+		HMAC_DRBG<SHA256>::IncorporateEntropy(entropy, entropyLength, additional, additionaLength);
+	}
+
+	void GenerateBlock(byte *output, size_t size)
+	{
+		m_requests++;
+		HMAC_DRBG<SHA256>::GenerateBlock(output, size);
+	}
+
+	unsigned int m_reseeds, m_requests;
+	SecByteBlock m_additional;
+};
+
+bool TestHardwareSeeded()
+{
+	// This tests the buffered and unbuffered paths, the reseed interval, and reseeding after a fork.
+	if (!HasRDRAND() && !HasRDSEED())
+		return true;
+
+	std::cout << "\nTesting HardwareSeededRNG generator...\n\n";
+
+	HardwareSeededRNG prng;
+	bool generate = true, mixed = true, interval = true, incorporate = true;
+
+	MeterFilter meter(new Redirector(TheBitBucket()));
+	RandomNumberSource test(prng, 100000, true, new Deflator(new Redirector(meter)));
+
+	if (meter.GetTotalBytes() < 100000)
+	{
+		std::cout << "FAILED:";
+		generate = false;
+	}
+	else
+		std::cout << "passed:";
+	std::cout << "  100000 generated bytes compressed to " << meter.GetTotalBytes() << " bytes by DEFLATE" << std::endl;
+
+	mixed = TestMixedRequestSizes(prng);
+
+	try
+	{
+		// The constructor reseeds once, and a 1000 byte interval reseeds 19 more
+		//   times within one 20000 byte request
+		byte seed[48];
+		GlobalRNG().GenerateBlock(seed, sizeof(seed));
+		CountingDRBG *drbg = new CountingDRBG(seed);
+		HardwareSeededRNG hmac(drbg, 1000);
+		interval = (drbg->m_reseeds == 1);
+
+		SecByteBlock block(20000);
+		hmac.GenerateBlock(block, block.size());
+		interval = interval && (drbg->m_reseeds == 20) && (drbg->m_requests == 20);
+	}
+	catch(const Exception&)
+	{
+		interval = false;
+	}
+
+	if (!interval)
+		std::cout << "FAILED:";
+	else
+		std::cout << "passed:";
+	std::cout << "  HMAC_DRBG(SHA256) reseeds every 1000 bytes" << std::endl;
+
+	try
+	{
+		// The input reaches the DRBG as additional input, and the buffered bytes are
+		//   discarded, so the next small request goes to the DRBG
+		byte seed[48], entropy[32], output[16];
+		GlobalRNG().GenerateBlock(seed, sizeof(seed));
+		GlobalRNG().GenerateBlock(entropy, sizeof(entropy));
+		CountingDRBG *drbg = new CountingDRBG(seed);
+		HardwareSeededRNG hmac(drbg);
+
+		hmac.GenerateBlock(output, sizeof(output));
+		const unsigned int requests = drbg->m_requests;
+		hmac.IncorporateEntropy(entropy, sizeof(entropy));
+		incorporate = (drbg->m_reseeds == 2) && (drbg->m_additional == SecByteBlock(entropy, sizeof(entropy)));
+
+		hmac.GenerateBlock(output, sizeof(output));
+		incorporate = incorporate && (drbg->m_requests == requests+1);
+
+		hmac.Reseed();
+		incorporate = incorporate && (drbg->m_reseeds == 3) && drbg->m_additional.empty();
+	}
+	catch(const Exception&)
+	{
+		incorporate = false;
+	}
+
+	if (!incorporate)
+		std::cout << "FAILED:";
+	else
+		std::cout << "passed:";
+	std::cout << "  IncorporateEntropy and Reseed" << std::endl;
+
+	bool forked = true;
+#if defined(CRYPTOPP_UNIX_AVAILABLE) && !defined(NO_OS_DEPENDENCE)
+	forked = TestForkedOutput(prng);
+#endif
+
+	return generate && mixed && interval && incorporate && forked;
+}
 #endif
 
 bool ValidateHashDRBG()
@@ -1256,6 +1652,270 @@ bool ValidateHmacDRBG()
 	return pass;
 }
 
+// Sets the counter of a CTR_DRBG with an all-zero key, so a test can start it near a carry
+class CTR_DRBG_Counter : public CTR_DRBG<AES, 128/8, 256/8>
+{
+public:
+	void Keystream(const byte *v, byte *output, size_t blocks, byte *last)
+	{
+		CTR_Reset();
+		std::memcpy(m_v, v, 16);
+		CTR_Keystream(output, blocks);
+		std::memcpy(last, m_v, 16);
+	}
+};
+
+bool ValidateCtrDRBG()
+{
+	std::cout << "\nTesting NIST CTR DRBGs...\n\n";
+	bool pass=true, fail;
+
+	// Generated with OpenSSL 3.0 CTR-DRBG, AES-256-CTR with the derivation function. The
+	// reseed entropy is supplied by the parent source, as SP 800-90A requires.
+
+	{
+		// [AES-256 use df], [PredictionResistance = False], [EntropyInputLen = 256], [NonceLen = 128]
+		// [PersonalizationStringLen = 256], [AdditionalInputLen = 0], [ReturnedBitsLen = 512]
+		const byte entropy[] = "\xdf\x09\x78\x85\xd1\x6c\xb8\x73\x3c\x68\x1d\xac\xfd\x15\xe9\x59\x46\xd9\x44\x62"
+			"\x6f\x3d\xea\xa9\x80\x8d\x92\x09\x7f\x31\x22\x11";
+		const byte nonce[] = "\xa6\xab\xf6\x8c\x72\x49\xed\x51\x37\x84\xf5\xdf\x5e\x14\x6b\xce";
+		const byte personalization[] = "\x6c\x4e\x74\x92\x13\x25\x22\x2e\x31\xa1\xcd\x13\xbe\x12\xed\x42\x69\x66\xce\x24"
+			"\xfc\x23\xd7\xda\x8d\x20\x97\x61\x6a\x06\x95\x6e";
+
+		CTR_DRBG<AES, 256/8, 384/8> drbg(entropy, 32, nonce, 16, personalization, 32);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(result, result.size());
+		drbg.GenerateBlock(result, result.size());
+
+		const byte expected[] = "\x26\x62\xf3\x89\xb1\x2f\x60\x88\x0b\x47\xd8\x2f\x97\x03\x21\x70\xee\xc4\xdd\x46"
+			"\x4c\x97\xc6\xb5\xe7\x7e\x14\xdd\xc3\x8b\x06\x57\x58\xf5\x6d\x8d\x03\x93\x1f\x1f"
+			"\xf9\xdd\xad\x84\x98\x8d\xc7\x61\x27\xf1\xac\x1c\xb9\xb8\x43\xe8\x27\x8d\x4b\xa2"
+			"\x4c\x68\x85\x0d";
+
+		fail = !!memcmp(result, expected, 512/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/256/384 (E=32, N=16, P=32)\n";
+	}
+
+	{
+		// [AES-256 use df], [PredictionResistance = False], [EntropyInputLen = 256], [NonceLen = 128]
+		// [PersonalizationStringLen = 256], [AdditionalInputLen = 256], [ReturnedBitsLen = 512]
+		const byte entropy1[] = "\x6c\x4e\x74\x92\x13\x25\x22\x2e\x31\xa1\xcd\x13\xbe\x12\xed\x42\x69\x66\xce\x24"
+			"\xfc\x23\xd7\xda\x8d\x20\x97\x61\x6a\x06\x95\x6e";
+		const byte entropy2[] = "\x4b\x7b\xe9\xb3\x39\x73\x2d\x84\x13\x2e\x05\x13\xa1\x09\x77\x89\x3f\xc7\xa6\x88"
+			"\x5b\x61\xa8\xd4\xad\x90\x25\xbe\x35\x1b\xb4\x54";
+		const byte nonce[] = "\x32\xf0\xf2\x99\xb4\x01\x57\x0c\x2b\xbd\xa5\x46\x1f\x10\x6f\xb7";
+		const byte personalization[] = "\xf8\x93\x6f\x9f\x56\xde\x8d\xea\x25\xd9\x7d\x79\x7f\x0e\xf1\x2b\x8b\xf3\x58\xe5"
+			"\x89\x08\xc4\x0a\x9a\xb3\x9d\xb9\x55\xdb\x08\xca";
+		const byte additional1[] = "\x12\x1d\x66\xb9\xdb\x4f\x62\x62\x0d\x4b\xdd\x46\x01\x07\xf9\xfe\xd1\x0d\x6b\x69"
+			"\xa2\xd3\x9f\x6c\xb4\xd9\xa8\x6a\x2a\x85\xee\x82";
+		const byte additional2[] = "\xbf\x36\xed\xa6\xf7\xba\xc2\xc8\x1f\xf6\x55\xac\xe0\x0d\x73\xa0\x1d\x3a\x1d\xc6"
+			"\xcf\x7b\xbb\xa3\xa1\xfd\x20\x66\x4a\x46\x41\xf8";
+		const byte additional3[] = "\x85\xd8\x6b\xac\x98\x96\xf7\xa6\x19\x12\x2d\xdf\x40\x0b\xf5\x15\xae\x80\xe1\xa7"
+			"\x15\xee\xb1\x3b\xa7\x46\xa2\x12\x40\xb0\x7b\x26";
+
+		CTR_DRBG<AES, 256/8, 384/8> drbg(entropy1, 32, nonce, 16, personalization, 32);
+		drbg.IncorporateEntropy(entropy2, 32, additional1, 32);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(additional2, 32, result, result.size());
+		drbg.GenerateBlock(additional3, 32, result, result.size());
+
+		const byte expected[] = "\x4b\xf7\x2f\xbf\x6b\xe5\x71\x18\xd3\xd1\x1c\xe6\xd8\x55\x85\x02\xc0\xda\x43\xef"
+			"\x3c\x81\xd0\x67\x70\x86\x53\xe3\x7b\x28\xa5\x86\xf6\x5c\xe2\x93\x29\x9d\xd3\xb6"
+			"\x85\x00\x30\xd6\x4e\xde\x1d\xfb\x6f\x50\x71\x00\xe3\x1a\xb1\x7a\xe5\x59\xf6\xf8"
+			"\x32\x86\x6e\xa7";
+
+		fail = !!memcmp(result, expected, 512/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/256/384 (E=32, N=16, P=32, A=32)\n";
+	}
+
+	{
+		// [AES-256 use df], [PredictionResistance = False], [EntropyInputLen = 256], [NonceLen = 128]
+		// [PersonalizationStringLen = 256], [AdditionalInputLen = 256], [ReturnedBitsLen = 8000]
+		// The expected value is the SHA-256 digest of the returned bits, which end in a partial block
+		const byte entropy[] = "\x53\xc3\x7d\x78\x8e\xb4\x4d\xb7\x48\x2f\x6d\x46\x3d\x19\xe5\x70\x24\x4c\xbb\xa0"
+			"\xe3\x58\xfc\x78\x74\xfa\x8c\xb1\x95\x5c\xaf\xb5";
+		const byte nonce[] = "\x19\x66\xfb\x7f\x2f\x90\x82\x95\x42\x4b\x45\x79\x9d\x17\x67\xe5";
+		const byte personalization[] = "\xdf\x09\x78\x85\xd1\x6c\xb8\x73\x3c\x68\x1d\xac\xfd\x15\xe9\x59\x46\xd9\x44\x62"
+			"\x6f\x3d\xea\xa9\x80\x8d\x92\x09\x7f\x31\x22\x11";
+		const byte additional1[] = "\xa6\xab\xf6\x8c\x72\x49\xed\x51\x37\x84\xf5\xdf\x5e\x14\x6b\xce\xd8\x20\x09\x43"
+			"\xb6\xb0\xe0\x41\x87\xd6\x15\xb5\x75\x9c\x5b\x3f";
+		const byte additional2[] = "\x6c\x4e\x74\x92\x13\x25\x22\x2e\x31\xa1\xcd\x13\xbe\x12\xed\x42\x69\x66\xce\x24"
+			"\xfc\x23\xd7\xda\x8d\x20\x97\x61\x6a\x06\x95\x6e";
+
+		CTR_DRBG<AES, 256/8, 384/8> drbg(entropy, 32, nonce, 16, personalization, 32);
+
+		SecByteBlock result(1000), digest(SHA256::DIGESTSIZE);
+		drbg.GenerateBlock(additional1, 32, result, result.size());
+		drbg.GenerateBlock(additional2, 32, result, result.size());
+		SHA256().CalculateDigest(digest, result, result.size());
+
+		const byte expected[] = "\xf2\x61\x84\x19\x5a\x56\x79\x36\xe1\xda\x0f\xd9\xe4\x7b\xbf\xa3\x16\x2f\xf2\xb1"
+			"\xda\x7e\xe3\xda\x4e\xfc\x21\x14\xf7\xab\xf3\x18";
+
+		fail = !!memcmp(digest, expected, 256/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/256/384 (E=32, N=16, P=32, A=32, R=1000)\n";
+	}
+
+	{
+		// [AES-128 use df], [PredictionResistance = False], [EntropyInputLen = 128], [NonceLen = 64]
+		// [PersonalizationStringLen = 128], [AdditionalInputLen = 0], [ReturnedBitsLen = 512]
+		const byte entropy[] = "\x90\x4c\xce\xc4\x04\x5f\x8c\x27\x8e\x4d\x09\xbc\xa6\x23\xa2\x35";
+		const byte nonce[] = "\x59\xf6\x92\xc4\xda\xe4\x01\x90";
+		const byte personalization[] = "\x8f\x6b\x23\x51\x93\x0c\x5a\x82\x40\x5e\xc3\x20\x63\xe2\x19\xfa";
+
+		CTR_DRBG<AES, 128/8, 256/8> drbg(entropy, 16, nonce, 8, personalization, 16);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(result, result.size());
+		drbg.GenerateBlock(result, result.size());
+
+		const byte expected[] = "\x16\x53\xa9\x11\xb4\xff\x1e\x02\x4f\x55\xa6\x71\xf5\xaa\xcc\xac\x53\xc3\x97\xf2"
+			"\x8c\x4e\xbe\xd6\x1c\x5e\xc8\xe8\x96\x60\x77\x74\x91\x05\x68\x6e\xe0\x4d\xe4\x5f"
+			"\xa6\xed\x0f\x39\xeb\x56\xb8\x3d\x18\xab\xbf\xd3\xf1\x22\xc1\x2d\x8d\x98\xa1\x80"
+			"\x30\xf3\x12\x4b";
+
+		fail = !!memcmp(result, expected, 512/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/128/256 (E=16, N=8, P=16)\n";
+	}
+
+	{
+		// [AES-128 use df], [PredictionResistance = False], [EntropyInputLen = 128], [NonceLen = 64]
+		// [PersonalizationStringLen = 128], [AdditionalInputLen = 128], [ReturnedBitsLen = 8000]
+		// The expected value is the SHA-256 digest of the returned bits
+		const byte entropy1[] = "\x61\x64\x93\x0d\x79\x0a\x4a\xf2\xbe\xd5\x07\x41\x91\x94\xa5\x55";
+		const byte entropy2[] = "\x7b\xcf\x2f\xdd\x41\xaa\xe3\xbe\xbe\xdc\xaa\x1a\x82\x9e\x65\x26";
+		const byte nonce[] = "\xf9\xe1\x35\x7b\x8f\x6f\x2b\x9b";
+		const byte personalization[] = "\x58\x6e\x83\x83\x1e\x60\x67\x73\x5f\xa2\x43\x8d\x94\x31\x25\x76";
+		const byte additional1[] = "\x12\x5f\x6b\xe0\x5d\x72\x2f\x2d\xd4\x20\x76\xc5\x6b\x58\x90\xa5";
+		const byte additional2[] = "\xbe\xd6\xca\x37\x75\xbd\x64\x88\x0d\x41\x39\xf1\x27\xb6\x9c\x19";
+		const byte additional3[] = "\x60\x2e\x57\x16\x70\x53\x07\x73\xce\xfa\xbb\xab\x54\x32\x8f\x8d";
+
+		CTR_DRBG<AES, 128/8, 256/8> drbg(entropy1, 16, nonce, 8, personalization, 16);
+		drbg.IncorporateEntropy(entropy2, 16, additional1, 16);
+
+		SecByteBlock result(1000), digest(SHA256::DIGESTSIZE);
+		drbg.GenerateBlock(additional2, 16, result, result.size());
+		drbg.GenerateBlock(additional3, 16, result, result.size());
+		SHA256().CalculateDigest(digest, result, result.size());
+
+		const byte expected[] = "\xb0\x8c\x58\x35\xf1\xd1\xe2\x15\x4e\xf0\x44\x9e\x50\x66\xfd\x43\xdd\x2b\xe6\x0c"
+			"\x8c\x9d\x72\xb4\x0d\x2e\xfc\x7d\xd6\x2d\x05\x3b";
+
+		fail = !!memcmp(digest, expected, 256/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/128/256 (E=16, N=8, P=16, A=16, R=1000)\n";
+	}
+
+	{
+		// [AES-192 use df], [PredictionResistance = False], [EntropyInputLen = 192], [NonceLen = 96]
+		// [PersonalizationStringLen = 192], [AdditionalInputLen = 0], [ReturnedBitsLen = 512]
+		// The seed length of 320 bits is not a multiple of the block size
+		const byte entropy[] = "\x68\xb3\x47\xce\x31\x6a\xa5\x0a\xd6\xbe\xd3\x1c\x73\xde\x14\xed\x0d\xcf\x6f\x17"
+			"\x2d\x6c\xf3\x98";
+		const byte nonce[] = "\x69\xcd\x88\x76\xbb\x2e\xd6\x8b\x36\x57\x3d\x58";
+		const byte personalization[] = "\x3b\xdc\x56\xfe\x03\x9f\xa0\x4c\x0a\x89\x66\x08\x7c\x79\x35\xb6\xd9\xbf\x81\xac"
+			"\x2b\x08\x94\xf1";
+
+		CTR_DRBG<AES, 192/8, 320/8> drbg(entropy, 24, nonce, 12, personalization, 24);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(result, result.size());
+		drbg.GenerateBlock(result, result.size());
+
+		const byte expected[] = "\xcd\xe9\x3c\x9e\x64\x94\x3d\x3e\x34\xd1\xbd\x45\xfd\x0f\x4a\x10\x93\xdf\x90\x74"
+			"\x65\xdb\x78\x1e\xf5\x99\xf1\x0d\x2a\x59\xa0\x3f\x6e\x21\x53\x2b\xed\x02\x12\x1b"
+			"\x52\x4d\x90\x79\x2a\x4b\x60\x78\x26\x1f\xcf\xed\x06\xa6\x7c\x58\x7a\xbd\x52\x00"
+			"\x8c\x67\x90\xb8";
+
+		fail = !!memcmp(result, expected, 512/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/192/320 (E=24, N=12, P=24)\n";
+	}
+
+	{
+		// [AES-192 use df], [PredictionResistance = False], [EntropyInputLen = 192], [NonceLen = 96]
+		// [PersonalizationStringLen = 192], [AdditionalInputLen = 192], [ReturnedBitsLen = 512]
+		const byte entropy1[] = "\xe7\x6a\xbe\x47\x05\xc7\x6b\x55\x07\xf0\x75\xe6\x60\xb5\x69\x93\x61\x0a\xd2\xe2"
+			"\x9d\xf3\x3a\xeb";
+		const byte entropy2[] = "\x42\xe0\x13\xb3\x9f\xde\xbe\x38\x8f\x9d\xe2\xa9\x40\x26\xcb\x43\xfc\xb0\x27\x26"
+			"\xf6\xa4\xe1\xe0";
+		const byte nonce[] = "\x31\xe9\x08\x57\x93\xc3\xc0\xdb\xba\xe5\x14\xbb";
+		const byte personalization[] = "\x7e\x60\x76\x8b\xa0\xad\xaa\x6e\x5f\xa2\x96\x8a\x10\x0a\x1c\x33\x4b\x87\x91\xaf"
+			"\x3b\x92\xb4\x7b";
+		const byte additional1[] = "\xc3\xb7\x22\x44\x83\xdf\xa3\xd9\xb5\x63\x42\x37\xc7\x1a\xba\x78\x4d\xd1\x91\xf5"
+			"\xf3\x3d\xa8\x6f";
+		const byte additional2[] = "\xd0\x01\x3f\x73\x29\x75\xb3\x40\x3f\x03\xff\xe0\x66\xa1\x3b\x13\x78\x9c\x43\xd1"
+			"\x71\x92\xe5\xfd";
+		const byte additional3[] = "\xbc\x8d\xce\x09\x43\xf0\xa8\xca\x0a\x2e\x97\xca\xc5\xd5\x7d\x9d\xe7\x74\x28\x0c"
+			"\x59\xd5\xbd\x55";
+
+		CTR_DRBG<AES, 192/8, 320/8> drbg(entropy1, 24, nonce, 12, personalization, 24);
+		drbg.IncorporateEntropy(entropy2, 24, additional1, 24);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(additional2, 24, result, result.size());
+		drbg.GenerateBlock(additional3, 24, result, result.size());
+
+		const byte expected[] = "\xff\xa6\x0f\xfe\x5f\x60\xb1\x11\xb8\xdc\x22\xe4\x8c\xbb\x92\x0c\xc1\xf2\x42\x9f"
+			"\x9a\x44\x82\x48\x03\xef\xde\x7f\x01\x9c\xd0\x89\x15\x8c\xa0\xc3\x39\xc2\x40\x76"
+			"\xa9\xb5\xaa\x2b\xea\x9f\x46\xa9\x66\xaf\x97\x6c\x83\x2a\x39\xc1\x36\x48\xd8\xe3"
+			"\xde\xf8\xfa\x7b";
+
+		fail = !!memcmp(result, expected, 512/8);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/192/320 (E=24, N=12, P=24, A=24)\n";
+	}
+
+	{
+		// V starts where the low 64 bits of the counter, and then all 128 bits, wrap. The
+		//   keystream must match encrypting one incremented counter at a time.
+		const byte starts[2][16] = {
+			{0,0,0,0,0,0,0,0, 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xfe},
+			{0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xfe}
+		};
+
+		byte key[16] = {0}, output[12*16], v[16], counter[16], expected[16];
+		ECB_Mode<AES>::Encryption ecb(key, sizeof(key));
+		CTR_DRBG_Counter drbg;
+
+		fail = false;
+		for (unsigned int i=0; i<2; ++i)
+		{
+			for (size_t blocks=1; blocks<=12; ++blocks)
+			{
+				drbg.Keystream(starts[i], output, blocks, v);
+
+				std::memcpy(counter, starts[i], 16);
+				for (size_t j=0; j<blocks; ++j)
+				{
+					IncrementCounterByOne(counter, 16);
+					ecb.ProcessData(expected, counter, 16);
+					fail = fail || memcmp(output+j*16, expected, 16) != 0;
+				}
+				fail = fail || memcmp(v, counter, 16) != 0;
+			}
+		}
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES/128/256 counter carry\n";
+	}
+
+	return pass;
+}
+
 class CipherFactory
 {
 public:
@@ -1331,6 +1991,35 @@ bool BlockTransformationTest(const CipherFactory &cg, BufferedTransformation &va
 	return pass;
 }
 
+// Checks AdvancedProcessBlocks against ProcessBlock on runs long enough to reach the parallel code paths
+bool ParallelBlocksTest(const CipherFactory &cg, const char *name, unsigned int blocks)
+{
+	const size_t size = cg.BlockSize()*blocks;
+	SecByteBlock key(cg.KeyLength()), plain(size), cipher(size), expected(size);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+	member_ptr<BlockTransformation> transE(cg.NewEncryption(key));
+	member_ptr<BlockTransformation> transD(cg.NewDecryption(key));
+
+	// ECB encryption
+	for (size_t i=0; i<size; i+=cg.BlockSize())
+		transE->ProcessBlock(plain+i, expected+i);
+	transE->AdvancedProcessBlocks(plain, NULLPTR, cipher, size, BlockTransformation::BT_AllowParallel);
+	bool fail = memcmp(cipher, expected, size) != 0;
+
+	// CBC style decryption in place, which runs in reverse and xors the previous ciphertext
+	for (size_t i=cg.BlockSize(); i<size; i+=cg.BlockSize())
+		transD->ProcessAndXorBlock(cipher+i, cipher+i-cg.BlockSize(), expected+i);
+	SecByteBlock temp(cipher);
+	transD->AdvancedProcessBlocks(temp+cg.BlockSize(), temp, temp+cg.BlockSize(), size-cg.BlockSize(),
+		BlockTransformation::BT_AllowParallel|BlockTransformation::BT_ReverseDirection);
+	fail = fail || memcmp(temp+cg.BlockSize(), expected+cg.BlockSize(), size-cg.BlockSize()) != 0;
+
+	std::cout << (fail ? "FAILED   " : "passed   ") << name << ", " << blocks << " blocks" << std::endl;
+	return !fail;
+}
+
 class FilterTester : public Unflushable<Sink>
 {
 public:
@@ -1402,6 +2091,11 @@ bool ValidateDES()
 	pass = BlockTransformationTest(FixedRoundsCipherFactory<DES_EDE3_Encryption, DES_EDE3_Decryption>(), valdata1, 1) && pass;
 	pass = BlockTransformationTest(FixedRoundsCipherFactory<DES_XEX3_Encryption, DES_XEX3_Decryption>(), valdata1, 1) && pass;
 
+	std::cout << "\nTesting EDE2 and EDE3 parallel blocks...\n\n";
+
+	pass = ParallelBlocksTest(FixedRoundsCipherFactory<DES_EDE2_Encryption, DES_EDE2_Decryption>(), "DES-EDE2", 700) && pass;
+	pass = ParallelBlocksTest(FixedRoundsCipherFactory<DES_EDE3_Encryption, DES_EDE3_Decryption>(), "DES-EDE3", 700) && pass;
+
 	return pass;
 }
 
@@ -1435,6 +2129,54 @@ bool TestModeIV(SymmetricCipher &e, SymmetricCipher &d)
 	return true;
 }
 
+// CTR keystream must match the cipher applied to a counter that carries across the whole block
+bool TestCounterCarry(BlockCipher &cipher, SymmetricCipher &ctr, const byte *iv, size_t blocks)
+{
+	const unsigned int blockSize = cipher.BlockSize();
+	SecByteBlock counter(iv, blockSize), expected(blocks*blockSize), actual(blocks*blockSize);
+
+	for (size_t i=0; i<blocks; ++i)
+	{
+		cipher.ProcessBlock(counter, expected+i*blockSize);
+		IncrementCounterByOne(counter, blockSize);
+	}
+
+	memset(actual, 0, actual.size());
+	ctr.Resynchronize(iv, blockSize);
+	ctr.ProcessString(actual, actual.size());
+	return expected == actual;
+}
+
+// AdvancedProcessBlocks() as an older derived class wrote it. It only increments the last byte
+//   of the counter and does not store the counter back.
+class LegacyCounterCipher : public BlockTransformation
+{
+public:
+	LegacyCounterCipher(const BlockTransformation &cipher) : m_cipher(cipher) {}
+	unsigned int BlockSize() const {return m_cipher.BlockSize();}
+	bool IsForwardTransformation() const {return true;}
+	void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
+		{m_cipher.ProcessAndXorBlock(inBlock, xorBlock, outBlock);}
+
+	size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
+	{
+		const unsigned int blockSize = BlockSize();
+		SecByteBlock counter(inBlocks, blockSize);
+		for (; length >= blockSize; length -= blockSize, outBlocks += blockSize)
+		{
+			m_cipher.ProcessAndXorBlock(counter, xorBlocks, outBlocks);
+			counter[blockSize-1]++;
+			if (xorBlocks)
+				xorBlocks += blockSize;
+		}
+		CRYPTOPP_UNUSED(flags);
+		return length;
+	}
+
+private:
+	const BlockTransformation &m_cipher;
+};
+
 bool ValidateCipherModes()
 {
 	std::cout << "\nTesting DES modes...\n\n";
@@ -1713,6 +2455,48 @@ bool ValidateCipherModes()
 		pass = pass && !fail;
 		std::cout << (fail ? "FAILED   " : "passed   ") << "AES CTR Mode" << std::endl;
 	}
+	{
+		// The last byte wraps, then the low 64 bits carry into the high 64 bits
+		byte counter[16];
+		memcpy(counter, plain, 8);
+		memset(counter+8, 0xff, 8);
+		counter[15] = 0x40;
+
+		AESEncryption aesE(plain, 16);
+		CTR_Mode<AES>::Encryption modeE(plain, 16, counter);
+		fail = !TestCounterCarry(aesE, modeE, counter, 300);
+
+		// The whole 64-bit block is the counter and wraps to zero
+		memset(counter, 0xff, 8);
+		counter[7] = 0x00;
+
+		DES_EDE3::Encryption desE3(plain, 24);
+		CTR_Mode<DES_EDE3>::Encryption modeE3(plain, 24, counter);
+		fail = !TestCounterCarry(desE3, modeE3, counter, 600) || fail;
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR Mode counter carry" << std::endl;
+	}
+	{
+		// A cipher that does not advertise wide counters is split where the last byte wraps
+		byte counter[16], expected[300*16], actual[300*16];
+		memcpy(counter, plain, 8);
+		memset(counter+8, 0xff, 8);
+		counter[15] = 0x40;
+
+		AESEncryption aesE(plain, 16);
+		LegacyCounterCipher legacy(aesE);
+		SecByteBlock start(counter, 16);
+		for (unsigned int i=0; i<300; ++i)
+		{
+			aesE.ProcessBlock(counter, expected+i*16);
+			IncrementCounterBlock(counter, 16, BlockTransformation::BT_Counter64);
+		}
+
+		legacy.ProcessCounterBlocks(start, NULLPTR, actual, sizeof(actual), BlockTransformation::BT_Counter64);
+		fail = memcmp(expected, actual, sizeof(actual)) != 0 || memcmp(start, counter, 16) != 0;
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR counter with a legacy AdvancedProcessBlocks" << std::endl;
+	}
 	{
 		OFB_Mode<AES>::Encryption modeE(plain, 16, plain);
 		OFB_Mode<AES>::Decryption modeD(plain, 16, plain);
@@ -1726,6 +2510,21 @@ bool ValidateCipherModes()
 		fail = !TestModeIV(modeE, modeD);
 		pass = pass && !fail;
 		std::cout << (fail ? "FAILED   " : "passed   ") << "AES CFB Mode" << std::endl;
+
+		// Decryption runs the cipher over many ciphertext blocks at once, also in place
+		SecByteBlock plaintext(1029), ciphertext(plaintext.size()), recovered(plaintext.size());
+		GlobalRNG().GenerateBlock(plaintext, plaintext.size());
+		modeE.Resynchronize(plain);
+		modeE.ProcessData(ciphertext, plaintext, plaintext.size());
+		modeD.Resynchronize(plain);
+		modeD.ProcessData(recovered, ciphertext, ciphertext.size());
+		fail = (recovered != plaintext);
+
+		modeD.Resynchronize(plain);
+		modeD.ProcessString(ciphertext, ciphertext.size());
+		fail = fail || (ciphertext != plaintext);
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES CFB Mode bulk decryption" << std::endl;
 	}
 	{
 		CBC_Mode<AES>::Encryption modeE(plain, 16, plain);
@@ -1734,6 +2533,76 @@ bool ValidateCipherModes()
 		pass = pass && !fail;
 		std::cout << (fail ? "FAILED   " : "passed   ") << "AES CBC Mode" << std::endl;
 	}
+	{
+		// Streams must match each object used on its own, including streams that share an object.
+		//   The second round checks that the objects continue their chains.
+		byte keys[64];
+		GlobalRNG().GenerateBlock(keys, sizeof(keys));
+		CBC_Mode<AES>::Encryption e1(keys, 16, plain), e2(keys+16, 16, plain), e3(keys+32, 32, plain);
+		CBC_Mode<AES>::Encryption r1(keys, 16, plain), r2(keys+16, 16, plain), r3(keys+32, 32, plain);
+		CBC_Encryption *modes[] = {&e1, &e2, &e3}, *references[] = {&r1, &r2, &r3};
+
+		const size_t count = 10, maxLength = 40*16;
+		SecByteBlock plaintext(count*maxLength), batched(plaintext.size()), single(plaintext.size());
+		CBC_Encryption::Stream streams[count];
+		fail = false;
+		for (unsigned int round=0; round<2; ++round)
+		{
+			GlobalRNG().GenerateBlock(plaintext, plaintext.size());
+			for (size_t i=0; i<count; ++i)
+			{
+				CBC_Encryption::Stream &s = streams[i];
+				s.mode = (i%4 == 0) ? NULLPTR : modes[i%3];
+				s.input = plaintext+i*maxLength;
+				s.output = batched+i*maxLength;
+				s.length = 16*((i*7+round)%40);
+				references[s.mode ? i%3 : 0]->ProcessData(single+i*maxLength, s.input, s.length);
+			}
+
+			e1.ProcessStreams(streams, count);
+			for (size_t i=0; i<count; ++i)
+				fail = fail || memcmp(batched+i*maxLength, single+i*maxLength, streams[i].length) != 0;
+		}
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES CBC Mode streams" << std::endl;
+	}
+	{
+		byte xtsKey[32];
+		GlobalRNG().GenerateBlock(xtsKey, sizeof(xtsKey));
+		XTS_Mode<AES>::Encryption modeE(xtsKey, sizeof(xtsKey), plain);
+		XTS_Mode<AES>::Decryption modeD(xtsKey, sizeof(xtsKey), plain);
+		fail = !TestModeIV(modeE, modeD);
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES XTS Mode" << std::endl;
+
+		// Sector batches must match one sector at a time, including ciphertext stealing. The
+		//   sector number is 128 bits, so runs that pass 2^64-1 carry into the high word.
+		const size_t sectorSize = 520, sectorCount = 11;
+		const word64 firstSectors[] = {W64LIT(0xfffffffffffffffc), W64LIT(0xffffffffffffffff)};
+		SecByteBlock plaintext(sectorSize*sectorCount), batched(plaintext.size()), single(plaintext.size());
+		GlobalRNG().GenerateBlock(plaintext, plaintext.size());
+
+		fail = false;
+		for (size_t j=0; j<COUNTOF(firstSectors); ++j)
+		{
+			const word64 firstSector = firstSectors[j];
+			modeE.ProcessSectors(batched, plaintext, sectorSize, sectorCount, firstSector);
+			for (size_t i=0; i<sectorCount; ++i)
+			{
+				byte tweak[16];
+				PutWord(false, LITTLE_ENDIAN_ORDER, tweak, word64(firstSector+i));
+				PutWord(false, LITTLE_ENDIAN_ORDER, tweak+8, word64(firstSector+i < firstSector));
+				modeE.Resynchronize(tweak, sizeof(tweak));
+				modeE.ProcessLastBlock(single+i*sectorSize, plaintext+i*sectorSize, sectorSize);
+			}
+			fail = fail || (batched != single);
+
+			modeD.ProcessSectors(batched, batched, sectorSize, sectorCount, firstSector);
+			fail = fail || (batched != plaintext);
+		}
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES XTS Mode sectors" << std::endl;
+	}
 
 	return pass;
 }
@@ -1743,7 +2612,9 @@ bool ValidateIDEA()
 	std::cout << "\nIDEA validation suite running...\n\n";
 
 	FileSource valdata(CRYPTOPP_DATA_DIR "TestData/ideaval.dat", true, new HexDecoder);
-	return BlockTransformationTest(FixedRoundsCipherFactory<IDEAEncryption, IDEADecryption>(), valdata);
+	bool pass = BlockTransformationTest(FixedRoundsCipherFactory<IDEAEncryption, IDEADecryption>(), valdata);
+	pass = ParallelBlocksTest(FixedRoundsCipherFactory<IDEAEncryption, IDEADecryption>(), "IDEA", 37) && pass;
+	return pass;
 }
 
 bool ValidateSAFER()
@@ -2026,6 +2897,7 @@ bool ValidateRC6()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RC6Encryption, RC6Decryption>(16), valdata, 2) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RC6Encryption, RC6Decryption>(24), valdata, 2) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RC6Encryption, RC6Decryption>(32), valdata, 2) && pass3;
+	pass3 = ParallelBlocksTest(FixedRoundsCipherFactory<RC6Encryption, RC6Decryption>(16), "RC6", 37) && pass3;
 	return pass1 && pass2 && pass3;
 }
 
@@ -2062,6 +2934,112 @@ bool ValidateMARS()
 	return pass1 && pass2 && pass3;
 }
 
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE
+// Eleven blocks each of ECB, CBC and CTR, from OpenSSL. The key is 00 01 02 ..., the IV and the
+//   initial counter are F0 F1 ... FF, and plaintext byte i is i*37+11.
+struct RijndaelModesVector
+{
+	unsigned int keyLength;
+	const char *ecb, *cbc, *ctr;
+};
+
+// The SSSE3 code only runs when AES-NI is missing. Keying with AES-NI disabled selects it.
+//   Lengths of one to eleven blocks run both the single block code and the eight block kernel.
+bool TestRijndaelSSSE3()
+{
+	static const RijndaelModesVector vectors[] = {
+		{16,
+			"26017E8FF83C5B3DF993C68DAFF05F037928180B7B618C3A4609831802CBAA13340D62401CEE04469D5FC211"
+			"260FE229DECA3D1FFC4F14F98FB395952FA9F9E648C708A84684F76CD7A17813982C4F0D5D670C9F43F5D862"
+			"5BF47C0262C29BC0BC86133FA60C319A1A107907DDB65B0B4B305A7D81D7DF2F3CB1C3A1E14229AA4F779A20"
+			"9E132B314765B23F0A7D53EE3B85E5DE4630BE7AF8C138F66C88167DBD208E4516AF725A9BD0BADFEA533E3F",
+			"54FB76CC3F1C85C8E9147AB2FCBEC9C988AF9205B10FC1EB37B6444C85BBF2BD8C31BDF1C900855F5EDE1A2B"
+			"F07CE10ECEB3824957A4B190255F7FE42082615687E1E369E35B9B8D487F15B9D21AF967776AFD4CDC3FD019"
+			"D23492D3FA509FECFEECD5B1083CF6BBC4D5E942F50695AECF79C6E039DCDA671D82C8747E95B26C67D124DA"
+			"7373410A2172BCBCE6F8E135369A2603A4F31BDF867ED4D5598A7AB6E2817C603869C2109D001F54574BC6A1",
+			"6D979292AB96D846A409A3A5F4FABC9BE90172CA588A05F32705BE4979A07E6C79A1674C433F62332879961B"
+			"281EE4A78BF82330B30B81B974256E8AF8BC36BC20713792F2927A2CF71A64F0F8D2D04B72F4C4FA4A8040C0"
+			"6B65284C173399450F166F6F2479DC3288872D5DDF1BCF2FDD44287FCC7FDFF5257D2A406ADFE09CB8C53284"
+			"206778403791A14DF159A8E4ABDD992443F88DF7A4F05F424DD862BEF63BC36F2325F21ECE4DF9F775B4880A"},
+		{24,
+			"A56D361EEB824C0192DFAD17985027C280E60FF0B29E7F494323F2CE3C0911AFCCFA4C283CFB8EDCBDBC3503"
+			"8ECE39CB11647F5A2CE83D6A7ADE296782DB47EFBB7C2773828039FC00932E2BB3B20F79E9D15C6C64EAA27B"
+			"F605A3850747A078A0D482CBA66B9A1A26B9A6C3C8F9743EFD8AA8EAF64BF0A3152CCF10A120D3C06AC905CE"
+			"8BD58EC2FE344C2289807BDE1BFCD06E3D513DA8E8FE26452E85A98D583718EEC7D5BF6761548915B5AABC4A",
+			"7C7B95787A04998A698A790384C9BF7C36F9341B7EBD1F5B948BE64D33D0381989E7E150D99D0483C3B511A3"
+			"010D4CFB9F4945979C54CE3953ED3065D6247F80AFB21ABEC002A8C2797B5B3B724979E1C346E39FAF28FCF6"
+			"A985EA3EA3444F7D3C74710404B45F48893FC1E0DD7E9BD572E500A0CB85E6649FC38D02F5B10A1527633391"
+			"72F6BA1793711D5F3B2B42DECAFDAD437CB7A5603F6EADB343C1D923ECC572899FB00593F01E7CA3F2F7B73C",
+			"20B21D28CB36809E80814BA03709B9C580888E492680CE6F04C745363CFDC88274AA8EDC7DAE9548685540F4"
+			"950CFC1B416EFA8138FFA4F955F73A62600D1DCA609F377E8C2B95901A81E790007C53A86778FA6587C44AD8"
+			"36FDB27ED4EFB11338DB5A2970B86D6DBF817C8FF6DAE457F6E2FA1F45E80773A9F7F69FA238CAC53958B15B"
+			"0D1A7A8A35F22B76B6BBCECF9CDC82AE60E4904F119AD5D9A37C3F70A0A1A26931F1C85F03FB676926637788"},
+		{32,
+			"BABDF707CFB130F349E5E128F1C379EA58E861E6FA698BECF368EAA4051A719A4940056E3787D4BDD9D9C74F"
+			"BAD60BC1A914042F1846C422FE1C354549A4DB277C60E409E7EFA2455D4761DF862BD60D4BAC8DB0081D1C08"
+			"29555F7DB55149C127780A36CB53F148F22097FD8881E08834587930E5EDBE112B6CDB27711C28DABF109584"
+			"58509601A1FEA1EF8E3EB999D81140013E0555F6C754BE373750BDFA875EDD32FA07ECA59686EFA1C47CB6E4",
+			"88CA0E75A15258DFD37B2D0E688A693B27F6280CFC17AF622A059975F4F48631FE8E1759C0DD234A2BE84C99"
+			"E317C13488EB2598EE5AE6B8DB4F09089199CEB1F9CEBD581100546F84FA758A68A0DD8F9D4B910ED964233D"
+			"09E0D6F64C69B59369922A75EF6DEA8AD6A01B91812016EBA37F7107ABE2797F36C05554DA53AA0C37FB7DAB"
+			"1425EF9694651FA12C50D8FE3A7C9D8982CF92800674B72F115998A6AF9D64A2FD8FB3B4A123430740542822",
+			"993098F7BC5269C569319BF687DE722291DFDE8A1E3E0D9FED0F98D35D4BE70832BCD4412B7C7C36AB7D3D52"
+			"F2D84359B248864759443EDC3053B1664BBF5982FD74EE63A678D3AC8915A23B60BA64E1931F0566955CEA96"
+			"B0114BB99B8AD7711E98D45133C341AA218798AEDFAD763DC376C565085E7441E276B0D6E86B4F7490D7897A"
+			"0BC4DD19BB87F13BA7532A4F2E675485A6E19278DE91562FEA1EE9FC0D3407330A311F01945B118579326181"}
+	};
+
+	byte key[32], iv[16], plain[176], out[176];
+	for (unsigned int i=0; i<sizeof(key); ++i)
+		key[i] = byte(i);
+	for (unsigned int i=0; i<sizeof(iv); ++i)
+		iv[i] = byte(0xf0+i);
+	for (unsigned int i=0; i<sizeof(plain); ++i)
+		plain[i] = byte(i*37+11);
+
+	// Objects keyed before this point, like GlobalRNG(), must not be used until the flag is restored
+	const bool hasAESNI = g_hasAESNI;
+	g_hasAESNI = false;
+
+	bool pass = true;
+	for (size_t i=0; i<COUNTOF(vectors); ++i)
+	{
+		const RijndaelModesVector &v = vectors[i];
+		std::string ecb, cbc, ctr;
+		StringSource(v.ecb, true, new HexDecoder(new StringSink(ecb)));
+		StringSource(v.cbc, true, new HexDecoder(new StringSink(cbc)));
+		StringSource(v.ctr, true, new HexDecoder(new StringSink(ctr)));
+
+		for (size_t blocks=1; blocks<=11; ++blocks)
+		{
+			const size_t length = blocks*16;
+			ECB_Mode<AES>::Encryption ecbE(key, v.keyLength);
+			ECB_Mode<AES>::Decryption ecbD(key, v.keyLength);
+			CBC_Mode<AES>::Encryption cbcE(key, v.keyLength, iv);
+			CBC_Mode<AES>::Decryption cbcD(key, v.keyLength, iv);
+			CTR_Mode<AES>::Encryption ctrE(key, v.keyLength, iv);
+
+			ecbE.ProcessData(out, plain, length);
+			pass = pass && memcmp(out, ecb.data(), length) == 0;
+			ecbD.ProcessData(out, reinterpret_cast<const byte *>(ecb.data()), length);
+			pass = pass && memcmp(out, plain, length) == 0;
+
+			cbcE.ProcessData(out, plain, length);
+			pass = pass && memcmp(out, cbc.data(), length) == 0;
+			cbcD.ProcessData(out, reinterpret_cast<const byte *>(cbc.data()), length);
+			pass = pass && memcmp(out, plain, length) == 0;
+
+			// CTR also ends on a partial block
+			ctrE.ProcessData(out, plain, length-5);
+			pass = pass && memcmp(out, ctr.data(), length-5) == 0;
+		}
+	}
+
+	g_hasAESNI = hasAESNI;
+	return pass;
+}
+#endif
+
 bool ValidateRijndael()
 {
 	std::cout << "\nRijndael (AES) validation suite running...\n\n";
@@ -2093,6 +3071,16 @@ bool ValidateRijndael()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(24), valdata, 3) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(32), valdata, 2) && pass3;
 	pass3 = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/aes.txt") && pass3;
+
+#if CRYPTOPP_BOOL_SSSE3_INTRINSICS_AVAILABLE
+	if (HasSSSE3())
+	{
+		const bool fail = !TestRijndaelSSSE3();
+		std::cout << (fail ? "FAILED:" : "passed:") << "  SSSE3 ECB, CBC and CTR without AES-NI\n";
+		pass3 = pass3 && !fail;
+	}
+#endif
+
 	return pass1 && pass2 && pass3;
 }
 
@@ -2351,6 +3339,7 @@ bool ValidateCAST()
 	pass6 = BlockTransformationTest(FixedRoundsCipherFactory<CAST256Encryption, CAST256Decryption>(16), val256, 1) && pass6;
 	pass6 = BlockTransformationTest(FixedRoundsCipherFactory<CAST256Encryption, CAST256Decryption>(24), val256, 1) && pass6;
 	pass6 = BlockTransformationTest(FixedRoundsCipherFactory<CAST256Encryption, CAST256Decryption>(32), val256, 1) && pass6;
+	pass6 = ParallelBlocksTest(FixedRoundsCipherFactory<CAST256Encryption, CAST256Decryption>(32), "CAST-256", 37) && pass6;
 
 	return pass1 && pass2 && pass3 && pass4 && pass5 && pass6;
 }
@@ -2544,6 +3533,7 @@ bool ValidateSHACAL2()
 	FileSource valdata(CRYPTOPP_DATA_DIR "TestData/shacal2v.dat", true, new HexDecoder);
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<SHACAL2Encryption, SHACAL2Decryption>(16), valdata, 4) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<SHACAL2Encryption, SHACAL2Decryption>(64), valdata, 10) && pass3;
+	pass3 = ParallelBlocksTest(FixedRoundsCipherFactory<SHACAL2Encryption, SHACAL2Decryption>(64), "SHACAL-2", 37) && pass3;
 	return pass1 && pass2 && pass3;
 }
 
@@ -2632,25 +3622,442 @@ bool ValidateVMAC()
 	return RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/vmac.txt");
 }
 
+// A batch over two key handles must match the messages processed one at a time
+bool TestAuthenticatedBatch(AuthenticatedSymmetricCipher &enc1, AuthenticatedSymmetricCipher &enc2,
+	AuthenticatedSymmetricCipher &dec1, AuthenticatedSymmetricCipher &dec2, int ivLength)
+{
+	typedef AuthenticatedSymmetricCipher::BatchMessage BatchMessage;
+	const size_t count = 11, maxLength = 600, maxHeader = 40;
+	SecByteBlock data(count*(2*maxLength+maxHeader+ivLength+16));
+	GlobalRNG().GenerateBlock(data, data.size());
+
+	BatchMessage messages[count];
+	std::vector<SecByteBlock> expected(count), expectedMac(count);
+	std::vector<const byte *> plaintext(count);
+	byte *p = data;
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		m.cipher = (i%3 == 1) ? &enc2 : NULLPTR;
+		m.iv = p; m.ivLength = ivLength; p += ivLength;
+		m.headerLength = (i*7)%maxHeader; m.header = p; p += maxHeader;
+		m.length = (i*131)%maxLength; m.input = plaintext[i] = p; p += maxLength;
+		m.output = p; p += maxLength;
+		m.mac = p; p += 16;
+		m.macSize = (i%4 == 3) ? 8 : 16;
+
+		AuthenticatedSymmetricCipher &e = m.cipher ? enc2 : enc1;
+		expected[i].New(m.length); expectedMac[i].New(m.macSize);
+		e.EncryptAndAuthenticate(expected[i], expectedMac[i], m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+	}
+
+	enc1.EncryptAndAuthenticateBatch(messages, count);
+	bool pass = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		pass = pass && expected[i] == SecByteBlock(m.output, m.length) && expectedMac[i] == SecByteBlock(m.mac, m.macSize);
+
+		// Decrypt in place, with one corrupted tag
+		m.cipher = m.cipher ? &dec2 : NULLPTR;
+		m.input = m.output;
+		if (i == 5)
+			m.mac[0] ^= 1;
+	}
+
+	pass = !dec1.DecryptAndVerifyBatch(messages, count) && pass;
+	for (size_t i=0; i<count; ++i)
+		pass = pass && messages[i].valid == (i != 5) && memcmp(messages[i].output, plaintext[i], messages[i].length) == 0;
+	return pass;
+}
+
 bool ValidateCCM()
 {
 	std::cout << "\nAES/CCM validation suite running...\n";
-	return RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/ccm.txt");
+	bool pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/ccm.txt");
+
+	byte key1[16], key2[16], iv[12];
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(key1, sizeof(key1));
+	GlobalRNG().GenerateBlock(key2, sizeof(key2));
+	CCM<AES>::Encryption enc1, enc2;
+	CCM<AES>::Decryption dec1, dec2;
+	enc1.SetKeyWithIV(key1, sizeof(key1), iv, sizeof(iv)); dec1.SetKeyWithIV(key1, sizeof(key1), iv, sizeof(iv));
+	enc2.SetKeyWithIV(key2, sizeof(key2), iv, sizeof(iv)); dec2.SetKeyWithIV(key2, sizeof(key2), iv, sizeof(iv));
+
+	const bool fail = !TestAuthenticatedBatch(enc1, enc2, dec1, dec2, 12) || !TestAuthenticatedBatch(enc1, enc2, dec1, dec2, 7);
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/CCM batch" << std::endl;
+	return pass && !fail;
 }
 
+#ifdef HAS_PTHREADS
+// One thread's messages through a prepared key shared with other threads
+struct GCMPreparedKeyJob
+{
+	enum {MESSAGES = 256, LENGTH = 4096};
+	const GCM_PreparedKeyBase *key;
+	const byte *iv, *plain, *expected, *expectedMac;
+	bool matched;
+};
+
+void* GCMPreparedKeyWorker(void *arg)
+{
+	GCMPreparedKeyJob *job = static_cast<GCMPreparedKeyJob *>(arg);
+	try
+	{
+		GCM<AES>::Encryption enc;
+		SecByteBlock cipher(GCMPreparedKeyJob::LENGTH);
+		byte mac[16];
+		job->matched = true;
+		for (unsigned int i=0; i<GCMPreparedKeyJob::MESSAGES; ++i)
+		{
+			enc.SetPreparedKey(*job->key);
+			enc.EncryptAndAuthenticate(cipher, mac, sizeof(mac), job->iv, 12, NULLPTR, 0, job->plain, cipher.size());
+			job->matched = job->matched && memcmp(cipher, job->expected, cipher.size()) == 0 && memcmp(mac, job->expectedMac, sizeof(mac)) == 0;
+		}
+	}
+	catch(const Exception&)
+	{
+		job->matched = false;
+	}
+	return NULLPTR;
+}
+
+// Threads encrypt through one prepared key with no lock. Each must match an object keyed directly.
+//   The key is 16 bytes, the nonce 12 bytes and the message GCMPreparedKeyJob::LENGTH bytes.
+bool TestGCMPreparedKeyThreads(const byte *key, const byte *iv, const byte *plain)
+{
+	static const unsigned int THREADS = 4;
+	byte mac[16];
+	SecByteBlock expected(GCMPreparedKeyJob::LENGTH);
+
+	GCM<AES>::Encryption enc;
+	enc.SetKeyWithIV(key, 16, iv, 12);
+	enc.EncryptAndAuthenticate(expected, mac, sizeof(mac), iv, 12, NULLPTR, 0, plain, expected.size());
+
+	const GCM<AES>::PreparedKey prepared(key, 16);
+	std::vector<GCMPreparedKeyJob> jobs(THREADS);
+	pthread_t threads[THREADS];
+	unsigned int started = 0;
+
+	for (unsigned int i=0; i<THREADS; ++i)
+	{
+		jobs[i].key = &prepared;
+		jobs[i].iv = iv;
+		jobs[i].plain = plain;
+		jobs[i].expected = expected;
+		jobs[i].expectedMac = mac;
+		jobs[i].matched = false;
+		if (pthread_create(&threads[i], NULLPTR, GCMPreparedKeyWorker, &jobs[i]) == 0)
+			started++;
+		else
+			break;
+	}
+	for (unsigned int i=0; i<started; ++i)
+		pthread_join(threads[i], NULLPTR);
+
+	bool pass = (started == THREADS);
+	for (unsigned int i=0; pass && i<THREADS; ++i)
+		pass = jobs[i].matched;
+	return pass;
+}
+#endif
+
 bool ValidateGCM()
 {
 	std::cout << "\nAES/GCM validation suite running...\n";
 	std::cout << "\n2K tables:";
 	bool pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)2048));
 	std::cout << "\n64K tables:";
-	return RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+	pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+
+	byte key1[16], key2[16], iv[12];
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(key1, sizeof(key1));
+	GlobalRNG().GenerateBlock(key2, sizeof(key2));
+	GCM<AES>::Encryption enc1, enc2;
+	GCM<AES>::Decryption dec1, dec2;
+	enc1.SetKeyWithIV(key1, sizeof(key1), iv, sizeof(iv)); dec1.SetKeyWithIV(key1, sizeof(key1), iv, sizeof(iv));
+	enc2.SetKeyWithIV(key2, sizeof(key2), iv, sizeof(iv)); dec2.SetKeyWithIV(key2, sizeof(key2), iv, sizeof(iv));
+
+	// The second batch has 64-bit IVs, which do not take the direct path
+	bool fail = !TestAuthenticatedBatch(enc1, enc2, dec1, dec2, 12) || !TestAuthenticatedBatch(enc1, enc2, dec1, dec2, 8);
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/GCM batch" << std::endl;
+	pass = pass && !fail;
+
+	// Objects switching between prepared keys must match objects keyed directly
+	byte plain[100], cipher[100], recovered[100], mac[16], expectedMac[16];
+	GlobalRNG().GenerateBlock(plain, sizeof(plain));
+	fail = false;
+	for (int tableSize = 2048; tableSize <= 64*1024; tableSize *= 32)
+	{
+		const GCM<AES>::PreparedKey prepared1(key1, sizeof(key1), MakeParameters(Name::TableSize(), tableSize));
+		const GCM<AES>::PreparedKey prepared2(key2, sizeof(key2), MakeParameters(Name::TableSize(), tableSize));
+		GCM<AES>::Encryption enc;
+		GCM<AES>::Decryption dec;
+
+		for (unsigned int i=0; i<6; ++i)
+		{
+			GCM<AES>::Encryption &expected = (i%2) ? enc2 : enc1;
+			const size_t ivLength = (i%3 == 2) ? 7 : sizeof(iv), length = 17*i;
+			expected.EncryptAndAuthenticate(cipher, expectedMac, sizeof(expectedMac), iv, (int)ivLength, iv, i, plain, length);
+
+			enc.SetPreparedKey((i%2) ? prepared2 : prepared1);
+			enc.EncryptAndAuthenticate(recovered, mac, sizeof(mac), iv, (int)ivLength, iv, i, plain, length);
+			fail = fail || memcmp(cipher, recovered, length) != 0 || memcmp(mac, expectedMac, sizeof(mac)) != 0;
+
+			dec.SetPreparedKey((i%2) ? prepared2 : prepared1);
+			fail = !dec.DecryptAndVerify(recovered, mac, sizeof(mac), iv, (int)ivLength, iv, i, cipher, length) || fail;
+			fail = fail || memcmp(recovered, plain, length) != 0;
+		}
+
+		// SetKey() takes the object off the prepared key
+		enc.SetKeyWithIV(key2, sizeof(key2), iv, sizeof(iv));
+		enc.EncryptAndAuthenticate(recovered, mac, sizeof(mac), iv, sizeof(iv), iv, 0, plain, sizeof(plain));
+		enc2.EncryptAndAuthenticate(cipher, expectedMac, sizeof(expectedMac), iv, sizeof(iv), iv, 0, plain, sizeof(plain));
+		fail = fail || memcmp(cipher, recovered, sizeof(plain)) != 0 || memcmp(mac, expectedMac, sizeof(mac)) != 0;
+	}
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/GCM prepared keys" << std::endl;
+	pass = pass && !fail;
+
+#ifdef HAS_PTHREADS
+	SecByteBlock threadPlain(GCMPreparedKeyJob::LENGTH);
+	GlobalRNG().GenerateBlock(threadPlain, threadPlain.size());
+	fail = !TestGCMPreparedKeyThreads(key1, iv, threadPlain);
+# if (CRYPTOPP_BOOL_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
+	// Again on the x86 assembly, which AES-NI and SSSE3 would otherwise bypass. GlobalRNG()
+	//   was keyed with the flags set, so it is not used until they are restored.
+	if (HasSSE2() && (HasAESNI() || HasSSSE3()))
+	{
+		const bool hasAESNI = g_hasAESNI, hasSSSE3 = g_hasSSSE3;
+		g_hasAESNI = g_hasSSSE3 = false;
+		fail = !TestGCMPreparedKeyThreads(key2, iv, threadPlain) || fail;
+		g_hasAESNI = hasAESNI; g_hasSSSE3 = hasSSSE3;
+	}
+# endif
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/GCM prepared key shared by threads" << std::endl;
+	pass = pass && !fail;
+#endif
+
+	return pass;
+}
+
+bool ValidateGCM_SIV()
+{
+	std::cout << "\nAES/GCM-SIV validation suite running...\n";
+	bool pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/gcm_siv.txt");
+
+	byte key[32], iv[12], mac[16], expectedMac[16];
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	SecByteBlock header(2100), plain(3000), cipher(plain.size()), expected(plain.size());
+	GlobalRNG().GenerateBlock(header, header.size());
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+	// A nonce passed to SetKeyWithIV() is used for messages with a NULL nonce
+	GCM_SIV<AES>::Encryption enc;
+	GCM_SIV<AES>::Decryption dec;
+	enc.SetKeyWithIV(key, 16, iv, sizeof(iv));
+	dec.SetKeyWithIV(key, 16, iv, sizeof(iv));
+	enc.EncryptAndAuthenticate(cipher, mac, sizeof(mac), NULLPTR, 0, header, 100, plain, 200);
+	enc.EncryptAndAuthenticate(expected, expectedMac, sizeof(expectedMac), iv, sizeof(iv), header, 100, plain, 200);
+	bool fail = memcmp(cipher, expected, 200) != 0 || memcmp(mac, expectedMac, sizeof(mac)) != 0;
+	fail = !dec.DecryptAndVerify(expected, mac, sizeof(mac), NULLPTR, 0, header, 100, cipher, 200) || fail;
+	fail = fail || memcmp(expected, plain, 200) != 0;
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/GCM-SIV nonce set with the key" << std::endl;
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	// The CLMUL POLYVAL hashes eight blocks per reduction, and must match the portable code
+	if (HasCLMUL())
+	{
+		const size_t lengths[] = {0, 15, 127, 128, 129, 2064, 2069, 3000};
+		fail = false;
+		for (unsigned int keyLength = 16; keyLength <= 32; keyLength += 16)
+		{
+			enc.SetKeyWithIV(key, keyLength, iv, sizeof(iv));
+			for (size_t i=0; i<COUNTOF(lengths); ++i)
+			{
+				const size_t headerLength = STDMIN(lengths[COUNTOF(lengths)-1-i], header.size());
+				enc.EncryptAndAuthenticate(cipher, mac, sizeof(mac), iv, sizeof(iv), header, headerLength, plain, lengths[i]);
+
+				const bool hasCLMUL = g_hasCLMUL;
+				g_hasCLMUL = false;
+				enc.EncryptAndAuthenticate(expected, expectedMac, sizeof(expectedMac), iv, sizeof(iv), header, headerLength, plain, lengths[i]);
+				g_hasCLMUL = hasCLMUL;
+
+				fail = fail || memcmp(cipher, expected, lengths[i]) != 0 || memcmp(mac, expectedMac, sizeof(mac)) != 0;
+			}
+		}
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES/GCM-SIV CLMUL and portable POLYVAL" << std::endl;
+	}
+#endif
+
+	return pass;
+}
+
+// The 8193 byte vector at the end of ocb.txt, from OpenSSL. The ciphertext is checked by its SHA-256.
+bool TestOCBLongMessage()
+{
+	byte key[16], iv[12];
+	for (unsigned int i=0; i<sizeof(key); ++i)
+		key[i] = byte(i);
+	StringSource("BBAA99887766554433221183", true, new HexDecoder(new ArraySink(iv, sizeof(iv))));
+
+	const size_t length = 8193;
+	SecByteBlock header(length), plain(length), cipher(length), recovered(length);
+	for (size_t i=0; i<length; ++i)
+	{
+		header[i] = byte(7*(i%255)+1);
+		plain[i] = byte(13*(i%255)+2);
+	}
+
+	OCB<AES>::Encryption enc;
+	OCB<AES>::Decryption dec;
+	enc.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+	dec.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+
+	byte mac[16];
+	enc.EncryptAndAuthenticate(cipher, mac, sizeof(mac), iv, sizeof(iv), header, length, plain, length);
+
+	std::string digest, tag;
+	StringSource(cipher, cipher.size(), true, new HashFilter(*new SHA256, new HexEncoder(new StringSink(digest))));
+	StringSource(mac, sizeof(mac), true, new HexEncoder(new StringSink(tag)));
+	bool pass = digest == "00FB9E77CF4A1CF07F7D276A13CB99603C6E1B72F47E44946620952BB70554CC";
+	pass = tag == "25B5C31C3F43B15C562B2947D4F1706F" && pass;
+
+	// Again in pieces that straddle the 128 block offset table. The message is
+	//   processed in whole blocks until the last call.
+	const size_t headerPieces[] = {1, 15, 16, 17, 2047, 2049, 4048};
+	const size_t messagePieces[] = {16, 2032, 2064, 16, 4064, 1};
+	dec.Resynchronize(iv, sizeof(iv));
+	for (size_t i=0, p=0; i<COUNTOF(headerPieces); p+=headerPieces[i++])
+		dec.Update(header+p, headerPieces[i]);
+	for (size_t i=0, p=0; i<COUNTOF(messagePieces); p+=messagePieces[i++])
+		dec.ProcessData(recovered+p, cipher+p, messagePieces[i]);
+	pass = dec.TruncatedVerify(mac, sizeof(mac)) && pass;
+	pass = memcmp(recovered, plain, length) == 0 && pass;
+	return pass;
+}
+
+bool ValidateOCB()
+{
+	std::cout << "\nAES/OCB validation suite running...\n";
+	bool pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/ocb.txt");
+
+	bool fail = !TestOCBLongMessage();
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED   " : "passed   ") << "AES/OCB 8193 byte message in pieces" << std::endl;
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+	// Again without AES-NI, and then without SSSE3 as well. Objects keyed before this
+	//   point, like GlobalRNG(), must not be used until the flags are restored.
+	if (HasAESNI())
+	{
+		const bool hasAESNI = g_hasAESNI, hasSSSE3 = g_hasSSSE3;
+		g_hasAESNI = false;
+		fail = !TestOCBLongMessage();
+		g_hasSSSE3 = false;
+		fail = !TestOCBLongMessage() || fail;
+		g_hasAESNI = hasAESNI; g_hasSSSE3 = hasSSSE3;
+
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "AES/OCB 8193 byte message without AES-NI" << std::endl;
+	}
+#endif
+
+	return pass;
+}
+
+// A batch over three key handles must match the messages processed one at a time
+bool TestCMACBatch(CMAC_Base &mac1, CMAC_Base &mac2, CMAC_Base &mac3)
+{
+	typedef CMAC_Base::BatchMessage BatchMessage;
+	const size_t count = 19, maxLength = 300;
+	const unsigned int digestSize = mac1.DigestSize();
+	SecByteBlock data(count*(maxLength+digestSize));
+	GlobalRNG().GenerateBlock(data, data.size());
+
+	BatchMessage messages[count];
+	std::vector<SecByteBlock> expected(count);
+	byte *p = data;
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		m.key = (i%3 == 1) ? &mac2 : (i%5 == 2) ? &mac3 : NULLPTR;
+		m.length = (i%4 == 0) ? (i/4)*digestSize : (i*37)%maxLength;
+		m.input = p; p += maxLength;
+		m.digest = p; p += digestSize;
+		m.digestSize = (i%4 == 3) ? digestSize/2 : digestSize;
+
+		CMAC_Base &k = m.key ? *m.key : mac1;
+		expected[i].New(m.digestSize);
+		k.CalculateTruncatedDigest(expected[i], m.digestSize, m.input, m.length);
+	}
+
+	mac1.CalculateDigestBatch(messages, count);
+	bool pass = true;
+	for (size_t i=0; i<count; ++i)
+		pass = pass && expected[i] == SecByteBlock(messages[i].digest, messages[i].digestSize);
+
+	messages[7].digest[0] ^= 1;
+	pass = !mac1.VerifyDigestBatch(messages, count) && pass;
+	for (size_t i=0; i<count; ++i)
+		pass = pass && messages[i].valid == (i != 7);
+	return pass;
 }
 
 bool ValidateCMAC()
 {
 	std::cout << "\nCMAC validation suite running...\n";
-	return RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/cmac.txt");
+	bool pass = RunTestDataFile(CRYPTOPP_DATA_DIR "TestVectors/cmac.txt");
+
+	// AES keys of two lengths, and a cipher with 64-bit blocks
+	byte key[32];
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	CMAC<AES> aes1(key, 16), aes2(key+16, 16), aes3(key, 32);
+	CMAC<DES_EDE3> des1(key, 24), des2(key+8, 24), des3(key+4, 24);
+
+	bool fail = !TestCMACBatch(aes1, aes2, aes3) || !TestCMACBatch(des1, des2, des3);
+	std::cout << (fail ? "FAILED   " : "passed   ") << "CMAC batch" << std::endl;
+
+	{
+		// A message in progress on a key handle survives a batch, including a handle with
+		//   a different block size that is computed on its own
+		byte message[100], expected[16], actual[16];
+		GlobalRNG().GenerateBlock(message, sizeof(message));
+		CMAC<AES> aesCheck(key+16, 16);
+		CMAC<DES_EDE3> desCheck(key, 24);
+
+		CMAC_Base::BatchMessage messages[2];
+		messages[0].key = &aes2; messages[1].key = &des1;
+		for (unsigned int i=0; i<2; ++i)
+		{
+			messages[i].input = message;
+			messages[i].length = sizeof(message);
+			messages[i].digest = actual;
+			messages[i].digestSize = 8;
+		}
+
+		aes2.Update(message, 37);
+		des1.Update(message, 37);
+		aes1.CalculateDigestBatch(messages, 2);
+		aes2.Update(message+37, sizeof(message)-37);
+		des1.Update(message+37, sizeof(message)-37);
+
+		bool progress = true;
+		aesCheck.CalculateDigest(expected, message, sizeof(message));
+		aes2.Final(actual);
+		progress = memcmp(expected, actual, aes2.DigestSize()) == 0;
+		desCheck.CalculateDigest(expected, message, sizeof(message));
+		des1.Final(actual);
+		progress = progress && memcmp(expected, actual, des1.DigestSize()) == 0;
+
+		fail = fail || !progress;
+		std::cout << (progress ? "passed   " : "FAILED   ") << "CMAC batch keeps a message in progress" << std::endl;
+	}
+	return pass && !fail;
 }
 
 NAMESPACE_END  // Test
@@ -22,6 +22,7 @@
 #include "whrlpool.h"
 #include "hkdf.h"
 #include "poly1305.h"
+#include "chacha.h"
 #include "siphash.h"
 #include "blake2.h"
 #include "hmac.h"
@@ -775,6 +776,57 @@ struct Poly1305_TestTuples
 	size_t klen, mlen, nlen, dlen;
 };
 
+// The one-shot functions must match the keyed objects
+bool TestOneShotPrimitives()
+{
+	SecByteBlock key(32), iv(8), input(16), data(200), expected(128), output(64);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(input, input.size());
+	GlobalRNG().GenerateBlock(data, data.size());
+
+	bool pass = true;
+	for (size_t keyLength=16; keyLength<=32; keyLength+=8)
+	{
+		AES::Encryption aes(key, keyLength);
+		aes.ProcessBlock(input, expected);
+		AES::EncryptBlock(output, key, keyLength, input);
+		pass = pass && memcmp(output, expected, 16) == 0;
+	}
+
+	for (size_t keyLength=16; keyLength<=32; keyLength+=16)
+	{
+		ChaCha20::Encryption chacha(key, keyLength, iv);
+		memset(expected, 0, 128);
+		chacha.ProcessString(expected, 128);
+
+		// Block counter, then the IV
+		byte block[16] = {0};
+		memcpy(block+8, iv, 8);
+		for (unsigned int i=0; i<2; ++i)
+		{
+			block[0] = (byte)i;
+			ChaCha20::Block(output, key, keyLength, block);
+			pass = pass && memcmp(output, expected+64*i, 64) == 0;
+		}
+	}
+
+	// Poly1305-AES is the one-time key r || AES_k(nonce)
+	for (size_t length=0; length<data.size(); length+=13)
+	{
+		Poly1305<AES> poly1305(key, 32, input, 16);
+		poly1305.CalculateDigest(expected, data, length);
+
+		byte oneTimeKey[32];
+		memcpy(oneTimeKey, key+16, 16);
+		AES::EncryptBlock(oneTimeKey+16, key, 16, input);
+		Poly1305OneTime::Hash(output, oneTimeKey, data, length);
+		pass = pass && memcmp(output, expected, 16) == 0;
+	}
+
+	return pass;
+}
+
 bool ValidatePoly1305()
 {
 	std::cout << "\nPoly1305 validation suite running...\n\n";
@@ -890,6 +942,77 @@ bool ValidatePoly1305()
 
 	std::cout << (!pass ? "FAILED   " : "passed   ") << count << " message authentication codes" << std::endl;
 
+	// Test data from RFC 7539, sections 2.5.2 and 2.6.2
+	{
+		const byte key[] = {
+			0x85,0xd6,0xbe,0x78,0x57,0x55,0x6d,0x33,0x7f,0x44,0x52,0xfe,0x42,0xd5,0x06,0xa8,
+			0x01,0x03,0x80,0x8a,0xfb,0x0d,0xb2,0xfd,0x4a,0xbf,0xf6,0xaf,0x41,0x49,0xf5,0x1b
+		};
+		const byte tag[] = {
+			0xa8,0x06,0x1d,0xc1,0x30,0x51,0x36,0xc6,0xc2,0x2b,0x8b,0xaf,0x0c,0x01,0x27,0xa9
+		};
+		const char message[] = "Cryptographic Forum Research Group";
+
+		Poly1305OneTime::Hash(digest, key, (const byte*)message, COUNTOF(message)-1);
+		fail = !!memcmp(digest, tag, sizeof(tag)) != 0;
+
+		const byte chachaKey[] = {
+			0x80,0x81,0x82,0x83,0x84,0x85,0x86,0x87,0x88,0x89,0x8a,0x8b,0x8c,0x8d,0x8e,0x8f,
+			0x90,0x91,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0x9b,0x9c,0x9d,0x9e,0x9f
+		};
+		const byte counterAndNonce[] = {
+			0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07
+		};
+		const byte oneTimeKey[] = {
+			0x8a,0xd5,0xa0,0x8b,0x90,0x5f,0x81,0xcc,0x81,0x50,0x40,0x27,0x4a,0xb2,0x94,0x71,
+			0xa8,0x33,0xb6,0x37,0xe3,0xfd,0x0d,0xa5,0x08,0xdb,0xb8,0xe2,0xfd,0xd1,0xa6,0x46
+		};
+		byte block[64];
+
+		ChaCha20::Block(block, chachaKey, sizeof(chachaKey), counterAndNonce);
+		fail = !!memcmp(block, oneTimeKey, sizeof(oneTimeKey)) != 0 || fail;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "one-time key generation and MAC\n";
+		pass = pass && !fail;
+	}
+
+	{
+		fail = !TestOneShotPrimitives();
+		std::cout << (fail ? "FAILED   " : "passed   ") << "one-shot AES, ChaCha20 and Poly1305\n";
+		pass = pass && !fail;
+	}
+
+	return pass;
+}
+
+// Hash() and HashBatch() must match a SipHash object
+template <unsigned int C, unsigned int D, bool T_128bit>
+bool TestSipHashOneShot()
+{
+	typedef SipHash<C, D, T_128bit> MAC;
+	const size_t count = 70, maxLength = 200, digestSize = MAC::DIGESTSIZE;
+	SecByteBlock key(16), data(count*maxLength), digests(count*digestSize), digest(digestSize), expected(digestSize);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(data, data.size());
+
+	std::vector<const byte *> inputs(count);
+	std::vector<size_t> lengths(count);
+	for (size_t i=0; i<count; ++i)
+	{
+		inputs[i] = data+i*maxLength;
+		lengths[i] = (i*29)%maxLength;
+	}
+
+	MAC mac(key, (unsigned int)key.size());
+	MAC::HashBatch(digests, key, &inputs[0], &lengths[0], count);
+
+	bool pass = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		mac.CalculateDigest(expected, inputs[i], lengths[i]);
+		MAC::Hash(digest, key, inputs[i], lengths[i]);
+		pass = pass && expected == digest && memcmp(expected, digests+i*digestSize, digestSize) == 0;
+	}
 	return pass;
 }
 
@@ -1064,6 +1187,11 @@ bool ValidateSipHash()
 		pass = pass4 && pass;
 	}
 
+	fail = !TestSipHashOneShot<2,4,false>() || !TestSipHashOneShot<2,4,true>() ||
+		!TestSipHashOneShot<4,8,false>() || !TestSipHashOneShot<4,8,true>();
+	std::cout << (fail ? "FAILED   " : "passed   ") << "SipHash one-shot and batch\n";
+	pass = !fail && pass;
+
 	return pass;
 }
 
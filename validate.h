@@ -20,10 +20,12 @@ bool TestOS_RNG();
 // bool TestSecRandom();
 bool TestAutoSeeded();
 bool TestAutoSeededX917();
+bool TestAutoSeededThreadLocal();
 
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
 bool TestRDRAND();
 bool TestRDSEED();
+bool TestHardwareSeeded();
 #endif
 
 bool ValidateBaseCode();
@@ -81,6 +83,8 @@ bool ValidateVMAC();
 bool ValidateCCM();
 bool ValidateGCM();
 bool ValidateCMAC();
+bool ValidateGCM_SIV();
+bool ValidateOCB();
 
 bool ValidateBBS();
 bool ValidateDH();
@@ -106,6 +110,7 @@ bool ValidateESIGN();
 
 bool ValidateHashDRBG();
 bool ValidateHmacDRBG();
+bool ValidateCtrDRBG();
 
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_IMPORTS)
 // http://github.com/weidai11/cryptopp/issues/92
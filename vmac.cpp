@@ -493,7 +493,11 @@ VMAC_Base::VHASH_Update_SSE2(const word64 *data, size_t blocksRemainingInWord64,
 	#if defined(CRYPTOPP_X64_ASM_AVAILABLE)
 		#define DeclareNH(a)			word64 a##0=0, a##1=0
 		#define MUL64(rh,rl,i1,i2)		asm ("mulq %3" : "=a"(rl), "=d"(rh) : "a"(i1), "g"(i2) : "cc");
-		#define AccumulateNH(a, b, c)	asm ("mulq %3; addq %%rax, %0; adcq %%rdx, %1" : "+r"(a##0), "+r"(a##1) : "a"(b), "g"(c) : "%rdx", "cc");
+		// mulq overwrites its rax operand, so it is bound to a temporary declared as an output.
+		//   A PMULUDQ based NH needs four partial products per 64x64 multiply and loses to this.
+		#define AccumulateNH(a, b, c)	{\
+			word64 _b = (b);\
+			asm ("mulq %3; addq %%rax, %0; adcq %%rdx, %1" : "+r"(a##0), "+r"(a##1), "+a"(_b) : "g"(c) : "%rdx", "cc");}
 		#define ADD128(rh,rl,ih,il)     asm ("addq %3, %1; adcq %2, %0" : "+r"(rh),"+r"(rl) : "r"(ih),"r"(il) : "cc");
 	#elif defined(_MSC_VER) && !CRYPTOPP_BOOL_SLOW_WORD64
 		#define DeclareNH(a) word64 a##0=0, a##1=0
@@ -2,713 +2,6 @@ include ksamd64.inc
 EXTERNDEF s_sosemanukMulTables:FAR
 .CODE
 
-ALIGN 8
-Salsa20_OperateKeystream PROC FRAME
-mov r10, [rsp + 5*8]
-alloc_stack(10*16 + 32*16 + 8)
-save_xmm128 xmm6, 0200h
-save_xmm128 xmm7, 0210h
-save_xmm128 xmm8, 0220h
-save_xmm128 xmm9, 0230h
-save_xmm128 xmm10, 0240h
-save_xmm128 xmm11, 0250h
-save_xmm128 xmm12, 0260h
-save_xmm128 xmm13, 0270h
-save_xmm128 xmm14, 0280h
-save_xmm128 xmm15, 0290h
-.endprolog
-cmp r8, 4
-jl label5
-movdqa xmm0, [r10 + 0*16]
-movdqa xmm1, [r10 + 1*16]
-movdqa xmm2, [r10 + 2*16]
-movdqa xmm3, [r10 + 3*16]
-pshufd xmm4, xmm0, 0*64+0*16+0*4+0
-movdqa [rsp + (0*4+0)*16 + 256], xmm4
-pshufd xmm4, xmm0, 1*64+1*16+1*4+1
-movdqa [rsp + (0*4+1)*16 + 256], xmm4
-pshufd xmm4, xmm0, 2*64+2*16+2*4+2
-movdqa [rsp + (0*4+2)*16 + 256], xmm4
-pshufd xmm4, xmm0, 3*64+3*16+3*4+3
-movdqa [rsp + (0*4+3)*16 + 256], xmm4
-pshufd xmm4, xmm1, 0*64+0*16+0*4+0
-movdqa [rsp + (1*4+0)*16 + 256], xmm4
-pshufd xmm4, xmm1, 2*64+2*16+2*4+2
-movdqa [rsp + (1*4+2)*16 + 256], xmm4
-pshufd xmm4, xmm1, 3*64+3*16+3*4+3
-movdqa [rsp + (1*4+3)*16 + 256], xmm4
-pshufd xmm4, xmm2, 1*64+1*16+1*4+1
-movdqa [rsp + (2*4+1)*16 + 256], xmm4
-pshufd xmm4, xmm2, 2*64+2*16+2*4+2
-movdqa [rsp + (2*4+2)*16 + 256], xmm4
-pshufd xmm4, xmm2, 3*64+3*16+3*4+3
-movdqa [rsp + (2*4+3)*16 + 256], xmm4
-pshufd xmm4, xmm3, 0*64+0*16+0*4+0
-movdqa [rsp + (3*4+0)*16 + 256], xmm4
-pshufd xmm4, xmm3, 1*64+1*16+1*4+1
-movdqa [rsp + (3*4+1)*16 + 256], xmm4
-pshufd xmm4, xmm3, 2*64+2*16+2*4+2
-movdqa [rsp + (3*4+2)*16 + 256], xmm4
-pshufd xmm4, xmm3, 3*64+3*16+3*4+3
-movdqa [rsp + (3*4+3)*16 + 256], xmm4
-label1:
-mov eax, dword ptr [r10 + 8*4]
-mov r11d, dword ptr [r10 + 5*4]
-mov dword ptr [rsp + 8*16 + 0*4 + 256], eax
-mov dword ptr [rsp + 5*16 + 0*4 + 256], r11d
-add eax, 1
-adc r11d, 0
-mov dword ptr [rsp + 8*16 + 1*4 + 256], eax
-mov dword ptr [rsp + 5*16 + 1*4 + 256], r11d
-add eax, 1
-adc r11d, 0
-mov dword ptr [rsp + 8*16 + 2*4 + 256], eax
-mov dword ptr [rsp + 5*16 + 2*4 + 256], r11d
-add eax, 1
-adc r11d, 0
-mov dword ptr [rsp + 8*16 + 3*4 + 256], eax
-mov dword ptr [rsp + 5*16 + 3*4 + 256], r11d
-add eax, 1
-adc r11d, 0
-mov dword ptr [r10 + 8*4], eax
-mov dword ptr [r10 + 5*4], r11d
-movdqa xmm0, [rsp + 12*16 + 1*256]
-movdqa xmm4, [rsp + 13*16 + 1*256]
-movdqa xmm8, [rsp + 14*16 + 1*256]
-movdqa xmm12, [rsp + 15*16 + 1*256]
-movdqa xmm2, [rsp + 0*16 + 1*256]
-movdqa xmm6, [rsp + 1*16 + 1*256]
-movdqa xmm10, [rsp + 2*16 + 1*256]
-movdqa xmm14, [rsp + 3*16 + 1*256]
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 7
-pslld xmm4, 7
-pslld xmm8, 7
-pslld xmm12, 7
-psrld xmm1, 32-7
-psrld xmm5, 32-7
-psrld xmm9, 32-7
-psrld xmm13, 32-7
-pxor xmm0, [rsp + 4*16 + 1*256]
-pxor xmm4, [rsp + 5*16 + 1*256]
-pxor xmm8, [rsp + 6*16 + 1*256]
-pxor xmm12, [rsp + 7*16 + 1*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 4*16], xmm0
-movdqa [rsp + 5*16], xmm4
-movdqa [rsp + 6*16], xmm8
-movdqa [rsp + 7*16], xmm12
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 9
-pslld xmm4, 9
-pslld xmm8, 9
-pslld xmm12, 9
-psrld xmm3, 32-9
-psrld xmm7, 32-9
-psrld xmm11, 32-9
-psrld xmm15, 32-9
-pxor xmm0, [rsp + 8*16 + 1*256]
-pxor xmm4, [rsp + 9*16 + 1*256]
-pxor xmm8, [rsp + 10*16 + 1*256]
-pxor xmm12, [rsp + 11*16 + 1*256]
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 8*16], xmm0
-movdqa [rsp + 9*16], xmm4
-movdqa [rsp + 10*16], xmm8
-movdqa [rsp + 11*16], xmm12
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-paddd xmm0, xmm1
-paddd xmm4, xmm5
-paddd xmm8, xmm9
-paddd xmm12, xmm13
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 13
-pslld xmm4, 13
-pslld xmm8, 13
-pslld xmm12, 13
-psrld xmm1, 32-13
-psrld xmm5, 32-13
-psrld xmm9, 32-13
-psrld xmm13, 32-13
-pxor xmm0, [rsp + 12*16 + 1*256]
-pxor xmm4, [rsp + 13*16 + 1*256]
-pxor xmm8, [rsp + 14*16 + 1*256]
-pxor xmm12, [rsp + 15*16 + 1*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 12*16], xmm0
-movdqa [rsp + 13*16], xmm4
-movdqa [rsp + 14*16], xmm8
-movdqa [rsp + 15*16], xmm12
-paddd xmm0, xmm3
-paddd xmm4, xmm7
-paddd xmm8, xmm11
-paddd xmm12, xmm15
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 18
-pslld xmm4, 18
-pslld xmm8, 18
-pslld xmm12, 18
-psrld xmm3, 32-18
-psrld xmm7, 32-18
-psrld xmm11, 32-18
-psrld xmm15, 32-18
-pxor xmm0, xmm2
-pxor xmm4, xmm6
-pxor xmm8, xmm10
-pxor xmm12, xmm14
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 0*16], xmm0
-movdqa [rsp + 1*16], xmm4
-movdqa [rsp + 2*16], xmm8
-movdqa [rsp + 3*16], xmm12
-mov rax, r9
-jmp label2
-labelSSE2_Salsa_Output:
-movdqa xmm0, xmm4
-punpckldq xmm4, xmm5
-movdqa xmm1, xmm6
-punpckldq xmm6, xmm7
-movdqa xmm2, xmm4
-punpcklqdq xmm4, xmm6
-punpckhqdq xmm2, xmm6
-punpckhdq xmm0, xmm5
-punpckhdq xmm1, xmm7
-movdqa xmm6, xmm0
-punpcklqdq xmm0, xmm1
-punpckhqdq xmm6, xmm1
-test rdx, rdx
-jz labelSSE2_Salsa_Output_A3
-test rdx, 15
-jnz labelSSE2_Salsa_Output_A7
-pxor xmm4, [rdx+0*16]
-pxor xmm2, [rdx+4*16]
-pxor xmm0, [rdx+8*16]
-pxor xmm6, [rdx+12*16]
-add rdx, 1*16
-jmp labelSSE2_Salsa_Output_A3
-labelSSE2_Salsa_Output_A7:
-movdqu xmm1, [rdx+0*16]
-pxor xmm4, xmm1
-movdqu xmm1, [rdx+4*16]
-pxor xmm2, xmm1
-movdqu xmm1, [rdx+8*16]
-pxor xmm0, xmm1
-movdqu xmm1, [rdx+12*16]
-pxor xmm6, xmm1
-add rdx, 1*16
-labelSSE2_Salsa_Output_A3:
-test rcx, 15
-jnz labelSSE2_Salsa_Output_A8
-movdqa [rcx+0*16], xmm4
-movdqa [rcx+4*16], xmm2
-movdqa [rcx+8*16], xmm0
-movdqa [rcx+12*16], xmm6
-jmp labelSSE2_Salsa_Output_A9
-labelSSE2_Salsa_Output_A8:
-movdqu [rcx+0*16], xmm4
-movdqu [rcx+4*16], xmm2
-movdqu [rcx+8*16], xmm0
-movdqu [rcx+12*16], xmm6
-labelSSE2_Salsa_Output_A9:
-add rcx, 1*16
-ret
-label6:
-movdqa xmm0, [rsp + 12*16 + 0*256]
-movdqa xmm4, [rsp + 13*16 + 0*256]
-movdqa xmm8, [rsp + 14*16 + 0*256]
-movdqa xmm12, [rsp + 15*16 + 0*256]
-movdqa xmm2, [rsp + 0*16 + 0*256]
-movdqa xmm6, [rsp + 1*16 + 0*256]
-movdqa xmm10, [rsp + 2*16 + 0*256]
-movdqa xmm14, [rsp + 3*16 + 0*256]
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 7
-pslld xmm4, 7
-pslld xmm8, 7
-pslld xmm12, 7
-psrld xmm1, 32-7
-psrld xmm5, 32-7
-psrld xmm9, 32-7
-psrld xmm13, 32-7
-pxor xmm0, [rsp + 4*16 + 0*256]
-pxor xmm4, [rsp + 5*16 + 0*256]
-pxor xmm8, [rsp + 6*16 + 0*256]
-pxor xmm12, [rsp + 7*16 + 0*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 4*16], xmm0
-movdqa [rsp + 5*16], xmm4
-movdqa [rsp + 6*16], xmm8
-movdqa [rsp + 7*16], xmm12
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 9
-pslld xmm4, 9
-pslld xmm8, 9
-pslld xmm12, 9
-psrld xmm3, 32-9
-psrld xmm7, 32-9
-psrld xmm11, 32-9
-psrld xmm15, 32-9
-pxor xmm0, [rsp + 8*16 + 0*256]
-pxor xmm4, [rsp + 9*16 + 0*256]
-pxor xmm8, [rsp + 10*16 + 0*256]
-pxor xmm12, [rsp + 11*16 + 0*256]
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 8*16], xmm0
-movdqa [rsp + 9*16], xmm4
-movdqa [rsp + 10*16], xmm8
-movdqa [rsp + 11*16], xmm12
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-paddd xmm0, xmm1
-paddd xmm4, xmm5
-paddd xmm8, xmm9
-paddd xmm12, xmm13
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 13
-pslld xmm4, 13
-pslld xmm8, 13
-pslld xmm12, 13
-psrld xmm1, 32-13
-psrld xmm5, 32-13
-psrld xmm9, 32-13
-psrld xmm13, 32-13
-pxor xmm0, [rsp + 12*16 + 0*256]
-pxor xmm4, [rsp + 13*16 + 0*256]
-pxor xmm8, [rsp + 14*16 + 0*256]
-pxor xmm12, [rsp + 15*16 + 0*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 12*16], xmm0
-movdqa [rsp + 13*16], xmm4
-movdqa [rsp + 14*16], xmm8
-movdqa [rsp + 15*16], xmm12
-paddd xmm0, xmm3
-paddd xmm4, xmm7
-paddd xmm8, xmm11
-paddd xmm12, xmm15
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 18
-pslld xmm4, 18
-pslld xmm8, 18
-pslld xmm12, 18
-psrld xmm3, 32-18
-psrld xmm7, 32-18
-psrld xmm11, 32-18
-psrld xmm15, 32-18
-pxor xmm0, xmm2
-pxor xmm4, xmm6
-pxor xmm8, xmm10
-pxor xmm12, xmm14
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 0*16], xmm0
-movdqa [rsp + 1*16], xmm4
-movdqa [rsp + 2*16], xmm8
-movdqa [rsp + 3*16], xmm12
-label2:
-movdqa xmm0, [rsp + 7*16 + 0*256]
-movdqa xmm4, [rsp + 4*16 + 0*256]
-movdqa xmm8, [rsp + 5*16 + 0*256]
-movdqa xmm12, [rsp + 6*16 + 0*256]
-movdqa xmm2, [rsp + 0*16 + 0*256]
-movdqa xmm6, [rsp + 1*16 + 0*256]
-movdqa xmm10, [rsp + 2*16 + 0*256]
-movdqa xmm14, [rsp + 3*16 + 0*256]
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 7
-pslld xmm4, 7
-pslld xmm8, 7
-pslld xmm12, 7
-psrld xmm1, 32-7
-psrld xmm5, 32-7
-psrld xmm9, 32-7
-psrld xmm13, 32-7
-pxor xmm0, [rsp + 13*16 + 0*256]
-pxor xmm4, [rsp + 14*16 + 0*256]
-pxor xmm8, [rsp + 15*16 + 0*256]
-pxor xmm12, [rsp + 12*16 + 0*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 13*16], xmm0
-movdqa [rsp + 14*16], xmm4
-movdqa [rsp + 15*16], xmm8
-movdqa [rsp + 12*16], xmm12
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-paddd xmm0, xmm2
-paddd xmm4, xmm6
-paddd xmm8, xmm10
-paddd xmm12, xmm14
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 9
-pslld xmm4, 9
-pslld xmm8, 9
-pslld xmm12, 9
-psrld xmm3, 32-9
-psrld xmm7, 32-9
-psrld xmm11, 32-9
-psrld xmm15, 32-9
-pxor xmm0, [rsp + 10*16 + 0*256]
-pxor xmm4, [rsp + 11*16 + 0*256]
-pxor xmm8, [rsp + 8*16 + 0*256]
-pxor xmm12, [rsp + 9*16 + 0*256]
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 10*16], xmm0
-movdqa [rsp + 11*16], xmm4
-movdqa [rsp + 8*16], xmm8
-movdqa [rsp + 9*16], xmm12
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-paddd xmm0, xmm1
-paddd xmm4, xmm5
-paddd xmm8, xmm9
-paddd xmm12, xmm13
-movdqa xmm1, xmm0
-movdqa xmm5, xmm4
-movdqa xmm9, xmm8
-movdqa xmm13, xmm12
-pslld xmm0, 13
-pslld xmm4, 13
-pslld xmm8, 13
-pslld xmm12, 13
-psrld xmm1, 32-13
-psrld xmm5, 32-13
-psrld xmm9, 32-13
-psrld xmm13, 32-13
-pxor xmm0, [rsp + 7*16 + 0*256]
-pxor xmm4, [rsp + 4*16 + 0*256]
-pxor xmm8, [rsp + 5*16 + 0*256]
-pxor xmm12, [rsp + 6*16 + 0*256]
-pxor xmm0, xmm1
-pxor xmm4, xmm5
-pxor xmm8, xmm9
-pxor xmm12, xmm13
-movdqa [rsp + 7*16], xmm0
-movdqa [rsp + 4*16], xmm4
-movdqa [rsp + 5*16], xmm8
-movdqa [rsp + 6*16], xmm12
-paddd xmm0, xmm3
-paddd xmm4, xmm7
-paddd xmm8, xmm11
-paddd xmm12, xmm15
-movdqa xmm3, xmm0
-movdqa xmm7, xmm4
-movdqa xmm11, xmm8
-movdqa xmm15, xmm12
-pslld xmm0, 18
-pslld xmm4, 18
-pslld xmm8, 18
-pslld xmm12, 18
-psrld xmm3, 32-18
-psrld xmm7, 32-18
-psrld xmm11, 32-18
-psrld xmm15, 32-18
-pxor xmm0, xmm2
-pxor xmm4, xmm6
-pxor xmm8, xmm10
-pxor xmm12, xmm14
-pxor xmm0, xmm3
-pxor xmm4, xmm7
-pxor xmm8, xmm11
-pxor xmm12, xmm15
-movdqa [rsp + 0*16], xmm0
-movdqa [rsp + 1*16], xmm4
-movdqa [rsp + 2*16], xmm8
-movdqa [rsp + 3*16], xmm12
-sub eax, 2
-jnz label6
-movdqa xmm4, [rsp + 0*16 + 256]
-paddd xmm4, [rsp + 0*16]
-movdqa xmm5, [rsp + 13*16 + 256]
-paddd xmm5, [rsp + 13*16]
-movdqa xmm6, [rsp + 10*16 + 256]
-paddd xmm6, [rsp + 10*16]
-movdqa xmm7, [rsp + 7*16 + 256]
-paddd xmm7, [rsp + 7*16]
-call labelSSE2_Salsa_Output
-movdqa xmm4, [rsp + 4*16 + 256]
-paddd xmm4, [rsp + 4*16]
-movdqa xmm5, [rsp + 1*16 + 256]
-paddd xmm5, [rsp + 1*16]
-movdqa xmm6, [rsp + 14*16 + 256]
-paddd xmm6, [rsp + 14*16]
-movdqa xmm7, [rsp + 11*16 + 256]
-paddd xmm7, [rsp + 11*16]
-call labelSSE2_Salsa_Output
-movdqa xmm4, [rsp + 8*16 + 256]
-paddd xmm4, [rsp + 8*16]
-movdqa xmm5, [rsp + 5*16 + 256]
-paddd xmm5, [rsp + 5*16]
-movdqa xmm6, [rsp + 2*16 + 256]
-paddd xmm6, [rsp + 2*16]
-movdqa xmm7, [rsp + 15*16 + 256]
-paddd xmm7, [rsp + 15*16]
-call labelSSE2_Salsa_Output
-movdqa xmm4, [rsp + 12*16 + 256]
-paddd xmm4, [rsp + 12*16]
-movdqa xmm5, [rsp + 9*16 + 256]
-paddd xmm5, [rsp + 9*16]
-movdqa xmm6, [rsp + 6*16 + 256]
-paddd xmm6, [rsp + 6*16]
-movdqa xmm7, [rsp + 3*16 + 256]
-paddd xmm7, [rsp + 3*16]
-call labelSSE2_Salsa_Output
-test rdx, rdx
-jz label9
-add rdx, 12*16
-label9:
-add rcx, 12*16
-sub r8, 4
-cmp r8, 4
-jge label1
-label5:
-sub r8, 1
-jl label4
-movdqa xmm0, [r10 + 0*16]
-movdqa xmm1, [r10 + 1*16]
-movdqa xmm2, [r10 + 2*16]
-movdqa xmm3, [r10 + 3*16]
-mov rax, r9
-label0:
-movdqa xmm4, xmm3
-paddd xmm4, xmm0
-movdqa xmm5, xmm4
-pslld xmm4, 7
-psrld xmm5, 32-7
-pxor xmm1, xmm4
-pxor xmm1, xmm5
-movdqa xmm4, xmm0
-paddd xmm4, xmm1
-movdqa xmm5, xmm4
-pslld xmm4, 9
-psrld xmm5, 32-9
-pxor xmm2, xmm4
-pxor xmm2, xmm5
-movdqa xmm4, xmm1
-paddd xmm4, xmm2
-movdqa xmm5, xmm4
-pslld xmm4, 13
-psrld xmm5, 32-13
-pxor xmm3, xmm4
-pxor xmm3, xmm5
-movdqa xmm4, xmm2
-paddd xmm4, xmm3
-movdqa xmm5, xmm4
-pslld xmm4, 18
-psrld xmm5, 32-18
-pxor xmm0, xmm4
-pxor xmm0, xmm5
-pshufd xmm1, xmm1, 2*64+1*16+0*4+3
-pshufd xmm2, xmm2, 1*64+0*16+3*4+2
-pshufd xmm3, xmm3, 0*64+3*16+2*4+1
-movdqa xmm4, xmm1
-paddd xmm4, xmm0
-movdqa xmm5, xmm4
-pslld xmm4, 7
-psrld xmm5, 32-7
-pxor xmm3, xmm4
-pxor xmm3, xmm5
-movdqa xmm4, xmm0
-paddd xmm4, xmm3
-movdqa xmm5, xmm4
-pslld xmm4, 9
-psrld xmm5, 32-9
-pxor xmm2, xmm4
-pxor xmm2, xmm5
-movdqa xmm4, xmm3
-paddd xmm4, xmm2
-movdqa xmm5, xmm4
-pslld xmm4, 13
-psrld xmm5, 32-13
-pxor xmm1, xmm4
-pxor xmm1, xmm5
-movdqa xmm4, xmm2
-paddd xmm4, xmm1
-movdqa xmm5, xmm4
-pslld xmm4, 18
-psrld xmm5, 32-18
-pxor xmm0, xmm4
-pxor xmm0, xmm5
-pshufd xmm1, xmm1, 0*64+3*16+2*4+1
-pshufd xmm2, xmm2, 1*64+0*16+3*4+2
-pshufd xmm3, xmm3, 2*64+1*16+0*4+3
-sub eax, 2
-jnz label0
-paddd xmm0, [r10 + 0*16]
-paddd xmm1, [r10 + 1*16]
-paddd xmm2, [r10 + 2*16]
-paddd xmm3, [r10 + 3*16]
-add dword ptr [r10 + 8*4], 1
-adc dword ptr [r10 + 5*4], 0
-pcmpeqb xmm6, xmm6
-psrlq xmm6, 32
-pshufd xmm7, xmm6, 0*64+1*16+2*4+3
-movdqa xmm4, xmm0
-movdqa xmm5, xmm3
-pand xmm0, xmm7
-pand xmm4, xmm6
-pand xmm3, xmm6
-pand xmm5, xmm7
-por xmm4, xmm5
-movdqa xmm5, xmm1
-pand xmm1, xmm7
-pand xmm5, xmm6
-por xmm0, xmm5
-pand xmm6, xmm2
-pand xmm2, xmm7
-por xmm1, xmm6
-por xmm2, xmm3
-movdqa xmm5, xmm4
-movdqa xmm6, xmm0
-shufpd xmm4, xmm1, 2
-shufpd xmm0, xmm2, 2
-shufpd xmm1, xmm5, 2
-shufpd xmm2, xmm6, 2
-test rdx, rdx
-jz labelSSE2_Salsa_Output_B3
-test rdx, 15
-jnz labelSSE2_Salsa_Output_B7
-pxor xmm4, [rdx+0*16]
-pxor xmm0, [rdx+1*16]
-pxor xmm1, [rdx+2*16]
-pxor xmm2, [rdx+3*16]
-add rdx, 4*16
-jmp labelSSE2_Salsa_Output_B3
-labelSSE2_Salsa_Output_B7:
-movdqu xmm3, [rdx+0*16]
-pxor xmm4, xmm3
-movdqu xmm3, [rdx+1*16]
-pxor xmm0, xmm3
-movdqu xmm3, [rdx+2*16]
-pxor xmm1, xmm3
-movdqu xmm3, [rdx+3*16]
-pxor xmm2, xmm3
-add rdx, 4*16
-labelSSE2_Salsa_Output_B3:
-test rcx, 15
-jnz labelSSE2_Salsa_Output_B8
-movdqa [rcx+0*16], xmm4
-movdqa [rcx+1*16], xmm0
-movdqa [rcx+2*16], xmm1
-movdqa [rcx+3*16], xmm2
-jmp labelSSE2_Salsa_Output_B9
-labelSSE2_Salsa_Output_B8:
-movdqu [rcx+0*16], xmm4
-movdqu [rcx+1*16], xmm0
-movdqu [rcx+2*16], xmm1
-movdqu [rcx+3*16], xmm2
-labelSSE2_Salsa_Output_B9:
-add rcx, 4*16
-jmp label5
-label4:
-movdqa xmm6, [rsp + 0200h]
-movdqa xmm7, [rsp + 0210h]
-movdqa xmm8, [rsp + 0220h]
-movdqa xmm9, [rsp + 0230h]
-movdqa xmm10, [rsp + 0240h]
-movdqa xmm11, [rsp + 0250h]
-movdqa xmm12, [rsp + 0260h]
-movdqa xmm13, [rsp + 0270h]
-movdqa xmm14, [rsp + 0280h]
-movdqa xmm15, [rsp + 0290h]
-add rsp, 10*16 + 32*16 + 8
-ret
-Salsa20_OperateKeystream ENDP
-
 ALIGN 8
 Sosemanuk_OperateKeystream PROC FRAME
 rex_push_reg rsi
@@ -1549,6 +842,7 @@ add r10, 32
 cmp r10, rdi
 jne label4
 mov [rdx+4*16], eax
+mov [rdx+4*17], r10d
 movdqa xmmword ptr [rdx+3*16], xmm3
 movdqa xmmword ptr [rdx+2*16], xmm2
 movdqa xmmword ptr [rdx+1*16], xmm1